@@ -0,0 +1,321 @@
+/*
+ * @brief GPDMA memory copy and fill service
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "dma_mem.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Control word and steps of word wide memory to memory descriptors */
+static GPDMA_DESC_TEMPLATE_T copyTmpl;
+
+/* Copies and fills below this size are made by the CPU */
+static uint32_t cpuThreshold = DMA_MEM_THRESHOLD;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Called from the DMA interrupt when the words of a job are moved */
+static void dmaMem_Done(GPDMA_REQ_T *pReq, Status status)
+{
+	DMA_MEM_JOB_T *pJob = (DMA_MEM_JOB_T *) pReq->pUserData;
+
+	pJob->status = status;
+	pJob->busy = 0;
+}
+
+/* Fill memory with the CPU, a word at a time once aligned */
+static void dmaMem_CpuFill(uint8_t *d, uint32_t fill, uint32_t bytes)
+{
+	uint32_t *dw;
+
+	while ((((uint32_t) d) & 3) && (bytes > 0)) {
+		*d++ = (uint8_t) fill;
+		bytes--;
+	}
+
+	dw = (uint32_t *) d;
+	while (bytes >= 16) {
+		dw[0] = fill;
+		dw[1] = fill;
+		dw[2] = fill;
+		dw[3] = fill;
+		dw += 4;
+		bytes -= 16;
+	}
+	while (bytes >= 4) {
+		*dw++ = fill;
+		bytes -= 4;
+	}
+
+	d = (uint8_t *) dw;
+	while (bytes > 0) {
+		*d++ = (uint8_t) fill;
+		bytes--;
+	}
+}
+
+/* Start moving words, from the fill pattern when pSrc is NULL */
+static Status dmaMem_Start(DMA_MEM_JOB_T *pJob, uint32_t *pDst, const uint32_t *pSrc, uint32_t words)
+{
+	int i, numDesc;
+
+	numDesc = Chip_GPDMA_BuildDescList(&copyTmpl, pJob->desc, DMA_MEM_MAX_DESC,
+									   (uint32_t) pSrc, (uint32_t) pDst, words * 4, NULL);
+	if (numDesc == 0) {
+		return ERROR;
+	}
+
+	/* A fill reads the same word again and again */
+	if (pSrc == NULL) {
+		for (i = 0; i < numDesc; i++) {
+			pJob->desc[i].src = (uint32_t) &pJob->fill;
+			pJob->desc[i].ctrl &= ~GPDMA_DMACCxControl_SI;
+		}
+	}
+
+	pJob->req.pDesc = &pJob->desc[0];
+	pJob->req.TransferType = GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA;
+	pJob->req.priority = GPDMA_PRIO_LOW;
+	pJob->req.callback = dmaMem_Done;
+	pJob->req.pChain = NULL;
+	pJob->req.pUserData = pJob;
+	pJob->busy = 1;
+	if (Chip_GPDMA_Submit(LPC_GPDMA, &pJob->req) == ERROR) {
+		pJob->busy = 0;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the copy and fill service */
+void dmaMem_Init(void)
+{
+	Chip_GPDMA_InitDescTemplate(LPC_GPDMA, &copyTmpl, GPDMA_CONN_MEMORY, GPDMA_CONN_MEMORY,
+								GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
+}
+
+/* Initialize a job before its first use */
+void dmaMem_InitJob(DMA_MEM_JOB_T *pJob)
+{
+	memset(&pJob->req, 0, sizeof(pJob->req));
+	pJob->busy = 0;
+	pJob->status = SUCCESS;
+}
+
+/* Set the size below which copies and fills are made by the CPU */
+void dmaMem_SetThreshold(uint32_t bytes)
+{
+	cpuThreshold = bytes;
+}
+
+/* Copy memory with the CPU */
+void dmaMem_CpuCopy(void *dst, const void *src, uint32_t bytes)
+{
+	uint8_t *d = (uint8_t *) dst;
+	const uint8_t *s = (const uint8_t *) src;
+	uint32_t *dw;
+	const uint32_t *sw;
+	uint32_t w0, w1, w2, w3;
+
+	if (((((uint32_t) d) ^ ((uint32_t) s)) & 3) == 0) {
+		while ((((uint32_t) d) & 3) && (bytes > 0)) {
+			*d++ = *s++;
+			bytes--;
+		}
+
+		/* 4 loads then 4 stores, compiled to LDM and STM */
+		dw = (uint32_t *) d;
+		sw = (const uint32_t *) s;
+		while (bytes >= 16) {
+			w0 = sw[0];
+			w1 = sw[1];
+			w2 = sw[2];
+			w3 = sw[3];
+			dw[0] = w0;
+			dw[1] = w1;
+			dw[2] = w2;
+			dw[3] = w3;
+			sw += 4;
+			dw += 4;
+			bytes -= 16;
+		}
+		while (bytes >= 4) {
+			*dw++ = *sw++;
+			bytes -= 4;
+		}
+		d = (uint8_t *) dw;
+		s = (const uint8_t *) sw;
+	}
+
+	while (bytes > 0) {
+		*d++ = *s++;
+		bytes--;
+	}
+}
+
+/* Start copying memory */
+Status dmaMem_CopyAsync(DMA_MEM_JOB_T *pJob, void *dst, const void *src, uint32_t bytes)
+{
+	uint8_t *d = (uint8_t *) dst;
+	const uint8_t *s = (const uint8_t *) src;
+	uint32_t head, tail;
+
+	if ((pJob->busy) || (bytes > DMA_MEM_MAX_JOB)) {
+		return ERROR;
+	}
+	pJob->status = SUCCESS;
+
+	/* The DMA moves words, both buffers must share the word alignment */
+	if ((bytes < cpuThreshold) || (((((uint32_t) d) ^ ((uint32_t) s)) & 3) != 0)) {
+		dmaMem_CpuCopy(d, s, bytes);
+		return SUCCESS;
+	}
+
+	head = (4 - (((uint32_t) d) & 3)) & 3;
+	if (head > bytes) {
+		head = bytes;
+	}
+	dmaMem_CpuCopy(d, s, head);
+	d += head;
+	s += head;
+	bytes -= head;
+
+	tail = bytes & 3;
+	bytes -= tail;
+	dmaMem_CpuCopy(d + bytes, s + bytes, tail);
+
+	if (bytes == 0) {
+		return SUCCESS;
+	}
+	return dmaMem_Start(pJob, (uint32_t *) d, (const uint32_t *) s, bytes / 4);
+}
+
+/* Start filling memory */
+Status dmaMem_SetAsync(DMA_MEM_JOB_T *pJob, void *dst, int value, uint32_t bytes)
+{
+	uint8_t *d = (uint8_t *) dst;
+	uint32_t head, tail;
+
+	if ((pJob->busy) || (bytes > DMA_MEM_MAX_JOB)) {
+		return ERROR;
+	}
+	pJob->status = SUCCESS;
+	pJob->fill = ((uint8_t) value) * 0x01010101UL;
+
+	if (bytes < cpuThreshold) {
+		dmaMem_CpuFill(d, pJob->fill, bytes);
+		return SUCCESS;
+	}
+
+	head = (4 - (((uint32_t) d) & 3)) & 3;
+	if (head > bytes) {
+		head = bytes;
+	}
+	dmaMem_CpuFill(d, pJob->fill, head);
+	d += head;
+	bytes -= head;
+
+	tail = bytes & 3;
+	bytes -= tail;
+	dmaMem_CpuFill(d + bytes, pJob->fill, tail);
+
+	if (bytes == 0) {
+		return SUCCESS;
+	}
+	return dmaMem_Start(pJob, (uint32_t *) d, NULL, bytes / 4);
+}
+
+/* Wait for a job to complete */
+Status dmaMem_Wait(DMA_MEM_JOB_T *pJob)
+{
+	while (pJob->busy) {}
+
+	return pJob->status;
+}
+
+/* Copy memory, a drop in replacement for memcpy() */
+void *dmaMem_Copy(void *dst, const void *src, uint32_t bytes)
+{
+	DMA_MEM_JOB_T job;
+	uint32_t offset, chunk;
+
+	dmaMem_InitJob(&job);
+	for (offset = 0; offset < bytes; offset += chunk) {
+		chunk = bytes - offset;
+		if (chunk > DMA_MEM_MAX_JOB) {
+			chunk = DMA_MEM_MAX_JOB;
+		}
+
+		/* Falls back to the CPU if the DMA cannot be used */
+		if ((dmaMem_CopyAsync(&job, (uint8_t *) dst + offset, (const uint8_t *) src + offset, chunk) == ERROR) ||
+			(dmaMem_Wait(&job) == ERROR)) {
+			dmaMem_CpuCopy((uint8_t *) dst + offset, (const uint8_t *) src + offset, chunk);
+		}
+	}
+
+	return dst;
+}
+
+/* Fill memory, a drop in replacement for memset() */
+void *dmaMem_Set(void *dst, int value, uint32_t bytes)
+{
+	DMA_MEM_JOB_T job;
+	uint32_t offset, chunk;
+
+	dmaMem_InitJob(&job);
+	for (offset = 0; offset < bytes; offset += chunk) {
+		chunk = bytes - offset;
+		if (chunk > DMA_MEM_MAX_JOB) {
+			chunk = DMA_MEM_MAX_JOB;
+		}
+
+		/* Falls back to the CPU if the DMA cannot be used */
+		if ((dmaMem_SetAsync(&job, (uint8_t *) dst + offset, value, chunk) == ERROR) ||
+			(dmaMem_Wait(&job) == ERROR)) {
+			dmaMem_CpuFill((uint8_t *) dst + offset, ((uint8_t) value) * 0x01010101UL, chunk);
+		}
+	}
+
+	return dst;
+}
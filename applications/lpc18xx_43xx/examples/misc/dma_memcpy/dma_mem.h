@@ -0,0 +1,179 @@
+/*
+ * @brief GPDMA memory copy and fill service
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __DMA_MEM_H_
+#define __DMA_MEM_H_
+
+#include "board.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Default size below which copies and fills are made by the CPU, in bytes.
+ * Starting a DMA request and taking its interrupt costs about as much as
+ * a CPU copy of this size from SRAM.
+ */
+#ifndef DMA_MEM_THRESHOLD
+#define DMA_MEM_THRESHOLD       (512)
+#endif
+
+/**
+ * Descriptors in a job, each moving up to 4095 words, which gives the
+ * largest size of one asynchronous copy or fill.
+ */
+#ifndef DMA_MEM_MAX_DESC
+#define DMA_MEM_MAX_DESC        (16)
+#endif
+
+/** Largest asynchronous copy or fill, in bytes */
+#define DMA_MEM_MAX_JOB         (DMA_MEM_MAX_DESC * GPDMA_MAX_TRANSFER_SIZE * 4)
+
+/**
+ * Copy or fill job, the completion token of the asynchronous calls. The
+ * fields are private, use the functions below. The job must be set up
+ * with dmaMem_InitJob() and stay valid until dmaMem_IsDone() returns true.
+ */
+typedef struct {
+	GPDMA_REQ_T req;									/*!< GPDMA request of the word aligned part */
+	DMA_TransferDescriptor_t desc[DMA_MEM_MAX_DESC];	/*!< Descriptor list of the request */
+	uint32_t fill;										/*!< Fill pattern, the source of a fill */
+	volatile uint8_t busy;								/*!< Set while the DMA transfer runs */
+	volatile Status status;								/*!< Result of the DMA transfer, set before busy is cleared */
+} DMA_MEM_JOB_T;
+
+/**
+ * @brief	Initialize the copy and fill service
+ * @return	Nothing
+ * @note	The GPDMA controller must already be initialized with
+ *			Chip_GPDMA_Init(), and Chip_GPDMA_ServiceIRQHandler() called from
+ *			DMA_IRQHandler() with the DMA interrupt enabled.
+ */
+void dmaMem_Init(void);
+
+/**
+ * @brief	Initialize a job before its first use
+ * @param	pJob	: Job to initialize
+ * @return	Nothing
+ */
+void dmaMem_InitJob(DMA_MEM_JOB_T *pJob);
+
+/**
+ * @brief	Set the size below which copies and fills are made by the CPU
+ * @param	bytes	: Threshold in bytes, 0 to use the DMA for all sizes
+ * @return	Nothing
+ */
+void dmaMem_SetThreshold(uint32_t bytes);
+
+/**
+ * @brief	Copy memory with the CPU
+ * @param	dst		: Destination address
+ * @param	src		: Source address
+ * @param	bytes	: Number of bytes to copy
+ * @return	Nothing
+ * @note	Copies 4 words per loop with load and store multiple when the
+ *			buffers have the same word alignment, else byte by byte.
+ */
+void dmaMem_CpuCopy(void *dst, const void *src, uint32_t bytes);
+
+/**
+ * @brief	Start copying memory
+ * @param	pJob	: Job used as the completion token
+ * @param	dst		: Destination address
+ * @param	src		: Source address
+ * @param	bytes	: Number of bytes to copy, up to DMA_MEM_MAX_JOB
+ * @return	SUCCESS if the copy is started or done, ERROR if the job is
+ *			busy or the size too large
+ * @note	Copies below the threshold and between buffers of different
+ *			word alignment are made by the CPU before returning. Otherwise
+ *			the CPU copies the unaligned head and tail bytes and the DMA the
+ *			words in between. The buffers must not overlap.
+ */
+Status dmaMem_CopyAsync(DMA_MEM_JOB_T *pJob, void *dst, const void *src, uint32_t bytes);
+
+/**
+ * @brief	Start filling memory
+ * @param	pJob	: Job used as the completion token
+ * @param	dst		: Destination address
+ * @param	value	: Byte value to fill with
+ * @param	bytes	: Number of bytes to fill, up to DMA_MEM_MAX_JOB
+ * @return	SUCCESS if the fill is started or done, ERROR if the job is
+ *			busy or the size too large
+ * @note	Fills below the threshold are made by the CPU before returning.
+ */
+Status dmaMem_SetAsync(DMA_MEM_JOB_T *pJob, void *dst, int value, uint32_t bytes);
+
+/**
+ * @brief	Check if a job has completed
+ * @param	pJob	: Job to check
+ * @return	true once the copy or fill is done
+ */
+STATIC INLINE bool dmaMem_IsDone(const DMA_MEM_JOB_T *pJob)
+{
+	return pJob->busy == 0;
+}
+
+/**
+ * @brief	Wait for a job to complete
+ * @param	pJob	: Job to wait for
+ * @return	SUCCESS, or ERROR if the DMA transfer failed
+ */
+Status dmaMem_Wait(DMA_MEM_JOB_T *pJob);
+
+/**
+ * @brief	Copy memory, a drop in replacement for memcpy()
+ * @param	dst		: Destination address
+ * @param	src		: Source address
+ * @param	bytes	: Number of bytes to copy, no size limit
+ * @return	dst
+ * @note	Waits for the DMA, so must not be called from an interrupt
+ *			with a priority at or above the DMA interrupt.
+ */
+void *dmaMem_Copy(void *dst, const void *src, uint32_t bytes);
+
+/**
+ * @brief	Fill memory, a drop in replacement for memset()
+ * @param	dst		: Destination address
+ * @param	value	: Byte value to fill with
+ * @param	bytes	: Number of bytes to fill, no size limit
+ * @return	dst
+ * @note	Waits for the DMA, so must not be called from an interrupt
+ *			with a priority at or above the DMA interrupt.
+ */
+void *dmaMem_Set(void *dst, int value, uint32_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_MEM_H_ */
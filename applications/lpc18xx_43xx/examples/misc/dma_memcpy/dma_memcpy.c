@@ -0,0 +1,217 @@
+/*
+ * @brief GPDMA memory copy and fill example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "board.h"
+#include "dma_mem.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Size of the SRAM buffers, the largest copy made in SRAM */
+#define SRAM_BUFF_SIZE      (8 * 1024)
+
+/* Internal flash, a source for copies to SRAM */
+#define FLASH_BASE_ADDR     (0x1A000000)
+
+/* Set to 1 when the SPIFI flash is in memory mode, as when booting from it */
+#define BENCH_SPIFI         (0)
+#define SPIFI_BASE_ADDR     (0x14000000)
+
+/* Set to 1 on boards with SDRAM set up on the EMC */
+#define BENCH_SDRAM         (0)
+#define SDRAM_BASE_ADDR     (0x28000000)
+#define SDRAM_BUFF_SIZE     (64 * 1024)
+
+/* A source and destination pair */
+typedef struct {
+	const char *name;
+	void *dst;
+	const void *src;
+	uint32_t maxSize;
+} BENCH_REGION_T;
+
+static uint32_t sramSrc[SRAM_BUFF_SIZE / 4];
+static uint32_t sramDst[SRAM_BUFF_SIZE / 4];
+
+static const BENCH_REGION_T regions[] = {
+	{"SRAM->SRAM", sramDst, sramSrc, SRAM_BUFF_SIZE},
+	{"FLASH->SRAM", sramDst, (const void *) FLASH_BASE_ADDR, SRAM_BUFF_SIZE},
+#if BENCH_SPIFI
+	{"SPIFI->SRAM", sramDst, (const void *) SPIFI_BASE_ADDR, SRAM_BUFF_SIZE},
+#endif
+#if BENCH_SDRAM
+	{"SDRAM->SDRAM", (void *) (SDRAM_BASE_ADDR + SDRAM_BUFF_SIZE), (const void *) SDRAM_BASE_ADDR, SDRAM_BUFF_SIZE},
+#endif
+};
+
+static const uint32_t sizes[] = {64, 256, 1024, 4096, 8192, 65536};
+
+/* Copy methods compared */
+typedef enum {
+	COPY_MEMCPY,
+	COPY_CPU,
+	COPY_DMA,
+	COPY_METHODS
+} COPY_METHOD_T;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Time one copy in RIT ticks, the DMA copy is checked against the source */
+static uint32_t timeCopy(COPY_METHOD_T method, void *dst, const void *src, uint32_t size, bool *pMatch)
+{
+	uint32_t start_time, ticks;
+
+	memset(dst, 0, size);
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	switch (method) {
+	case COPY_MEMCPY:
+		memcpy(dst, src, size);
+		break;
+
+	case COPY_CPU:
+		dmaMem_CpuCopy(dst, src, size);
+		break;
+
+	default:
+		dmaMem_Copy(dst, src, size);
+		break;
+	}
+	ticks = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+
+	*pMatch = (memcmp(dst, src, size) == 0);
+	return ticks;
+}
+
+/* Compare the copy methods across sizes for one region */
+static void benchRegion(const BENCH_REGION_T *pRegion)
+{
+	uint32_t ticks[COPY_METHODS];
+	bool match, allMatch;
+	int i, m;
+
+	DEBUGOUT("\r\n%s\r\n", pRegion->name);
+	DEBUGSTR("    SIZE   memcpy  CPU LDM/STM   DMA (ticks)\r\n");
+	for (i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+		if (sizes[i] > pRegion->maxSize) {
+			break;
+		}
+
+		allMatch = true;
+		for (m = 0; m < COPY_METHODS; m++) {
+			ticks[m] = timeCopy((COPY_METHOD_T) m, pRegion->dst, pRegion->src, sizes[i], &match);
+			allMatch &= match;
+		}
+		DEBUGOUT("%8d %8d %12d %5d %s\r\n", sizes[i], ticks[COPY_MEMCPY], ticks[COPY_CPU],
+				 ticks[COPY_DMA], allMatch ? "" : "NOT MATCHING");
+	}
+}
+
+/* Count the CPU loops done while an asynchronous copy runs */
+static void benchAsync(void)
+{
+	static DMA_MEM_JOB_T job;
+	uint32_t start_time, ticks, loops = 0;
+	Status status;
+
+	dmaMem_InitJob(&job);
+	memset(sramDst, 0, SRAM_BUFF_SIZE);
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	status = dmaMem_CopyAsync(&job, sramDst, sramSrc, SRAM_BUFF_SIZE);
+	while ((status == SUCCESS) && !dmaMem_IsDone(&job)) {
+		loops++;
+	}
+	ticks = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+	if (status == SUCCESS) {
+		status = dmaMem_Wait(&job);
+	}
+
+	DEBUGOUT("\r\nAsynchronous %d byte copy: %d ticks, %d CPU loops while waiting, %s\r\n",
+			 SRAM_BUFF_SIZE, ticks, loops,
+			 ((status == SUCCESS) && (memcmp(sramDst, sramSrc, SRAM_BUFF_SIZE) == 0)) ? "MATCHING" : "NOT MATCHING");
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	DMA interrupt handler
+ * @return	Nothing
+ */
+void DMA_IRQHandler(void)
+{
+	Chip_GPDMA_ServiceIRQHandler(LPC_GPDMA);
+}
+
+/**
+ * @brief	Main entry point
+ * @return	Nothing
+ */
+int main(void)
+{
+	int i;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+	Chip_RIT_Init(LPC_RITIMER);
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_EnableIRQ(DMA_IRQn);
+	dmaMem_Init();
+
+	for (i = 0; i < (SRAM_BUFF_SIZE / 4); i++) {
+		sramSrc[i] = i | (~i << (16 - (i & 15)));	/* Fill it with some pattern */
+	}
+
+	/* Time the DMA for all sizes, not only above the threshold */
+	DEBUGOUT("***** MEMORY COPY TEST, CPU at %d MHz *****\r\n", SystemCoreClock / 1000000);
+	dmaMem_SetThreshold(0);
+	for (i = 0; i < (sizeof(regions) / sizeof(regions[0])); i++) {
+		benchRegion(&regions[i]);
+	}
+	benchAsync();
+
+	dmaMem_SetThreshold(DMA_MEM_THRESHOLD);
+	dmaMem_Set(sramDst, 0x5A, SRAM_BUFF_SIZE);
+	DEBUGOUT("\r\nFill check: %s\r\n", (((uint8_t *) sramDst)[SRAM_BUFF_SIZE - 1] == 0x5A) ? "OK" : "FAILED");
+
+	while (1) {
+		__WFI();
+	}
+}
@@ -0,0 +1,211 @@
+/*
+ * @brief COBS, SLIP and HDLC framing throughput example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "board.h"
+#include "frame_codec.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Payload size and number of frames timed per case */
+#define PAYLOAD_SIZE        256
+#define FRAME_COUNT         16
+
+/* Ring buffer size, a power of 2 holding all the timed frames */
+#define RING_SIZE           (16 * 1024)
+
+/* Payload contents */
+typedef enum {
+	PAYLOAD_RANDOM,			/* Few bytes to stuff */
+	PAYLOAD_SPECIAL,		/* Every byte stuffed */
+	PAYLOADS
+} PAYLOAD_T;
+
+static const char *const typeNames[] = {"COBS", "SLIP", "HDLC"};
+static const char *const crcNames[] = {"none ", "CRC16", "CRC32"};
+static const char *const payloadNames[] = {"random ", "special"};
+
+static uint8_t payload[PAYLOAD_SIZE];
+static uint8_t frameBuff[PAYLOAD_SIZE + 4];
+static uint8_t ringBuff[RING_SIZE];
+static RINGBUFF_T ring;
+static FRAME_DEC_T decoder;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Fill the payload, the special bytes of all the framings alternate */
+static void fillPayload(PAYLOAD_T contents)
+{
+	static const uint8_t special[] = {0x00, 0xC0, 0xDB, 0x7E, 0x7D};
+	uint32_t seed = 0x12345678;
+	int i;
+
+	for (i = 0; i < PAYLOAD_SIZE; i++) {
+		seed = (seed * 1103515245) + 12345;
+		if (contents == PAYLOAD_SPECIAL) {
+			payload[i] = special[i % sizeof(special)];
+		}
+		else {
+			payload[i] = (uint8_t) (seed >> 16);
+		}
+	}
+}
+
+/* Decode a SLIP frame a byte at a time, as done after Chip_UART_ReadRB() */
+static int slipBytewise(RINGBUFF_T *pRB, uint8_t *pFrame, int size)
+{
+	uint8_t byte;
+	bool esc = false;
+	int len = 0;
+
+	while (RingBuffer_Pop(pRB, &byte)) {
+		if (byte == 0xC0) {
+			if (len > 0) {
+				return len;
+			}
+		}
+		else if (byte == 0xDB) {
+			esc = true;
+		}
+		else if (len < size) {
+			if (esc) {
+				byte = (byte == 0xDC) ? 0xC0 : 0xDB;
+				esc = false;
+			}
+			pFrame[len++] = byte;
+		}
+	}
+	return 0;
+}
+
+/* Convert RIT ticks for FRAME_COUNT payloads to KBytes per second */
+static uint32_t toKBps(uint32_t ticks)
+{
+	uint64_t bytes = (uint64_t) PAYLOAD_SIZE * FRAME_COUNT * Chip_Clock_GetRate(CLK_MX_RITIMER);
+
+	if (ticks == 0) {
+		ticks = 1;
+	}
+	return (uint32_t) (bytes / ticks / 1024);
+}
+
+/* Time encoding and decoding of one framing */
+static void benchCase(FRAME_TYPE_T type, FRAME_CRC_T crcType, PAYLOAD_T contents)
+{
+	uint32_t start_time, encTicks, decTicks, len;
+	int i, frames = 0;
+	uint8_t *pFrame;
+
+	RingBuffer_Init(&ring, ringBuff, 1, RING_SIZE);
+	Frame_InitDecoder(&decoder, type, crcType, frameBuff, sizeof(frameBuff));
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (i = 0; i < FRAME_COUNT; i++) {
+		Frame_EncodeRB(type, crcType, &ring, payload, PAYLOAD_SIZE);
+	}
+	encTicks = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	while (Frame_DecodeRB(&decoder, &ring)) {
+		pFrame = Frame_GetFrame(&decoder, &len);
+		if ((len == PAYLOAD_SIZE) && (pFrame[PAYLOAD_SIZE - 1] == payload[PAYLOAD_SIZE - 1])) {
+			frames++;
+		}
+	}
+	decTicks = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+
+	DEBUGOUT("%s %s %s %8d %8d   %s\r\n", typeNames[type], crcNames[crcType], payloadNames[contents],
+			 toKBps(encTicks), toKBps(decTicks),
+			 ((frames == FRAME_COUNT) && (memcmp(frameBuff, payload, PAYLOAD_SIZE) == 0)) ? "OK" : "FAILED");
+}
+
+/* Time the byte at a time SLIP decoder for comparison */
+static void benchBytewise(PAYLOAD_T contents)
+{
+	uint32_t start_time, ticks;
+	int i, frames = 0;
+
+	RingBuffer_Init(&ring, ringBuff, 1, RING_SIZE);
+	for (i = 0; i < FRAME_COUNT; i++) {
+		Frame_EncodeRB(FRAME_SLIP, FRAME_CRC_NONE, &ring, payload, PAYLOAD_SIZE);
+	}
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	while (slipBytewise(&ring, frameBuff, sizeof(frameBuff)) > 0) {
+		frames++;
+	}
+	ticks = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+
+	DEBUGOUT("SLIP none  %s  bytewise %8d   %s\r\n", payloadNames[contents], toKBps(ticks),
+			 ((frames == FRAME_COUNT) && (memcmp(frameBuff, payload, PAYLOAD_SIZE) == 0)) ? "OK" : "FAILED");
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Main entry point
+ * @return	Nothing
+ */
+int main(void)
+{
+	int type, crcType, contents;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+	Chip_RIT_Init(LPC_RITIMER);
+
+	DEBUGOUT("***** FRAMING TEST, CPU at %d MHz, %d byte payloads *****\r\n",
+			 SystemCoreClock / 1000000, PAYLOAD_SIZE);
+	DEBUGSTR("TYPE FCS   PAYLOAD   ENCODE   DECODE (KB/s)\r\n");
+	for (contents = 0; contents < PAYLOADS; contents++) {
+		fillPayload((PAYLOAD_T) contents);
+		for (type = FRAME_COBS; type <= FRAME_HDLC; type++) {
+			for (crcType = FRAME_CRC_NONE; crcType <= FRAME_CRC32; crcType++) {
+				benchCase((FRAME_TYPE_T) type, (FRAME_CRC_T) crcType, (PAYLOAD_T) contents);
+			}
+		}
+		benchBytewise((PAYLOAD_T) contents);
+	}
+
+	while (1) {
+		__WFI();
+	}
+}
@@ -45,7 +45,8 @@
 #define TRANSFER_BLOCK_SZ          (4 * 3 * 1024) /* 3K of data transfered per LLI */
 #define DMA_DESCRIPTOR_COUNT       256
 
-static uint8_t ch_no;
+static GPDMA_REQ_T dma_req;
+static GPDMA_DESC_TEMPLATE_T desc_tmpl;
 static DMA_TransferDescriptor_t desc_array[DMA_DESCRIPTOR_COUNT];
 static volatile int dma_xfer_complete;
 /*****************************************************************************
@@ -92,6 +93,12 @@ static int prepare_dma_desc(uint32_t* dst, const uint32_t* src, uint32_t sz)
 	return num_desc;
 }
 
+/* Called from the DMA interrupt when the whole list is transferred */
+static void dma_done(GPDMA_REQ_T *pReq, Status status)
+{
+	dma_xfer_complete = (status == SUCCESS) ? 1 : -1;
+}
+
 /* Print the result of a data transfer */
 static void print_result(const void *dst, const void *src, int sz, uint32_t stime, uint32_t etime, const char *mode)
 {
@@ -109,18 +116,27 @@ static void print_result(const void *dst, const void *src, int sz, uint32_t stim
 	DEBUGOUT("TIME   TAKEN: %lu (uSec(s))\r\n", (etime - stime) / clk);
 	DEBUGOUT("SRC/DST COMP: %s\r\n", invalid ? "NOT MATCHING" : "MATCHING");
 }
+
+/* Print the cost of building a descriptor list */
+static void print_build(int num_desc, uint32_t ticks, const char *mode)
+{
+	DEBUGOUT("\r\nDescriptor build results [MODE: %s]\r\n"
+		"=========================================\r\n", mode);
+	DEBUGOUT("DESCRIPTORS : %d\r\n", num_desc);
+	DEBUGOUT("TIME   TAKEN: %lu (ticks)\r\n", ticks);
+	DEBUGOUT("COST PER KiB: %lu (ticks)\r\n", ticks / (TRANSFER_SIZE / 1024));
+}
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
 
 /**
- * @brief	RIT interrupt handler
+ * @brief	DMA interrupt handler
  * @return	Nothing
  */
 void DMA_IRQHandler(void)
 {
-	dma_xfer_complete = 1;
-	Chip_GPDMA_Interrupt(LPC_GPDMA, ch_no);
+	Chip_GPDMA_ServiceIRQHandler(LPC_GPDMA);
 }
 
 /**
@@ -129,6 +145,7 @@ void DMA_IRQHandler(void)
  */
 int main(void)
 {
+	int i, num_desc;
 	uint32_t start_time;
 	uint32_t end_time;
 	uint32_t *dst = (uint32_t *) TRANSFER_DST_ADDR;
@@ -139,6 +156,7 @@ int main(void)
 
 	/* Initialize the DMA */
 	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_EnableIRQ(DMA_IRQn);
 
 	/* Prepare the source buffer for transfer */
 	prepare_src_data(src, TRANSFER_SIZE/sizeof(*src));
@@ -147,18 +165,43 @@ int main(void)
 	memcpy(dst, src, TRANSFER_SIZE);
 	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
 	print_result(dst, src, TRANSFER_SIZE, start_time, end_time, "CPU (memcpy)");
-	memset(dst, 0, TRANSFER_SIZE);
-	ch_no = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
-	if (prepare_dma_desc(dst, src, TRANSFER_SIZE) <= 0) {
+
+	/* Build the list one descriptor at a time */
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	num_desc = prepare_dma_desc(dst, src, TRANSFER_SIZE);
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	print_build(num_desc, end_time - start_time, "Chip_GPDMA_PrepareDescriptor");
+
+	/* Build the list from a template */
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	Chip_GPDMA_InitDescTemplate(LPC_GPDMA, &desc_tmpl, GPDMA_CONN_MEMORY, GPDMA_CONN_MEMORY,
+		GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
+	num_desc = Chip_GPDMA_BuildDescList(&desc_tmpl, desc_array, DMA_DESCRIPTOR_COUNT,
+		(uint32_t) src, (uint32_t) dst, TRANSFER_SIZE, NULL);
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	print_build(num_desc, end_time - start_time, "Chip_GPDMA_BuildDescList");
+	if (num_desc <= 0) {
 		DEBUGSTR("Unable to create DMA Descriptors\r\n");
 		while (1) {}
 	}
-	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
-	Chip_GPDMA_SGTransfer(LPC_GPDMA, ch_no, &desc_array[0], GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
-	NVIC_EnableIRQ(DMA_IRQn);
-	while(!dma_xfer_complete); /* Set by ISR */
-	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
-	print_result(dst, src, TRANSFER_SIZE, start_time, end_time, "DMA");
+
+	/* The second transfer reuses the list as it is */
+	dma_req.pDesc = &desc_array[0];
+	dma_req.TransferType = GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA;
+	dma_req.priority = GPDMA_PRIO_HIGH;
+	dma_req.callback = dma_done;
+	for (i = 0; i < 2; i++) {
+		memset(dst, 0, TRANSFER_SIZE);
+		dma_xfer_complete = 0;
+		start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+		if (Chip_GPDMA_Submit(LPC_GPDMA, &dma_req) != SUCCESS) {
+			DEBUGSTR("Unable to start the DMA transfer\r\n");
+			while (1) {}
+		}
+		while(!dma_xfer_complete); /* Set by the request callback */
+		end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+		print_result(dst, src, TRANSFER_SIZE, start_time, end_time, i ? "DMA (reused list)" : "DMA");
+	}
 	/* LED is toggled in interrupt handler */
 	while (1) {}
 }
@@ -0,0 +1,230 @@
+/*
+ * @brief SPIFI command mode GPDMA transfer engine
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "spifi_dma.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* End the transfer, release the DMA channel and report the result */
+static void spifiDMA_Finish(SPIFI_DMA_T *pDMA, SPIFI_ERR_T err)
+{
+	Chip_GPDMA_Stop(LPC_GPDMA, pDMA->dmaCh);
+	pDMA->polling = 0;
+	pDMA->busy = 0;
+
+	if (pDMA->cb) {
+		pDMA->cb(pDMA->cbData, err);
+	}
+}
+
+/* Start the next chunk of a transfer, or finish it when nothing is left */
+static SPIFI_ERR_T spifiDMA_NextChunk(SPIFI_DMA_T *pDMA)
+{
+	uint32_t maxBytes;
+	Status status;
+	SPIFI_ERR_T err;
+
+	if (pDMA->write) {
+		/* Stay within the device page */
+		maxBytes = pDMA->pHandle->pInfoData->pageSize -
+				   (pDMA->addr % pDMA->pHandle->pInfoData->pageSize);
+	}
+	else {
+		maxBytes = pDMA->pHandle->pInfoData->maxReadSize;
+	}
+	if (maxBytes > SPIFI_DMA_MAX_XFER) {
+		maxBytes = SPIFI_DMA_MAX_XFER;
+	}
+	pDMA->xferBytes = (pDMA->bytes < maxBytes ? pDMA->bytes : maxBytes) & ~15;
+
+	if (pDMA->xferBytes == 0) {
+		err = SPIFI_ERR_NONE;
+
+		/* Read the bytes that do not fill a burst with the CPU */
+		if (pDMA->bytes) {
+			err = spifiDevRead(pDMA->pHandle, pDMA->addr, pDMA->pBuf, pDMA->bytes);
+		}
+		spifiDMA_Finish(pDMA, err);
+		return err;
+	}
+
+	/* The command is issued first, the controller stalls until the GPDMA
+	   moves data through its FIFO */
+	err = spifiDevDMAStart(pDMA->pHandle, pDMA->addr, pDMA->xferBytes, pDMA->write);
+	if (err != SPIFI_ERR_NONE) {
+		spifiDMA_Finish(pDMA, err);
+		return err;
+	}
+
+	if (pDMA->write) {
+		status = Chip_GPDMA_Transfer(LPC_GPDMA, pDMA->dmaCh, (uint32_t) pDMA->pBuf, GPDMA_CONN_SPIFI,
+									 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, pDMA->xferBytes >> 2);
+	}
+	else {
+		status = Chip_GPDMA_Transfer(LPC_GPDMA, pDMA->dmaCh, GPDMA_CONN_SPIFI, (uint32_t) pDMA->pBuf,
+									 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, pDMA->xferBytes >> 2);
+	}
+
+	/* Nothing will move the data, end the command waiting for it */
+	if (status != SUCCESS) {
+		spifiDevDMAAbort(pDMA->pHandle);
+		spifiDMA_Finish(pDMA, SPIFI_ERR_GEN);
+		return SPIFI_ERR_GEN;
+	}
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Move past the chunk just completed and start the next one */
+static void spifiDMA_Advance(SPIFI_DMA_T *pDMA)
+{
+	pDMA->addr += pDMA->xferBytes;
+	pDMA->pBuf += (pDMA->xferBytes >> 2);
+	pDMA->bytes -= pDMA->xferBytes;
+
+	spifiDMA_NextChunk(pDMA);
+}
+
+/* Common start of a read or program */
+static SPIFI_ERR_T spifiDMA_Start(SPIFI_DMA_T *pDMA, uint32_t addr, uint32_t *pBuf, uint32_t bytes,
+								  uint8_t write, SPIFI_DMA_CALLBACK_T cb, void *cbData)
+{
+	if (pDMA->busy) {
+		return SPIFI_ERR_BUSY;
+	}
+
+	pDMA->dmaCh = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, GPDMA_CONN_SPIFI);
+	if (pDMA->dmaCh == GPDMA_NO_FREE_CHANNEL) {
+		return SPIFI_ERR_BUSY;
+	}
+	pDMA->write = write;
+	pDMA->polling = 0;
+	pDMA->addr = addr;
+	pDMA->pBuf = pBuf;
+	pDMA->bytes = bytes;
+	pDMA->cb = cb;
+	pDMA->cbData = cbData;
+	pDMA->busy = 1;
+
+	return spifiDMA_NextChunk(pDMA);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize a SPIFI DMA transfer engine */
+void spifiDMA_Init(SPIFI_DMA_T *pDMA, const SPIFI_HANDLE_T *pHandle)
+{
+	memset(pDMA, 0, sizeof(SPIFI_DMA_T));
+	pDMA->pHandle = pHandle;
+
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+/* Start reading the device into memory */
+SPIFI_ERR_T spifiDMA_Read(SPIFI_DMA_T *pDMA, uint32_t addr, uint32_t *readBuff, uint32_t bytes,
+						  SPIFI_DMA_CALLBACK_T cb, void *cbData)
+{
+	return spifiDMA_Start(pDMA, addr, readBuff, bytes, 0, cb, cbData);
+}
+
+/* Start programming memory into the device */
+SPIFI_ERR_T spifiDMA_Program(SPIFI_DMA_T *pDMA, uint32_t addr, const uint32_t *writeBuff, uint32_t bytes,
+							 SPIFI_DMA_CALLBACK_T cb, void *cbData)
+{
+	/* Pages are only ever split on whole GPDMA bursts */
+	if (((addr | bytes) & 15) != 0) {
+		return SPIFI_ERR_ALIGNERR;
+	}
+
+	return spifiDMA_Start(pDMA, addr, (uint32_t *) writeBuff, bytes, 1, cb, cbData);
+}
+
+/* GPDMA interrupt handler of the engine */
+void spifiDMA_DMAHandler(SPIFI_DMA_T *pDMA)
+{
+	/* The DMA interrupt is shared by all channels */
+	if (!pDMA->busy || !Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INT, pDMA->dmaCh)) {
+		return;
+	}
+
+	if (Chip_GPDMA_Interrupt(LPC_GPDMA, pDMA->dmaCh) != SUCCESS) {
+		spifiDevDMAAbort(pDMA->pHandle);
+		spifiDMA_Finish(pDMA, SPIFI_ERR_GEN);
+		return;
+	}
+
+	spifiDevDMAEnd(pDMA->pHandle);
+	if (pDMA->write) {
+		/* Let the controller wait for the page program, spifiDMA_Poll()
+		   picks up from there */
+		spifiDevPollBusyStart(pDMA->pHandle);
+		pDMA->polling = 1;
+	}
+	else {
+		spifiDMA_Advance(pDMA);
+	}
+}
+
+/* Advance a program once the device finished a page */
+void spifiDMA_Poll(SPIFI_DMA_T *pDMA)
+{
+	SPIFI_ERR_T err;
+
+	if (!pDMA->polling) {
+		return;
+	}
+
+	err = spifiDevPollBusyEnd(pDMA->pHandle);
+	if (err == SPIFI_ERR_BUSY) {
+		return;
+	}
+	pDMA->polling = 0;
+
+	if (err != SPIFI_ERR_NONE) {
+		spifiDMA_Finish(pDMA, err);
+	}
+	else {
+		spifiDMA_Advance(pDMA);
+	}
+}
@@ -0,0 +1,156 @@
+/*
+ * @brief SPIFI command mode GPDMA transfer engine
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __SPIFI_DMA_H_
+#define __SPIFI_DMA_H_
+
+#include "board.h"
+#include "spifilib_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Largest transfer moved by one GPDMA channel setup, in bytes. The GPDMA
+ * transfer size is limited to 4095 words and the SPIFI DMA requests are
+ * made for bursts of 4 words.
+ */
+#define SPIFI_DMA_MAX_XFER      (4095 * 4 & ~15)
+
+/**
+ * @brief	Transfer completion callback
+ * @param	cbData	: Data pointer passed when the transfer was started
+ * @param	err		: SPIFI_ERR_NONE when the whole transfer succeeded, error code otherwise
+ * @return	Nothing
+ * @note	Called from the DMA interrupt for reads, and from spifiDMA_Poll()
+ *			for programs.
+ */
+typedef void (*SPIFI_DMA_CALLBACK_T)(void *cbData, SPIFI_ERR_T err);
+
+/**
+ * SPIFI DMA transfer engine context
+ */
+typedef struct {
+	const SPIFI_HANDLE_T *pHandle;	/*!< LPCSPIFILIB device the transfers are made on */
+	uint8_t dmaCh;					/*!< GPDMA channel of the transfer in progress */
+	uint8_t write;					/*!< Non-zero for a program, 0 for a read */
+	volatile uint8_t busy;			/*!< Set while a transfer is in progress */
+	volatile uint8_t polling;		/*!< Set while the controller waits for a page program */
+	uint32_t addr;					/*!< Device address of the current chunk */
+	uint32_t *pBuf;					/*!< Memory address of the current chunk */
+	uint32_t bytes;					/*!< Bytes left to transfer, including the current chunk */
+	uint32_t xferBytes;				/*!< Size of the current chunk */
+	SPIFI_DMA_CALLBACK_T cb;		/*!< Completion callback, or NULL */
+	void *cbData;					/*!< Data pointer passed to the callback */
+} SPIFI_DMA_T;
+
+/**
+ * @brief	Initialize a SPIFI DMA transfer engine
+ * @param	pDMA	: Pointer to the engine context
+ * @param	pHandle	: LPCSPIFILIB device handle, device must not be in memory mode
+ * @return	Nothing
+ * @note	The GPDMA controller must already be initialized with Chip_GPDMA_Init().
+ */
+void spifiDMA_Init(SPIFI_DMA_T *pDMA, const SPIFI_HANDLE_T *pHandle);
+
+/**
+ * @brief	Start reading the device into memory
+ * @param	pDMA		: Pointer to the engine context
+ * @param	addr		: LPCSPIFILIB device address to start the read at
+ * @param	readBuff	: Address of buffer to read into, must be 32-bit aligned
+ * @param	bytes		: Number of bytes to read, no size limit
+ * @param	cb			: Function called when the read completes, or NULL
+ * @param	cbData		: Data pointer passed to cb
+ * @return	SPIFI_ERR_NONE if the read was started, SPIFI_ERR_BUSY if a transfer
+ *			is in progress or no GPDMA channel is free, else the device error
+ * @note	The read is made in chunks of up to SPIFI_DMA_MAX_XFER bytes (and the
+ *			max single read size), restarted from the DMA interrupt. The last
+ *			bytes that do not fill a 16 byte burst are read by the CPU. cb is
+ *			called once the read ends, also when it ends within this call.
+ */
+SPIFI_ERR_T spifiDMA_Read(SPIFI_DMA_T *pDMA, uint32_t addr, uint32_t *readBuff, uint32_t bytes,
+						  SPIFI_DMA_CALLBACK_T cb, void *cbData);
+
+/**
+ * @brief	Start programming memory into the device
+ * @param	pDMA		: Pointer to the engine context
+ * @param	addr		: LPCSPIFILIB device address to start the program at, 16 byte aligned
+ * @param	writeBuff	: Address of buffer to write, must be 32-bit aligned
+ * @param	bytes		: Number of bytes to program, a multiple of 16
+ * @param	cb			: Function called when the program completes, or NULL
+ * @param	cbData		: Data pointer passed to cb
+ * @return	SPIFI_ERR_NONE if the program was started, SPIFI_ERR_ALIGNERR for a
+ *			misaligned range, SPIFI_ERR_BUSY if a transfer is in progress or no
+ *			GPDMA channel is free, else the device error
+ * @note	The range is programmed one page at a time. Once the data of a page
+ *			is sent the controller polls the device busy status by itself, and
+ *			spifiDMA_Poll() starts the next page when the device is ready. cb
+ *			is called once the program ends, also when it ends within this call.
+ */
+SPIFI_ERR_T spifiDMA_Program(SPIFI_DMA_T *pDMA, uint32_t addr, const uint32_t *writeBuff, uint32_t bytes,
+							 SPIFI_DMA_CALLBACK_T cb, void *cbData);
+
+/**
+ * @brief	Check if a transfer is in progress
+ * @param	pDMA	: Pointer to the engine context
+ * @return	true while a read or program is in progress
+ */
+STATIC INLINE bool spifiDMA_IsBusy(SPIFI_DMA_T *pDMA)
+{
+	return pDMA->busy != 0;
+}
+
+/**
+ * @brief	GPDMA interrupt handler of the engine
+ * @param	pDMA	: Pointer to the engine context
+ * @return	Nothing
+ * @note	Must be called from DMA_IRQHandler().
+ */
+void spifiDMA_DMAHandler(SPIFI_DMA_T *pDMA);
+
+/**
+ * @brief	Advance a program once the device finished a page
+ * @param	pDMA	: Pointer to the engine context
+ * @return	Nothing
+ * @note	Must be called periodically (SysTick, timer) while a program is in
+ *			progress. A page takes about a millisecond, so a 1 mS tick leaves
+ *			the device idle for less than a page time. The call returns
+ *			immediately when the device is still busy.
+ */
+void spifiDMA_Poll(SPIFI_DMA_T *pDMA);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPIFI_DMA_H_ */
@@ -0,0 +1,385 @@
+/*
+ * @brief SPIFI GPDMA read / program example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "spifilib_api.h"
+#include "spifilib_mmap.h"
+#include "spifi_dma.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+#define TEST_BUFFSIZE (16 * 1024)
+#define TEST_BLOCK    (1)
+#define RANDOM_READS  (512)		/* Reads made by the random access tests */
+#define RANDOM_SIZE   (32)		/* Bytes per random read */
+#define TICKRATE_HZ1  (1000)	/* 1000 ticks per second I.e 1 mSec / tick */
+
+#ifndef SPIFLASH_BASE_ADDRESS
+#define SPIFLASH_BASE_ADDRESS (0x14000000)
+#endif
+
+STATIC const PINMUX_GRP_T spifipinmuxing[] = {
+	{0x3, 3,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI CLK */
+	{0x3, 4,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D3 */
+	{0x3, 5,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D2 */
+	{0x3, 6,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D1 */
+	{0x3, 7,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D0 */
+	{0x3, 8,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)}	/* SPIFI CS/SSEL */
+};
+
+/* Local memory, 32-bit aligned that will be used for driver context (handle) */
+static uint32_t lmem[21];
+
+/* Transfer engine, memory map context and test buffer */
+static SPIFI_DMA_T spifiDma;
+static SPIFI_MMAP_T spifiMap;
+static uint32_t buffer[TEST_BUFFSIZE / sizeof(uint32_t)];
+static volatile SPIFI_ERR_T dmaResult;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Displays error message and dead loops */
+static void fatalError(char *str, SPIFI_ERR_T errNum)
+{
+	DEBUGOUT("\r\n%s() Error:%d %s\r\n", str, errNum, spifiReturnErrString(errNum));
+
+	/* Loop forever */
+	while (1) {
+		__WFI();
+	}
+}
+
+static uint32_t CalculateDivider(uint32_t baseClock, uint32_t target)
+{
+	uint32_t divider = (baseClock / target);
+
+	/* If there is a remainder then increment the dividor so that the resultant
+	   clock is not over the target */
+	if (baseClock % target) {
+		++divider;
+	}
+	return divider;
+}
+
+static SPIFI_HANDLE_T *initializeSpifi(void)
+{
+	SPIFI_HANDLE_T *pReturnVal;
+
+	/* Initialize LPCSPIFILIB library, reset the interface */
+	spifiInit(LPC_SPIFI_BASE, true);
+
+	/* register support for the family(s) we may want to work with */
+	spifiRegisterFamily(spifi_REG_FAMILY_CommonCommandSet);
+
+	/* Get required memory for detected device, this may vary per device family */
+	if (spifiGetHandleMemSize(LPC_SPIFI_BASE) == 0) {
+		/* No device detected, error */
+		fatalError("spifiGetHandleMemSize", SPIFI_ERR_GEN);
+	}
+
+	/* Initialize and detect a device and get device context */
+	pReturnVal = spifiInitDevice(&lmem, sizeof(lmem), LPC_SPIFI_BASE, SPIFLASH_BASE_ADDRESS);
+	if (pReturnVal == NULL) {
+		fatalError("spifiInitDevice", SPIFI_ERR_GEN);
+	}
+	return pReturnVal;
+}
+
+/* Transfer engine completion callback */
+static void dmaDone(void *cbData, SPIFI_ERR_T err)
+{
+	dmaResult = err;
+}
+
+/* Wait for the transfer engine, counting the loops the CPU was free for */
+static uint32_t waitDma(void)
+{
+	uint32_t loops = 0;
+
+	while (spifiDMA_IsBusy(&spifiDma)) {
+		loops++;
+	}
+	if (dmaResult != SPIFI_ERR_NONE) {
+		fatalError("spifiDMA", dmaResult);
+	}
+	return loops;
+}
+
+/* Check the buffer holds the test pattern */
+static void verifyBuffer(const char *mode)
+{
+	uint32_t idx;
+
+	for (idx = 0; idx < (TEST_BUFFSIZE / sizeof(uint32_t)); idx++) {
+		if (buffer[idx] != (idx ^ 0xA5A5A5A5)) {
+			DEBUGOUT("%s: mismatch at 0x%x\r\n", mode, idx * sizeof(uint32_t));
+			fatalError("verify", SPIFI_ERR_VAL);
+		}
+	}
+}
+
+/* Print the time taken by a transfer */
+static void printResult(const char *mode, uint32_t bytes, uint32_t stime, uint32_t etime, uint32_t loops)
+{
+	uint32_t clk = SystemCoreClock / 1000000;
+	uint32_t usecs = (etime - stime) / clk;
+
+	DEBUGOUT("%-20s: %lu bytes in %lu uSec(s), %lu KB/s, %lu free CPU loops\r\n", mode,
+			 bytes, usecs, (usecs ? ((bytes / 1024UL) * 1000000UL) / usecs : 0), loops);
+}
+
+/* Read the test area with the memory map context */
+static void mappedRead(const char *mode, uint32_t addr)
+{
+	uint32_t start_time, end_time;
+	SPIFI_ERR_T errCode;
+
+	memset(buffer, 0, sizeof(buffer));
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	errCode = spifiMMapRead(&spifiMap, addr, buffer, TEST_BUFFSIZE);
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("spifiMMapRead", errCode);
+	}
+	verifyBuffer(mode);
+	printResult(mode, TEST_BUFFSIZE, start_time, end_time, 0);
+}
+
+/* Make small reads at pseudo random offsets of the test area, with the memory
+   map context (memory or command mode) or with the GPDMA */
+static void randomRead(const char *mode, uint32_t addr, bool useDma)
+{
+	uint32_t idx, word, offset;
+	uint32_t seed = 12345;
+	uint32_t start_time, end_time;
+	SPIFI_ERR_T errCode;
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (idx = 0; idx < RANDOM_READS; idx++) {
+		seed = (seed * 1103515245) + 12345;
+		offset = ((seed >> 8) % (TEST_BUFFSIZE - RANDOM_SIZE)) & ~0x3;
+
+		if (useDma) {
+			errCode = spifiDMA_Read(&spifiDma, addr + offset, buffer, RANDOM_SIZE, dmaDone, NULL);
+			if (errCode == SPIFI_ERR_NONE) {
+				waitDma();
+			}
+		}
+		else {
+			errCode = spifiMMapRead(&spifiMap, addr + offset, buffer, RANDOM_SIZE);
+		}
+		if (errCode != SPIFI_ERR_NONE) {
+			fatalError(mode, errCode);
+		}
+
+		for (word = 0; word < (RANDOM_SIZE / sizeof(uint32_t)); word++) {
+			if (buffer[word] != (((offset / sizeof(uint32_t)) + word) ^ 0xA5A5A5A5)) {
+				DEBUGOUT("%s: mismatch at 0x%x\r\n", mode, offset + (word * sizeof(uint32_t)));
+				fatalError("verify", SPIFI_ERR_VAL);
+			}
+		}
+	}
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	printResult(mode, RANDOM_READS * RANDOM_SIZE, start_time, end_time, 0);
+}
+
+static void RunExample(void)
+{
+	uint32_t idx;
+	uint32_t spifiBaseClockRate;
+	uint32_t addr;
+	uint32_t start_time;
+	uint32_t end_time;
+	uint32_t loops;
+	SPIFI_HANDLE_T *pSpifi;
+	SPIFI_ERR_T errCode;
+
+	/* Setup SPIFI FLASH pin muxing (QUAD) */
+	Chip_SCU_SetPinMuxing(spifipinmuxing, sizeof(spifipinmuxing) / sizeof(PINMUX_GRP_T));
+
+	/* SPIFI base clock will be based on the main PLL rate and a divider */
+	spifiBaseClockRate = Chip_Clock_GetClockInputHz(CLKIN_MAINPLL);
+
+	/* Setup SPIFI clock to run around 1Mhz for device detection */
+	Chip_Clock_SetDivider(CLK_IDIV_E, CLKIN_MAINPLL, CalculateDivider(spifiBaseClockRate, 1000000));
+	Chip_Clock_SetBaseClock(CLK_BASE_SPIFI, CLKIN_IDIVE, true, false);
+
+	/* Initialize the spifi library. This registers the device family and detects the part */
+	pSpifi = initializeSpifi();
+	DEBUGOUT("Device Identified   = %s\r\n", spifiDevGetDeviceName(pSpifi));
+
+	/* Run the device at its maximum interface rate, in quad mode if supported */
+	Chip_Clock_SetDivider(CLK_IDIV_E, CLKIN_MAINPLL,
+						  CalculateDivider(spifiBaseClockRate, spifiDevGetInfo(pSpifi, SPIFI_INFO_MAXCLOCK)));
+	DEBUGOUT("SPIFI final Rate    = %d\r\n", Chip_Clock_GetClockInputHz(CLKIN_IDIVE));
+	spifiDevSetOpts(pSpifi, SPIFI_OPT_USE_QUAD, true);
+
+	errCode = spifiDevUnlockDevice(pSpifi);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("unlockDevice", errCode);
+	}
+
+	/* Setup the GPDMA and the transfer engine */
+	Chip_GPDMA_Init(LPC_GPDMA);
+	spifiDMA_Init(&spifiDma, pSpifi);
+
+	/* RIT counter is used to time the transfers */
+	Chip_RIT_Init(LPC_RITIMER);
+
+	addr = spifiGetAddrFromBlock(pSpifi, TEST_BLOCK);
+	DEBUGOUT("Erasing block %d...\r\n", TEST_BLOCK);
+	errCode = spifiErase(pSpifi, TEST_BLOCK, 1);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("EraseBlocks", errCode);
+	}
+
+	for (idx = 0; idx < (TEST_BUFFSIZE / sizeof(uint32_t)); idx++) {
+		buffer[idx] = idx ^ 0xA5A5A5A5;
+	}
+
+	/* Program with the GPDMA, pages are advanced from SysTick */
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	errCode = spifiDMA_Program(&spifiDma, addr, buffer, TEST_BUFFSIZE, dmaDone, NULL);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("spifiDMA_Program", errCode);
+	}
+	loops = waitDma();
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	printResult("DMA program", TEST_BUFFSIZE, start_time, end_time, loops);
+
+	/* Read with the CPU */
+	memset(buffer, 0, sizeof(buffer));
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	errCode = spifiRead(pSpifi, addr, buffer, TEST_BUFFSIZE);
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("spifiRead", errCode);
+	}
+	verifyBuffer("CPU read");
+	printResult("CPU read", TEST_BUFFSIZE, start_time, end_time, 0);
+
+	/* Read with the GPDMA */
+	memset(buffer, 0, sizeof(buffer));
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	errCode = spifiDMA_Read(&spifiDma, addr, buffer, TEST_BUFFSIZE, dmaDone, NULL);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("spifiDMA_Read", errCode);
+	}
+	loops = waitDma();
+	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	verifyBuffer("DMA read");
+	printResult("DMA read", TEST_BUFFSIZE, start_time, end_time, loops);
+
+	/* Read through the memory mapped address space, with and without prefetch */
+	spifiMMapInit(&spifiMap, pSpifi, SPIFI_MMAP_PREFETCH_CODE | SPIFI_MMAP_PREFETCH_DATA);
+	mappedRead("Mapped read", addr);
+	spifiMMapSetPrefetch(&spifiMap, 0);
+	mappedRead("Mapped read, no pf", addr);
+
+	/* Random access, memory mode first */
+	DEBUGOUT("Random reads of %d bytes\r\n", RANDOM_SIZE);
+	randomRead("Mapped random, no pf", addr, false);
+	spifiMMapSetPrefetch(&spifiMap, SPIFI_MMAP_PREFETCH_CODE | SPIFI_MMAP_PREFETCH_DATA);
+	randomRead("Mapped random", addr, false);
+
+	/* Then in command mode, the memory map context reads with the CPU */
+	spifiMMapBeginCmd(&spifiMap);
+	randomRead("CPU random", addr, false);
+	randomRead("DMA random", addr, true);
+	spifiMMapEndCmd(&spifiMap);
+
+	/* A program through the context returns to memory mode with a clean cache */
+	buffer[0] = 0;
+	errCode = spifiMMapProgram(&spifiMap, addr, buffer, sizeof(uint32_t));
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("spifiMMapProgram", errCode);
+	}
+	if (*(const volatile uint32_t *) spifiMMapGetPtr(&spifiMap, addr) != 0) {
+		fatalError("coherency", SPIFI_ERR_VAL);
+	}
+	DEBUGOUT("Memory mode entered %d times\r\n", spifiMap.remaps);
+
+	/* Done, de-init will enter memory mode */
+	spifiDevDeInit(pSpifi);
+	DEBUGOUT("Complete.\r\n");
+
+	while (1) {
+		__WFI();
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	SysTick interrupt handler, advances DMA page programs
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
+{
+	spifiDMA_Poll(&spifiDma);
+}
+
+/**
+ * @brief	DMA interrupt handler
+ * @return	Nothing
+ */
+void DMA_IRQHandler(void)
+{
+	spifiDMA_DMAHandler(&spifiDma);
+}
+
+/**
+ * @brief	Main entry point
+ * @return	Nothing
+ */
+int main(void)
+{
+	SystemCoreClockUpdate();
+	Board_Init();
+
+	/* Enable and setup SysTick Timer at a periodic rate */
+	SysTick_Config(SystemCoreClock / TICKRATE_HZ1);
+
+	/* Run the example code */
+	RunExample();
+
+	return 0;
+}
@@ -0,0 +1,748 @@
+/*
+ * @brief Log-structured key/value store on SPIFI flash
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "spifi_kv.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Sector header magic, "SKV1" */
+#define KV_SECTOR_MAGIC     0x31564B53
+
+/* Record flags, in the top byte of the record length word */
+#define KV_REC_TOMBSTONE    (1UL << 24)
+#define KV_REC_LENMASK      0x00FFFFFF
+
+/* Index entry address of a key removed by compaction */
+#define KV_INDEX_REMOVED    (1)
+
+/* Words moved per read/program when copying a record value */
+#define KV_COPY_WORDS       (16)
+
+#define KV_ALIGN4(x)        (((x) + 3) & ~3UL)
+
+/* Header at the start of each sector. A sector is in the log when the header
+   CRC is good, its position in the log is given by the sequence number. */
+typedef struct {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t sectorSize;
+	uint32_t srcSeq;		/* Sector being compacted when this one was opened, or 0 */
+	uint32_t crc;			/* CRC of the fields above */
+} KV_SECTOR_HDR_T;
+
+/* Header in front of each record value. The header is programmed before the
+   value, so a torn header stops the scan of its sector and a torn value fails
+   the data CRC. */
+typedef struct {
+	uint32_t key;
+	uint32_t lenFlags;		/* Value length and KV_REC_* flags */
+	uint32_t dataCrc;		/* CRC of the value */
+	uint32_t hdrCrc;		/* CRC of the fields above */
+} KV_RECORD_HDR_T;
+
+/* CRC-32 (IEEE 802.3), 4 bits at a time */
+static const uint32_t kvCrcTable[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint32_t kvCrc(uint32_t crc, const void *pData, uint32_t len)
+{
+	const uint8_t *p = (const uint8_t *) pData;
+
+	crc = ~crc;
+	while (len--) {
+		crc ^= *p++;
+		crc = (crc >> 4) ^ kvCrcTable[crc & 0x0F];
+		crc = (crc >> 4) ^ kvCrcTable[crc & 0x0F];
+	}
+
+	return ~crc;
+}
+
+static SPIFI_KV_STATUS_T kvFlashErr(SPIFI_KV_T *pKV, SPIFI_ERR_T err)
+{
+	pKV->lastErr = err;
+	return SPIFI_KV_FLASHERR;
+}
+
+static uint32_t kvSectorAddr(const SPIFI_KV_T *pKV, uint32_t sector)
+{
+	return pKV->baseAddr + (sector * pKV->sectorSize);
+}
+
+static uint32_t kvNextSector(const SPIFI_KV_T *pKV, uint32_t sector)
+{
+	return (sector + 1 == pKV->numSectors) ? 0 : sector + 1;
+}
+
+/* First index entry probed for a key */
+static uint32_t kvIndexHome(const SPIFI_KV_T *pKV, uint32_t key)
+{
+	uint32_t idx = key * 2654435761UL;
+
+	return (idx ^ (idx >> 16)) & pKV->indexMask;
+}
+
+/* Find the index entry of a key */
+static SPIFI_KV_ENTRY_T *kvIndexFind(SPIFI_KV_T *pKV, uint32_t key)
+{
+	SPIFI_KV_ENTRY_T *pEntry;
+	uint32_t idx = kvIndexHome(pKV, key);
+
+	for (;; ) {
+		pEntry = &pKV->pIndex[idx];
+		if (pEntry->addr == 0) {
+			return NULL;
+		}
+		if ((pEntry->key == key) && (pEntry->addr != KV_INDEX_REMOVED)) {
+			return pEntry;
+		}
+		idx = (idx + 1) & pKV->indexMask;
+	}
+}
+
+/* Returns the first entry that is empty or holds a removed key on the probe
+   path of a key */
+static SPIFI_KV_ENTRY_T *kvIndexFree(SPIFI_KV_T *pKV, uint32_t key)
+{
+	uint32_t idx = kvIndexHome(pKV, key);
+
+	while ((pKV->pIndex[idx].addr != 0) && (pKV->pIndex[idx].addr != KV_INDEX_REMOVED)) {
+		idx = (idx + 1) & pKV->indexMask;
+	}
+
+	return &pKV->pIndex[idx];
+}
+
+/* Drop the removed keys from the index. The keys are inserted again starting
+   after an empty entry, so every key finds the entries before it on its probe
+   path already placed. */
+static void kvIndexRehash(SPIFI_KV_T *pKV)
+{
+	SPIFI_KV_ENTRY_T entry;
+	uint32_t idx, start, count;
+
+	for (idx = 0; idx <= pKV->indexMask; ++idx) {
+		if (pKV->pIndex[idx].addr == KV_INDEX_REMOVED) {
+			pKV->pIndex[idx].addr = 0;
+		}
+	}
+
+	/* There are fewer keys than entries */
+	for (start = 0; pKV->pIndex[start].addr != 0; ++start) {}
+
+	for (count = 0; count < pKV->indexMask; ++count) {
+		idx = (start + 1 + count) & pKV->indexMask;
+		if (pKV->pIndex[idx].addr != 0) {
+			entry = pKV->pIndex[idx];
+			pKV->pIndex[idx].addr = 0;
+			*kvIndexFree(pKV, entry.key) = entry;
+		}
+	}
+	pKV->indexUsed = pKV->indexLive;
+}
+
+/* Point a key to a record, adding it to the index if needed */
+static SPIFI_KV_STATUS_T kvIndexSet(SPIFI_KV_T *pKV, uint32_t key, uint32_t addr)
+{
+	SPIFI_KV_ENTRY_T *pEntry = kvIndexFind(pKV, key);
+
+	if (pEntry == NULL) {
+		/* Keep one empty entry so that lookups end */
+		if (pKV->indexLive >= pKV->indexMask) {
+			return SPIFI_KV_INDEXFULL;
+		}
+
+		pEntry = kvIndexFree(pKV, key);
+		if (pEntry->addr == 0) {
+			if (pKV->indexUsed >= pKV->indexMask) {
+				kvIndexRehash(pKV);
+				pEntry = kvIndexFree(pKV, key);
+			}
+			pKV->indexUsed++;
+		}
+		pKV->indexLive++;
+		pEntry->key = key;
+	}
+	pEntry->addr = addr;
+
+	return SPIFI_KV_OK;
+}
+
+static uint8_t kvIndexHasRoom(const SPIFI_KV_T *pKV)
+{
+	return pKV->indexLive < pKV->indexMask;
+}
+
+/* Read a record header, returns false at the end of the records of a sector */
+static bool kvReadRecord(SPIFI_KV_T *pKV, uint32_t addr, KV_RECORD_HDR_T *pHdr, SPIFI_ERR_T *pErr)
+{
+	*pErr = spifiRead(pKV->pHandle, addr, (uint32_t *) pHdr, sizeof(KV_RECORD_HDR_T));
+	if (*pErr != SPIFI_ERR_NONE) {
+		return false;
+	}
+
+	/* Erased space and torn headers both end the records */
+	return (pHdr->hdrCrc == kvCrc(0, pHdr, 12)) &&
+		   ((pHdr->lenFlags & KV_REC_LENMASK) <= spifiKV_MaxValueSize(pKV));
+}
+
+static bool kvIsErased(const KV_RECORD_HDR_T *pHdr)
+{
+	return (pHdr->key & pHdr->lenFlags & pHdr->dataCrc & pHdr->hdrCrc) == 0xFFFFFFFF;
+}
+
+static uint32_t kvRecordSize(const KV_RECORD_HDR_T *pHdr)
+{
+	return SPIFI_KV_RECORD_HDR + KV_ALIGN4(pHdr->lenFlags & KV_REC_LENMASK);
+}
+
+/* Check the value of a record against its CRC */
+static SPIFI_KV_STATUS_T kvCheckData(SPIFI_KV_T *pKV, uint32_t addr, const KV_RECORD_HDR_T *pHdr)
+{
+	uint32_t buff[KV_COPY_WORDS];
+	uint32_t len = pHdr->lenFlags & KV_REC_LENMASK;
+	uint32_t crc = 0;
+	uint32_t bytes;
+	SPIFI_ERR_T err;
+
+	addr += SPIFI_KV_RECORD_HDR;
+	while (len) {
+		bytes = (len > sizeof(buff)) ? sizeof(buff) : len;
+		err = spifiRead(pKV->pHandle, addr, buff, bytes);
+		if (err != SPIFI_ERR_NONE) {
+			return kvFlashErr(pKV, err);
+		}
+		crc = kvCrc(crc, buff, bytes);
+		addr += bytes;
+		len -= bytes;
+	}
+
+	return (crc == pHdr->dataCrc) ? SPIFI_KV_OK : SPIFI_KV_CORRUPT;
+}
+
+/* Erase a sector and make it the head of the log */
+static SPIFI_KV_STATUS_T kvOpenSector(SPIFI_KV_T *pKV, uint32_t sector, uint32_t seq, uint32_t srcSeq)
+{
+	KV_SECTOR_HDR_T hdr;
+	uint32_t addr = kvSectorAddr(pKV, sector);
+	SPIFI_ERR_T err;
+
+	/* Free sectors are only erased when they are used, they may hold
+	   anything after a power loss */
+	err = spifiEraseRange(pKV->pHandle, addr, addr + pKV->sectorSize - 1, 0, NULL);
+	if (err == SPIFI_ERR_NONE) {
+		hdr.magic = KV_SECTOR_MAGIC;
+		hdr.seq = seq;
+		hdr.sectorSize = pKV->sectorSize;
+		hdr.srcSeq = srcSeq;
+		hdr.crc = kvCrc(0, &hdr, 16);
+		err = spifiProgram(pKV->pHandle, addr, (uint32_t *) &hdr, sizeof(hdr));
+	}
+	if (err != SPIFI_ERR_NONE) {
+		return kvFlashErr(pKV, err);
+	}
+
+	if (pKV->usedSectors == 0) {
+		pKV->tailSector = sector;
+	}
+	pKV->headSector = sector;
+	pKV->headSeq = seq;
+	pKV->writeOffs = SPIFI_KV_SECTOR_HDR;
+	pKV->usedSectors++;
+
+	return SPIFI_KV_OK;
+}
+
+/* Drop the oldest sector from the log */
+static SPIFI_KV_STATUS_T kvFreeTail(SPIFI_KV_T *pKV)
+{
+	uint32_t zero = 0;
+	SPIFI_ERR_T err;
+
+	/* Clearing the magic is enough, the sector is erased when it is reused */
+	err = spifiProgram(pKV->pHandle, kvSectorAddr(pKV, pKV->tailSector), &zero, sizeof(zero));
+	if (err != SPIFI_ERR_NONE) {
+		return kvFlashErr(pKV, err);
+	}
+	pKV->tailSector = kvNextSector(pKV, pKV->tailSector);
+	pKV->usedSectors--;
+
+	return SPIFI_KV_OK;
+}
+
+/* Append a record, the value comes from RAM (pData) or from another record (srcAddr) */
+static SPIFI_KV_STATUS_T kvAppend(SPIFI_KV_T *pKV, const KV_RECORD_HDR_T *pHdr, const void *pData,
+								  uint32_t srcAddr, uint32_t *pAddr)
+{
+	uint32_t buff[KV_COPY_WORDS];
+	uint32_t addr = kvSectorAddr(pKV, pKV->headSector) + pKV->writeOffs;
+	uint32_t len = pHdr->lenFlags & KV_REC_LENMASK;
+	uint32_t offs, bytes;
+	SPIFI_ERR_T err;
+
+	/* Nothing more is appended to this sector if the record fails half way */
+	pKV->writeOffs += kvRecordSize(pHdr);
+	*pAddr = addr;
+
+	err = spifiProgram(pKV->pHandle, addr, (const uint32_t *) pHdr, sizeof(KV_RECORD_HDR_T));
+	addr += SPIFI_KV_RECORD_HDR;
+	if ((err == SPIFI_ERR_NONE) && (len != 0)) {
+		if (pData) {
+			err = spifiProgram(pKV->pHandle, addr, (const uint32_t *) pData, len);
+		}
+		else {
+			srcAddr += SPIFI_KV_RECORD_HDR;
+			for (offs = 0; (offs < len) && (err == SPIFI_ERR_NONE); offs += bytes) {
+				bytes = ((len - offs) > sizeof(buff)) ? sizeof(buff) : (len - offs);
+				err = spifiRead(pKV->pHandle, srcAddr + offs, buff, bytes);
+				if (err == SPIFI_ERR_NONE) {
+					err = spifiProgram(pKV->pHandle, addr + offs, buff, bytes);
+				}
+			}
+		}
+	}
+	if (err != SPIFI_ERR_NONE) {
+		pKV->writeOffs = pKV->sectorSize;
+		return kvFlashErr(pKV, err);
+	}
+
+	return SPIFI_KV_OK;
+}
+
+static SPIFI_KV_STATUS_T kvCompact(SPIFI_KV_T *pKV);
+
+/* Make room for a record in the head sector. Normal writes keep one free
+   sector so that compaction can always move a sector. */
+static SPIFI_KV_STATUS_T kvMakeRoom(SPIFI_KV_T *pKV, uint32_t recSize)
+{
+	SPIFI_KV_STATUS_T status;
+	uint32_t tries;
+
+	for (tries = 0; (pKV->writeOffs + recSize) > pKV->sectorSize; ++tries) {
+		if (spifiKV_FreeSectors(pKV) > 1) {
+			return kvOpenSector(pKV, kvNextSector(pKV, pKV->headSector), pKV->headSeq + 1, 0);
+		}
+
+		/* Compaction moves the live records of the oldest sector to the head,
+		   give up when a full pass over the log freed nothing */
+		if (tries >= pKV->numSectors) {
+			return SPIFI_KV_FULL;
+		}
+		status = kvCompact(pKV);
+		if (status != SPIFI_KV_OK) {
+			return status;
+		}
+	}
+
+	return SPIFI_KV_OK;
+}
+
+/* Move the live records of the oldest sector to the head and drop it. The
+   records fill the head, then at most one new sector, which records the tail
+   it was opened for. A power loss before the tail is dropped leaves the log
+   one sector longer, so the mount drops that sector again and the compaction
+   starts over with the free sector it needs. */
+static SPIFI_KV_STATUS_T kvCompactSector(SPIFI_KV_T *pKV, uint32_t tailSeq, bool *pOpened)
+{
+	KV_RECORD_HDR_T hdr;
+	SPIFI_KV_ENTRY_T *pEntry;
+	SPIFI_KV_STATUS_T status;
+	SPIFI_ERR_T err;
+	uint32_t sectorAddr, offs, addr, newAddr;
+
+	/* Never copy records into the sector being compacted */
+	if (pKV->usedSectors == 1) {
+		status = kvOpenSector(pKV, kvNextSector(pKV, pKV->headSector), pKV->headSeq + 1, tailSeq);
+		if (status != SPIFI_KV_OK) {
+			return status;
+		}
+		*pOpened = true;
+	}
+
+	sectorAddr = kvSectorAddr(pKV, pKV->tailSector);
+	for (offs = SPIFI_KV_SECTOR_HDR; (offs + SPIFI_KV_RECORD_HDR) <= pKV->sectorSize; offs += kvRecordSize(&hdr)) {
+		addr = sectorAddr + offs;
+		if (!kvReadRecord(pKV, addr, &hdr, &err)) {
+			if (err != SPIFI_ERR_NONE) {
+				return kvFlashErr(pKV, err);
+			}
+			break;
+		}
+
+		/* Only the record the index points to is live */
+		pEntry = kvIndexFind(pKV, hdr.key);
+		if ((pEntry == NULL) || (pEntry->addr != addr)) {
+			continue;
+		}
+
+		if (hdr.lenFlags & KV_REC_TOMBSTONE) {
+			/* There is nothing older than the tail, the delete marker can go */
+			pEntry->addr = KV_INDEX_REMOVED;
+			pKV->indexLive--;
+			continue;
+		}
+
+		/* The live records of a sector always fit in a new sector */
+		status = SPIFI_KV_OK;
+		if ((pKV->writeOffs + kvRecordSize(&hdr)) > pKV->sectorSize) {
+			if (*pOpened) {
+				return SPIFI_KV_CORRUPT;
+			}
+			status = kvOpenSector(pKV, kvNextSector(pKV, pKV->headSector), pKV->headSeq + 1, tailSeq);
+			*pOpened = true;
+		}
+		if (status == SPIFI_KV_OK) {
+			status = kvAppend(pKV, &hdr, NULL, addr, &newAddr);
+		}
+		if (status != SPIFI_KV_OK) {
+			return status;
+		}
+		pEntry->addr = newAddr;
+	}
+
+	return kvFreeTail(pKV);
+}
+
+static SPIFI_KV_STATUS_T kvCompact(SPIFI_KV_T *pKV)
+{
+	SPIFI_KV_STATUS_T status;
+	bool opened = false;
+
+	if (spifiKV_FreeSectors(pKV) == 0) {
+		return SPIFI_KV_FULL;
+	}
+
+	status = kvCompactSector(pKV, pKV->headSeq + 1 - pKV->usedSectors, &opened);
+	if ((status != SPIFI_KV_OK) && (opened)) {
+		/* The sector opened for a failed compaction is dropped on the next
+		   mount, nothing else may be written to it */
+		pKV->writeOffs = pKV->sectorSize;
+	}
+
+	return status;
+}
+
+/* Add the records of a sector to the index, returns the end of the records
+   or the sector size if nothing can be appended to the sector */
+static SPIFI_KV_STATUS_T kvScanSector(SPIFI_KV_T *pKV, uint32_t sector, uint32_t *pEnd)
+{
+	KV_RECORD_HDR_T hdr, lastHdr;
+	SPIFI_KV_STATUS_T status;
+	SPIFI_ERR_T err;
+	uint32_t sectorAddr = kvSectorAddr(pKV, sector);
+	uint32_t offs = SPIFI_KV_SECTOR_HDR;
+	uint32_t lastAddr = 0;
+	bool closed = false;
+
+	while ((offs + SPIFI_KV_RECORD_HDR) <= pKV->sectorSize) {
+		if (!kvReadRecord(pKV, sectorAddr + offs, &hdr, &err)) {
+			if (err != SPIFI_ERR_NONE) {
+				return kvFlashErr(pKV, err);
+			}
+			closed = !kvIsErased(&hdr);
+			break;
+		}
+
+		/* Records are indexed one behind, the value of the last one is checked first */
+		if (lastAddr) {
+			status = kvIndexSet(pKV, lastHdr.key, lastAddr);
+			if (status != SPIFI_KV_OK) {
+				return status;
+			}
+		}
+		lastHdr = hdr;
+		lastAddr = sectorAddr + offs;
+		offs += kvRecordSize(&hdr);
+	}
+
+	if (lastAddr) {
+		/* Only the last record of a sector can have been cut by a power loss */
+		status = kvCheckData(pKV, lastAddr, &lastHdr);
+		if (status == SPIFI_KV_OK) {
+			status = kvIndexSet(pKV, lastHdr.key, lastAddr);
+		}
+		else if (status == SPIFI_KV_CORRUPT) {
+			/* Keep the torn record last in its sector */
+			closed = true;
+			status = SPIFI_KV_OK;
+		}
+		if (status != SPIFI_KV_OK) {
+			return status;
+		}
+	}
+
+	*pEnd = (closed) ? pKV->sectorSize : offs;
+
+	return SPIFI_KV_OK;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Mount a store, formatting it if it is blank */
+SPIFI_KV_STATUS_T spifiKV_Mount(SPIFI_KV_T *pKV, const SPIFI_HANDLE_T *pHandle, uint32_t baseAddr,
+								uint32_t bytes, SPIFI_KV_ENTRY_T *pIndex, uint32_t indexEntries)
+{
+	KV_SECTOR_HDR_T hdr;
+	SPIFI_KV_STATUS_T status;
+	SPIFI_ERR_T err;
+	uint32_t sector, idx, end, srcSeq = 0;
+	uint32_t minSeq = 0xFFFFFFFF, maxSeq = 0;
+	uint32_t minSector = 0, maxSector = 0;
+
+	memset(pKV, 0, sizeof(SPIFI_KV_T));
+	pKV->pHandle = pHandle;
+	pKV->baseAddr = baseAddr;
+	pKV->pIndex = pIndex;
+	pKV->indexMask = indexEntries - 1;
+
+	/* Smallest erase unit the device has */
+	pKV->sectorSize = spifiDevGetInfo(pHandle, SPIFI_INFO_ERASE_BLOCKSIZE);
+	if ((spifiDevGetInfo(pHandle, SPIFI_INFO_CAPS) & SPIFI_CAP_SUBBLKERASE) &&
+		(spifiDevGetInfo(pHandle, SPIFI_INFO_ERASE_SUBBLOCKSIZE) != 0)) {
+		pKV->sectorSize = spifiDevGetInfo(pHandle, SPIFI_INFO_ERASE_SUBBLOCKSIZE);
+	}
+	if (pKV->sectorSize == 0) {
+		return SPIFI_KV_ARGERR;
+	}
+	pKV->numSectors = bytes / pKV->sectorSize;
+
+	if ((indexEntries < 2) || ((indexEntries & pKV->indexMask) != 0) || (pKV->numSectors < 3) ||
+		((bytes % pKV->sectorSize) != 0) ||
+		(((baseAddr - spifiDevGetInfo(pHandle, SPIFI_INFO_BASE_ADDRESS)) % pKV->sectorSize) != 0)) {
+		return SPIFI_KV_ARGERR;
+	}
+	memset(pIndex, 0, indexEntries * sizeof(SPIFI_KV_ENTRY_T));
+
+	/* Find the oldest and newest sectors of the log */
+	for (sector = 0; sector < pKV->numSectors; ++sector) {
+		err = spifiRead(pHandle, kvSectorAddr(pKV, sector), (uint32_t *) &hdr, sizeof(hdr));
+		if (err != SPIFI_ERR_NONE) {
+			return kvFlashErr(pKV, err);
+		}
+		if ((hdr.magic != KV_SECTOR_MAGIC) || (hdr.sectorSize != pKV->sectorSize) ||
+			(hdr.crc != kvCrc(0, &hdr, 16))) {
+			continue;
+		}
+		if (hdr.seq < minSeq) {
+			minSeq = hdr.seq;
+			minSector = sector;
+		}
+		if (hdr.seq >= maxSeq) {
+			maxSeq = hdr.seq;
+			maxSector = sector;
+			srcSeq = hdr.srcSeq;
+		}
+	}
+
+	if (minSeq == 0xFFFFFFFF) {
+		/* Blank store */
+		return kvOpenSector(pKV, 0, 1, 0);
+	}
+
+	/* Sectors are allocated in turn, so the log is a contiguous run of sectors */
+	if ((maxSeq - minSeq) >= pKV->numSectors) {
+		return SPIFI_KV_CORRUPT;
+	}
+
+	/* A compaction cut before it dropped the tail, the records of its new
+	   sector are still in the tail. The sector is erased when it is opened
+	   again. */
+	if ((srcSeq == minSeq) && (maxSeq != minSeq)) {
+		maxSeq--;
+		maxSector = (maxSector == 0) ? pKV->numSectors - 1 : maxSector - 1;
+	}
+	pKV->tailSector = minSector;
+	pKV->headSector = maxSector;
+	pKV->headSeq = maxSeq;
+	pKV->usedSectors = (maxSeq - minSeq) + 1;
+
+	/* Rebuild the index from the oldest to the newest record */
+	sector = minSector;
+	for (idx = 0; idx < pKV->usedSectors; ++idx) {
+		status = kvScanSector(pKV, sector, &end);
+		if (status != SPIFI_KV_OK) {
+			return status;
+		}
+		if (sector == pKV->headSector) {
+			pKV->writeOffs = end;
+		}
+		sector = kvNextSector(pKV, sector);
+	}
+
+	return SPIFI_KV_OK;
+}
+
+/* Erase all the sectors of a store and mount it empty */
+SPIFI_KV_STATUS_T spifiKV_Format(SPIFI_KV_T *pKV)
+{
+	SPIFI_ERR_T err;
+
+	err = spifiEraseRange(pKV->pHandle, pKV->baseAddr,
+						  pKV->baseAddr + (pKV->numSectors * pKV->sectorSize) - 1, 0, NULL);
+	if (err != SPIFI_ERR_NONE) {
+		return kvFlashErr(pKV, err);
+	}
+
+	memset(pKV->pIndex, 0, (pKV->indexMask + 1) * sizeof(SPIFI_KV_ENTRY_T));
+	pKV->indexUsed = 0;
+	pKV->indexLive = 0;
+	pKV->usedSectors = 0;
+
+	return kvOpenSector(pKV, 0, 1, 0);
+}
+
+/* Store a value */
+SPIFI_KV_STATUS_T spifiKV_Set(SPIFI_KV_T *pKV, uint32_t key, const void *pData, uint32_t len)
+{
+	KV_RECORD_HDR_T hdr;
+	SPIFI_KV_STATUS_T status;
+	uint32_t addr;
+
+	if (len > spifiKV_MaxValueSize(pKV)) {
+		return SPIFI_KV_ARGERR;
+	}
+	if ((kvIndexFind(pKV, key) == NULL) && (!kvIndexHasRoom(pKV))) {
+		return SPIFI_KV_INDEXFULL;
+	}
+
+	hdr.key = key;
+	hdr.lenFlags = len;
+	hdr.dataCrc = kvCrc(0, pData, len);
+	hdr.hdrCrc = kvCrc(0, &hdr, 12);
+
+	status = kvMakeRoom(pKV, kvRecordSize(&hdr));
+	if (status == SPIFI_KV_OK) {
+		status = kvAppend(pKV, &hdr, pData, 0, &addr);
+	}
+	if (status == SPIFI_KV_OK) {
+		status = kvIndexSet(pKV, key, addr);
+	}
+
+	return status;
+}
+
+/* Read a value */
+SPIFI_KV_STATUS_T spifiKV_Get(SPIFI_KV_T *pKV, uint32_t key, void *pData, uint32_t bufLen, uint32_t *pLen)
+{
+	KV_RECORD_HDR_T hdr;
+	SPIFI_KV_ENTRY_T *pEntry;
+	SPIFI_ERR_T err;
+	uint32_t len;
+
+	pEntry = kvIndexFind(pKV, key);
+	if (pEntry == NULL) {
+		return SPIFI_KV_NOTFOUND;
+	}
+	if (!kvReadRecord(pKV, pEntry->addr, &hdr, &err)) {
+		return (err != SPIFI_ERR_NONE) ? kvFlashErr(pKV, err) : SPIFI_KV_CORRUPT;
+	}
+	if (hdr.lenFlags & KV_REC_TOMBSTONE) {
+		return SPIFI_KV_NOTFOUND;
+	}
+
+	len = hdr.lenFlags & KV_REC_LENMASK;
+	if (pLen) {
+		*pLen = len;
+	}
+	if (len > bufLen) {
+		return SPIFI_KV_ARGERR;
+	}
+
+	err = spifiRead(pKV->pHandle, pEntry->addr + SPIFI_KV_RECORD_HDR, (uint32_t *) pData, len);
+	if (err != SPIFI_ERR_NONE) {
+		return kvFlashErr(pKV, err);
+	}
+
+	return (kvCrc(0, pData, len) == hdr.dataCrc) ? SPIFI_KV_OK : SPIFI_KV_CORRUPT;
+}
+
+/* Delete a value */
+SPIFI_KV_STATUS_T spifiKV_Delete(SPIFI_KV_T *pKV, uint32_t key)
+{
+	KV_RECORD_HDR_T hdr;
+	SPIFI_KV_ENTRY_T *pEntry;
+	SPIFI_KV_STATUS_T status;
+	SPIFI_ERR_T err;
+	uint32_t addr;
+
+	pEntry = kvIndexFind(pKV, key);
+	if (pEntry == NULL) {
+		return SPIFI_KV_NOTFOUND;
+	}
+	if (!kvReadRecord(pKV, pEntry->addr, &hdr, &err)) {
+		return (err != SPIFI_ERR_NONE) ? kvFlashErr(pKV, err) : SPIFI_KV_CORRUPT;
+	}
+	if (hdr.lenFlags & KV_REC_TOMBSTONE) {
+		return SPIFI_KV_NOTFOUND;
+	}
+
+	/* A zero length delete marker hides the older records until they are compacted */
+	hdr.key = key;
+	hdr.lenFlags = KV_REC_TOMBSTONE;
+	hdr.dataCrc = kvCrc(0, NULL, 0);
+	hdr.hdrCrc = kvCrc(0, &hdr, 12);
+
+	status = kvMakeRoom(pKV, kvRecordSize(&hdr));
+	if (status == SPIFI_KV_OK) {
+		status = kvAppend(pKV, &hdr, NULL, 0, &addr);
+	}
+	if (status == SPIFI_KV_OK) {
+		/* Compaction may have moved the entry */
+		status = kvIndexSet(pKV, key, addr);
+	}
+
+	return status;
+}
+
+/* Background compaction */
+SPIFI_KV_STATUS_T spifiKV_Maintain(SPIFI_KV_T *pKV)
+{
+	if (spifiKV_FreeSectors(pKV) >= SPIFI_KV_MAINTAIN_FREE) {
+		return SPIFI_KV_OK;
+	}
+
+	return kvCompact(pKV);
+}
@@ -0,0 +1,188 @@
+/*
+ * @brief Log-structured key/value store on SPIFI flash
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __SPIFI_KV_H_
+#define __SPIFI_KV_H_
+
+#include "board.h"
+#include "spifilib_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Minimum number of free sectors spifiKV_Maintain() keeps by compacting the
+ * oldest sector. One free sector is always kept for compaction itself.
+ */
+#define SPIFI_KV_MAINTAIN_FREE  (3)
+
+/** Size of the header at the start of each sector, in bytes */
+#define SPIFI_KV_SECTOR_HDR     (20)
+
+/** Size of the header in front of each record value, in bytes */
+#define SPIFI_KV_RECORD_HDR     (16)
+
+/**
+ * @brief Key/value store status
+ */
+typedef enum {
+	SPIFI_KV_OK = 0,			/*!< No error */
+	SPIFI_KV_NOTFOUND,			/*!< Key is not in the store */
+	SPIFI_KV_FULL,				/*!< No room for the record, even after compaction */
+	SPIFI_KV_INDEXFULL,			/*!< RAM index has no free entry */
+	SPIFI_KV_CORRUPT,			/*!< Stored value failed its CRC check */
+	SPIFI_KV_ARGERR,			/*!< Bad argument (size, alignment) */
+	SPIFI_KV_FLASHERR			/*!< LPCSPIFILIB error, see lastErr */
+} SPIFI_KV_STATUS_T;
+
+/**
+ * @brief RAM index entry, maps a key to the address of its newest record
+ */
+typedef struct {
+	uint32_t key;				/*!< Key */
+	uint32_t addr;				/*!< Record address, 0 for an empty entry */
+} SPIFI_KV_ENTRY_T;
+
+/**
+ * @brief Key/value store context, the fields are private to the store functions
+ */
+typedef struct {
+	const SPIFI_HANDLE_T *pHandle;	/*!< Device the store is on */
+	uint32_t baseAddr;			/*!< Address of the first sector */
+	uint32_t sectorSize;		/*!< Size of a sector (erase unit) */
+	uint32_t numSectors;		/*!< Number of sectors in the store */
+	SPIFI_KV_ENTRY_T *pIndex;	/*!< RAM index */
+	uint32_t indexMask;			/*!< Number of index entries - 1 */
+	uint32_t indexUsed;			/*!< Index entries not empty, removed keys included */
+	uint32_t indexLive;			/*!< Keys in the index */
+	uint32_t headSector;		/*!< Sector records are appended to */
+	uint32_t headSeq;			/*!< Sequence number of the head sector */
+	uint32_t writeOffs;			/*!< Append offset in the head sector */
+	uint32_t tailSector;		/*!< Oldest sector in use */
+	uint32_t usedSectors;		/*!< Number of sectors in use, head and tail included */
+	SPIFI_ERR_T lastErr;		/*!< Last LPCSPIFILIB error */
+} SPIFI_KV_T;
+
+/**
+ * @brief	Mount a store, formatting it if it is blank
+ * @param	pKV			: Store context to initialize
+ * @param	pHandle		: LPCSPIFILIB device handle, in command mode
+ * @param	baseAddr	: First address of the store, sector aligned
+ * @param	bytes		: Size of the store, a multiple of the sector size
+ * @param	pIndex		: RAM index storage
+ * @param	indexEntries: Number of index entries, a power of 2 larger than the number of keys
+ * @return	SPIFI_KV_OK, or an error code
+ * @note	The sectors are the device sub-blocks when the device supports
+ * sub-block erase, otherwise the blocks. At least 3 sectors are needed.
+ * Mount reads each sector header, each record header, and the value of the
+ * last record of each sector, so its time grows with the number of records
+ * and not with the size of the values. The index is rebuilt from the records.
+ */
+SPIFI_KV_STATUS_T spifiKV_Mount(SPIFI_KV_T *pKV, const SPIFI_HANDLE_T *pHandle, uint32_t baseAddr,
+								uint32_t bytes, SPIFI_KV_ENTRY_T *pIndex, uint32_t indexEntries);
+
+/**
+ * @brief	Erase all the sectors of a store and mount it empty
+ * @param	pKV		: Mounted store
+ * @return	SPIFI_KV_OK, or an error code
+ */
+SPIFI_KV_STATUS_T spifiKV_Format(SPIFI_KV_T *pKV);
+
+/**
+ * @brief	Store a value
+ * @param	pKV		: Mounted store
+ * @param	key		: Key
+ * @param	pData	: Value, 32-bit aligned
+ * @param	len		: Value length in bytes, up to spifiKV_MaxValueSize()
+ * @return	SPIFI_KV_OK, or an error code
+ * @note	The record is appended to the log, the previous value stays valid
+ * until the new record is completely written.
+ */
+SPIFI_KV_STATUS_T spifiKV_Set(SPIFI_KV_T *pKV, uint32_t key, const void *pData, uint32_t len);
+
+/**
+ * @brief	Read a value
+ * @param	pKV		: Mounted store
+ * @param	key		: Key
+ * @param	pData	: Buffer for the value, 32-bit aligned
+ * @param	bufLen	: Size of the buffer in bytes
+ * @param	pLen	: Returns the length of the value, may be NULL
+ * @return	SPIFI_KV_OK, SPIFI_KV_NOTFOUND, SPIFI_KV_ARGERR if the buffer is too
+ * small (*pLen is set), or another error code
+ */
+SPIFI_KV_STATUS_T spifiKV_Get(SPIFI_KV_T *pKV, uint32_t key, void *pData, uint32_t bufLen, uint32_t *pLen);
+
+/**
+ * @brief	Delete a value
+ * @param	pKV		: Mounted store
+ * @param	key		: Key
+ * @return	SPIFI_KV_OK, SPIFI_KV_NOTFOUND, or another error code
+ */
+SPIFI_KV_STATUS_T spifiKV_Delete(SPIFI_KV_T *pKV, uint32_t key);
+
+/**
+ * @brief	Background compaction
+ * @param	pKV		: Mounted store
+ * @return	SPIFI_KV_OK, or an error code
+ * @note	Compacts the oldest sector when fewer than SPIFI_KV_MAINTAIN_FREE
+ * sectors are free, so that spifiKV_Set() rarely has to. Should be called from
+ * the idle loop. Compaction moves the live records of the oldest sector to the
+ * head of the log and erases it, so all sectors are erased in turn.
+ */
+SPIFI_KV_STATUS_T spifiKV_Maintain(SPIFI_KV_T *pKV);
+
+/**
+ * @brief	Returns the largest value the store can hold
+ * @param	pKV		: Mounted store
+ * @return	Maximum value length in bytes
+ */
+STATIC INLINE uint32_t spifiKV_MaxValueSize(const SPIFI_KV_T *pKV)
+{
+	return pKV->sectorSize - SPIFI_KV_SECTOR_HDR - SPIFI_KV_RECORD_HDR;
+}
+
+/**
+ * @brief	Returns the number of free sectors
+ * @param	pKV		: Mounted store
+ * @return	Number of erased sectors not in the log
+ */
+STATIC INLINE uint32_t spifiKV_FreeSectors(const SPIFI_KV_T *pKV)
+{
+	return pKV->numSectors - pKV->usedSectors;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPIFI_KV_H_ */
@@ -0,0 +1,284 @@
+/*
+ * @brief SPIFI flash key/value store example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "spifilib_api.h"
+#include "spifi_kv.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+#define KV_BLOCKS       (4)		/* Blocks at the top of the device used by the store */
+#define KV_INDEX_SIZE   (64)	/* Index entries, a power of 2 */
+#define KEY_BOOTCOUNT   (1)
+#define KEY_CONFIG      (0x100)	/* First of the stress test keys */
+#define CONFIG_KEYS     (8)
+#define CONFIG_WORDS    (24)
+#define STRESS_WRITES   (2000)
+
+#ifndef SPIFLASH_BASE_ADDRESS
+#define SPIFLASH_BASE_ADDRESS (0x14000000)
+#endif
+
+STATIC const PINMUX_GRP_T spifipinmuxing[] = {
+	{0x3, 3,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI CLK */
+	{0x3, 4,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D3 */
+	{0x3, 5,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D2 */
+	{0x3, 6,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D1 */
+	{0x3, 7,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},	/* SPIFI D0 */
+	{0x3, 8,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)}	/* SPIFI CS/SSEL */
+};
+
+/* Local memory, 32-bit aligned that will be used for driver context (handle) */
+static uint32_t lmem[21];
+
+/* Store and its RAM index */
+static SPIFI_KV_T kvStore;
+static SPIFI_KV_ENTRY_T kvIndex[KV_INDEX_SIZE];
+static uint32_t config[CONFIG_KEYS][CONFIG_WORDS];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Displays error message and dead loops */
+static void fatalError(char *str, int errNum)
+{
+	DEBUGOUT("\r\n%s() Error:%d\r\n", str, errNum);
+
+	/* Loop forever */
+	while (1) {
+		__WFI();
+	}
+}
+
+static uint32_t CalculateDivider(uint32_t baseClock, uint32_t target)
+{
+	uint32_t divider = (baseClock / target);
+
+	/* If there is a remainder then increment the dividor so that the resultant
+	   clock is not over the target */
+	if (baseClock % target) {
+		++divider;
+	}
+	return divider;
+}
+
+static SPIFI_HANDLE_T *initializeSpifi(void)
+{
+	SPIFI_HANDLE_T *pReturnVal;
+
+	/* Initialize LPCSPIFILIB library, reset the interface */
+	spifiInit(LPC_SPIFI_BASE, true);
+
+	/* register support for the family(s) we may want to work with */
+	spifiRegisterFamily(spifi_REG_FAMILY_CommonCommandSet);
+
+	/* Get required memory for detected device, this may vary per device family */
+	if (spifiGetHandleMemSize(LPC_SPIFI_BASE) == 0) {
+		/* No device detected, error */
+		fatalError("spifiGetHandleMemSize", SPIFI_ERR_GEN);
+	}
+
+	/* Initialize and detect a device and get device context */
+	pReturnVal = spifiInitDevice(&lmem, sizeof(lmem), LPC_SPIFI_BASE, SPIFLASH_BASE_ADDRESS);
+	if (pReturnVal == NULL) {
+		fatalError("spifiInitDevice", SPIFI_ERR_GEN);
+	}
+	return pReturnVal;
+}
+
+/* Mount the store, printing the time taken to rebuild the index */
+static void mountStore(SPIFI_HANDLE_T *pSpifi, uint32_t baseAddr, uint32_t bytes)
+{
+	SPIFI_KV_STATUS_T status;
+	uint32_t start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+
+	status = spifiKV_Mount(&kvStore, pSpifi, baseAddr, bytes, kvIndex, KV_INDEX_SIZE);
+	if (status != SPIFI_KV_OK) {
+		fatalError("spifiKV_Mount", status);
+	}
+	DEBUGOUT("Mounted %d sectors of %d bytes (%d used, %d keys) in %d uSec(s)\r\n",
+			 kvStore.numSectors, kvStore.sectorSize, kvStore.usedSectors, kvStore.indexUsed,
+			 (Chip_RIT_GetCounter(LPC_RITIMER) - start_time) / (SystemCoreClock / 1000000));
+}
+
+/* Check the stress test keys hold their last values */
+static void verifyConfig(void)
+{
+	uint32_t buff[CONFIG_WORDS];
+	uint32_t idx, len;
+	SPIFI_KV_STATUS_T status;
+
+	for (idx = 0; idx < CONFIG_KEYS; idx++) {
+		status = spifiKV_Get(&kvStore, KEY_CONFIG + idx, buff, sizeof(buff), &len);
+		if (status != SPIFI_KV_OK) {
+			fatalError("spifiKV_Get", status);
+		}
+		if ((len != sizeof(buff)) || (memcmp(buff, config[idx], sizeof(buff)) != 0)) {
+			fatalError("verify", KEY_CONFIG + idx);
+		}
+	}
+}
+
+static void RunExample(void)
+{
+	uint32_t idx, word;
+	uint32_t spifiBaseClockRate;
+	uint32_t baseAddr, bytes;
+	uint32_t bootCount, len;
+	uint32_t start_time;
+	SPIFI_HANDLE_T *pSpifi;
+	SPIFI_KV_STATUS_T status;
+	SPIFI_ERR_T errCode;
+
+	/* Setup SPIFI FLASH pin muxing (QUAD) */
+	Chip_SCU_SetPinMuxing(spifipinmuxing, sizeof(spifipinmuxing) / sizeof(PINMUX_GRP_T));
+
+	/* SPIFI base clock will be based on the main PLL rate and a divider */
+	spifiBaseClockRate = Chip_Clock_GetClockInputHz(CLKIN_MAINPLL);
+
+	/* Setup SPIFI clock to run around 1Mhz for device detection */
+	Chip_Clock_SetDivider(CLK_IDIV_E, CLKIN_MAINPLL, CalculateDivider(spifiBaseClockRate, 1000000));
+	Chip_Clock_SetBaseClock(CLK_BASE_SPIFI, CLKIN_IDIVE, true, false);
+
+	/* Initialize the spifi library. This registers the device family and detects the part */
+	pSpifi = initializeSpifi();
+	DEBUGOUT("Device Identified   = %s\r\n", spifiDevGetDeviceName(pSpifi));
+
+	/* Run the device at its maximum interface rate, in quad mode if supported */
+	Chip_Clock_SetDivider(CLK_IDIV_E, CLKIN_MAINPLL,
+						  CalculateDivider(spifiBaseClockRate, spifiDevGetInfo(pSpifi, SPIFI_INFO_MAXCLOCK)));
+	spifiDevSetOpts(pSpifi, SPIFI_OPT_USE_QUAD, true);
+
+	errCode = spifiDevUnlockDevice(pSpifi);
+	if (errCode != SPIFI_ERR_NONE) {
+		fatalError("unlockDevice", errCode);
+	}
+
+	/* RIT counter is used to time the mounts */
+	Chip_RIT_Init(LPC_RITIMER);
+
+	/* The store uses the last blocks of the device */
+	bytes = KV_BLOCKS * spifiDevGetInfo(pSpifi, SPIFI_INFO_ERASE_BLOCKSIZE);
+	baseAddr = spifiDevGetInfo(pSpifi, SPIFI_INFO_BASE_ADDRESS) +
+			   spifiDevGetInfo(pSpifi, SPIFI_INFO_DEVSIZE) - bytes;
+	mountStore(pSpifi, baseAddr, bytes);
+
+	/* Count the boots, the value survives resets and power loss */
+	bootCount = 0;
+	status = spifiKV_Get(&kvStore, KEY_BOOTCOUNT, &bootCount, sizeof(bootCount), &len);
+	if ((status != SPIFI_KV_OK) && (status != SPIFI_KV_NOTFOUND)) {
+		fatalError("spifiKV_Get", status);
+	}
+	bootCount++;
+	status = spifiKV_Set(&kvStore, KEY_BOOTCOUNT, &bootCount, sizeof(bootCount));
+	if (status != SPIFI_KV_OK) {
+		fatalError("spifiKV_Set", status);
+	}
+	DEBUGOUT("Boot count          = %d\r\n", bootCount);
+
+	/* Rewrite a few records many times, the log wraps over the sectors and
+	   compaction runs from the idle point of the loop */
+	DEBUGOUT("Writing %d records...\r\n", STRESS_WRITES);
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (idx = 0; idx < STRESS_WRITES; idx++) {
+		for (word = 0; word < CONFIG_WORDS; word++) {
+			config[idx % CONFIG_KEYS][word] = (bootCount << 16) ^ (idx * CONFIG_WORDS + word);
+		}
+		status = spifiKV_Set(&kvStore, KEY_CONFIG + (idx % CONFIG_KEYS), config[idx % CONFIG_KEYS],
+							 sizeof(config[0]));
+		if (status != SPIFI_KV_OK) {
+			fatalError("spifiKV_Set", status);
+		}
+
+		status = spifiKV_Maintain(&kvStore);
+		if (status != SPIFI_KV_OK) {
+			fatalError("spifiKV_Maintain", status);
+		}
+	}
+	DEBUGOUT("Records written in %d mSec(s)\r\n",
+			 (Chip_RIT_GetCounter(LPC_RITIMER) - start_time) / (SystemCoreClock / 1000));
+	verifyConfig();
+
+	/* A new mount must rebuild the same index from the flash */
+	mountStore(pSpifi, baseAddr, bytes);
+	verifyConfig();
+
+	/* Deleted keys stay deleted after a mount */
+	status = spifiKV_Delete(&kvStore, KEY_CONFIG + CONFIG_KEYS);
+	if ((status != SPIFI_KV_OK) && (status != SPIFI_KV_NOTFOUND)) {
+		fatalError("spifiKV_Delete", status);
+	}
+	status = spifiKV_Set(&kvStore, KEY_CONFIG + CONFIG_KEYS, &bootCount, sizeof(bootCount));
+	if (status == SPIFI_KV_OK) {
+		status = spifiKV_Delete(&kvStore, KEY_CONFIG + CONFIG_KEYS);
+	}
+	if (status != SPIFI_KV_OK) {
+		fatalError("spifiKV_Delete", status);
+	}
+	mountStore(pSpifi, baseAddr, bytes);
+	if (spifiKV_Get(&kvStore, KEY_CONFIG + CONFIG_KEYS, &word, sizeof(word), &len) != SPIFI_KV_NOTFOUND) {
+		fatalError("deleted key", KEY_CONFIG + CONFIG_KEYS);
+	}
+
+	/* Done, de-init will enter memory mode */
+	spifiDevDeInit(pSpifi);
+	DEBUGOUT("Complete.\r\n");
+
+	while (1) {
+		__WFI();
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Main entry point
+ * @return	Nothing
+ */
+int main(void)
+{
+	SystemCoreClockUpdate();
+	Board_Init();
+
+	/* Run the example code */
+	RunExample();
+
+	return 0;
+}
@@ -32,6 +32,7 @@
 #include "board.h"
 #include <string.h>
 #include "spifilib_api.h"
+#include "spifilib_sfdp.h"
 
 #include "test_suite.h"
 
@@ -89,6 +90,7 @@ static SPIFI_HANDLE_T *initializeSpifi(void)
 
 	/* register support for the family(s) we may want to work with
 	     (only 1 is required) */
+	spifiRegisterFamily(spifi_REG_FAMILY_SFDP);
 	spifiRegisterFamily(spifi_REG_FAMILY_CommonCommandSet);
 
 	for (idx = 0; idx < spifiGetSuppFamilyCount(); ++idx) {
@@ -221,6 +223,15 @@ static void RunExample(void)
 	/* Run the device lock unlock test */
 	test_suiteLockUnlockBattery(pSpifi);
 
+	/* Run the non-blocking erase / program test */
+	test_suiteJobBattery(pSpifi);
+
+	/* Run the erase planner test */
+	test_suiteErasePlanBattery(pSpifi);
+
+	/* Run the SFDP parser test */
+	test_suiteSFDPBattery();
+
 	/* Run the performance test */
 	test_suitePerformanceBattery(pSpifi);
 
@@ -0,0 +1,299 @@
+/*
+ * @brief CCAN message object manager example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#include "board.h"
+#include "string.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define CCAN_BIT_RATE           (500000)
+
+/* Message objects of the manager, the 12 left are free for filters */
+#define FIFO_OBJS               (16)
+#define TX_OBJS                 (4)
+#define TX_QUEUE_SIZE           (64)
+#define RX_RB_SIZE              (64)
+
+/* Frames of 8 data bytes on STREAMS IDs, each carrying its own sequence
+   number, and a control ID caught by a filter object */
+#define STREAMS                 (8)
+#define STREAM_ID(n)            (0x100 + ((n) << 4))
+#define CTRL_ID                 (0x080)
+#define BENCH_FRAMES            (4000)
+#define BURST_FRAMES            (16)
+
+/* Objects left for filters, and the IDs received in the filter test */
+#define FILTER_OBJS             (CCAN_MSG_MAX_NUM - FIFO_OBJS - TX_OBJS)
+#define RX_ID_RANGES            (12)
+
+/* Bits of a standard data frame with 8 data bytes, without stuff bits,
+   and the interframe space */
+#define FRAME_BITS              (111 + 3)
+
+static CCAN_MGR_T canMgr;
+static CCAN_TXQ_ENTRY_T txQueue[TX_QUEUE_SIZE];
+static CCAN_MSG_OBJ_T rxFrames[RX_RB_SIZE];
+static RINGBUFF_T rxRing;
+
+static CCAN_ID_RANGE_T rxIds[RX_ID_RANGES] = {
+	{0x0A5, 0x0A5}, {0x100, 0x10F}, {0x180, 0x187}, {0x1F3, 0x1F3},
+	{0x2C0, 0x2C0}, {0x333, 0x333}, {0x401, 0x40F}, {0x5AA, 0x5AA},
+	{0x6E1, 0x6E1}, {0x6E4, 0x6E4}, {0x700, 0x77F}, {0x7F0, 0x7F0}
+};
+static CCAN_FILTER_T rxFilters[FILTER_OBJS + 1];
+static CCAN_ID_SET_T rxIdSet;
+
+static uint32_t txSeq[STREAMS], rxSeq[STREAMS];
+static uint32_t rxCount, ctrlCount, outOfOrder;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void set_pinmux(void)
+{
+#if (defined(BOARD_NXP_LPCXPRESSO_4337) || defined(BOARD_NXP_LPCXPRESSO_1837))
+	Chip_SCU_PinMuxSet(0x3, 1, (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC2)); /* CAN RD */
+	Chip_SCU_PinMuxSet(0x3, 2, (SCU_MODE_INACT | SCU_MODE_FUNC2)); /* CAN TD */
+#else
+	#warning "No pin muxing set for this board"
+#endif
+}
+
+/* Queue the next frame of a stream */
+static Status sendStream(uint32_t stream)
+{
+	CCAN_MSG_OBJ_T msg;
+
+	msg.id = STREAM_ID(stream);
+	msg.dlc = 8;
+	memcpy(msg.data, &txSeq[stream], sizeof(uint32_t));
+	memset(&msg.data[4], stream, 4);
+	if (Chip_CCAN_Mgr_Send(&canMgr, &msg) != SUCCESS) {
+		return ERROR;
+	}
+	txSeq[stream]++;
+	return SUCCESS;
+}
+
+/* Read the received frames, checking the sequence of each stream */
+static void readFrames(void)
+{
+	CCAN_MSG_OBJ_T msg;
+	uint32_t stream, seq;
+
+	while (RingBuffer_Pop(&rxRing, &msg)) {
+		if (msg.id == CTRL_ID) {
+			ctrlCount++;
+			continue;
+		}
+		stream = (msg.id - STREAM_ID(0)) >> 4;
+		if (stream >= STREAMS) {
+			continue;
+		}
+		memcpy(&seq, msg.data, sizeof(uint32_t));
+		if (seq != rxSeq[stream]) {
+			outOfOrder++;
+		}
+		rxSeq[stream] = seq + 1;
+		rxCount++;
+	}
+}
+
+/* Queue a burst of frames of decreasing priority and print the order they
+   come back in */
+static void showPriority(void)
+{
+	CCAN_MSG_OBJ_T msg;
+	uint32_t i;
+
+	msg.dlc = 0;
+	for (i = 0; i < BURST_FRAMES; i++) {
+		msg.id = 0x7F0 - i;
+		Chip_CCAN_Mgr_Send(&canMgr, &msg);
+	}
+	while (Chip_CCAN_Mgr_GetTxPending(&canMgr) != 0) {}
+
+	DEBUGSTR("Queued 0x7F0 down to 0x7E1, received:");
+	for (i = 0; i < BURST_FRAMES; i++) {
+		while (!RingBuffer_Pop(&rxRing, &msg)) {}
+		DEBUGOUT(" %03X", msg.id);
+	}
+	DEBUGSTR("\r\n");
+}
+
+/* Send BENCH_FRAMES frames round the streams as fast as the queue takes them */
+static void benchStreams(void)
+{
+	CCAN_MGR_STATS_T stats;
+	uint32_t start_time, elapsed, bitTime, sent = 0, stream = 0;
+	CCAN_MSG_OBJ_T msg;
+
+	Chip_CCAN_Mgr_GetStats(&canMgr, &stats, true);
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	while (sent < BENCH_FRAMES) {
+		if (sendStream(stream) == SUCCESS) {
+			stream = (stream + 1) % STREAMS;
+			sent++;
+
+			/* A control frame every 100 frames, it skips the FIFO */
+			if ((sent % 100) == 0) {
+				msg.id = CTRL_ID;
+				msg.dlc = 0;
+				Chip_CCAN_Mgr_Send(&canMgr, &msg);
+			}
+		}
+		readFrames();
+	}
+	while (Chip_CCAN_Mgr_GetTxPending(&canMgr) != 0) {
+		readFrames();
+	}
+	elapsed = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+	readFrames();
+
+	Chip_CCAN_Mgr_GetStats(&canMgr, &stats, false);
+	bitTime = elapsed / ((uint64_t) Chip_Clock_GetRate(CLK_MX_RITIMER) / CCAN_BIT_RATE);
+	if (bitTime == 0) {
+		bitTime = 1;
+	}
+	DEBUGOUT("Sent %d frames in %d ticks, bus %d%% used\r\n", stats.txFrames, elapsed,
+			 (uint32_t) (((uint64_t) stats.txFrames * FRAME_BITS * 100) / bitTime));
+	DEBUGOUT("Received %d stream frames, %d out of order, %d control frames\r\n",
+			 rxCount, outOfOrder, ctrlCount);
+	DEBUGOUT("Drops: %d receive, %d overruns, %d send refused; %d bus off\r\n",
+			 stats.rxDrops, stats.rxOverruns, stats.txDrops, stats.busOff);
+}
+
+/* Receive a list of IDs with compiled filters and the ID set, then send every
+   standard ID once and count the frames getting through */
+static void runFilters(void)
+{
+	CCAN_MGR_STATS_T stats;
+	CCAN_MSG_OBJ_T msg;
+	uint32_t i, numFilters, wanted = 0, received = 0;
+
+	numFilters = Chip_CCAN_Filter_Compile(rxIds, RX_ID_RANGES, rxFilters, FILTER_OBJS + 1);
+	Chip_CCAN_IdSet_Init(&rxIdSet, rxIds, RX_ID_RANGES);
+	for (i = 0; i <= CCAN_MSG_ID_STD_MASK; i++) {
+		if (Chip_CCAN_IdSet_Contains(&rxIdSet, i)) {
+			wanted++;
+		}
+	}
+
+	/* The widest filter for the FIFO, the others in their own objects */
+	Chip_CCAN_Mgr_RemoveRxFilter(&canMgr, CTRL_ID, CCAN_MSG_ID_STD_MASK | CCAN_MSG_ID_EXT_FLAG);
+	Chip_CCAN_Mgr_SetFifoFilter(&canMgr, rxFilters[0].id, rxFilters[0].mask);
+	for (i = 1; i < numFilters; i++) {
+		Chip_CCAN_Mgr_AddRxFilter(&canMgr, rxFilters[i].id, rxFilters[i].mask);
+	}
+	Chip_CCAN_Mgr_SetIdSet(&canMgr, &rxIdSet);
+
+	DEBUGOUT("\r\n%d ID ranges (%d IDs) compiled into %d filters:\r\n", RX_ID_RANGES, wanted, numFilters);
+	for (i = 0; i < numFilters; i++) {
+		DEBUGOUT("  ID %03X mask %03X, %d IDs\r\n", rxFilters[i].id & CCAN_MSG_ID_STD_MASK,
+				 rxFilters[i].mask & CCAN_MSG_ID_STD_MASK, Chip_CCAN_Filter_GetIdCount(&rxFilters[i]));
+	}
+
+	Chip_CCAN_Mgr_GetStats(&canMgr, &stats, true);
+	msg.dlc = 0;
+	for (i = 0; i <= CCAN_MSG_ID_STD_MASK; i++) {
+		msg.id = i;
+		while (Chip_CCAN_Mgr_Send(&canMgr, &msg) != SUCCESS) {}
+		while (RingBuffer_Pop(&rxRing, &msg)) {
+			received++;
+		}
+	}
+	while (Chip_CCAN_Mgr_GetTxPending(&canMgr) != 0) {}
+	while (RingBuffer_Pop(&rxRing, &msg)) {
+		received++;
+	}
+
+	Chip_CCAN_Mgr_GetStats(&canMgr, &stats, false);
+	DEBUGOUT("Sent all %d standard IDs: %d passed the filters, %d dropped by the ID set, %d received\r\n",
+			 CCAN_MSG_ID_STD_MASK + 1, stats.rxFrames + stats.rxFiltered + stats.rxDrops + stats.rxOverruns,
+			 stats.rxFiltered, received);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle CAN0 interrupt by calling the CCAN manager handler
+ * @return	Nothing
+ */
+void CAN0_IRQHandler(void)
+{
+	Chip_CCAN_Mgr_IRQHandler(&canMgr);
+}
+
+/**
+ * @brief	Main program body
+ * @return	int
+ */
+int main(void)
+{
+	SystemCoreClockUpdate();
+	Board_Init();
+	set_pinmux();
+	Chip_RIT_Init(LPC_RITIMER);
+
+	/* Set CCAN peripheral clock under 100Mhz for working stable */
+	Chip_Clock_SetBaseClock(CLK_BASE_APB3, CLKIN_IDIVC, true, false);
+	Chip_CCAN_Init(LPC_C_CAN0);
+	Chip_CCAN_SetBitRate(LPC_C_CAN0, CCAN_BIT_RATE);
+
+	/* Loop back mode receives the frames sent, without a bus */
+	Chip_CCAN_EnableTestMode(LPC_C_CAN0);
+	Chip_CCAN_ConfigTestMode(LPC_C_CAN0, CCAN_TEST_LOOPBACK_MODE);
+
+	RingBuffer_Init(&rxRing, rxFrames, sizeof(CCAN_MSG_OBJ_T), RX_RB_SIZE);
+	Chip_CCAN_Mgr_Init(&canMgr, LPC_C_CAN0, &rxRing, FIFO_OBJS, TX_OBJS, txQueue, TX_QUEUE_SIZE);
+	Chip_CCAN_Mgr_AddRxFilter(&canMgr, CTRL_ID, CCAN_MSG_ID_STD_MASK | CCAN_MSG_ID_EXT_FLAG);
+	NVIC_EnableIRQ(C_CAN0_IRQn);
+
+	DEBUGOUT("***** CCAN MANAGER TEST, loop back at %d bit/s, %d FIFO and %d transmit objects *****\r\n",
+			 CCAN_BIT_RATE, FIFO_OBJS, TX_OBJS);
+	showPriority();
+	benchStreams();
+	runFilters();
+
+	while (1) {
+		__WFI();
+	}
+}
@@ -0,0 +1,406 @@
+/*
+ * @brief Journaled record store on the on-chip EEPROM
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "ee_journal.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Page header layout */
+#define PAGE_SEQ        (0)		/* Sequence number, 32 bits */
+#define PAGE_TAG        (4)		/* Layout tag */
+#define PAGE_COUNT      (5)		/* Number of record copies */
+#define PAGE_CRC        (6)		/* CRC16 of the rest of the page */
+
+#define NO_PAGE         (0xFF)
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* CRC16 (CCITT) */
+static uint16_t crc16(uint16_t crc, const uint8_t *pData, uint32_t len)
+{
+	uint32_t bit;
+
+	while (len--) {
+		crc ^= *pData++ << 8;
+		for (bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+/* CRC of a page, the CRC field excluded */
+static uint16_t pageCrc(const uint8_t *pPage)
+{
+	return crc16(crc16(0xFFFF, pPage, PAGE_CRC), pPage + EE_JOURNAL_PAGE_HDR,
+				 EEPROM_PAGE_SIZE - EE_JOURNAL_PAGE_HDR);
+}
+
+/* Read a page of the store */
+static void readPage(EE_JOURNAL_T *pJ, uint32_t page, uint32_t *pBuff)
+{
+	const volatile uint32_t *pMem = (const volatile uint32_t *) EEPROM_ADDRESS(pJ->firstPage + page, 0);
+	uint32_t idx;
+
+	for (idx = 0; idx < (EEPROM_PAGE_SIZE / 4); idx++) {
+		pBuff[idx] = pMem[idx];
+	}
+}
+
+/* Returns the number of record copies of a valid page, -1 if the page is not valid */
+static int checkPage(EE_JOURNAL_T *pJ, const uint8_t *pPage)
+{
+	uint32_t pos = EE_JOURNAL_PAGE_HDR;
+	uint32_t idx;
+
+	if ((pPage[PAGE_TAG] != pJ->tag) ||
+		(pageCrc(pPage) != (pPage[PAGE_CRC] | (pPage[PAGE_CRC + 1] << 8)))) {
+		return -1;
+	}
+
+	for (idx = 0; idx < pPage[PAGE_COUNT]; idx++) {
+		if ((pos + EE_JOURNAL_ENTRY_HDR) > EEPROM_PAGE_SIZE) {
+			return -1;
+		}
+		if ((pPage[pos] >= pJ->numRecords) || (pPage[pos + 1] != pJ->pSizes[pPage[pos]])) {
+			return -1;
+		}
+		pos += EE_JOURNAL_ENTRY_HDR + pPage[pos + 1];
+		if (pos > EEPROM_PAGE_SIZE) {
+			return -1;
+		}
+	}
+	return pPage[PAGE_COUNT];
+}
+
+static uint32_t getSeq(const uint8_t *pPage)
+{
+	return pPage[PAGE_SEQ] | (pPage[PAGE_SEQ + 1] << 8) | (pPage[PAGE_SEQ + 2] << 16) |
+		   ((uint32_t) pPage[PAGE_SEQ + 3] << 24);
+}
+
+/* Page bytes needed by a record copy */
+static uint32_t entrySize(EE_JOURNAL_T *pJ, uint32_t record)
+{
+	return EE_JOURNAL_ENTRY_HDR + pJ->pSizes[record];
+}
+
+/* Page bytes needed by the newest copies held in a page */
+static uint32_t homeBytes(EE_JOURNAL_T *pJ, uint32_t page)
+{
+	uint32_t record, bytes = 0;
+
+	for (record = 0; record < pJ->numRecords; record++) {
+		if (pJ->home[record] == page) {
+			bytes += entrySize(pJ, record);
+		}
+	}
+	return bytes;
+}
+
+/* Add a record copy to a page */
+static uint32_t addEntry(EE_JOURNAL_T *pJ, uint8_t *pPage, uint32_t pos, uint32_t record)
+{
+	pPage[pos] = record;
+	pPage[pos + 1] = pJ->pSizes[record];
+	memcpy(&pPage[pos + EE_JOURNAL_ENTRY_HDR], &pJ->pImage[pJ->offset[record]], pJ->pSizes[record]);
+	pPage[PAGE_COUNT]++;
+
+	if (pJ->dirty & (1UL << record)) {
+		pJ->dirty &= ~(1UL << record);
+		pJ->dirtyBytes -= entrySize(pJ, record);
+	}
+	else {
+		pJ->stats.copies++;
+	}
+	pJ->home[record] = pJ->headPage;
+	pJ->stats.recordWrites++;
+
+	return pos + entrySize(pJ, record);
+}
+
+/* Returns true when the page program is complete */
+static bool programDone(EE_JOURNAL_T *pJ)
+{
+	if (pJ->busy) {
+		if ((Chip_EEPROM_GetIntStatus(LPC_EEPROM) & EEPROM_INT_ENDOFPROG) == 0) {
+			return false;
+		}
+		Chip_EEPROM_ClearIntStatus(LPC_EEPROM, EEPROM_INT_ENDOFPROG);
+		pJ->busy = 0;
+	}
+	return true;
+}
+
+/* Build the head page and start its program. The newest copies held by the
+   page after it are copied first, so that page can be reused next. A program
+   cut by a power loss then only loses the updates it carried. */
+static void startPage(EE_JOURNAL_T *pJ)
+{
+	uint32_t buff[EEPROM_PAGE_SIZE / 4];
+	uint8_t *pPage = (uint8_t *) buff;
+	volatile uint32_t *pMem = (volatile uint32_t *) EEPROM_ADDRESS(pJ->firstPage + pJ->headPage, 0);
+	uint32_t next = (pJ->headPage + 1) % pJ->numPages;
+	uint32_t pos = EE_JOURNAL_PAGE_HDR;
+	uint32_t record;
+	uint16_t crc;
+
+	memset(buff, 0xFF, sizeof(buff));
+	pPage[PAGE_COUNT] = 0;
+	for (record = 0; record < pJ->numRecords; record++) {
+		if (pJ->home[record] == next) {
+			pos = addEntry(pJ, pPage, pos, record);
+		}
+	}
+	for (record = 0; record < pJ->numRecords; record++) {
+		if ((pJ->dirty & (1UL << record)) && ((pos + entrySize(pJ, record)) <= EEPROM_PAGE_SIZE)) {
+			pos = addEntry(pJ, pPage, pos, record);
+		}
+	}
+
+	pPage[PAGE_SEQ] = pJ->seq & 0xFF;
+	pPage[PAGE_SEQ + 1] = (pJ->seq >> 8) & 0xFF;
+	pPage[PAGE_SEQ + 2] = (pJ->seq >> 16) & 0xFF;
+	pPage[PAGE_SEQ + 3] = pJ->seq >> 24;
+	pPage[PAGE_TAG] = pJ->tag;
+	crc = pageCrc(pPage);
+	pPage[PAGE_CRC] = crc & 0xFF;
+	pPage[PAGE_CRC + 1] = crc >> 8;
+
+	/* Fill the page register and start the erase/program, it takes a few mSec */
+	for (record = 0; record < (EEPROM_PAGE_SIZE / 4); record++) {
+		pMem[record] = buff[record];
+	}
+	Chip_EEPROM_ClearIntStatus(LPC_EEPROM, EEPROM_INT_ENDOFPROG);
+	Chip_EEPROM_SetCmd(LPC_EEPROM, EEPROM_CMD_ERASE_PRG_PAGE);
+	pJ->busy = 1;
+
+	pJ->stats.pageWrites++;
+	pJ->headPage = next;
+	pJ->seq++;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Mount a store */
+EE_JOURNAL_STATUS_T eeJournal_Mount(EE_JOURNAL_T *pJ, uint32_t firstPage, uint32_t numPages,
+									const uint8_t *pSizes, uint32_t numRecords, uint8_t *pImage)
+{
+	uint32_t buff[EEPROM_PAGE_SIZE / 4];
+	uint8_t *pPage = (uint8_t *) buff;
+	uint32_t page, idx, pos, record, seq, total = 0;
+	uint32_t newest = NO_PAGE, newestSeq = 0;
+	uint16_t tag;
+	int count;
+
+	if ((numPages < 2) || (numPages > NO_PAGE) || ((firstPage + numPages) > (EEPROM_PAGE_NUM - 1)) ||
+		(numRecords == 0) || (numRecords > EE_JOURNAL_MAX_RECORDS)) {
+		return EE_JOURNAL_ARGERR;
+	}
+
+	memset(pJ, 0, sizeof(*pJ));
+	pJ->firstPage = firstPage;
+	pJ->numPages = numPages;
+	pJ->numRecords = numRecords;
+	pJ->pSizes = pSizes;
+	pJ->pImage = pImage;
+	for (record = 0; record < numRecords; record++) {
+		if ((pSizes[record] == 0) || (pSizes[record] > EE_JOURNAL_MAX_SIZE)) {
+			return EE_JOURNAL_ARGERR;
+		}
+		pJ->offset[record] = total;
+		pJ->home[record] = NO_PAGE;
+		total += pSizes[record];
+	}
+
+	/* The head page must always find room for the copies it moves */
+	for (record = 0, pos = EE_JOURNAL_MAX_SIZE + EE_JOURNAL_ENTRY_HDR; record < numRecords; record++) {
+		pos += entrySize(pJ, record);
+	}
+	if (pos > ((numPages - 1) * (EEPROM_PAGE_SIZE - EE_JOURNAL_PAGE_HDR))) {
+		return EE_JOURNAL_ARGERR;
+	}
+
+	/* The tag changes with the store layout */
+	tag = crc16(crc16(0xFFFF, pSizes, numRecords), (const uint8_t *) &numPages, sizeof(numPages));
+	pJ->tag = tag ^ (tag >> 8);
+
+	Chip_EEPROM_Init(LPC_EEPROM);
+	Chip_EEPROM_SetAutoProg(LPC_EEPROM, EEPROM_AUTOPROG_OFF);
+
+	/* Find the newest page */
+	for (page = 0; page < numPages; page++) {
+		readPage(pJ, page, buff);
+		if (checkPage(pJ, pPage) >= 0) {
+			seq = getSeq(pPage);
+			if ((newest == NO_PAGE) || ((int32_t) (seq - newestSeq) > 0)) {
+				newest = page;
+				newestSeq = seq;
+			}
+		}
+	}
+
+	if (newest == NO_PAGE) {
+		pJ->headPage = 0;
+		pJ->seq = 1;
+		return EE_JOURNAL_OK;
+	}
+	pJ->headPage = (newest + 1) % numPages;
+	pJ->seq = newestSeq + 1;
+
+	/* Pages are written in ring order, replay them from the oldest so the
+	   newest copy of each record is applied last */
+	for (idx = 1; idx <= numPages; idx++) {
+		page = (newest + idx) % numPages;
+		readPage(pJ, page, buff);
+		count = checkPage(pJ, pPage);
+		if ((count < 0) || ((int32_t) (getSeq(pPage) - newestSeq) > 0)) {
+			continue;
+		}
+
+		for (pos = EE_JOURNAL_PAGE_HDR; count > 0; count--) {
+			record = pPage[pos];
+			memcpy(&pImage[pJ->offset[record]], &pPage[pos + EE_JOURNAL_ENTRY_HDR], pSizes[record]);
+			pJ->home[record] = page;
+			pos += entrySize(pJ, record);
+		}
+	}
+
+	/* The head page is reused next, a newest copy in it is written again */
+	for (record = 0; record < numRecords; record++) {
+		if (pJ->home[record] == pJ->headPage) {
+			pJ->home[record] = NO_PAGE;
+			pJ->dirty |= 1UL << record;
+			pJ->dirtyBytes += entrySize(pJ, record);
+		}
+	}
+
+	return EE_JOURNAL_OK;
+}
+
+/* Update a record in RAM */
+EE_JOURNAL_STATUS_T eeJournal_Write(EE_JOURNAL_T *pJ, uint32_t record, const void *pData)
+{
+	uint8_t *pRec;
+
+	if (record >= pJ->numRecords) {
+		return EE_JOURNAL_ARGERR;
+	}
+
+	pRec = &pJ->pImage[pJ->offset[record]];
+	if (memcmp(pRec, pData, pJ->pSizes[record]) == 0) {
+		return EE_JOURNAL_OK;
+	}
+	memcpy(pRec, pData, pJ->pSizes[record]);
+
+	pJ->stats.updates++;
+	if (pJ->dirty & (1UL << record)) {
+		pJ->stats.coalesced++;
+	}
+	else {
+		pJ->dirty |= 1UL << record;
+		pJ->dirtyBytes += entrySize(pJ, record);
+	}
+	return EE_JOURNAL_OK;
+}
+
+/* Read a record */
+EE_JOURNAL_STATUS_T eeJournal_Read(EE_JOURNAL_T *pJ, uint32_t record, void *pData)
+{
+	if (record >= pJ->numRecords) {
+		return EE_JOURNAL_ARGERR;
+	}
+
+	memcpy(pData, &pJ->pImage[pJ->offset[record]], pJ->pSizes[record]);
+	return EE_JOURNAL_OK;
+}
+
+/* Background writer */
+EE_JOURNAL_STATUS_T eeJournal_Poll(EE_JOURNAL_T *pJ, uint32_t now)
+{
+	uint32_t room;
+	uint32_t all = (2UL << (pJ->numRecords - 1)) - 1;
+
+	if (!programDone(pJ)) {
+		return EE_JOURNAL_BUSY;
+	}
+
+	if (pJ->dirty == 0) {
+		pJ->pendTimed = 0;
+		return EE_JOURNAL_OK;
+	}
+	if (!pJ->pendTimed) {
+		pJ->pendSince = now;
+		pJ->pendTimed = 1;
+	}
+
+	/* Full pages are written, the copies moved out of the next page take
+	   their room first. Merged updates stop growing once every record is
+	   pending, and the delay bounds the updates lost on a power cut. */
+	room = EEPROM_PAGE_SIZE - EE_JOURNAL_PAGE_HDR - homeBytes(pJ, (pJ->headPage + 1) % pJ->numPages);
+	if ((pJ->dirtyBytes >= room) || (pJ->dirty == all) ||
+		((pJ->maxDelay != 0) && ((now - pJ->pendSince) >= pJ->maxDelay))) {
+		startPage(pJ);
+		if (pJ->dirty == 0) {
+			pJ->pendTimed = 0;
+		}
+		return EE_JOURNAL_BUSY;
+	}
+	return EE_JOURNAL_OK;
+}
+
+/* Write all pending updates */
+EE_JOURNAL_STATUS_T eeJournal_Flush(EE_JOURNAL_T *pJ)
+{
+	uint32_t pages;
+
+	/* Every page is reached within one turn of the ring, and one of them has
+	   room for a pending update */
+	for (pages = 0; (pJ->dirty != 0) && (pages < (2 * pJ->numPages)); pages++) {
+		while (!programDone(pJ)) {}
+		startPage(pJ);
+	}
+	while (!programDone(pJ)) {}
+	pJ->pendTimed = 0;
+
+	return (pJ->dirty != 0) ? EE_JOURNAL_FULL : EE_JOURNAL_OK;
+}
@@ -0,0 +1,186 @@
+/*
+ * @brief Journaled record store on the on-chip EEPROM
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __EE_JOURNAL_H_
+#define __EE_JOURNAL_H_
+
+#include "board.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Maximum number of records in a store */
+#define EE_JOURNAL_MAX_RECORDS  (32)
+
+/** Size of the header at the start of each page, in bytes */
+#define EE_JOURNAL_PAGE_HDR     (8)
+
+/** Size of the header in front of each record copy, in bytes */
+#define EE_JOURNAL_ENTRY_HDR    (2)
+
+/** Largest record, a copy must fit in one page */
+#define EE_JOURNAL_MAX_SIZE     (EEPROM_PAGE_SIZE - EE_JOURNAL_PAGE_HDR - EE_JOURNAL_ENTRY_HDR)
+
+/**
+ * @brief Record store status
+ */
+typedef enum {
+	EE_JOURNAL_OK = 0,			/*!< No error */
+	EE_JOURNAL_BUSY,			/*!< A page is being programmed */
+	EE_JOURNAL_FULL,			/*!< Pending updates could not be written */
+	EE_JOURNAL_ARGERR			/*!< Bad argument (record number, size, page range) */
+} EE_JOURNAL_STATUS_T;
+
+/**
+ * @brief Record store statistics, counted since the store was mounted
+ */
+typedef struct {
+	uint32_t updates;			/*!< eeJournal_Write() calls that changed a record */
+	uint32_t coalesced;			/*!< Updates of a record that already had a pending update */
+	uint32_t pageWrites;		/*!< Pages programmed */
+	uint32_t recordWrites;		/*!< Record copies programmed */
+	uint32_t copies;			/*!< Unchanged records copied out of the next page to be reused */
+} EE_JOURNAL_STATS_T;
+
+/**
+ * @brief Record store context, the fields are private to the store functions
+ */
+typedef struct {
+	uint32_t firstPage;			/*!< First EEPROM page of the store */
+	uint32_t numPages;			/*!< Number of pages in the store */
+	uint32_t numRecords;		/*!< Number of records */
+	const uint8_t *pSizes;		/*!< Size of each record */
+	uint8_t *pImage;			/*!< RAM copy of the records, in record order */
+	uint16_t offset[EE_JOURNAL_MAX_RECORDS];	/*!< Offset of each record in the RAM copy */
+	uint8_t home[EE_JOURNAL_MAX_RECORDS];		/*!< Page holding the newest copy of each record, 0xFF for none */
+	uint32_t dirty;				/*!< Records with pending updates, one bit per record */
+	uint32_t dirtyBytes;		/*!< Page bytes the pending updates need */
+	uint32_t maxDelay;			/*!< Longest wait of a pending update, 0 for no limit */
+	uint32_t pendSince;			/*!< Time eeJournal_Poll() first saw the pending updates */
+	uint8_t pendTimed;			/*!< pendSince is set */
+	uint32_t headPage;			/*!< Next page written, it holds no newest copy */
+	uint32_t seq;				/*!< Sequence number of the next page written */
+	uint8_t tag;				/*!< Layout tag, pages of another layout are ignored */
+	uint8_t busy;				/*!< A page program was started */
+	EE_JOURNAL_STATS_T stats;	/*!< Statistics */
+} EE_JOURNAL_T;
+
+/**
+ * @brief	Mount a store, recovering the newest consistent copy of each record
+ * @param	pJ			: Store context to initialize
+ * @param	firstPage	: First EEPROM page of the store
+ * @param	numPages	: Number of pages, at least 2
+ * @param	pSizes		: Size of each record, up to EE_JOURNAL_MAX_SIZE bytes
+ * @param	numRecords	: Number of records, up to EE_JOURNAL_MAX_RECORDS
+ * @param	pImage		: RAM copy of the records, holding the sum of the record sizes
+ * @return	EE_JOURNAL_OK, or EE_JOURNAL_ARGERR
+ * @note	The last EEPROM page is not writable and can't be in the store.
+ * Records are kept in @a pImage in record order without padding. Records
+ * that are not found in the EEPROM keep the value @a pImage holds on entry,
+ * so it should be set to the defaults. The record copies plus one largest copy
+ * must fit in numPages - 1 pages. Pages written with other record sizes are
+ * ignored.
+ */
+EE_JOURNAL_STATUS_T eeJournal_Mount(EE_JOURNAL_T *pJ, uint32_t firstPage, uint32_t numPages,
+									const uint8_t *pSizes, uint32_t numRecords, uint8_t *pImage);
+
+/**
+ * @brief	Update a record in RAM
+ * @param	pJ		: Mounted store
+ * @param	record	: Record number
+ * @param	pData	: New value, pSizes[record] bytes
+ * @return	EE_JOURNAL_OK, or EE_JOURNAL_ARGERR
+ * @note	Does not access the EEPROM. The update is written by eeJournal_Poll()
+ * or eeJournal_Flush(), further updates before that only replace the RAM copy.
+ */
+EE_JOURNAL_STATUS_T eeJournal_Write(EE_JOURNAL_T *pJ, uint32_t record, const void *pData);
+
+/**
+ * @brief	Read a record
+ * @param	pJ		: Mounted store
+ * @param	record	: Record number
+ * @param	pData	: Buffer for the value, pSizes[record] bytes
+ * @return	EE_JOURNAL_OK, or EE_JOURNAL_ARGERR
+ * @note	Reads the RAM copy, pending updates included.
+ */
+EE_JOURNAL_STATUS_T eeJournal_Read(EE_JOURNAL_T *pJ, uint32_t record, void *pData);
+
+/**
+ * @brief	Limit the time an update waits to be written
+ * @param	pJ		: Mounted store
+ * @param	delay	: Longest wait, in the time unit passed to eeJournal_Poll(), 0 for no limit
+ * @return	Nothing
+ * @note	Without a limit, updates that are merged into a few records may
+ * never fill a page and are only written by eeJournal_Flush().
+ */
+STATIC INLINE void eeJournal_SetMaxDelay(EE_JOURNAL_T *pJ, uint32_t delay)
+{
+	pJ->maxDelay = delay;
+}
+
+/**
+ * @brief	Background writer
+ * @param	pJ		: Mounted store
+ * @param	now		: Current time, in any unit that counts up and wraps at 32 bits
+ * @return	EE_JOURNAL_BUSY while a page program is in progress, EE_JOURNAL_OK otherwise
+ * @note	Starts a page program when the pending updates fill the next page,
+ * when every record has a pending update, or when the oldest pending update
+ * waited the delay set with eeJournal_SetMaxDelay(). Returns without waiting
+ * for the program. Should be called from the idle loop.
+ */
+EE_JOURNAL_STATUS_T eeJournal_Poll(EE_JOURNAL_T *pJ, uint32_t now);
+
+/**
+ * @brief	Write all pending updates
+ * @param	pJ		: Mounted store
+ * @return	EE_JOURNAL_OK, or EE_JOURNAL_FULL
+ * @note	Waits for the page programs. Call before a planned reset or power down.
+ */
+EE_JOURNAL_STATUS_T eeJournal_Flush(EE_JOURNAL_T *pJ);
+
+/**
+ * @brief	Returns the store statistics
+ * @param	pJ		: Mounted store
+ * @return	Pointer to the statistics
+ * @note	Each page is programmed about pageWrites / numPages times.
+ */
+STATIC INLINE const EE_JOURNAL_STATS_T *eeJournal_GetStats(const EE_JOURNAL_T *pJ)
+{
+	return &pJ->stats;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EE_JOURNAL_H_ */
@@ -0,0 +1,187 @@
+/*
+ * @brief EEPROM journaled record store example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "ee_journal.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+#define TICKRATE_HZ     (100)	/* Event counter updates per second */
+#define STATS_SECONDS   (10)	/* Statistics display interval */
+#define SAVE_SECONDS    (10)	/* Longest time an update waits for a page program */
+#define FIRST_PAGE      (64)	/* First EEPROM page of the store */
+#define NUM_PAGES       (16)	/* Pages in the store */
+#define NUM_EVENTS      (8)		/* Event counters */
+
+/* Records */
+enum {
+	REC_BOOTCOUNT,
+	REC_COUNTERS,
+	REC_COUNT
+};
+
+/* Counters, one record so a page always holds the uptime and events together */
+typedef struct {
+	uint32_t uptime;
+	uint32_t events[NUM_EVENTS];
+} COUNTERS_T;
+
+/* RAM copy of the records, in record order */
+typedef struct {
+	uint32_t bootCount;
+	COUNTERS_T counters;
+} RECORDS_T;
+
+static const uint8_t recSizes[REC_COUNT] = {
+	sizeof(uint32_t), sizeof(COUNTERS_T)
+};
+
+static EE_JOURNAL_T journal;
+static RECORDS_T records;
+static volatile uint32_t ticks;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Check the counters restored from the EEPROM. An event counter is updated
+   on each tick and the uptime every TICKRATE_HZ ticks, so the events are
+   TICKRATE_HZ times the uptime, plus less than one second for each boot. */
+static void checkCounters(void)
+{
+	uint32_t idx, seconds, total = 0;
+
+	for (idx = 0; idx < NUM_EVENTS; idx++) {
+		total += records.counters.events[idx];
+	}
+	seconds = total / TICKRATE_HZ;
+
+	DEBUGOUT("Restored counters   = %d second(s), %d event(s)\r\n", records.counters.uptime, total);
+	if ((seconds < records.counters.uptime) || ((seconds - records.counters.uptime) > records.bootCount)) {
+		DEBUGOUT("Counters are NOT consistent\r\n");
+	}
+	else if ((records.bootCount != 0) && (total == 0)) {
+		DEBUGOUT("No counters were saved, run for more than %d seconds\r\n", SAVE_SECONDS);
+	}
+	else {
+		DEBUGOUT("Counters are consistent\r\n");
+	}
+}
+
+/* Displays error message and dead loops */
+static void fatalError(char *str, int errNum)
+{
+	DEBUGOUT("\r\n%s() Error:%d\r\n", str, errNum);
+
+	/* Loop forever */
+	while (1) {
+		__WFI();
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle interrupt from SysTick timer
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
+{
+	ticks++;
+}
+
+/**
+ * @brief	Main entry point
+ * @return	Nothing
+ */
+int main(void)
+{
+	const EE_JOURNAL_STATS_T *pStats;
+	EE_JOURNAL_STATUS_T status;
+	COUNTERS_T counters;
+	uint32_t lastTick = 0, value;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+
+	/* Records not found in the EEPROM keep these defaults */
+	memset(&records, 0, sizeof(records));
+	status = eeJournal_Mount(&journal, FIRST_PAGE, NUM_PAGES, recSizes, REC_COUNT, (uint8_t *) &records);
+	if (status != EE_JOURNAL_OK) {
+		fatalError("eeJournal_Mount", status);
+	}
+	DEBUGOUT("Boot count          = %d\r\n", records.bootCount);
+	checkCounters();
+
+	/* The boot count is written at once */
+	value = records.bootCount + 1;
+	eeJournal_Write(&journal, REC_BOOTCOUNT, &value);
+	status = eeJournal_Flush(&journal);
+	if (status != EE_JOURNAL_OK) {
+		fatalError("eeJournal_Flush", status);
+	}
+
+	/* The counter updates are merged and never fill a page, save them at
+	   least every SAVE_SECONDS */
+	eeJournal_SetMaxDelay(&journal, SAVE_SECONDS * TICKRATE_HZ);
+	SysTick_Config(SystemCoreClock / TICKRATE_HZ);
+
+	while (1) {
+		if (ticks != lastTick) {
+			lastTick++;
+			eeJournal_Read(&journal, REC_COUNTERS, &counters);
+			counters.events[lastTick % NUM_EVENTS]++;
+			if ((lastTick % TICKRATE_HZ) == 0) {
+				counters.uptime++;
+			}
+			eeJournal_Write(&journal, REC_COUNTERS, &counters);
+
+			if ((lastTick % (TICKRATE_HZ * STATS_SECONDS)) == 0) {
+				pStats = eeJournal_GetStats(&journal);
+				DEBUGOUT("Updates %d, coalesced %d, pages %d, copies %d\r\n",
+						 pStats->updates, pStats->coalesced, pStats->pageWrites, pStats->copies);
+			}
+		}
+
+		eeJournal_Poll(&journal, ticks);
+		__WFI();
+	}
+
+	return 0;
+}
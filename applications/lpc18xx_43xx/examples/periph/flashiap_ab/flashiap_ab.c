@@ -0,0 +1,146 @@
+/*
+ * @brief A/B FLASH bank update example using the IAP commands
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include "fw_update.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+#define MAX_CHUNK       (1460)	/* Largest chunk, a TCP segment */
+#define SWAP_BANKS      (0)		/* Set to 1 to boot the updated bank at the next reset */
+
+static FW_UPDATE_T updater;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Displays error message and dead loops */
+static void fatalError(char *str, int errNum)
+{
+	DEBUGOUT("\r\n%s() Error:%d (IAP %d)\r\n", str, errNum, updater.lastIapErr);
+
+	/* Loop forever */
+	while (1) {
+		__WFI();
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Main program body
+ * @return	Always returns 0
+ */
+int main(void)
+{
+	const FW_UPDATE_STATS_T *pStats;
+	FW_UPDATE_STATUS_T status;
+	const uint8_t *pSrc;
+	uint32_t srcAddr, offset, chunk, crc, seed;
+	uint32_t start_time;
+	uint8_t bank;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+	Chip_RIT_Init(LPC_RITIMER);
+
+	/* The image is the bank running this code, copied to the other bank */
+	srcAddr = ((uint32_t) &main) & 0xFF000000;
+	if (srcAddr == FW_UPDATE_BANK_A_ADDR) {
+		bank = IAP_FLASH_BANK_B;
+	}
+	else if (srcAddr == FW_UPDATE_BANK_B_ADDR) {
+		bank = IAP_FLASH_BANK_A;
+	}
+	else {
+		fatalError("not running from flash", 0);
+	}
+	pSrc = (const uint8_t *) srcAddr;
+	DEBUGOUT("Copying bank %c to bank %c\r\n", (bank == IAP_FLASH_BANK_B) ? 'A' : 'B',
+			 (bank == IAP_FLASH_BANK_B) ? 'B' : 'A');
+
+	/* The sender gives the image CRC */
+	crc = fwUpdate_Crc32(0, pSrc, FW_UPDATE_BANK_SIZE);
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	status = fwUpdate_Begin(&updater, bank, FW_UPDATE_BANK_SIZE);
+	if (status != FW_UPDATE_OK) {
+		fatalError("fwUpdate_Begin", status);
+	}
+
+	/* Chunks of varying size, as received from a network or USB transport,
+	   with the programming done between them */
+	for (offset = 0, seed = 1; offset < FW_UPDATE_BANK_SIZE; offset += chunk) {
+		seed = (seed * 1103515245) + 12345;
+		chunk = 1 + ((seed >> 16) % MAX_CHUNK);
+		if (chunk > (FW_UPDATE_BANK_SIZE - offset)) {
+			chunk = FW_UPDATE_BANK_SIZE - offset;
+		}
+
+		status = fwUpdate_Write(&updater, pSrc + offset, chunk);
+		if (status == FW_UPDATE_OK) {
+			status = fwUpdate_Poll(&updater);
+		}
+		if (status != FW_UPDATE_OK) {
+			fatalError("fwUpdate_Write", status);
+		}
+	}
+
+	status = fwUpdate_End(&updater, crc);
+	if (status != FW_UPDATE_OK) {
+		fatalError("fwUpdate_End", status);
+	}
+	pStats = fwUpdate_GetStats(&updater);
+	DEBUGOUT("Updated %d blocks, %d sectors (%d erased ahead) in %d mSec(s)\r\n",
+			 pStats->blocks, pStats->sectors, pStats->erasedAhead,
+			 (Chip_RIT_GetCounter(LPC_RITIMER) - start_time) / (SystemCoreClock / 1000));
+	DEBUGOUT("Blocks programmed by fwUpdate_Write() = %d\r\n", pStats->inlinePrograms);
+
+#if SWAP_BANKS
+	status = fwUpdate_Activate(&updater);
+	if (status != FW_UPDATE_OK) {
+		fatalError("fwUpdate_Activate", status);
+	}
+	DEBUGOUT("Bank %c boots at the next reset\r\n", (bank == IAP_FLASH_BANK_A) ? 'A' : 'B');
+#endif
+
+	while (1) {
+		__WFI();
+	}
+}
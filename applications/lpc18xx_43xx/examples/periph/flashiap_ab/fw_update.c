@@ -0,0 +1,406 @@
+/*
+ * @brief Streaming A/B firmware updater using the IAP commands
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "fw_update.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Update states */
+#define STATE_IDLE      (0)
+#define STATE_WRITING   (1)
+#define STATE_DONE      (2)
+
+/* Buffer states */
+#define BUFF_FREE       (0)
+#define BUFF_FILLING    (1)
+#define BUFF_READY      (2)		/* Full, waiting to be programmed */
+#define BUFF_PARKED     (3)		/* First block, programmed by fwUpdate_End() */
+#define NO_BUFF         (0xFF)
+
+/* Sector layout of a bank, 8 sectors of 8KB followed by 64KB sectors */
+#define SMALL_SECTOR_SIZE   (8 * 1024)
+#define SMALL_SECTORS       (8)
+#define LARGE_SECTOR_SIZE   (64 * 1024)
+
+/* Smallest IAP Copy RAM to flash size, the vector block is programmed in pages */
+#define PAGE_SIZE       (512)
+
+#define CRC32_POLY      (0xEDB88320)
+
+static uint32_t crcTable[256];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void crcInit(void)
+{
+	uint32_t idx, bit, crc;
+
+	for (idx = 0; idx < 256; idx++) {
+		crc = idx;
+		for (bit = 0; bit < 8; bit++) {
+			crc = (crc & 1) ? ((crc >> 1) ^ CRC32_POLY) : (crc >> 1);
+		}
+		crcTable[idx] = crc;
+	}
+}
+
+/* Sector holding an image offset */
+static uint32_t sectorNum(uint32_t offset)
+{
+	if (offset < (SMALL_SECTORS * SMALL_SECTOR_SIZE)) {
+		return offset / SMALL_SECTOR_SIZE;
+	}
+	return SMALL_SECTORS + ((offset - (SMALL_SECTORS * SMALL_SECTOR_SIZE)) / LARGE_SECTOR_SIZE);
+}
+
+/* Image offset of the end of the sector holding an offset */
+static uint32_t sectorEnd(uint32_t offset)
+{
+	if (offset < (SMALL_SECTORS * SMALL_SECTOR_SIZE)) {
+		return (offset | (SMALL_SECTOR_SIZE - 1)) + 1;
+	}
+	return (offset | (LARGE_SECTOR_SIZE - 1)) + 1;
+}
+
+static FW_UPDATE_STATUS_T iapFailed(FW_UPDATE_T *pU, uint8_t ret)
+{
+	pU->lastIapErr = ret;
+	pU->state = STATE_IDLE;
+	return FW_UPDATE_IAPERR;
+}
+
+/* Erase the sector after the erased part of the bank */
+static FW_UPDATE_STATUS_T eraseNext(FW_UPDATE_T *pU)
+{
+	uint32_t sector = sectorNum(pU->erasedEnd);
+	uint8_t ret;
+
+	ret = Chip_IAP_PreSectorForReadWrite(sector, sector, pU->bank);
+	if (ret == IAP_CMD_SUCCESS) {
+		ret = Chip_IAP_EraseSector(sector, sector, pU->bank);
+	}
+	if (ret != IAP_CMD_SUCCESS) {
+		return iapFailed(pU, ret);
+	}
+
+	pU->erasedEnd = sectorEnd(pU->erasedEnd);
+	pU->stats.sectors++;
+	return FW_UPDATE_OK;
+}
+
+/* Program a part of a block */
+static uint8_t programRange(FW_UPDATE_T *pU, uint32_t offset, uint32_t *pSrc, uint32_t bytes)
+{
+	uint32_t sector = sectorNum(offset);
+	uint8_t ret;
+
+	ret = Chip_IAP_PreSectorForReadWrite(sector, sector, pU->bank);
+	if (ret == IAP_CMD_SUCCESS) {
+		ret = Chip_IAP_CopyRamToFlash(pU->baseAddr + offset, pSrc, bytes);
+	}
+	return ret;
+}
+
+/* Program a buffer and check it reads back */
+static FW_UPDATE_STATUS_T programBuff(FW_UPDATE_T *pU, uint32_t idx)
+{
+	uint32_t offset = pU->buffOffset[idx];
+	FW_UPDATE_STATUS_T status;
+	uint32_t pos;
+	uint8_t ret;
+
+	while (pU->erasedEnd <= offset) {
+		status = eraseNext(pU);
+		if (status != FW_UPDATE_OK) {
+			return status;
+		}
+	}
+
+	if (offset != 0) {
+		ret = programRange(pU, offset, pU->buff[idx], FW_UPDATE_BLOCK_SIZE);
+	}
+	else {
+		/* The page with the vectors is programmed after the rest of the block,
+		   a program cut short by a power loss can then only leave valid
+		   vectors with a part of that page missing */
+		ret = IAP_CMD_SUCCESS;
+		for (pos = PAGE_SIZE; (pos < FW_UPDATE_BLOCK_SIZE) && (ret == IAP_CMD_SUCCESS); pos += PAGE_SIZE) {
+			ret = programRange(pU, pos, &pU->buff[idx][pos / 4], PAGE_SIZE);
+		}
+		if (ret == IAP_CMD_SUCCESS) {
+			ret = programRange(pU, 0, pU->buff[idx], PAGE_SIZE);
+		}
+	}
+	if (ret != IAP_CMD_SUCCESS) {
+		return iapFailed(pU, ret);
+	}
+
+	/* The flash is read once and compared with the CRC taken while the
+	   buffer was filled, instead of a compare with the RAM copy */
+	if (fwUpdate_Crc32(0, (const void *) (pU->baseAddr + offset), FW_UPDATE_BLOCK_SIZE) != pU->blockCrc[idx]) {
+		pU->state = STATE_IDLE;
+		return FW_UPDATE_VERIFYERR;
+	}
+
+	pU->buffState[idx] = BUFF_FREE;
+	pU->stats.blocks++;
+	return FW_UPDATE_OK;
+}
+
+/* Returns the full buffer with the lowest offset, NO_BUFF if none */
+static uint32_t nextReady(FW_UPDATE_T *pU)
+{
+	uint32_t idx, ready = NO_BUFF;
+
+	for (idx = 0; idx < 3; idx++) {
+		if ((pU->buffState[idx] == BUFF_READY) &&
+			((ready == NO_BUFF) || (pU->buffOffset[idx] < pU->buffOffset[ready]))) {
+			ready = idx;
+		}
+	}
+	return ready;
+}
+
+/* A buffer is full, the first block is kept for the end */
+static void completeBuff(FW_UPDATE_T *pU)
+{
+	pU->buffState[pU->fillBuff] = (pU->buffOffset[pU->fillBuff] == 0) ? BUFF_PARKED : BUFF_READY;
+	pU->fillBuff = NO_BUFF;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Update a CRC32 */
+uint32_t fwUpdate_Crc32(uint32_t crc, const void *pData, uint32_t len)
+{
+	const uint8_t *p8 = (const uint8_t *) pData;
+
+	if (crcTable[1] == 0) {
+		crcInit();
+	}
+
+	crc = ~crc;
+	while (len--) {
+		crc = crcTable[(crc ^ *p8++) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+/* Start an update */
+FW_UPDATE_STATUS_T fwUpdate_Begin(FW_UPDATE_T *pU, uint8_t bank, uint32_t size)
+{
+	uint8_t ret;
+
+	if ((bank != IAP_FLASH_BANK_A) && (bank != IAP_FLASH_BANK_B)) {
+		return FW_UPDATE_ARGERR;
+	}
+
+	memset(pU, 0, sizeof(*pU));
+	pU->bank = bank;
+	pU->baseAddr = (bank == IAP_FLASH_BANK_A) ? FW_UPDATE_BANK_A_ADDR : FW_UPDATE_BANK_B_ADDR;
+	pU->fillBuff = NO_BUFF;
+
+	/* The running bank can't be written */
+	if ((size == 0) || (size > FW_UPDATE_BANK_SIZE) ||
+		((((uint32_t) &fwUpdate_Begin) & 0xFF000000) == pU->baseAddr)) {
+		return FW_UPDATE_ARGERR;
+	}
+	pU->size = size;
+
+	ret = Chip_IAP_Init();
+	if (ret != IAP_CMD_SUCCESS) {
+		return iapFailed(pU, ret);
+	}
+
+	pU->state = STATE_WRITING;
+	return FW_UPDATE_OK;
+}
+
+/* Add a chunk of the image */
+FW_UPDATE_STATUS_T fwUpdate_Write(FW_UPDATE_T *pU, const void *pData, uint32_t len)
+{
+	const uint8_t *p8 = (const uint8_t *) pData;
+	FW_UPDATE_STATUS_T status;
+	uint32_t idx, pos, bytes;
+
+	if (pU->state != STATE_WRITING) {
+		return FW_UPDATE_STATEERR;
+	}
+	if ((pU->rxOffset + len) > pU->size) {
+		return FW_UPDATE_SIZEERR;
+	}
+
+	while (len) {
+		/* Start a block in a free buffer, programming one if both are full */
+		if (pU->fillBuff == NO_BUFF) {
+			for (idx = 0; (idx < 3) && (pU->buffState[idx] != BUFF_FREE); idx++) {}
+			if (idx == 3) {
+				idx = nextReady(pU);
+				status = programBuff(pU, idx);
+				if (status != FW_UPDATE_OK) {
+					return status;
+				}
+				pU->stats.inlinePrograms++;
+			}
+			pU->fillBuff = idx;
+			pU->buffState[idx] = BUFF_FILLING;
+			pU->buffOffset[idx] = pU->rxOffset;
+			pU->blockCrc[idx] = 0;
+		}
+
+		pos = pU->rxOffset % FW_UPDATE_BLOCK_SIZE;
+		bytes = FW_UPDATE_BLOCK_SIZE - pos;
+		if (bytes > len) {
+			bytes = len;
+		}
+		memcpy((uint8_t *) pU->buff[pU->fillBuff] + pos, p8, bytes);
+		pU->blockCrc[pU->fillBuff] = fwUpdate_Crc32(pU->blockCrc[pU->fillBuff], p8, bytes);
+		pU->streamCrc = fwUpdate_Crc32(pU->streamCrc, p8, bytes);
+		p8 += bytes;
+		len -= bytes;
+		pU->rxOffset += bytes;
+
+		if ((pU->rxOffset % FW_UPDATE_BLOCK_SIZE) == 0) {
+			completeBuff(pU);
+		}
+	}
+
+	return FW_UPDATE_OK;
+}
+
+/* Background programming */
+FW_UPDATE_STATUS_T fwUpdate_Poll(FW_UPDATE_T *pU)
+{
+	uint32_t idx;
+	FW_UPDATE_STATUS_T status;
+
+	if (pU->state != STATE_WRITING) {
+		return FW_UPDATE_OK;
+	}
+
+	idx = nextReady(pU);
+	if (idx != NO_BUFF) {
+		return programBuff(pU, idx);
+	}
+
+	/* Nothing to program, erase the next sector before the data reaches it */
+	if (pU->erasedEnd < pU->size) {
+		status = eraseNext(pU);
+		if (status == FW_UPDATE_OK) {
+			pU->stats.erasedAhead++;
+		}
+		return status;
+	}
+	return FW_UPDATE_OK;
+}
+
+/* Complete the update */
+FW_UPDATE_STATUS_T fwUpdate_End(FW_UPDATE_T *pU, uint32_t crc)
+{
+	FW_UPDATE_STATUS_T status;
+	uint32_t idx, pos, sum;
+	uint32_t *pVectors;
+
+	if (pU->state != STATE_WRITING) {
+		return FW_UPDATE_STATEERR;
+	}
+	if (pU->rxOffset != pU->size) {
+		return FW_UPDATE_SIZEERR;
+	}
+
+	/* Pad the last block with erased flash bytes */
+	if (pU->fillBuff != NO_BUFF) {
+		idx = pU->fillBuff;
+		pos = pU->rxOffset % FW_UPDATE_BLOCK_SIZE;
+		memset((uint8_t *) pU->buff[idx] + pos, 0xFF, FW_UPDATE_BLOCK_SIZE - pos);
+		pU->blockCrc[idx] = fwUpdate_Crc32(pU->blockCrc[idx], (uint8_t *) pU->buff[idx] + pos,
+										   FW_UPDATE_BLOCK_SIZE - pos);
+		completeBuff(pU);
+	}
+
+	for (idx = nextReady(pU); idx != NO_BUFF; idx = nextReady(pU)) {
+		status = programBuff(pU, idx);
+		if (status != FW_UPDATE_OK) {
+			return status;
+		}
+	}
+
+	if (pU->streamCrc != crc) {
+		pU->state = STATE_IDLE;
+		return FW_UPDATE_CRCERR;
+	}
+
+	/* The boot ROM only starts an image whose first 8 vectors sum to 0 */
+	for (idx = 0; pU->buffState[idx] != BUFF_PARKED; idx++) {}
+	pVectors = pU->buff[idx];
+	for (pos = 0, sum = 0; pos < 8; pos++) {
+		sum += pVectors[pos];
+	}
+	if (sum != 0) {
+		pU->state = STATE_IDLE;
+		return FW_UPDATE_IMAGEERR;
+	}
+
+	status = programBuff(pU, idx);
+	if (status != FW_UPDATE_OK) {
+		return status;
+	}
+
+	pU->state = STATE_DONE;
+	return FW_UPDATE_OK;
+}
+
+/* Make the updated bank the boot bank */
+FW_UPDATE_STATUS_T fwUpdate_Activate(FW_UPDATE_T *pU)
+{
+	uint8_t ret;
+
+	if (pU->state != STATE_DONE) {
+		return FW_UPDATE_STATEERR;
+	}
+
+	ret = Chip_IAP_SetBootFlashBank(pU->bank);
+	if (ret != IAP_CMD_SUCCESS) {
+		return iapFailed(pU, ret);
+	}
+	return FW_UPDATE_OK;
+}
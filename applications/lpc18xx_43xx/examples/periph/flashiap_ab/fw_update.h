@@ -0,0 +1,177 @@
+/*
+ * @brief Streaming A/B firmware updater using the IAP commands
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __FW_UPDATE_H_
+#define __FW_UPDATE_H_
+
+#include "board.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Size of a program block, the largest IAP Copy RAM to flash size */
+#define FW_UPDATE_BLOCK_SIZE    (4096)
+
+/** Size of a flash bank, 512KB on the LPC4337/LPC4357 */
+#ifndef FW_UPDATE_BANK_SIZE
+#define FW_UPDATE_BANK_SIZE     (512 * 1024)
+#endif
+
+/** Flash bank base addresses */
+#define FW_UPDATE_BANK_A_ADDR   (0x1A000000)
+#define FW_UPDATE_BANK_B_ADDR   (0x1B000000)
+
+/**
+ * @brief Firmware updater status
+ */
+typedef enum {
+	FW_UPDATE_OK = 0,			/*!< No error */
+	FW_UPDATE_ARGERR,			/*!< Bad argument, or the bank is the one running */
+	FW_UPDATE_STATEERR,			/*!< Call out of sequence */
+	FW_UPDATE_SIZEERR,			/*!< More or less data than announced */
+	FW_UPDATE_IAPERR,			/*!< IAP command failed, see lastIapErr */
+	FW_UPDATE_VERIFYERR,		/*!< A programmed block does not read back */
+	FW_UPDATE_CRCERR,			/*!< Image CRC does not match */
+	FW_UPDATE_IMAGEERR			/*!< Vector table checksum is not valid */
+} FW_UPDATE_STATUS_T;
+
+/**
+ * @brief Firmware updater statistics
+ */
+typedef struct {
+	uint32_t blocks;			/*!< Blocks programmed */
+	uint32_t sectors;			/*!< Sectors erased */
+	uint32_t erasedAhead;		/*!< Sectors erased by fwUpdate_Poll() before data reached them */
+	uint32_t inlinePrograms;	/*!< Blocks fwUpdate_Write() had to program itself */
+} FW_UPDATE_STATS_T;
+
+/**
+ * @brief Firmware updater context, the fields are private to the updater functions
+ */
+typedef struct {
+	uint32_t buff[3][FW_UPDATE_BLOCK_SIZE / 4];	/*!< Block buffers */
+	uint32_t buffOffset[3];		/*!< Image offset of each buffer */
+	uint8_t buffState[3];		/*!< State of each buffer */
+	uint8_t fillBuff;			/*!< Buffer being filled */
+	uint8_t bank;				/*!< Bank being written */
+	uint8_t state;				/*!< Update state */
+	uint32_t baseAddr;			/*!< Base address of the bank */
+	uint32_t size;				/*!< Image size */
+	uint32_t rxOffset;			/*!< Image bytes received */
+	uint32_t erasedEnd;			/*!< Image offset up to which the bank is erased */
+	uint32_t streamCrc;			/*!< CRC32 of the received data */
+	uint32_t blockCrc[3];		/*!< CRC32 of each buffer, computed as it is filled */
+	uint8_t lastIapErr;			/*!< Last IAP status code */
+	FW_UPDATE_STATS_T stats;	/*!< Statistics */
+} FW_UPDATE_T;
+
+/**
+ * @brief	Update a CRC32 (IEEE 802.3, as zlib crc32())
+ * @param	crc		: CRC of the previous data, 0 to start
+ * @param	pData	: Data
+ * @param	len		: Data length in bytes
+ * @return	CRC of the data so far
+ */
+uint32_t fwUpdate_Crc32(uint32_t crc, const void *pData, uint32_t len);
+
+/**
+ * @brief	Start an update of a flash bank
+ * @param	pU		: Updater context to initialize
+ * @param	bank	: IAP_FLASH_BANK_A or IAP_FLASH_BANK_B, not the bank running this code
+ * @param	size	: Image size in bytes
+ * @return	FW_UPDATE_OK, or an error code
+ * @note	Sectors are erased just ahead of the data, so the update does not
+ * start with a long erase of the whole bank.
+ */
+FW_UPDATE_STATUS_T fwUpdate_Begin(FW_UPDATE_T *pU, uint8_t bank, uint32_t size);
+
+/**
+ * @brief	Add a chunk of the image
+ * @param	pU		: Updater context
+ * @param	pData	: Chunk data, any alignment
+ * @param	len		: Chunk length in bytes, any length
+ * @return	FW_UPDATE_OK, or an error code
+ * @note	Chunks are copied into one block buffer while the other is
+ * programmed by fwUpdate_Poll(). When both buffers are full the block is
+ * programmed here. Must not be called while fwUpdate_Poll() runs, from an
+ * interrupt for example.
+ */
+FW_UPDATE_STATUS_T fwUpdate_Write(FW_UPDATE_T *pU, const void *pData, uint32_t len);
+
+/**
+ * @brief	Background programming
+ * @param	pU		: Updater context
+ * @return	FW_UPDATE_OK, or an error code
+ * @note	Programs and verifies one full block, or else erases the next
+ * sector ahead of the data. Should be called from the idle loop.
+ */
+FW_UPDATE_STATUS_T fwUpdate_Poll(FW_UPDATE_T *pU);
+
+/**
+ * @brief	Complete the update
+ * @param	pU		: Updater context
+ * @param	crc		: Expected fwUpdate_Crc32() of the whole image
+ * @return	FW_UPDATE_OK, or an error code
+ * @note	The first block, with the vector table, is held back and only
+ * programmed once all the other blocks are written and verified, the image
+ * CRC matches and the vector table checksum is valid. A failed update, or one
+ * interrupted before that block, never leaves a bootable image. The page with
+ * the vectors is programmed after the rest of the block, so a power loss
+ * while it is programmed can only leave a part of that 512 byte page missing.
+ */
+FW_UPDATE_STATUS_T fwUpdate_End(FW_UPDATE_T *pU, uint32_t crc);
+
+/**
+ * @brief	Make the updated bank the boot bank
+ * @param	pU		: Updater context, after a successful fwUpdate_End()
+ * @return	FW_UPDATE_OK, or an error code
+ * @note	The boot bank is switched by a single IAP command. The new image
+ * runs from the next reset.
+ */
+FW_UPDATE_STATUS_T fwUpdate_Activate(FW_UPDATE_T *pU);
+
+/**
+ * @brief	Returns the updater statistics
+ * @param	pU		: Updater context
+ * @return	Pointer to the statistics
+ */
+STATIC INLINE const FW_UPDATE_STATS_T *fwUpdate_GetStats(const FW_UPDATE_T *pU)
+{
+	return &pU->stats;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FW_UPDATE_H_ */
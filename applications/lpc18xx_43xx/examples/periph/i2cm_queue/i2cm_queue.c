@@ -0,0 +1,288 @@
+/*
+ * @brief I2CM job queue example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define SPEED_400KHZ            (400000)
+
+/* Slave with 16-bit registers 1 to 4 */
+#if (defined(BOARD_KEIL_MCB_1857) || defined(BOARD_KEIL_MCB_4357))
+#define I2C_ADDR_7BIT           (0x41)
+#elif (defined(BOARD_NGX_XPLORER_1830) || defined(BOARD_NGX_XPLORER_4330))
+#define I2C_ADDR_7BIT           (0x1A)
+#elif (defined(BOARD_NXP_LPCXPRESSO_4337) || defined(BOARD_NXP_LPCXPRESSO_1837))
+#define I2C_ADDR_7BIT           (0x40)
+#else
+#warning "WARNING: No slave with 16-bit registers known for this board, reads will NAK"
+#define I2C_ADDR_7BIT           (0x40)
+#endif
+
+/* Register reads of each timed case, four per job */
+#define BENCH_READS             (256)
+#define READS_PER_JOB           (4)
+#define BENCH_JOBS              (BENCH_READS / READS_PER_JOB)
+
+/* Periodic sampling, in SysTick ticks */
+#define TICKRATE_HZ             (1000)
+#define FAST_PERIOD             (1)
+#define SLOW_PERIOD             (5)
+#define RUN_TICKS               (1000)
+
+static const uint8_t regAddr[READS_PER_JOB] = {1, 2, 3, 4};
+static uint8_t regData[BENCH_READS][2];
+
+static I2CM_QUEUE_T i2cQueue;
+
+/* The timed jobs, each reads the four registers with repeated starts */
+static I2CM_XFER_T benchXfers[BENCH_JOBS][READS_PER_JOB];
+static I2CM_JOB_T benchJobs[BENCH_JOBS];
+
+/* Two sampling schedules on separate devices of the same slave, so that
+   they take turns on the bus */
+static I2CM_DEVICE_T fastDev, slowDev;
+static I2CM_XFER_T fastXfer, slowXfers[READS_PER_JOB];
+static I2CM_JOB_T fastJob, slowJob;
+static uint8_t fastData[2], slowData[READS_PER_JOB][2];
+
+static volatile uint32_t ticks;
+static volatile uint32_t jobsDone, fastSamples, slowSamples;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Set up a register read transfer */
+static void setupRead(I2CM_XFER_T *xfer, const uint8_t *reg, uint8_t *data)
+{
+	xfer->slaveAddr = I2C_ADDR_7BIT;
+	xfer->options = 0;
+	xfer->status = 0;
+	xfer->txSz = 1;
+	xfer->rxSz = 2;
+	xfer->txBuff = reg;
+	xfer->rxBuff = data;
+}
+
+/* Count the completed timed jobs */
+static void benchDone(I2CM_JOB_T *pJob, uint32_t status)
+{
+	(void) pJob;
+	(void) status;
+	jobsDone++;
+}
+
+/* Count the samples taken */
+static void sampleDone(I2CM_JOB_T *pJob, uint32_t status)
+{
+	if (status == I2CM_STATUS_OK) {
+		if (pJob == &fastJob) {
+			fastSamples++;
+		}
+		else {
+			slowSamples++;
+		}
+	}
+}
+
+/* Print the time taken and the bus utilisation, busClocks against the SCL
+   periods in the time taken */
+static void printUtilisation(const char *name, uint32_t elapsed, uint32_t busClocks, uint32_t errors)
+{
+	uint64_t sclPeriods = (uint64_t) elapsed * SPEED_400KHZ / Chip_Clock_GetRate(CLK_MX_RITIMER);
+
+	if (sclPeriods == 0) {
+		sclPeriods = 1;
+	}
+	DEBUGOUT("%-9s %10d %5d%% %6d\r\n", name, elapsed, (uint32_t) ((busClocks * 100ULL) / sclPeriods), errors);
+}
+
+/* Time BENCH_READS register reads with blocking transfers, one after the other */
+static void benchBlocking(void)
+{
+	I2CM_XFER_T xfer;
+	uint32_t start_time, i, errors = 0;
+
+	/* Chip_I2CM_XferBlocking() polls the state changes itself */
+	NVIC_DisableIRQ(I2C0_IRQn);
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (i = 0; i < BENCH_READS; i++) {
+		setupRead(&xfer, &regAddr[i % READS_PER_JOB], regData[i]);
+		Chip_I2CM_XferBlocking(LPC_I2C0, &xfer);
+		if (xfer.status != I2CM_STATUS_OK) {
+			errors++;
+		}
+		/* The next START must not cut the STOP short */
+		while (!Chip_I2CM_BusFree(LPC_I2C0)) {}
+	}
+
+	/* Each read is START, address, register, repeated START, address, two data
+	   bytes and STOP */
+	printUtilisation("blocking", Chip_RIT_GetCounter(LPC_RITIMER) - start_time,
+					 BENCH_READS * (3 + 5 * 9), errors);
+
+	NVIC_ClearPendingIRQ(I2C0_IRQn);
+	NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+/* Time the same reads as queued jobs of READS_PER_JOB chained reads */
+static void benchQueue(void)
+{
+	I2CM_QUEUE_STATS_T stats;
+	uint32_t start_time, elapsed, i, j;
+
+	for (i = 0; i < BENCH_JOBS; i++) {
+		for (j = 0; j < READS_PER_JOB; j++) {
+			setupRead(&benchXfers[i][j], &regAddr[j], regData[(i * READS_PER_JOB) + j]);
+		}
+		benchJobs[i].pXfers = benchXfers[i];
+		benchJobs[i].numXfers = READS_PER_JOB;
+		benchJobs[i].pDev = NULL;
+		benchJobs[i].callback = benchDone;
+	}
+
+	Chip_I2CM_Queue_GetStats(&i2cQueue, &stats, true);
+	jobsDone = 0;
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (i = 0; i < BENCH_JOBS; i++) {
+		Chip_I2CM_Queue_Submit(&i2cQueue, &benchJobs[i]);
+	}
+	while (jobsDone < BENCH_JOBS) {}
+	elapsed = Chip_RIT_GetCounter(LPC_RITIMER) - start_time;
+
+	Chip_I2CM_Queue_GetStats(&i2cQueue, &stats, true);
+	printUtilisation("queue", elapsed, stats.busClocks, stats.errors);
+}
+
+/* Sample on two schedules and count the CPU loops left to the application */
+static void runPeriodic(void)
+{
+	I2CM_QUEUE_STATS_T stats;
+	uint32_t i, end, loops = 0;
+
+	setupRead(&fastXfer, &regAddr[1], fastData);
+	fastJob.pXfers = &fastXfer;
+	fastJob.numXfers = 1;
+	fastJob.pDev = &fastDev;
+	fastJob.callback = sampleDone;
+
+	for (i = 0; i < READS_PER_JOB; i++) {
+		setupRead(&slowXfers[i], &regAddr[i], slowData[i]);
+	}
+	slowJob.pXfers = slowXfers;
+	slowJob.numXfers = READS_PER_JOB;
+	slowJob.pDev = &slowDev;
+	slowJob.callback = sampleDone;
+
+	Chip_I2CM_Queue_GetStats(&i2cQueue, &stats, true);
+	end = ticks + RUN_TICKS;
+	Chip_I2CM_Queue_Schedule(&i2cQueue, &fastJob, FAST_PERIOD);
+	Chip_I2CM_Queue_Schedule(&i2cQueue, &slowJob, SLOW_PERIOD);
+	while ((int32_t) (end - ticks) > 0) {
+		loops++;
+	}
+	Chip_I2CM_Queue_Unschedule(&i2cQueue, &fastJob);
+	Chip_I2CM_Queue_Unschedule(&i2cQueue, &slowJob);
+	while ((Chip_I2CM_Queue_GetJobState(&fastJob) != I2CM_JOB_IDLE) ||
+		   (Chip_I2CM_Queue_GetJobState(&slowJob) != I2CM_JOB_IDLE)) {}
+
+	Chip_I2CM_Queue_GetStats(&i2cQueue, &stats, false);
+	DEBUGOUT("\r\nSampling every %d and %d ms for %d ms: %d and %d samples, %d errors, "
+			 "%d missed, bus %d%% used, %d CPU loops free\r\n",
+			 FAST_PERIOD, SLOW_PERIOD, RUN_TICKS, fastSamples, slowSamples, stats.errors,
+			 stats.missed, (stats.busClocks * 100) / ((SPEED_400KHZ / TICKRATE_HZ) * RUN_TICKS), loops);
+	DEBUGOUT("Last registers 1 to 4: 0x%02X%02X 0x%02X%02X 0x%02X%02X 0x%02X%02X\r\n",
+			 slowData[0][0], slowData[0][1], slowData[1][0], slowData[1][1],
+			 slowData[2][0], slowData[2][1], slowData[3][0], slowData[3][1]);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle interrupt from SysTick timer, submits the periodic jobs
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
+{
+	ticks++;
+	Chip_I2CM_Queue_Tick(&i2cQueue);
+}
+
+/**
+ * @brief	Handle I2C0 interrupt by calling the I2CM queue handler
+ * @return	Nothing
+ */
+void I2C0_IRQHandler(void)
+{
+	Chip_I2CM_Queue_IRQHandler(&i2cQueue);
+}
+
+/**
+ * @brief	Main program body
+ * @return	int
+ */
+int main(void)
+{
+	SystemCoreClockUpdate();
+	Board_Init();
+	Chip_RIT_Init(LPC_RITIMER);
+
+	Board_I2C_Init(I2C0);
+	Chip_I2CM_Init(LPC_I2C0);
+	Chip_I2CM_SetBusSpeed(LPC_I2C0, SPEED_400KHZ);
+	Chip_I2CM_Queue_Init(&i2cQueue, LPC_I2C0);
+	NVIC_SetPriority(I2C0_IRQn, 0);
+	NVIC_EnableIRQ(I2C0_IRQn);
+
+	NVIC_SetPriority(SysTick_IRQn, 1);
+	SysTick_Config(SystemCoreClock / TICKRATE_HZ);
+
+	DEBUGOUT("***** I2CM QUEUE TEST, %d register reads of slave 0x%02X at %d Hz *****\r\n",
+			 BENCH_READS, I2C_ADDR_7BIT, SPEED_400KHZ);
+	DEBUGSTR("METHOD         TICKS   BUS ERRORS\r\n");
+	benchBlocking();
+	benchQueue();
+	runPeriodic();
+
+	while (1) {
+		__WFI();
+	}
+}
@@ -0,0 +1,266 @@
+/*
+ * @brief SSP DMA job queue example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "string.h"
+#include "board.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#if (defined(BOARD_HITEX_EVA_1850) || defined(BOARD_HITEX_EVA_4350))
+#define LPC_SSP           LPC_SSP0
+#else
+#define LPC_SSP           LPC_SSP1
+#endif
+
+/* GPIO chip select driven by Board_SSP_Init() for SSP1 */
+#define CS_PORT           5
+#define CS_PIN            8
+
+/* Bus clock of the timed jobs */
+#define BENCH_BITRATE     (12000000)
+
+/* Frames moved per timed case, and the buffer holding them */
+#define BENCH_FRAMES      (8192)
+
+/* Periodic sensor job, 16 frames every PERIOD_MS, for RUN_MS */
+#define TICKRATE_HZ       (1000)
+#define PERIOD_MS         (1)
+#define RUN_MS            (1000)
+
+static uint8_t txBuff[BENCH_FRAMES];
+static uint8_t rxBuff[BENCH_FRAMES];
+
+static SSP_QUEUE_T sspQueue;
+/* Jobs are recycled once they complete, the queue only holds references */
+#define JOB_POOL          (16)
+static SSP_JOB_T jobs[JOB_POOL];
+static SSP_JOB_T sensorJob;
+static uint8_t sensorRx[16];
+
+static volatile uint32_t ticks;
+static volatile uint32_t jobsDone;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Count the completed jobs */
+static void jobDone(SSP_JOB_T *pJob, Status status)
+{
+	(void) pJob;
+	(void) status;
+	jobsDone++;
+}
+
+/* Return the bit rate the SSP runs at */
+static uint32_t actualBitRate(void)
+{
+	uint32_t scr = (LPC_SSP->CR0 >> 8) & 0xFF;
+
+	return Chip_Clock_GetRate((LPC_SSP == LPC_SSP1) ? CLK_APB2_SSP1 : CLK_APB0_SSP0) /
+		   (LPC_SSP->CPSR * (scr + 1));
+}
+
+/* Print the bus utilisation of a timed case, the time the frames take on
+   the wire against the time measured */
+static void printUtilisation(const char *name, uint32_t frameSize, uint32_t elapsed)
+{
+	uint64_t wireTicks = (uint64_t) BENCH_FRAMES * 8 * Chip_Clock_GetRate(CLK_MX_RITIMER) /
+						 actualBitRate();
+	bool ok = (memcmp(txBuff, rxBuff, BENCH_FRAMES) == 0);
+
+	if (elapsed == 0) {
+		elapsed = 1;
+	}
+	DEBUGOUT("%-8s %6d %10d %5d%%   %s\r\n", name, frameSize, elapsed,
+			 (uint32_t) ((wireTicks * 100) / elapsed), ok ? "OK" : "FAILED");
+}
+
+/* Time moving BENCH_FRAMES frames with blocking polled transfers of jobSize frames */
+static void benchBlocking(uint32_t jobSize)
+{
+	Chip_SSP_DATA_SETUP_T xf_setup;
+	uint32_t start_time, i;
+
+	memset(rxBuff, 0, sizeof(rxBuff));
+	Chip_SSP_SetFormat(LPC_SSP, SSP_BITS_8, SSP_FRAMEFORMAT_SPI, SSP_CLOCK_MODE0);
+	Chip_SSP_SetBitRate(LPC_SSP, BENCH_BITRATE);
+	Chip_SSP_DMA_Disable(LPC_SSP);
+
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (i = 0; i < BENCH_FRAMES; i += jobSize) {
+		xf_setup.tx_data = &txBuff[i];
+		xf_setup.rx_data = &rxBuff[i];
+		xf_setup.tx_cnt = xf_setup.rx_cnt = 0;
+		xf_setup.length = jobSize;
+		Chip_GPIO_SetPinState(LPC_GPIO_PORT, CS_PORT, CS_PIN, false);
+		Chip_SSP_RWFrames_Blocking(LPC_SSP, &xf_setup);
+		Chip_GPIO_SetPinState(LPC_GPIO_PORT, CS_PORT, CS_PIN, true);
+	}
+	printUtilisation("blocking", jobSize, Chip_RIT_GetCounter(LPC_RITIMER) - start_time);
+
+	Chip_SSP_DMA_Enable(LPC_SSP);
+}
+
+/* Time moving BENCH_FRAMES frames with queued jobs of jobSize frames */
+static void benchQueue(uint32_t jobSize)
+{
+	SSP_JOB_T *pJob;
+	uint32_t start_time, i, numJobs = BENCH_FRAMES / jobSize;
+
+	memset(rxBuff, 0, sizeof(rxBuff));
+	memset(jobs, 0, sizeof(jobs));
+
+	/* The first job starts at once and the others queue behind it, a pool
+	   entry is filled again as soon as its job has completed */
+	jobsDone = 0;
+	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (i = 0; i < numJobs; i++) {
+		pJob = &jobs[i % JOB_POOL];
+		while (Chip_SSP_Queue_GetJobState(pJob) != SSP_JOB_IDLE) {}
+		pJob->tx_data = &txBuff[i * jobSize];
+		pJob->rx_data = &rxBuff[i * jobSize];
+		pJob->length = jobSize;
+		pJob->bitRate = BENCH_BITRATE;
+		pJob->bits = SSP_BITS_8;
+		pJob->clockMode = SSP_CLOCK_MODE0;
+		pJob->cs.port = CS_PORT;
+		pJob->cs.pin = CS_PIN;
+		pJob->callback = jobDone;
+		Chip_SSP_Queue_Submit(&sspQueue, pJob);
+	}
+	while (jobsDone < numJobs) {}
+	printUtilisation("queue", jobSize, Chip_RIT_GetCounter(LPC_RITIMER) - start_time);
+}
+
+/* Run a periodic job and count the CPU loops left to the application */
+static void benchPeriodic(void)
+{
+	SSP_QUEUE_STATS_T stats;
+	uint32_t end, loops = 0;
+
+	memset(&sensorJob, 0, sizeof(sensorJob));
+	sensorJob.tx_data = NULL;		/* Clocks out all ones */
+	sensorJob.rx_data = sensorRx;
+	sensorJob.length = sizeof(sensorRx);
+	sensorJob.bitRate = 1000000;
+	sensorJob.bits = SSP_BITS_8;
+	sensorJob.clockMode = SSP_CLOCK_MODE3;
+	sensorJob.cs.port = CS_PORT;
+	sensorJob.cs.pin = CS_PIN;
+
+	Chip_SSP_Queue_GetStats(&sspQueue, &stats, true);
+	end = ticks + RUN_MS;
+	Chip_SSP_Queue_Schedule(&sspQueue, &sensorJob, PERIOD_MS);
+	while ((int32_t) (end - ticks) > 0) {
+		loops++;
+	}
+	Chip_SSP_Queue_Unschedule(&sspQueue, &sensorJob);
+	while (Chip_SSP_Queue_GetJobState(&sensorJob) != SSP_JOB_IDLE) {}
+
+	Chip_SSP_Queue_GetStats(&sspQueue, &stats, false);
+	DEBUGOUT("\r\nPeriodic 16 frame job every %d ms for %d ms: %d jobs, %d frames, "
+			 "%d errors, %d missed, %d CPU loops free\r\n", PERIOD_MS, RUN_MS,
+			 stats.jobs, stats.frames, stats.errors, stats.missed, loops);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle interrupt from SysTick timer, submits the periodic jobs
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
+{
+	ticks++;
+	Chip_SSP_Queue_Tick(&sspQueue);
+}
+
+/**
+ * @brief	DMA interrupt handler, completes the SSP jobs
+ * @return	Nothing
+ */
+void DMA_IRQHandler(void)
+{
+	Chip_GPDMA_ServiceIRQHandler(LPC_GPDMA);
+}
+
+/**
+ * @brief	Main routine for SSP DMA job queue example
+ * @return	Nothing
+ */
+int main(void)
+{
+	static const uint32_t sizes[] = {8, 64, 512, 4096};
+	uint32_t i;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+	Chip_RIT_Init(LPC_RITIMER);
+
+	for (i = 0; i < BENCH_FRAMES; i++) {
+		txBuff[i] = (uint8_t) (i ^ (i >> 8));
+	}
+
+	/* SSP in loop back mode, the frames sent come back as received frames */
+	Board_SSP_Init(LPC_SSP);
+	Chip_SSP_Init(LPC_SSP);
+	Chip_SSP_EnableLoopBack(LPC_SSP);
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_SetPriority(DMA_IRQn, 0);
+	NVIC_EnableIRQ(DMA_IRQn);
+	Chip_SSP_Queue_Init(&sspQueue, LPC_SSP, LPC_GPDMA);
+
+	NVIC_SetPriority(SysTick_IRQn, 1);
+	SysTick_Config(SystemCoreClock / TICKRATE_HZ);
+
+	DEBUGOUT("***** SSP QUEUE TEST, CPU at %d MHz, SPI at %d Hz *****\r\n",
+			 SystemCoreClock / 1000000, BENCH_BITRATE);
+	DEBUGSTR("METHOD   FRAMES      TICKS   BUS\r\n");
+	for (i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+		benchBlocking(sizes[i]);
+		benchQueue(sizes[i]);
+	}
+	benchPeriodic();
+
+	while (1) {
+		__WFI();
+	}
+}
@@ -0,0 +1,197 @@
+/*
+ * @brief UART DMA example with ring buffers
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include "board.h"
+#include <stdio.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Transmit and receive ring buffers, and their DMA context */
+STATIC RINGBUFF_T txring, rxring;
+STATIC UART_DMA_T uartdma;
+
+/* Transmit and receive ring buffer sizes, powers of 2 */
+#define UART_SRB_SIZE 256	/* Send */
+#define UART_RRB_SIZE 256	/* Receive */
+
+/* Transmit and receive buffers */
+static uint8_t rxbuff[UART_RRB_SIZE], txbuff[UART_SRB_SIZE];
+
+const char inst1[] = "LPC18xx/43xx UART example using DMA and ring buffers\r\n";
+const char inst2[] = "Data is echoed back, press ? for statistics or ESC to quit\r\n";
+
+#if (defined(BOARD_NGX_XPLORER_1830) || defined(BOARD_NGX_XPLORER_4330))
+/* Use UART0 for NGX boards */
+#define LPC_UARTX       LPC_USART0
+#define UARTx_IRQn      USART0_IRQn
+#define UARTx_IRQHandler UART0_IRQHandler
+#endif
+
+#if (defined(BOARD_NXP_LPCXPRESSO_4337) || defined(BOARD_NXP_LPCXPRESSO_1837))
+/* Use UART0 for LPC-Xpresso boards */
+#define LPC_UARTX       LPC_USART0
+#define UARTx_IRQn      USART0_IRQn
+#define UARTx_IRQHandler UART0_IRQHandler
+#endif
+
+#if (defined(BOARD_KEIL_MCB_1857) || defined(BOARD_KEIL_MCB_4357))
+/* Use UART3 for Keil boards */
+#define LPC_UARTX       LPC_USART3
+#define UARTx_IRQn      USART3_IRQn
+#define UARTx_IRQHandler UART3_IRQHandler
+#endif
+#if (defined(BOARD_HITEX_EVA_1850) || defined(BOARD_HITEX_EVA_4350))
+/* Use UART0 for Hitex boards */
+#define LPC_UARTX       LPC_USART0
+#define UARTx_IRQn      USART0_IRQn
+#define UARTx_IRQHandler UART0_IRQHandler
+#endif
+#if defined(BOARD_NXP_LPCLINK2_4370)
+#define LPC_UARTX       LPC_USART2
+#define UARTx_IRQn      USART2_IRQn
+#define UARTx_IRQHandler UART2_IRQHandler
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Send the statistics collected since the last call */
+static void send_stats(void)
+{
+	UART_DMA_STATS_T stats;
+	char str[160];
+	int len;
+
+	Chip_UART_DMA_GetStats(&uartdma, &stats, true);
+	len = sprintf(str, "\r\nrx %lu bytes in %lu blocks, tx %lu bytes in %lu blocks\r\n"
+				  "timeouts %lu, overruns %lu, stalls %lu, DMA errors %lu\r\n",
+				  (unsigned long) stats.rxBytes, (unsigned long) stats.rxBlocks,
+				  (unsigned long) stats.txBytes, (unsigned long) stats.txBlocks,
+				  (unsigned long) stats.idleEvents, (unsigned long) stats.rxOverruns,
+				  (unsigned long) stats.rxStalls, (unsigned long) stats.dmaErrors);
+	Chip_UART_DMA_Send(&uartdma, str, len);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	UART interrupt handler, commits the bytes received by DMA
+ * @return	Nothing
+ */
+void UARTx_IRQHandler(void)
+{
+	Chip_UART_DMA_IRQHandler(&uartdma);
+}
+
+/**
+ * @brief	DMA interrupt handler, completes the UART DMA transfers
+ * @return	Nothing
+ */
+void DMA_IRQHandler(void)
+{
+	Chip_GPDMA_ServiceIRQHandler(LPC_GPDMA);
+}
+
+/**
+ * @brief	Main UART program body
+ * @return	Always returns 1
+ */
+int main(void)
+{
+	uint8_t buf[32];
+	int i, bytes;
+	bool quit = false;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+	Board_UART_Init(LPC_UARTX);
+	Board_LED_Set(0, false);
+
+	/* Setup UART for 115.2K8N1 */
+	Chip_UART_Init(LPC_UARTX);
+	Chip_UART_SetBaud(LPC_UARTX, 115200);
+	Chip_UART_ConfigData(LPC_UARTX, (UART_LCR_WLEN8 | UART_LCR_SBS_1BIT));
+	Chip_UART_TXEnable(LPC_UARTX);
+
+	RingBuffer_Init(&rxring, rxbuff, 1, UART_RRB_SIZE);
+	RingBuffer_Init(&txring, txbuff, 1, UART_SRB_SIZE);
+
+	/* DMA completions are handled before the UART time-outs */
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_SetPriority(DMA_IRQn, 0);
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	/* Trigger level 3 (14 chars), received bytes are otherwise committed
+	   on the character time-out */
+	Chip_UART_DMA_Init(&uartdma, LPC_UARTX, LPC_GPDMA, &rxring, &txring, UART_FCR_TRG_LEV3);
+	NVIC_SetPriority(UARTx_IRQn, 1);
+	NVIC_EnableIRQ(UARTx_IRQn);
+
+	/* Send initial messages */
+	Chip_UART_DMA_Send(&uartdma, inst1, sizeof(inst1) - 1);
+	Chip_UART_DMA_Send(&uartdma, inst2, sizeof(inst2) - 1);
+
+	/* Echo what is received until the ESC (ASCII 27) key */
+	while (!quit) {
+		bytes = Chip_UART_DMA_Read(&uartdma, buf, sizeof(buf));
+		for (i = 0; i < bytes; i++) {
+			if (buf[i] == 27) {
+				quit = true;
+			}
+			else if (buf[i] == '?') {
+				send_stats();
+			}
+			else if (Chip_UART_DMA_Send(&uartdma, &buf[i], 1) != 1) {
+				Board_LED_Toggle(0);/* Toggle LED if the TX ring buffer is full */
+			}
+		}
+	}
+
+	/* Wait for the last bytes to be sent */
+	while (!RingBuffer_IsEmpty(&txring)) {}
+
+	/* DeInitialize UART peripheral */
+	NVIC_DisableIRQ(UARTx_IRQn);
+	Chip_UART_DMA_DeInit(&uartdma);
+	Chip_UART_DeInit(LPC_UARTX);
+
+	return 1;
+}
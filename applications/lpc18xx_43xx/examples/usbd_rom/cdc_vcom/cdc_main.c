@@ -149,6 +149,8 @@ int main(void)
 	usb_param.max_num_ep = 4;
 	usb_param.mem_base = USB_STACK_MEM_BASE;
 	usb_param.mem_size = USB_STACK_MEM_SIZE;
+	usb_param.USB_Reset_Event = vcom_usb_reset;
+	usb_param.USB_Configure_Event = vcom_usb_reset;
 
 	/* Set the USB descriptors */
 	desc.device_desc = (uint8_t *) USB_DeviceDescriptor;
@@ -203,7 +205,9 @@ int main(void)
 		}
 		/* If VCOM port is opened echo whatever we receive back to host. */
 		if (prompt) {
-			rdCnt = vcom_bread(&g_rxBuff[0], 256);
+			/* Only take what can be echoed, the rest stays queued (and the host
+			   NAKed) until the TX ring drains */
+			rdCnt = vcom_bread(&g_rxBuff[0], MIN(sizeof(g_rxBuff), RingBuffer_GetFree(&g_vCOM.tx_rb)));
 			if (rdCnt) {
 				vcom_write(&g_rxBuff[0], rdCnt);
 			}
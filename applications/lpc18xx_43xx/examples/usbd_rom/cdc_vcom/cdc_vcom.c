@@ -40,6 +40,11 @@
 /* Part of WORKAROUND for artf42016. */
 static USB_EP_HANDLER_T g_defaultCdcHdlr;
 
+/* Ring buffer storage, accessed directly by the USB DMA. The RX storage has
+   some slack past the ring end so a read request can cross the wrap point. */
+static uint8_t g_txRbData[VCOM_TX_RB_SZ] ALIGNED(4);
+static uint8_t g_rxRbData[VCOM_RX_RB_SZ + VCOM_RX_RB_SLACK] ALIGNED(4);
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -53,13 +58,94 @@ VCOM_DATA_T g_vCOM;
  * Private functions
  ****************************************************************************/
 
+/* Max packet size of the bulk endpoints for the current connection speed */
+static uint32_t VCOM_max_packet(VCOM_DATA_T *pVcom)
+{
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) pVcom->hUsb;
+
+	return (pCtrl->device_speed == USB_HIGH_SPEED) ? USB_HS_MAX_BULK_PACKET : USB_FS_MAX_BULK_PACKET;
+}
+
+/* Queue the linear segment at the TX ring tail on the IN endpoint. Must be
+   called with the USB interrupt disabled or from the USB interrupt. */
+static void VCOM_tx_start(VCOM_DATA_T *pVcom)
+{
+	void *pData;
+	uint32_t len;
+
+	if ((pVcom->tx_flags & VCOM_TX_BUSY) || !(pVcom->tx_flags & VCOM_TX_CONNECTED)) {
+		return;
+	}
+
+	/* The controller DMAs straight out of the ring, up to the wrap point */
+	len = RingBuffer_GetReadRegion(&pVcom->tx_rb, &pData);
+	if (len == 0) {
+		return;
+	}
+	len = MIN(len, VCOM_MAX_XFER_SZ);
+
+	pVcom->tx_flags |= VCOM_TX_BUSY;
+	pVcom->tx_xfer_len = len;
+	USBD_API->hw->WriteEP(pVcom->hUsb, USB_CDC_IN_EP, (uint8_t *) pData, len);
+}
+
+/* Queue the free space at the RX ring head on the OUT endpoint. Must be
+   called with the USB interrupt disabled or from the USB interrupt. */
+static void VCOM_rx_start(VCOM_DATA_T *pVcom)
+{
+	RINGBUFF_T *pRb = &pVcom->rx_rb;
+	uint32_t maxp = VCOM_max_packet(pVcom);
+	uint32_t idx = pRb->head & (pRb->count - 1);
+	uint32_t len = RingBuffer_GetFree(pRb);
+
+	if (pVcom->rx_flags & VCOM_RX_QUEUED) {
+		return;
+	}
+
+	/* Requests must be a multiple of the packet size so the host can never
+	   overrun them. Data landing in the slack area is moved to the ring start
+	   on completion. */
+	len = MIN(len, (pRb->count - idx) + VCOM_RX_RB_SLACK);
+	len = MIN(len, VCOM_MAX_XFER_SZ);
+	len &= ~(maxp - 1);
+
+	if (len == 0) {
+		/* Leave the endpoint unarmed, the host is NAKed until data is read */
+		if ((pVcom->rx_flags & VCOM_RX_THROTTLED) == 0) {
+			pVcom->rx_flags |= VCOM_RX_THROTTLED;
+			pVcom->rx_throttle_cnt++;
+		}
+		return;
+	}
+
+	pVcom->rx_flags = VCOM_RX_QUEUED;
+	USBD_API->hw->ReadReqEP(pVcom->hUsb, USB_CDC_OUT_EP, (uint8_t *) pRb->data + idx, len);
+}
+
 /* VCOM bulk EP_IN endpoint handler */
 static ErrorCode_t VCOM_bulk_in_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
 	VCOM_DATA_T *pVcom = (VCOM_DATA_T *) data;
 
 	if (event == USB_EVT_IN) {
+		if (pVcom->tx_flags & VCOM_TX_ZLP) {
+			pVcom->tx_flags &= ~VCOM_TX_ZLP;
+		}
+		else {
+			RingBuffer_ReleaseRead(&pVcom->tx_rb, pVcom->tx_xfer_len);
+
+			/* Terminate a burst ending on a packet boundary so the host read completes */
+			if (RingBuffer_IsEmpty(&pVcom->tx_rb) && (pVcom->tx_xfer_len != 0) &&
+				((pVcom->tx_xfer_len & (VCOM_max_packet(pVcom) - 1)) == 0)) {
+				pVcom->tx_flags |= VCOM_TX_ZLP;
+				pVcom->tx_xfer_len = 0;
+				USBD_API->hw->WriteEP(hUsb, USB_CDC_IN_EP, (uint8_t *) pVcom->tx_rb.data, 0);
+				return LPC_OK;
+			}
+		}
+		pVcom->tx_xfer_len = 0;
 		pVcom->tx_flags &= ~VCOM_TX_BUSY;
+		VCOM_tx_start(pVcom);
 	}
 	return LPC_OK;
 }
@@ -68,29 +154,26 @@ static ErrorCode_t VCOM_bulk_in_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t ev
 static ErrorCode_t VCOM_bulk_out_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
 	VCOM_DATA_T *pVcom = (VCOM_DATA_T *) data;
+	RINGBUFF_T *pRb = &pVcom->rx_rb;
+	uint32_t idx, cnt;
 
 	switch (event) {
 	case USB_EVT_OUT:
-		pVcom->rx_count = USBD_API->hw->ReadEP(hUsb, USB_CDC_OUT_EP, pVcom->rx_buff);
-		if (pVcom->rx_flags & VCOM_RX_BUF_QUEUED) {
-			pVcom->rx_flags &= ~VCOM_RX_BUF_QUEUED;
-			if (pVcom->rx_count != 0) {
-				pVcom->rx_flags |= VCOM_RX_BUF_FULL;
-			}
+		idx = pRb->head & (pRb->count - 1);
+		cnt = USBD_API->hw->ReadEP(hUsb, USB_CDC_OUT_EP, (uint8_t *) pRb->data + idx);
 
+		/* Move any data received past the ring end to the ring start */
+		if ((idx + cnt) > (uint32_t) pRb->count) {
+			memcpy(pRb->data, (uint8_t *) pRb->data + pRb->count, (idx + cnt) - pRb->count);
 		}
-		else if (pVcom->rx_flags & VCOM_RX_DB_QUEUED) {
-			pVcom->rx_flags &= ~VCOM_RX_DB_QUEUED;
-			pVcom->rx_flags |= VCOM_RX_DONE;
-		}
+		RingBuffer_CommitWrite(pRb, cnt);
+		pVcom->rx_flags &= ~VCOM_RX_QUEUED;
+		VCOM_rx_start(pVcom);
 		break;
 
 	case USB_EVT_OUT_NAK:
-		/* queue free buffer for RX */
-		if ((pVcom->rx_flags & (VCOM_RX_BUF_FULL | VCOM_RX_BUF_QUEUED)) == 0) {
-			USBD_API->hw->ReadReqEP(hUsb, USB_CDC_OUT_EP, pVcom->rx_buff, VCOM_RX_BUF_SZ);
-			pVcom->rx_flags |= VCOM_RX_BUF_QUEUED;
-		}
+		/* queue free ring space for RX */
+		VCOM_rx_start(pVcom);
 		break;
 
 	default:
@@ -105,8 +188,9 @@ static ErrorCode_t VCOM_SetLineCode(USBD_HANDLE_T hCDC, CDC_LINE_CODING *line_co
 {
 	VCOM_DATA_T *pVcom = &g_vCOM;
 
-	/* Called when baud rate is changed/set. Using it to know host connection state */
-	pVcom->tx_flags = VCOM_TX_CONNECTED;	/* reset other flags */
+	/* Called when baud rate is changed/set. Using it to know host connection state.
+	   Busy state is kept as the controller may still own part of the TX ring. */
+	pVcom->tx_flags |= VCOM_TX_CONNECTED;
 
 	return LPC_OK;
 }
@@ -163,6 +247,24 @@ static ErrorCode_t CDC_ep0_override_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_
  * Public functions
  ****************************************************************************/
 
+/* USB reset and configure event handler */
+ErrorCode_t vcom_usb_reset(USBD_HANDLE_T hUsb)
+{
+	VCOM_DATA_T *pVcom = &g_vCOM;
+
+	/* The transfers queued before are gone, wait for the host to connect again.
+	   The TX data is dropped here as the interrupt is its consumer, the RX data
+	   by the next vcom_bread() as the application is. */
+	pVcom->tx_flags = 0;
+	pVcom->tx_xfer_len = 0;
+	RingBuffer_ReleaseRead(&pVcom->tx_rb, RingBuffer_GetCount(&pVcom->tx_rb));
+
+	pVcom->rx_flags = 0;
+	pVcom->rx_drop_head = RB_VHEAD(&pVcom->rx_rb);
+
+	return LPC_OK;
+}
+
 /* Virtual com port init routine */
 ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT_PARAM_T *pUsbParam)
 {
@@ -195,13 +297,9 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	/* store the default CDC handler and replace it with ours */
 	pCtrl->ep0_hdlr_cb[pCtrl->num_ep0_hdlrs - 1] = CDC_ep0_override_hdlr;
 
-	/* allocate transfer buffers */
-	if (cdc_param.mem_size < VCOM_RX_BUF_SZ) {
-		return ERR_FAILED;
-	}
-	g_vCOM.rx_buff = (uint8_t *) cdc_param.mem_base;
-	cdc_param.mem_base += VCOM_RX_BUF_SZ;
-	cdc_param.mem_size -= VCOM_RX_BUF_SZ;
+	/* setup transfer rings */
+	RingBuffer_Init(&g_vCOM.tx_rb, g_txRbData, 1, VCOM_TX_RB_SZ);
+	RingBuffer_Init(&g_vCOM.rx_rb, g_rxRbData, 1, VCOM_RX_RB_SZ);
 
 	/* register endpoint interrupt handler */
 	ep_indx = (((USB_CDC_IN_EP & 0x0F) << 1) + 1);
@@ -228,71 +326,40 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 uint32_t vcom_bread(uint8_t *pBuf, uint32_t buf_len)
 {
 	VCOM_DATA_T *pVcom = &g_vCOM;
-	uint16_t cnt = 0;
-	/* read from the default buffer if any data present */
-	if (pVcom->rx_count) {
-		cnt = (pVcom->rx_count < buf_len) ? pVcom->rx_count : buf_len;
-		memcpy(pBuf, pVcom->rx_buff, cnt);
-		pVcom->rx_rd_count += cnt;
+	uint32_t cnt;
 
+	/* Drop the data received before a USB reset */
+	cnt = pVcom->rx_drop_head - RB_VTAIL(&pVcom->rx_rb);
+	if ((int32_t) cnt > 0) {
+		RingBuffer_ReleaseRead(&pVcom->rx_rb, cnt);
+	}
+
+	/* Single consumer, the USB interrupt only ever moves the head */
+	cnt = RingBuffer_PopMult(&pVcom->rx_rb, pBuf, buf_len);
+
+	if (cnt && (pVcom->rx_flags & VCOM_RX_THROTTLED)) {
 		/* enter critical section */
 		NVIC_DisableIRQ(LPC_USB_IRQ);
-		if (pVcom->rx_rd_count >= pVcom->rx_count) {
-			pVcom->rx_flags &= ~VCOM_RX_BUF_FULL;
-			pVcom->rx_rd_count = pVcom->rx_count = 0;
-		}
+		VCOM_rx_start(pVcom);
 		/* exit critical section */
 		NVIC_EnableIRQ(LPC_USB_IRQ);
 	}
 	return cnt;
 }
 
-/* Virtual com port read routine */
-ErrorCode_t vcom_read_req(uint8_t *pBuf, uint32_t len)
-{
-	VCOM_DATA_T *pVcom = &g_vCOM;
-
-	/* check if we queued Rx buffer */
-	if (pVcom->rx_flags & (VCOM_RX_BUF_QUEUED | VCOM_RX_DB_QUEUED)) {
-		return ERR_BUSY;
-	}
-	/* enter critical section */
-	NVIC_DisableIRQ(LPC_USB_IRQ);
-	/* if not queue the request and return 0 bytes */
-	USBD_API->hw->ReadReqEP(pVcom->hUsb, USB_CDC_OUT_EP, pBuf, len);
-	/* exit critical section */
-	NVIC_EnableIRQ(LPC_USB_IRQ);
-	pVcom->rx_flags |= VCOM_RX_DB_QUEUED;
-
-	return LPC_OK;
-}
-
-/* Gets current read count. */
-uint32_t vcom_read_cnt(void)
-{
-	VCOM_DATA_T *pVcom = &g_vCOM;
-	uint32_t ret = 0;
-
-	if (pVcom->rx_flags & VCOM_RX_DONE) {
-		ret = pVcom->rx_count;
-		pVcom->rx_count = 0;
-	}
-
-	return ret;
-}
-
 /* Virtual com port write routine*/
 uint32_t vcom_write(uint8_t *pBuf, uint32_t len)
 {
 	VCOM_DATA_T *pVcom = &g_vCOM;
 	uint32_t ret = 0;
 
-	if ( (pVcom->tx_flags & VCOM_TX_CONNECTED) && ((pVcom->tx_flags & VCOM_TX_BUSY) == 0) ) {
-		pVcom->tx_flags |= VCOM_TX_BUSY;
+	if (pVcom->tx_flags & VCOM_TX_CONNECTED) {
+		/* Single producer, the USB interrupt only ever moves the tail */
+		ret = RingBuffer_InsertMult(&pVcom->tx_rb, pBuf, len);
 
 		/* enter critical section */
 		NVIC_DisableIRQ(LPC_USB_IRQ);
-		ret = USBD_API->hw->WriteEP(pVcom->hUsb, USB_CDC_IN_EP, pBuf, len);
+		VCOM_tx_start(pVcom);
 		/* exit critical section */
 		NVIC_EnableIRQ(LPC_USB_IRQ);
 	}
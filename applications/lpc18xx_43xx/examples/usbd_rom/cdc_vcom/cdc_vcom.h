@@ -33,6 +33,7 @@
 #define __CDC_VCOM_H_
 
 #include "app_usbd_cfg.h"
+#include "ring_buffer.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -43,13 +44,15 @@ extern "C"
  * @{
  */
 
-#define VCOM_RX_BUF_SZ      512
+#define VCOM_TX_RB_SZ       4096		/* TX ring size in bytes, must be a power of 2 */
+#define VCOM_RX_RB_SZ       4096		/* RX ring size in bytes, must be a power of 2 */
+#define VCOM_RX_RB_SLACK    USB_HS_MAX_BULK_PACKET	/* RX area past the ring end for requests crossing the wrap point */
+#define VCOM_MAX_XFER_SZ    (16 * 1024)	/* Largest transfer queued on a single dTD */
 #define VCOM_TX_CONNECTED   _BIT(8)		/* connection state is for both RX/Tx */
 #define VCOM_TX_BUSY        _BIT(0)
-#define VCOM_RX_DONE        _BIT(0)
-#define VCOM_RX_BUF_FULL    _BIT(1)
-#define VCOM_RX_BUF_QUEUED  _BIT(2)
-#define VCOM_RX_DB_QUEUED   _BIT(3)
+#define VCOM_TX_ZLP         _BIT(1)
+#define VCOM_RX_QUEUED      _BIT(0)
+#define VCOM_RX_THROTTLED   _BIT(1)
 
 /**
  * Structure containing Virtual Comm port control data
@@ -57,9 +60,11 @@ extern "C"
 typedef struct VCOM_DATA {
 	USBD_HANDLE_T hUsb;
 	USBD_HANDLE_T hCdc;
-	uint8_t *rx_buff;
-	uint16_t rx_rd_count;
-	uint16_t rx_count;
+	RINGBUFF_T tx_rb;			/* Data waiting to be sent to the host */
+	RINGBUFF_T rx_rb;			/* Data received from the host */
+	uint32_t tx_xfer_len;		/* Size of the transfer queued on the IN endpoint */
+	uint32_t rx_throttle_cnt;	/* Number of times the host was NAKed for lack of RX space */
+	volatile uint32_t rx_drop_head;	/* RX ring head at the last USB reset, older data is dropped */
 	volatile uint16_t tx_flags;
 	volatile uint16_t rx_flags;
 } VCOM_DATA_T;
@@ -79,26 +84,26 @@ extern VCOM_DATA_T g_vCOM;
 ErrorCode_t vcom_init (USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT_PARAM_T *pUsbParam);
 
 /**
- * @brief	Virtual com port buffered read routine
- * @param	pBuf	: Pointer to buffer where read data should be copied
- * @param	buf_len	: Length of the buffer passed
- * @return	Return number of bytes read.
+ * @brief	USB reset and configure event handler
+ * @param	hUsb	: Handle to USBD stack instance
+ * @return	Always returns LPC_OK.
+ * @note	Set as USB_Reset_Event and USB_Configure_Event of the USBD init
+ * parameters. The port is disconnected until the host sets the line coding
+ * again, the data not yet sent is dropped and so is the data received, on
+ * the next vcom_bread().
  */
-uint32_t vcom_bread (uint8_t *pBuf, uint32_t buf_len);
+ErrorCode_t vcom_usb_reset(USBD_HANDLE_T hUsb);
 
 /**
- * @brief	Virtual com port read routine
+ * @brief	Virtual com port buffered read routine
  * @param	pBuf	: Pointer to buffer where read data should be copied
  * @param	buf_len	: Length of the buffer passed
- * @return	Always returns LPC_OK.
- */
-ErrorCode_t vcom_read_req (uint8_t *pBuf, uint32_t buf_len);
-
-/**
- * @brief	Gets current read count.
- * @return	Returns current read count.
+ * @return	Return number of bytes read.
+ * @note	Data is DMA'd by the USB controller straight into the RX ring.
+ * While the ring has less than one packet of free space the host is NAKed,
+ * reading data from the ring re-arms the OUT endpoint.
  */
-uint32_t vcom_read_cnt(void);
+uint32_t vcom_bread (uint8_t *pBuf, uint32_t buf_len);
 
 /**
  * @brief	Check if Vcom is connected
@@ -112,7 +117,10 @@ static INLINE uint32_t vcom_connected(void) {
  * @brief	Virtual com port write routine
  * @param	pBuf	: Pointer to buffer to be written
  * @param	buf_len	: Length of the buffer passed
- * @return	Number of bytes written
+ * @return	Number of bytes queued, less than @a buf_len when the TX ring is full
+ * @note	Data is copied into the TX ring and sent from there as multi-packet
+ * transfers covering the largest linear segment of the ring. A zero length
+ * packet terminates a burst ending on a packet boundary.
  */
 uint32_t vcom_write (uint8_t *pBuf, uint32_t buf_len);
 
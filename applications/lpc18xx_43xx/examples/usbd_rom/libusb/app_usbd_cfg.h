@@ -79,6 +79,13 @@ extern "C"
 #define LUSB_OUT_EP                     0x01
 #define LUSB_INT_EP                     0x82
 
+/* Number of read and send requests that can be outstanding on the bulk
+   endpoints, must be a power of 2. When a request completes the next queued
+   one is handed to the controller from the endpoint interrupt, so keeping
+   more than one request queued avoids gaps between transfers. */
+#define LUSB_RX_QUEUE_LEN               4
+#define LUSB_TX_QUEUE_LEN               4
+
 /* On LPC18xx/43xx the USB controller requires endpoint queue heads to start on
    a 4KB aligned memory. Hence the mem_base value passed to USB stack init should
    be 4KB aligned. The following manifest constants are used to define this memory.
@@ -44,15 +44,28 @@
 static uint32_t g_ep0RxBusy = 0;/* flag indicating whether EP0 OUT/RX buffer is busy. */
 static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base EP0 handler */
 
+/**
+ * Queued bulk transfer request
+ */
+typedef struct _LUSB_REQ_ {
+	uint8_t *pBuf;
+	uint32_t len;
+	LUSB_XFER_CB_T cb;
+	void *cbData;
+} LUSB_REQ_T;
+
 /**
  * Structure containing Virtual Comm port control data
  */
 typedef struct _LUSB_CTRL_ {
 	USBD_HANDLE_T hUsb;
-	uint8_t *pRxBuf;
-	uint32_t rxBuffLen;
-	uint8_t *pTxBuf;
-	uint32_t txBuffLen;
+	LUSB_REQ_T rxQ[LUSB_RX_QUEUE_LEN];
+	uint32_t rxHead;		/* Free running index of the request on the OUT endpoint */
+	uint32_t rxTail;		/* Free running index of the next free request */
+	int32_t rxBuffLen;		/* Length received by the last completed read */
+	LUSB_REQ_T txQ[LUSB_TX_QUEUE_LEN];
+	uint32_t txHead;		/* Free running index of the request on the IN endpoint */
+	uint32_t txTail;		/* Free running index of the next free request */
 	uint32_t newStatus;
 	uint32_t curStatus;
 	volatile uint8_t connected;
@@ -83,10 +96,21 @@ ErrorCode_t lusb_ResetEvent(USBD_HANDLE_T hUsb)
 ErrorCode_t lusb_BulkIN_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) data;
+	LUSB_REQ_T *pReq;
 
-	if (event == USB_EVT_IN) {
-		pUSB->txBuffLen = 0;
-		pUSB->pTxBuf = 0;
+	if ((event == USB_EVT_IN) && (pUSB->txHead != pUSB->txTail)) {
+		pReq = &pUSB->txQ[pUSB->txHead & (LUSB_TX_QUEUE_LEN - 1)];
+		pUSB->txHead++;
+
+		/* Hand the next request to the controller before running the callback */
+		if (pUSB->txHead != pUSB->txTail) {
+			LUSB_REQ_T *pNext = &pUSB->txQ[pUSB->txHead & (LUSB_TX_QUEUE_LEN - 1)];
+			USBD_API->hw->WriteEP(hUsb, LUSB_IN_EP, pNext->pBuf, pNext->len);
+		}
+
+		if (pReq->cb) {
+			pReq->cb(pReq->cbData, pReq->pBuf, pReq->len);
+		}
 	}
 	return LPC_OK;
 }
@@ -116,11 +140,25 @@ ErrorCode_t lusb_IntrIN_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 ErrorCode_t lusb_BulkOUT_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) data;
+	LUSB_REQ_T *pReq;
+	uint32_t len;
 
 	/* We received a transfer from the USB host. */
-	if (event == USB_EVT_OUT) {
-		pUSB->rxBuffLen = USBD_API->hw->ReadEP(hUsb, LUSB_OUT_EP, pUSB->pRxBuf);
-		pUSB->pRxBuf = 0;
+	if ((event == USB_EVT_OUT) && (pUSB->rxHead != pUSB->rxTail)) {
+		pReq = &pUSB->rxQ[pUSB->rxHead & (LUSB_RX_QUEUE_LEN - 1)];
+		len = USBD_API->hw->ReadEP(hUsb, LUSB_OUT_EP, pReq->pBuf);
+		pUSB->rxHead++;
+
+		/* Hand the next request to the controller before running the callback */
+		if (pUSB->rxHead != pUSB->rxTail) {
+			LUSB_REQ_T *pNext = &pUSB->rxQ[pUSB->rxHead & (LUSB_RX_QUEUE_LEN - 1)];
+			USBD_API->hw->ReadReqEP(hUsb, LUSB_OUT_EP, pNext->pBuf, pNext->len);
+		}
+		pUSB->rxBuffLen = len;
+
+		if (pReq->cb) {
+			pReq->cb(pReq->cbData, pReq->pBuf, len);
+		}
 	}
 
 	return LPC_OK;
@@ -314,42 +352,73 @@ bool libusbdev_Connected(void)
 	return USB_IsConfigured(g_lusb.hUsb);
 }
 
-/* Queue the read buffer to USB DMA */
-ErrorCode_t libusbdev_QueueReadReq(uint8_t *pBuf, uint32_t buf_len)
+/* Queue the read buffer to USB DMA with a completion callback */
+ErrorCode_t libusbdev_QueueReadReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_XFER_CB_T cb, void *cbData)
 {
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
+	LUSB_REQ_T *pReq;
 	ErrorCode_t ret = ERR_FAILED;
 
-	/* Check if a read request is pending */
-	if (pUSB->pRxBuf == 0) {
-		/* Queue the read request */
-		pUSB->pRxBuf = pBuf;
-		pUSB->rxBuffLen = buf_len;
-		USBD_API->hw->ReadReqEP(pUSB->hUsb, LUSB_OUT_EP, pBuf, buf_len);
+	/* enter critical section */
+	NVIC_DisableIRQ(LPC_USB_IRQ);
+
+	/* Check if there is room for another read request */
+	if ((pUSB->rxTail - pUSB->rxHead) < LUSB_RX_QUEUE_LEN) {
+		pReq = &pUSB->rxQ[pUSB->rxTail & (LUSB_RX_QUEUE_LEN - 1)];
+		pReq->pBuf = pBuf;
+		pReq->len = buf_len;
+		pReq->cb = cb;
+		pReq->cbData = cbData;
+
+		/* Start the transfer now if the endpoint is idle, else the endpoint
+		   handler starts it when the requests queued before it complete */
+		if (pUSB->rxTail++ == pUSB->rxHead) {
+			USBD_API->hw->ReadReqEP(pUSB->hUsb, LUSB_OUT_EP, pBuf, buf_len);
+		}
 		ret = LPC_OK;
 	}
 
+	/* exit critical section */
+	NVIC_EnableIRQ(LPC_USB_IRQ);
+
 	return ret;
 }
 
+/* Queue the read buffer to USB DMA */
+ErrorCode_t libusbdev_QueueReadReq(uint8_t *pBuf, uint32_t buf_len)
+{
+	return libusbdev_QueueReadReqCb(pBuf, buf_len, NULL, NULL);
+}
+
 /* Check if queued read buffer got any data */
 int32_t libusbdev_QueueReadDone(void)
 {
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
 
 	/* A read request is pending */
-	if (pUSB->pRxBuf) {
+	if (pUSB->rxHead != pUSB->rxTail) {
 		return -1;
 	}
 	/* if data received return the length */
 	return pUSB->rxBuffLen;
 }
 
+/* Number of read requests not yet completed */
+uint32_t libusbdev_QueueReadPending(void)
+{
+	return g_lusb.rxTail - g_lusb.rxHead;
+}
+
 /* A blocking read call */
 int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len)
 {
 	int32_t ret = -1;
 
+	/* Only read when no other request is queued, so the data lands in pBuf */
+	if (libusbdev_QueueReadPending() != 0) {
+		return ret;
+	}
+
 	/* Queue read request  */
 	if (libusbdev_QueueReadReq(pBuf, buf_len) == LPC_OK) {
 		/* wait for Rx to complete */
@@ -362,32 +431,60 @@ int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len)
 	return ret;
 }
 
-/* Queue the given buffer for transmision to USB host application. */
-ErrorCode_t libusbdev_QueueSendReq(uint8_t *pBuf, uint32_t buf_len)
+/* Queue the given buffer for transmision with a completion callback */
+ErrorCode_t libusbdev_QueueSendReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_XFER_CB_T cb, void *cbData)
 {
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
+	LUSB_REQ_T *pReq;
 	ErrorCode_t ret = ERR_FAILED;
 
-	/* Check if a read request is pending */
-	if (pUSB->pTxBuf == 0) {
-		/* Queue the read request */
-		pUSB->pTxBuf = pBuf;
-		pUSB->txBuffLen = buf_len;
+	/* enter critical section */
+	NVIC_DisableIRQ(LPC_USB_IRQ);
 
-		USBD_API->hw->WriteEP(pUSB->hUsb, LUSB_IN_EP, pBuf, buf_len);
+	/* Check if there is room for another send request */
+	if ((pUSB->txTail - pUSB->txHead) < LUSB_TX_QUEUE_LEN) {
+		pReq = &pUSB->txQ[pUSB->txTail & (LUSB_TX_QUEUE_LEN - 1)];
+		pReq->pBuf = pBuf;
+		pReq->len = buf_len;
+		pReq->cb = cb;
+		pReq->cbData = cbData;
+
+		/* Start the transfer now if the endpoint is idle, else the endpoint
+		   handler starts it when the requests queued before it complete */
+		if (pUSB->txTail++ == pUSB->txHead) {
+			USBD_API->hw->WriteEP(pUSB->hUsb, LUSB_IN_EP, pBuf, buf_len);
+		}
 		ret = LPC_OK;
 	}
 
+	/* exit critical section */
+	NVIC_EnableIRQ(LPC_USB_IRQ);
+
 	return ret;
 }
 
+/* Queue the given buffer for transmision to USB host application. */
+ErrorCode_t libusbdev_QueueSendReq(uint8_t *pBuf, uint32_t buf_len)
+{
+	return libusbdev_QueueSendReqCb(pBuf, buf_len, NULL, NULL);
+}
+
 /* Check if queued send is done. */
 int32_t libusbdev_QueueSendDone(void)
 {
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
 
-	/* return remaining length */
-	return pUSB->txBuffLen;
+	/* return remaining length of the request on the endpoint */
+	if (pUSB->txHead == pUSB->txTail) {
+		return 0;
+	}
+	return pUSB->txQ[pUSB->txHead & (LUSB_TX_QUEUE_LEN - 1)].len;
+}
+
+/* Number of send requests not yet completed */
+uint32_t libusbdev_QueueSendPending(void)
+{
+	return g_lusb.txTail - g_lusb.txHead;
 }
 
 /* Send the given buffer to USB host application */
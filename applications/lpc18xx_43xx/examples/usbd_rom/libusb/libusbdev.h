@@ -44,6 +44,17 @@ extern "C"
  * @{
  */
 
+/**
+ * @brief	Bulk transfer completion callback
+ * @param	cbData	: Data pointer passed when the request was queued
+ * @param	pBuf	: Buffer of the completed request
+ * @param	len		: Number of bytes received for a read, length of the request for a send
+ * @return	Nothing
+ * @note	Called from the USB interrupt. The next queued request has already
+ *			been handed to the controller, and the callback may queue new requests.
+ */
+typedef void (*LUSB_XFER_CB_T)(void *cbData, uint8_t *pBuf, uint32_t len);
+
 /**
  * @brief	Initialize USB interface.
  * @param	mem_base	: Pointer to memory address which can be used by libusbdev driver
@@ -68,17 +79,37 @@ extern ErrorCode_t libusbdev_QueueReadReq(uint8_t *pBuf, uint32_t buf_len);
 
 /**
  * @brief	Check if queued read buffer got any data
- * @return	Returns length of data received. Returns -1 if read is still pending.
+ * @return	Returns length of data received by the last completed read.
+ *			Returns -1 if a read is still pending.
  * @note	Since on USB, zero length packets are transferred -1 is used for
  *			Rx pending indication.
  */
 extern int32_t libusbdev_QueueReadDone (void);
 
+/**
+ * @brief	Queue the read buffer to USB DMA with a completion callback
+ * @param	pBuf	: Pointer to buffer where read data should be copied
+ * @param	buf_len	: Length of the buffer passed
+ * @param	cb		: Function called when the read completes, or NULL
+ * @param	cbData	: Data pointer passed to cb
+ * @return	Returns LPC_OK on success, ERR_FAILED when LUSB_RX_QUEUE_LEN
+ *			reads are already outstanding.
+ * @note	Requests complete in the order they were queued. Queued requests
+ *			are dropped without callback on USB bus reset.
+ */
+extern ErrorCode_t libusbdev_QueueReadReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_XFER_CB_T cb, void *cbData);
+
+/**
+ * @brief	Get the number of outstanding read requests
+ * @return	Number of queued read requests not yet completed.
+ */
+extern uint32_t libusbdev_QueueReadPending(void);
+
 /**
  * @brief	A blocking read call
  * @param	pBuf	: Pointer to buffer where read data should be copied
  * @param	buf_len	: Length of the buffer passed
- * @return	Return number of bytes read. Returns -1 if previous read is pending.
+ * @return	Return number of bytes read. Returns -1 if a previous read is pending.
  */
 extern int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len);
 
@@ -92,11 +123,30 @@ extern ErrorCode_t libusbdev_QueueSendReq(uint8_t *pBuf, uint32_t buf_len);
 
 /**
  * @brief	Check if queued send is done.
- * @return	Returns length of remaining data to be sent.
- *			0 indicates transfer done.
+ * @return	Returns length of the send request in progress.
+ *			0 indicates all queued transfers are done.
  */
 extern int32_t libusbdev_QueueSendDone (void);
 
+/**
+ * @brief	Queue the given buffer for transmission with a completion callback
+ * @param	pBuf	: Pointer to buffer to be written
+ * @param	buf_len	: Length of the buffer passed
+ * @param	cb		: Function called when the send completes, or NULL
+ * @param	cbData	: Data pointer passed to cb
+ * @return	Returns LPC_OK on success, ERR_FAILED when LUSB_TX_QUEUE_LEN
+ *			sends are already outstanding.
+ * @note	Requests complete in the order they were queued. Queued requests
+ *			are dropped without callback on USB bus reset.
+ */
+extern ErrorCode_t libusbdev_QueueSendReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_XFER_CB_T cb, void *cbData);
+
+/**
+ * @brief	Get the number of outstanding send requests
+ * @return	Number of queued send requests not yet completed.
+ */
+extern uint32_t libusbdev_QueueSendPending(void);
+
 /**
  * @brief	Send the given buffer to USB host application.
  * @param	pBuf	: Pointer to buffer to be written
@@ -33,6 +33,7 @@
 #include "board.h"
 #include <stdio.h>
 #include <string.h>
+#include "app_usbd_cfg.h"
 #include "libusbdev.h"
 
 /*****************************************************************************
@@ -45,8 +46,8 @@
 /* Application defined LUSB interrupt status  */
 #define LUSB_DATA_PENDING       _BIT(0)
 
-/* Packet buffer for processing */
-static uint8_t g_rxBuff[PACKET_BUFFER_SIZE];
+/* Packet buffers for processing, one per outstanding read request */
+static uint8_t g_rxBuff[LUSB_RX_QUEUE_LEN][PACKET_BUFFER_SIZE];
 
 /*****************************************************************************
  * Public types/enumerations/variables
@@ -56,6 +57,14 @@ static uint8_t g_rxBuff[PACKET_BUFFER_SIZE];
  * Private functions
  ****************************************************************************/
 
+/* Read completion callback, called from the USB interrupt */
+static void rx_done(void *cbData, uint8_t *pBuf, uint32_t len)
+{
+	/* Dummy process read data ......*/
+	/* requeue read request behind the ones still outstanding */
+	libusbdev_QueueReadReqCb(pBuf, PACKET_BUFFER_SIZE, rx_done, cbData);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -66,6 +75,8 @@ static uint8_t g_rxBuff[PACKET_BUFFER_SIZE];
  */
 int main(void)
 {
+	uint32_t i;
+
 	/* Initialize board and chip */
 	SystemCoreClockUpdate();
 	Board_Init();
@@ -80,19 +91,19 @@ int main(void)
 			__WFI();
 		}
 
-		while (libusbdev_Connected()) {
-
-			if (libusbdev_QueueReadDone() != -1) {
-
-				/* Dummy process read data ......*/
-				/* requeue read request */
-				libusbdev_QueueReadReq(g_rxBuff, PACKET_BUFFER_SIZE);
+		/* queue every packet buffer for reception, the callback requeues them */
+		if (libusbdev_QueueReadPending() == 0) {
+			for (i = 0; i < LUSB_RX_QUEUE_LEN; i++) {
+				libusbdev_QueueReadReqCb(g_rxBuff[i], PACKET_BUFFER_SIZE, rx_done, NULL);
 			}
+		}
 
-			if (libusbdev_QueueSendDone() == 0) {
-				/* Queue send request */
-				libusbdev_QueueSendReq(g_rxBuff, PACKET_BUFFER_SIZE);
-			}
+		while (libusbdev_Connected()) {
+			/* keep the send queue full so the IN endpoint never idles */
+			while (libusbdev_QueueSendReq(g_rxBuff[0], PACKET_BUFFER_SIZE) == LPC_OK) {}
+
+			/* Sleep until next IRQ happens */
+			__WFI();
 		}
 	}
 }
@@ -37,6 +37,7 @@
  *  The following files must be built with any user project that uses this module:
  *    - LPCUSBlib/Drivers/USB/Class/Device/Audio.c <i>(Makefile source module name: LPCUSBLIB_SRC_USBCLASS)</i>
  *    - LPCUSBlib/Drivers/USB/Class/Host/Audio.c <i>(Makefile source module name: LPCUSBLIB_SRC_USBCLASS)</i>
+ *    - LPCUSBlib/Drivers/USB/Class/Device/AudioStreamDevice.c <i>(LPC18xx/43xx only, Makefile source module name: LPCUSBLIB_SRC_USBCLASS)</i>
  *
  *  @section Sec_ModDescription Module Description
  *  Audio 1.0 Class Driver module. This module contains an internal implementation of the USB Audio 1.0 Class, for both
@@ -61,6 +62,10 @@
 
 		#if defined(USB_CAN_BE_DEVICE)
 			#include "Device/AudioClassDevice.h"
+
+			#if defined(__LPC18XX__) || defined(__LPC43XX__)
+				#include "Device/AudioStreamDevice.h"
+			#endif
 		#endif
 
 		#if defined(USB_CAN_BE_HOST)
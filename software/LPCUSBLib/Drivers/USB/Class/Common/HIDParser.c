@@ -363,3 +363,98 @@ uint16_t USB_GetHIDReportSize(HID_ReportInfo_t* const ParserData,
 
 	return 0;
 }
+
+uint8_t USB_CompileHIDReport(HID_ReportInfo_t* const ParserData,
+                             const uint8_t ReportID,
+                             const uint8_t ReportType,
+                             HID_CompiledReport_t* const Compiled)
+{
+	uint8_t IDPrefixBytes = (ReportID ? 1 : 0);
+
+	memset(Compiled, 0x00, sizeof(HID_CompiledReport_t));
+
+	Compiled->ReportID   = ReportID;
+	Compiled->ReportType = ReportType;
+	Compiled->ReportSize = USB_GetHIDReportSize(ParserData, ReportID, ReportType) + IDPrefixBytes;
+
+	for (uint8_t i = 0; i < ParserData->TotalReportItems; i++)
+	{
+		HID_ReportItem_t*    ReportItem = &ParserData->ReportItems[i];
+		uint8_t              BitSize    = ReportItem->Attributes.BitSize;
+		HID_CompiledField_t* Field;
+		uint16_t             FirstBit;
+
+		if ((ReportItem->ReportID != ReportID) || (ReportItem->ItemType != ReportType))
+		  continue;
+
+		if (!(BitSize) || (BitSize > 32))
+		  continue;
+
+		Field    = &Compiled->Fields[Compiled->TotalFields++];
+		FirstBit = ReportItem->BitOffset + (IDPrefixBytes * 8);
+
+		Field->ByteOffset = (FirstBit / 8);
+		Field->Shift      = (FirstBit % 8);
+		Field->ByteCount  = ((Field->Shift + BitSize + 7) / 8);
+		Field->Mask       = (BitSize == 32) ? 0xFFFFFFFF : ((1UL << BitSize) - 1);
+		Field->ReportItem = ReportItem;
+
+		if (ReportItem->Attributes.Logical.Minimum > ReportItem->Attributes.Logical.Maximum)
+		{
+			Field->Flags   |= HID_CFIELD_SIGNED;
+			Field->SignBit  = (1UL << (BitSize - 1));
+		}
+	}
+
+	if (!(Compiled->TotalFields))
+	  return HID_PARSE_NoMatchingReportItems;
+
+	return HID_PARSE_Successful;
+}
+
+bool USB_DecodeHIDReport(const HID_CompiledReport_t* const Compiled,
+                         const uint8_t* ReportData,
+                         const uint16_t ReportSize,
+                         int32_t* const Values)
+{
+	const HID_CompiledField_t* Field = Compiled->Fields;
+
+	if (ReportSize < Compiled->ReportSize)
+	  return false;
+
+	if (Compiled->ReportID && (ReportData[0] != Compiled->ReportID))
+	  return false;
+
+	for (uint8_t i = 0; i < Compiled->TotalFields; i++, Field++)
+	{
+		const uint8_t* FieldData = &ReportData[Field->ByteOffset];
+		uint32_t       RawValue  = 0;
+
+		switch (Field->ByteCount)
+		{
+			case 5:
+			case 4:
+				RawValue |= ((uint32_t)FieldData[3] << 24);
+			case 3:
+				RawValue |= ((uint32_t)FieldData[2] << 16);
+			case 2:
+				RawValue |= ((uint32_t)FieldData[1] << 8);
+			default:
+				RawValue |= FieldData[0];
+		}
+
+		RawValue >>= Field->Shift;
+
+		if (Field->ByteCount == 5)
+		  RawValue |= ((uint32_t)FieldData[4] << (32 - Field->Shift));
+
+		RawValue &= Field->Mask;
+
+		if (Field->Flags & HID_CFIELD_SIGNED)
+		  RawValue = ((RawValue ^ Field->SignBit) - Field->SignBit);
+
+		Values[i] = (int32_t)RawValue;
+	}
+
+	return true;
+}
@@ -54,6 +54,10 @@
  *  This module also contains routines for the processing of data in an actual HID report, using the parsed report
  *  descriptor data as a guide for the encoding.
  *
+ *  For high report rates, the parsed items of a report can be compiled with @ref USB_CompileHIDReport() into a
+ *  table of precomputed field extractors (byte offset, shift, mask and sign extension), which
+ *  @ref USB_DecodeHIDReport() then applies to decode all the fields of a received report in a single pass.
+ *
  *  @{
  */
 
@@ -149,6 +153,13 @@
 				HID_PARSE_UsageListOverflow           = 6, /**< More than @ref HID_USAGE_STACK_DEPTH usages listed in a row. */
 				HID_PARSE_InsufficientReportIDItems   = 7, /**< More than @ref HID_MAX_REPORT_IDS report IDs in the device. */
 				HID_PARSE_NoUnfilteredReportItems     = 8, /**< All report items from the device were filtered by the filtering callback routine. */
+				HID_PARSE_NoMatchingReportItems       = 9, /**< No parsed report items match the report ID and type given to @ref USB_CompileHIDReport(). */
+			};
+
+			/** Enum for the flags of a compiled HID report field, stored in @ref HID_CompiledField_t. */
+			enum HID_CompiledField_Flags_t
+			{
+				HID_CFIELD_SIGNED                     = (1 << 0), /**< Field has a negative logical minimum and is sign-extended when decoded. */
 			};
 
 		/* Type Defines: */
@@ -261,6 +272,37 @@
 				                                      */
 			} HID_ReportInfo_t;
 
+			/** @brief HID Compiled Report Field Structure.
+			 *
+			 *  Type define for a single precomputed field extractor. The field's raw value is obtained by loading
+			 *  \c ByteCount little-endian bytes from \c ByteOffset in the report, shifting right by \c Shift and
+			 *  masking with \c Mask, without any per-bit processing.
+			 */
+			typedef struct
+			{
+				uint16_t          ByteOffset; /**< Offset of the first byte holding the field, including any report ID prefix. */
+				uint8_t           ByteCount;  /**< Number of bytes spanned by the field (1 to 5). */
+				uint8_t           Shift;      /**< Right shift applied to the loaded bytes to align the field to bit 0. */
+				uint32_t          Mask;       /**< Mask applied after shifting, covering the field's bit size. */
+				uint32_t          SignBit;    /**< Sign bit of the field when @ref HID_CFIELD_SIGNED is set, zero otherwise. */
+				uint8_t           Flags;      /**< Mask of @ref HID_CompiledField_Flags_t flags. */
+				HID_ReportItem_t* ReportItem; /**< Parsed report item the field was compiled from. */
+			} HID_CompiledField_t;
+
+			/** @brief HID Compiled Report Structure.
+			 *
+			 *  Type define for the extraction program of one report (a report ID and report type pair), created by
+			 *  @ref USB_CompileHIDReport() from a @ref HID_ReportInfo_t and executed by @ref USB_DecodeHIDReport().
+			 */
+			typedef struct
+			{
+				uint8_t             ReportID;    /**< Report ID of the compiled report, or 0x00 if the device has only one report. */
+				uint8_t             ReportType;  /**< Report type, a value in @ref HID_ReportItemTypes_t. */
+				uint16_t            ReportSize;  /**< Size in bytes of the report, including the report ID prefix if present. */
+				uint8_t             TotalFields; /**< Total number of fields stored in the \c Fields array. */
+				HID_CompiledField_t Fields[HID_MAX_REPORTITEMS]; /**< Field extractors, in report item order. */
+			} HID_CompiledReport_t;
+
 		/* Function Prototypes: */
 			/** Function to process a given HID report returned from an attached device, and store it into a given
 			 *  @ref HID_ReportInfo_t structure.
@@ -320,6 +362,40 @@
 			                              const uint8_t ReportID,
 			                              const uint8_t ReportType) ATTR_CONST ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Compiles the parsed report items of a single report into a compact extraction program, so that
+			 *  received reports can be decoded in one pass with @ref USB_DecodeHIDReport() instead of calling
+			 *  @ref USB_GetHIDReportItemInfo() for each item.
+			 *
+			 *  A field is treated as signed when its logical minimum, as stored by the parser, is larger than its
+			 *  logical maximum, which is the case for any negative minimum paired with a positive maximum.
+			 *
+			 *  @param  ParserData  Pointer to a @ref HID_ReportInfo_t instance containing the parser output.
+			 *  @param  ReportID    Report ID of the report to compile, or 0x00 if the device has only one report.
+			 *  @param  ReportType  Type of the report to compile, a value from the @ref HID_ReportItemTypes_t enum.
+			 *  \param[out] Compiled  Pointer to a @ref HID_CompiledReport_t instance for the compiled output.
+			 *
+			 *  @return A value in the @ref HID_Parse_ErrorCodes_t enum.
+			 */
+			uint8_t USB_CompileHIDReport(HID_ReportInfo_t* const ParserData,
+			                             const uint8_t ReportID,
+			                             const uint8_t ReportType,
+			                             HID_CompiledReport_t* const Compiled) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(4);
+
+			/** Decodes every field of a received report in a single pass, using an extraction program previously
+			 *  built by @ref USB_CompileHIDReport(). Signed fields are sign-extended to 32 bits.
+			 *
+			 *  @param  Compiled    Pointer to the compiled report describing the layout of \c ReportData.
+			 *  @param  ReportData  Buffer containing an IN or FEATURE report from an attached device.
+			 *  @param  ReportSize  Size in bytes of the data in \c ReportData.
+			 *  \param[out] Values  Array of \c TotalFields entries receiving the decoded values, in field order.
+			 *
+			 *  \returns Boolean \c true if the report matched the compiled report ID and size, \c false otherwise.
+			 */
+			bool USB_DecodeHIDReport(const HID_CompiledReport_t* const Compiled,
+			                         const uint8_t* ReportData,
+			                         const uint16_t ReportSize,
+			                         int32_t* const Values) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2) ATTR_NON_NULL_PTR_ARG(4);
+
 			/** Callback routine for the HID Report Parser. This callback <b>must</b> be implemented by the user code when
 			 *  the parser is used, to determine what report IN, OUT and FEATURE item's information is stored into the user
 			 *  @ref HID_ReportInfo_t structure. This can be used to filter only those items the application will be using, so that
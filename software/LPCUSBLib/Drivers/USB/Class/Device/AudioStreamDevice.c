@@ -0,0 +1,358 @@
+/*
+ * @brief Isochronous USB to I2S streaming engine for the USB Audio 1.0 Class device driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "../../Core/USBMode.h"
+
+#if defined(USB_CAN_BE_DEVICE) && (defined(__LPC18XX__) || defined(__LPC43XX__))
+
+#define  __INCLUDE_FROM_AUDIO_DRIVER
+#define  __INCLUDE_FROM_AUDIO_STREAM_DEVICE_C
+#include "AudioStreamDevice.h"
+
+/* Ring index of a free running slot number */
+#define AUDIO_STREAM_SLOT(n)           ((n) & (AUDIO_STREAM_SLOTS - 1))
+
+/* Transfer size field of a GPDMA control word */
+#define AUDIO_STREAM_SIZE_MASK         GPDMA_DMACCxControl_TransferSize(0xFFF)
+
+/* I2S transmit FIFO level the DMA request is raised at, matches the 4 word bursts */
+#define AUDIO_STREAM_I2S_DMA_DEPTH     4
+
+/* Default buffer handler of the device controller driver, used for other iso endpoints */
+extern uint32_t Dummy_EPGetISOAddress(uint32_t EPNum, uint32_t *last_packet_size);
+
+static Audio_Device_Stream_t* ActiveStream;
+static uint32_t SilenceBuffer[AUDIO_STREAM_SLOT_SIZE / 4];
+
+static void Audio_Device_StreamSetSlot(Audio_Device_Stream_t* const Stream,
+                                       const uint32_t Slot,
+                                       const void* Data,
+                                       const uint32_t Words)
+{
+	DMA_TransferDescriptor_t* Descriptor = &Stream->Descriptors[AUDIO_STREAM_SLOT(Slot)];
+
+	Descriptor->src  = (uint32_t)Data;
+	Descriptor->ctrl = Stream->State.CtrlWord | GPDMA_DMACCxControl_TransferSize(Words);
+}
+
+static uint32_t Audio_Device_StreamSlotWords(const Audio_Device_Stream_t* const Stream,
+                                             const uint32_t Slot)
+{
+	return Stream->Descriptors[AUDIO_STREAM_SLOT(Slot)].ctrl & AUDIO_STREAM_SIZE_MASK;
+}
+
+static void Audio_Device_StreamSetFeedback(Audio_Device_Stream_t* const Stream,
+                                           const uint32_t Feedback)
+{
+	/* 16.16 samples per frame to the full speed 10.14 format */
+	uint32_t Value = (Feedback >> 2);
+
+	Stream->FeedbackBuffer[0] = (uint8_t)(Value);
+	Stream->FeedbackBuffer[1] = (uint8_t)(Value >> 8);
+	Stream->FeedbackBuffer[2] = (uint8_t)(Value >> 16);
+}
+
+static void Audio_Device_StreamReset(Audio_Device_Stream_t* const Stream)
+{
+	for (uint8_t Slot = 0; Slot < AUDIO_STREAM_SLOTS; Slot++)
+	  Audio_Device_StreamSetSlot(Stream, Slot, SilenceBuffer, Stream->State.SilenceWords);
+
+	Stream->State.Running      = false;
+	Stream->State.WriteSlot    = 0;
+	Stream->State.ReadSlot     = 0;
+	Stream->State.PlayedWords  = 0;
+	Stream->State.WindowStart  = 0;
+	Stream->State.WindowFrames = 0;
+	Stream->State.Feedback     = Stream->State.NominalFeedback;
+
+	Audio_Device_StreamSetFeedback(Stream, Stream->State.Feedback);
+}
+
+static uint32_t Audio_Device_StreamPosition(Audio_Device_Stream_t* const Stream)
+{
+	LPC_GPDMA_T* const GPDMA = LPC_GPDMA;
+	const uint8_t Channel    = Stream->State.DMAChannel;
+	uint32_t Position        = Stream->State.PlayedWords;
+	uint32_t Slot            = Stream->State.ReadSlot;
+	uint32_t Remaining;
+	uint32_t Next;
+
+	/* Sample the channel again if it loaded a new descriptor in between */
+	do
+	{
+		Remaining = (GPDMA->CH[Channel].CONTROL & AUDIO_STREAM_SIZE_MASK);
+		Next      = GPDMA->CH[Channel].LLI;
+	}
+	while (Remaining != (GPDMA->CH[Channel].CONTROL & AUDIO_STREAM_SIZE_MASK));
+
+	/* Count the slots the GPDMA has moved past but the DMA interrupt has not retired yet */
+	for (uint8_t Count = 0; Count < AUDIO_STREAM_SLOTS; Count++)
+	{
+		if (Next == (uint32_t)&Stream->Descriptors[AUDIO_STREAM_SLOT(Slot + 1)])
+		  break;
+
+		Position += Audio_Device_StreamSlotWords(Stream, Slot);
+		Slot++;
+	}
+
+	return Position + Audio_Device_StreamSlotWords(Stream, Slot) - Remaining;
+}
+
+static void Audio_Device_StreamMeasure(Audio_Device_Stream_t* const Stream,
+                                       const uint32_t Level)
+{
+	uint32_t Position;
+	uint32_t Measured;
+	int32_t  Feedback;
+	int32_t  Limit;
+
+	if (++Stream->State.WindowFrames < (1 << AUDIO_STREAM_FEEDBACK_SHIFT))
+	  return;
+
+	/* Samples consumed by the I2S clock over the last window of USB frames */
+	Position = Audio_Device_StreamPosition(Stream);
+	Measured = (((Position - Stream->State.WindowStart) * 4) / Stream->Config.BytesPerSampleFrame) << (16 - AUDIO_STREAM_FEEDBACK_SHIFT);
+
+	Stream->State.WindowStart  = Position;
+	Stream->State.WindowFrames = 0;
+	Stream->State.Feedback    += ((int32_t)(Measured - Stream->State.Feedback) >> 2);
+
+	/* Steer the ring back to its target level, 1/64 sample per frame for each slot off */
+	Feedback = (int32_t)Stream->State.Feedback + (((int32_t)AUDIO_STREAM_TARGET_LEVEL - (int32_t)Level) << 10);
+	Limit    = (int32_t)Stream->State.NominalFeedback;
+
+	if (Feedback > (Limit + (1 << 16)))
+	  Feedback = (Limit + (1 << 16));
+	else if (Feedback < (Limit - (1 << 16)))
+	  Feedback = (Limit - (1 << 16));
+
+	Audio_Device_StreamSetFeedback(Stream, (uint32_t)Feedback);
+}
+
+static void Audio_Device_StreamRun(Audio_Device_Stream_t* const Stream)
+{
+	Stream->State.DMAChannel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, Stream->Config.DMAConnection);
+
+	/* Stay stopped, the start is tried again with the next frame */
+	if (Stream->State.DMAChannel == GPDMA_NO_FREE_CHANNEL)
+	  return;
+
+	Chip_I2S_DMA_TxCmd(Stream->Config.I2S, I2S_DMA_REQUEST_CHANNEL_1, ENABLE, AUDIO_STREAM_I2S_DMA_DEPTH);
+
+	if (Chip_GPDMA_SGTransfer(LPC_GPDMA, Stream->State.DMAChannel,
+	                          &Stream->Descriptors[AUDIO_STREAM_SLOT(Stream->State.ReadSlot)],
+	                          GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == SUCCESS)
+	{
+		Stream->State.Running = true;
+	}
+	else
+	{
+		Chip_GPDMA_Stop(LPC_GPDMA, Stream->State.DMAChannel);
+		Chip_I2S_DMA_TxCmd(Stream->Config.I2S, I2S_DMA_REQUEST_CHANNEL_1, DISABLE, AUDIO_STREAM_I2S_DMA_DEPTH);
+	}
+}
+
+static uint32_t Audio_Device_StreamReceive(Audio_Device_Stream_t* const Stream,
+                                           uint32_t Length)
+{
+	const uint8_t BytesPerSampleFrame = Stream->Config.BytesPerSampleFrame;
+	uint32_t Slot  = Stream->State.WriteSlot;
+	uint8_t* Data  = (uint8_t*)Stream->Slots[AUDIO_STREAM_SLOT(Slot)];
+	uint32_t Level = (Slot - Stream->State.ReadSlot);
+
+	if (Stream->State.Running)
+	{
+		Audio_Device_StreamMeasure(Stream, Level);
+
+		/* The slot is, or is about to be, loaded by the GPDMA: restart ahead of it */
+		if (Length && ((int32_t)Level < 2))
+		{
+			Stream->Stats.Frames++;
+			Stream->Stats.LateFrames++;
+			Stream->State.WriteSlot = Stream->State.ReadSlot + 2;
+
+			return (uint32_t)Stream->Slots[AUDIO_STREAM_SLOT(Stream->State.WriteSlot)];
+		}
+	}
+
+	if (!(Length))
+	  return (uint32_t)Data;
+
+	Stream->Stats.Frames++;
+
+	/* The next slot would be the one being played */
+	if ((Level + 1) >= AUDIO_STREAM_SLOTS)
+	{
+		Stream->Stats.Overruns++;
+		return (uint32_t)Data;
+	}
+
+	Length -= (Length % BytesPerSampleFrame);
+
+	if (Stream->State.Running)
+	{
+		if ((Level >= (AUDIO_STREAM_TARGET_LEVEL + AUDIO_STREAM_HYSTERESIS)) && (Length > BytesPerSampleFrame))
+		{
+			Length -= BytesPerSampleFrame;
+			Stream->Stats.DroppedSamples++;
+		}
+		else if ((Level <= (AUDIO_STREAM_TARGET_LEVEL - AUDIO_STREAM_HYSTERESIS)) && Length &&
+		         ((Length + BytesPerSampleFrame) <= AUDIO_STREAM_SLOT_SIZE))
+		{
+			memcpy(&Data[Length], &Data[Length - BytesPerSampleFrame], BytesPerSampleFrame);
+			Length += BytesPerSampleFrame;
+			Stream->Stats.InsertedSamples++;
+		}
+	}
+
+	Audio_Device_StreamSetSlot(Stream, Slot, Data, (Length / 4));
+	Stream->State.WriteSlot = ++Slot;
+
+	if (!(Stream->State.Running) && ((Slot - Stream->State.ReadSlot) >= AUDIO_STREAM_TARGET_LEVEL))
+	  Audio_Device_StreamRun(Stream);
+
+	return (uint32_t)Stream->Slots[AUDIO_STREAM_SLOT(Slot)];
+}
+
+bool Audio_Device_StreamInit(Audio_Device_Stream_t* const Stream)
+{
+	if (!(Stream->Config.BytesPerSampleFrame) || (Stream->Config.BytesPerSampleFrame & 3) ||
+	    (Stream->Config.DataOUTEndpointNumber == Stream->Config.FeedbackINEndpointNumber))
+	{
+		return false;
+	}
+
+	memset(&Stream->State, 0x00, sizeof(Stream->State));
+	memset(&Stream->Stats, 0x00, sizeof(Stream->Stats));
+
+	if (Chip_GPDMA_PrepareDescriptor(LPC_GPDMA, &Stream->Descriptors[0], (uint32_t)SilenceBuffer,
+	                                 Stream->Config.DMAConnection, 1, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+	                                 &Stream->Descriptors[1]) != SUCCESS)
+	{
+		return false;
+	}
+
+	/* Interrupt on every slot, bursts no larger than the space signalled by the I2S DMA request */
+	Stream->State.CtrlWord = (Stream->Descriptors[0].ctrl & ~(AUDIO_STREAM_SIZE_MASK |
+	                                                          GPDMA_DMACCxControl_SBSize(7) |
+	                                                          GPDMA_DMACCxControl_DBSize(7))) |
+	                         GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) |
+	                         GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4) |
+	                         GPDMA_DMACCxControl_I;
+
+	for (uint8_t Slot = 0; Slot < AUDIO_STREAM_SLOTS; Slot++)
+	{
+		Stream->Descriptors[Slot].dst = Stream->Descriptors[0].dst;
+		Stream->Descriptors[Slot].lli = (uint32_t)&Stream->Descriptors[AUDIO_STREAM_SLOT(Slot + 1)];
+	}
+
+	Stream->State.NominalFeedback = ((Stream->Config.SampleRate << 13) / 125);
+	Stream->State.SilenceWords    = (((Stream->State.NominalFeedback >> 16) * Stream->Config.BytesPerSampleFrame) / 4);
+
+	Audio_Device_StreamReset(Stream);
+
+	ActiveStream = Stream;
+	return true;
+}
+
+bool Audio_Device_StreamConfigureFeedback(Audio_Device_Stream_t* const Stream,
+                                          const uint8_t PortNumber)
+{
+	return Endpoint_ConfigureEndpoint(PortNumber, Stream->Config.FeedbackINEndpointNumber, EP_TYPE_ISOCHRONOUS,
+	                                  ENDPOINT_DIR_IN, AUDIO_STREAM_FEEDBACK_SIZE, ENDPOINT_BANK_SINGLE);
+}
+
+void Audio_Device_StreamStart(Audio_Device_Stream_t* const Stream)
+{
+	Audio_Device_StreamStop(Stream);
+
+	memset(&Stream->Stats, 0x00, sizeof(Stream->Stats));
+}
+
+void Audio_Device_StreamStop(Audio_Device_Stream_t* const Stream)
+{
+	if (Stream->State.Running)
+	{
+		Chip_GPDMA_Stop(LPC_GPDMA, Stream->State.DMAChannel);
+		Chip_I2S_DMA_TxCmd(Stream->Config.I2S, I2S_DMA_REQUEST_CHANNEL_1, DISABLE, AUDIO_STREAM_I2S_DMA_DEPTH);
+	}
+
+	Audio_Device_StreamReset(Stream);
+}
+
+void Audio_Device_StreamDMAHandler(Audio_Device_Stream_t* const Stream)
+{
+	uint32_t Current;
+
+	if (!(Stream->State.Running) || (Chip_GPDMA_Interrupt(LPC_GPDMA, Stream->State.DMAChannel) != SUCCESS))
+	  return;
+
+	/* The channel holds the link of the descriptor it is playing, several slots may have ended since the last interrupt */
+	Current = ((LPC_GPDMA->CH[Stream->State.DMAChannel].LLI - (uint32_t)&Stream->Descriptors[0]) /
+	           sizeof(DMA_TransferDescriptor_t)) - 1;
+
+	while (AUDIO_STREAM_SLOT(Stream->State.ReadSlot) != AUDIO_STREAM_SLOT(Current))
+	{
+		uint32_t Slot = Stream->State.ReadSlot;
+
+		Stream->State.PlayedWords += Audio_Device_StreamSlotWords(Stream, Slot);
+		Audio_Device_StreamSetSlot(Stream, Slot, SilenceBuffer, Stream->State.SilenceWords);
+		Stream->State.ReadSlot = ++Slot;
+
+		if ((int32_t)(Stream->State.WriteSlot - Slot) <= 0)
+		  Stream->Stats.Underruns++;
+	}
+}
+
+uint32_t CALLBACK_HAL_GetISOBufferAddress(const uint32_t EPNum, uint32_t *last_packet_size)
+{
+	Audio_Device_Stream_t* const Stream = ActiveStream;
+
+	if (Stream != NULL)
+	{
+		if (EPNum == Stream->Config.DataOUTEndpointNumber)
+		{
+			return Audio_Device_StreamReceive(Stream, *last_packet_size);
+		}
+		else if (EPNum == Stream->Config.FeedbackINEndpointNumber)
+		{
+			*last_packet_size = AUDIO_STREAM_FEEDBACK_SIZE;
+			return (uint32_t)Stream->FeedbackBuffer;
+		}
+	}
+
+	return Dummy_EPGetISOAddress(EPNum, last_packet_size);
+}
+
+#endif
+
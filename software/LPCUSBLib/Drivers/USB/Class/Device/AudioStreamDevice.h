@@ -0,0 +1,218 @@
+/*
+ * @brief Isochronous USB to I2S streaming engine for the USB Audio 1.0 Class device driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+/** @ingroup Group_USBClassAudioDevice
+ *  @defgroup Group_USBClassAudioStream Audio 1.0 Class Device Isochronous Streaming Engine (LPC18xx/43xx)
+ *
+ *  @section Sec_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - LPCUSBlib/Drivers/USB/Class/Device/AudioStreamDevice.c <i>(Makefile source module name: LPCUSBLIB_SRC_USBCLASS)</i>
+ *
+ *  @section Sec_ModDescription Module Description
+ *  Moves the samples of an asynchronous isochronous OUT audio stream straight from the USB controller
+ *  into the I2S transmit FIFO. Each USB frame is received by the device controller into one slot of a
+ *  multi-frame ring, and a circular GPDMA descriptor chain plays the ring out through I2S, so no per
+ *  sample CPU work is done. Slots that have been played are pointed back at a silence buffer, so a
+ *  late host never stalls the I2S clock.
+ *
+ *  The number of samples consumed by the I2S clock is measured against the USB frame clock and sent back
+ *  to the host on an explicit feedback endpoint (10.14 format). A small correction from the ring fill level
+ *  is added so the ring settles around half full. When the host ignores the feedback, one sample frame is
+ *  dropped or repeated per USB frame while the fill level is outside its hysteresis window.
+ *
+ *  The engine implements @ref CALLBACK_HAL_GetISOBufferAddress(), so the application must not define it,
+ *  the data and feedback endpoints must use different endpoint numbers, and only one stream can be active.
+ *  The GPDMA controller must have been initialized by the application, which also calls
+ *  @ref Audio_Device_StreamDMAHandler() from its DMA interrupt. The USB and DMA interrupts must run at the
+ *  same priority. Sample frames must be a multiple of 32 bits (16-bit stereo or 32-bit containers) to match
+ *  the I2S FIFO.
+ *
+ *  @{
+ */
+
+#ifndef _AUDIO_STREAM_DEVICE_H_
+#define _AUDIO_STREAM_DEVICE_H_
+
+	/* Includes: */
+		#include "../../USB.h"
+		#include "../Common/AudioClassCommon.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_AUDIO_DRIVER)
+			#error Do not include this file directly. Include LPCUSBlib/Drivers/USB.h instead.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Number of USB frames buffered between the USB controller and I2S, must be a power of 2. */
+			#define AUDIO_STREAM_SLOTS             8
+
+			/** Size in bytes of one ring slot, the length the device controller receives each iso OUT frame into. */
+			#define AUDIO_STREAM_SLOT_SIZE         USB_DATA_BUFFER_TEM_LENGTH
+
+			/** Fill level, in slots, the stream is started at and steered towards. */
+			#define AUDIO_STREAM_TARGET_LEVEL      (AUDIO_STREAM_SLOTS / 2)
+
+			/** Distance from @ref AUDIO_STREAM_TARGET_LEVEL, in slots, outside of which samples are dropped or repeated. */
+			#define AUDIO_STREAM_HYSTERESIS        2
+
+			/** Number of USB frames the consumed sample count is measured over (log2). */
+			#define AUDIO_STREAM_FEEDBACK_SHIFT    7
+
+			/** Size in bytes of the full speed (10.14) feedback value. */
+			#define AUDIO_STREAM_FEEDBACK_SIZE     3
+
+		/* Type Defines: */
+			/** @brief Audio streaming engine statistics.
+			 *
+			 *  Counters are cleared by @ref Audio_Device_StreamStart() and only ever incremented by the engine.
+			 */
+			typedef struct
+			{
+				uint32_t Frames; /**< Number of data frames received from the host. */
+				uint32_t Underruns; /**< Number of ring slots played as silence while the stream was running. */
+				uint32_t Overruns; /**< Number of frames discarded because the ring was full. */
+				uint32_t LateFrames; /**< Number of frames discarded because their slot had already been played. */
+				uint32_t DroppedSamples; /**< Number of sample frames dropped to compensate for a fast host. */
+				uint32_t InsertedSamples; /**< Number of sample frames repeated to compensate for a slow host. */
+			} Audio_Stream_Stats_t;
+
+			/** @brief Audio streaming engine configuration and state structure.
+			 *
+			 *  One instance should be made for the isochronous OUT stream of an Audio interface, and passed to each
+			 *  of the streaming engine functions.
+			 */
+			typedef struct
+			{
+				const struct
+				{
+					uint8_t  DataOUTEndpointNumber; /**< Endpoint number of the isochronous OUT audio data endpoint. */
+					uint8_t  FeedbackINEndpointNumber; /**< Endpoint number of the isochronous IN feedback endpoint. */
+					uint8_t  BytesPerSampleFrame; /**< Size in bytes of one sample for all channels, a multiple of 4. */
+					uint32_t SampleRate; /**< Nominal sample rate of the stream and of the I2S interface, in Hz. */
+					LPC_I2S_T* I2S; /**< I2S peripheral the stream is played out on, already configured. */
+					uint32_t DMAConnection; /**< GPDMA connection of the I2S transmit request, GPDMA_CONN_I2S_Tx_Channel_0
+					                         *   or GPDMA_CONN_I2S1_Tx_Channel_0.
+					                         */
+				} Config; /**< Config data for the stream. All elements in this section <b>must</b> be set. */
+				struct
+				{
+					bool     Running; /**< Set while the GPDMA is playing the ring out. */
+					uint8_t  DMAChannel; /**< GPDMA channel used for the I2S transfers. */
+					volatile uint32_t WriteSlot; /**< Free running index of the slot being received from USB. */
+					volatile uint32_t ReadSlot; /**< Free running index of the slot being played by the GPDMA. */
+					uint32_t PlayedWords; /**< Number of 32-bit words played from slots before @ref ReadSlot. */
+					uint32_t CtrlWord; /**< GPDMA control word of a slot, without the transfer size. */
+					uint32_t NominalFeedback; /**< Nominal samples per frame, in 16.16 format. */
+					uint32_t Feedback; /**< Current feedback value, in 16.16 format. */
+					uint32_t WindowStart; /**< Word position at the start of the feedback measurement window. */
+					uint16_t WindowFrames; /**< Number of frames received in the current measurement window. */
+					uint16_t SilenceWords; /**< Number of 32-bit words played when a slot is empty. */
+				} State; /**< State data for the stream, reset by @ref Audio_Device_StreamStart(). */
+				Audio_Stream_Stats_t Stats; /**< Underrun, overrun and drift compensation counters. */
+				DMA_TransferDescriptor_t Descriptors[AUDIO_STREAM_SLOTS]; /**< Circular GPDMA chain, one per slot. */
+				uint32_t Slots[AUDIO_STREAM_SLOTS][AUDIO_STREAM_SLOT_SIZE / 4]; /**< Ring of received frames. */
+				uint8_t  FeedbackBuffer[4] ATTR_ALIGNED(4); /**< Feedback value sent on the feedback endpoint. */
+			} Audio_Device_Stream_t;
+
+		/* Function Prototypes: */
+			/**
+			 * @brief	Initializes a stream and makes it the target of the isochronous endpoint buffer callback. This must be called
+			 *  before the endpoints of the Audio interface are configured.
+			 *
+			 * @param	Stream	: Pointer to a structure containing the stream configuration and state.
+			 * @return	Boolean \c true if the stream could be initialized, \c false otherwise.
+			 */
+			bool Audio_Device_StreamInit(Audio_Device_Stream_t* const Stream) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Configures the feedback endpoint of a stream. This should be called from the
+			 *  @ref EVENT_USB_Device_ConfigurationChanged() event after @ref Audio_Device_ConfigureEndpoints().
+			 *
+			 * @param	Stream		: Pointer to a structure containing the stream configuration and state.
+			 * @param	PortNumber	: USB port the Audio interface is running on.
+			 * @return	Boolean \c true if the endpoint was successfully configured, \c false otherwise.
+			 */
+			bool Audio_Device_StreamConfigureFeedback(Audio_Device_Stream_t* const Stream,
+			                                          const uint8_t PortNumber) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Starts buffering a stream. The I2S transfers start once the ring is filled up to
+			 *  @ref AUDIO_STREAM_TARGET_LEVEL. This should be called from @ref EVENT_Audio_Device_StreamStartStop() when the
+			 *  streaming interface is enabled.
+			 *
+			 * @param	Stream	: Pointer to a structure containing the stream configuration and state.
+			 * @return	Nothing
+			 */
+			void Audio_Device_StreamStart(Audio_Device_Stream_t* const Stream) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Stops the I2S transfers of a stream and discards any buffered frames. This should be called from
+			 *  @ref EVENT_Audio_Device_StreamStartStop() when the streaming interface is disabled.
+			 *
+			 * @param	Stream	: Pointer to a structure containing the stream configuration and state.
+			 * @return	Nothing
+			 */
+			void Audio_Device_StreamStop(Audio_Device_Stream_t* const Stream) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Retires the ring slots played by the GPDMA. This must be called from the DMA interrupt handler.
+			 *
+			 * @param	Stream	: Pointer to a structure containing the stream configuration and state.
+			 * @return	Nothing
+			 */
+			void Audio_Device_StreamDMAHandler(Audio_Device_Stream_t* const Stream) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Device controller callback returning the buffer of the next isochronous transfer of an endpoint.
+			 *  Implemented by the streaming engine, called by the LPC18xx/43xx device controller driver.
+			 *
+			 * @param	EPNum				: Logical endpoint number.
+			 * @param	last_packet_size	: Number of bytes received by the completed OUT transfer, or the
+			 *                                number of bytes to send on the next IN transfer.
+			 * @return	Address of the buffer for the next transfer.
+			 */
+			uint32_t CALLBACK_HAL_GetISOBufferAddress(const uint32_t EPNum, uint32_t *last_packet_size);
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
@@ -0,0 +1,144 @@
+/*
+ * @brief Chan FATFS simple abstraction layer (for NAND FLASH)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2015
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "diskio.h"
+#include "nand_ftl.h"
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Disk Status */
+static volatile DSTATUS Stat = STA_NOINIT;
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize Disk Drive */
+DSTATUS disk_initialize(BYTE drv)
+{
+	if (drv) {
+		return STA_NOINIT;				/* Supports only single drive */
+	}
+
+	if (Stat != STA_NOINIT) {
+		return Stat;					/* FTL already mounted */
+	}
+
+	lpc_nandflash_init();
+
+	/* An erased device mounts as an empty disk */
+	if (nand_ftl_mount() != NAND_FTL_OK) {
+		return Stat;
+	}
+
+	Stat &= ~STA_NOINIT;
+	return Stat;
+}
+
+/* Read Sector(s) */
+DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
+{
+	if (drv || !count) {
+		return RES_PARERR;
+	}
+	if (Stat & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+
+	return (nand_ftl_read(buff, sector, count) == NAND_FTL_OK) ? RES_OK : RES_ERROR;
+}
+
+/* Get Disk Status */
+DSTATUS disk_status(BYTE drv)
+{
+	if (drv) {
+		return STA_NOINIT;	/* Supports only single drive */
+	}
+	return Stat;
+}
+
+/* Write Sector(s) */
+DRESULT disk_write(BYTE drv, const BYTE *buff, DWORD sector, BYTE count)
+{
+	if (drv || !count) {
+		return RES_PARERR;
+	}
+	if (Stat & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+
+	return (nand_ftl_write(buff, sector, count) == NAND_FTL_OK) ? RES_OK : RES_ERROR;
+}
+
+/* Disk Drive miscellaneous Functions */
+DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void *buff)
+{
+	DRESULT res;
+
+	if (drv) {
+		return RES_PARERR;
+	}
+	if (Stat & STA_NOINIT) {
+		return RES_NOTRDY;
+	}
+
+	res = RES_ERROR;
+
+	switch (ctrl) {
+	case CTRL_SYNC:	/* Program the page held in the FTL write cache */
+		if (nand_ftl_sync() == NAND_FTL_OK) {
+			res = RES_OK;
+		}
+		break;
+
+	case GET_SECTOR_COUNT:	/* Get number of sectors on the disk (DWORD) */
+		*(DWORD *) buff = nand_ftl_get_sector_count();
+		res = RES_OK;
+		break;
+
+	case GET_SECTOR_SIZE:	/* Get R/W sector size (WORD) */
+		*(WORD *) buff = NAND_FTL_SECTOR_SIZE;
+		res = RES_OK;
+		break;
+
+	case GET_BLOCK_SIZE:/* Get erase block size in unit of sector (DWORD) */
+		*(DWORD *) buff = nand_ftl_get_block_sectors();
+		res = RES_OK;
+		break;
+
+	default:
+		res = RES_PARERR;
+		break;
+	}
+
+	return res;
+}
@@ -0,0 +1,840 @@
+/*
+ * @brief NAND flash translation layer for the Chan FATFS disk interface
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2015
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "nand_ftl.h"
+#include "lpc_nandflash_k9f1g.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define FTL_PAGE_SIZE           K9F1G_PAGE_SIZE
+#define FTL_SPARE_SIZE          K9F1G_SPARE_SIZE
+#define FTL_PAGES_PER_BLOCK     K9F1G_PAGES_PER_BLOCK
+#define FTL_SECTORS_PER_PAGE    (FTL_PAGE_SIZE / NAND_FTL_SECTOR_SIZE)
+#define FTL_ECC_STEPS           (FTL_PAGE_SIZE / NAND_FTL_ECC_STEP)
+
+/* Logical pages, physical pages are numbered block * FTL_PAGES_PER_BLOCK + page */
+#define FTL_LOGICAL_PAGES       ((NAND_FTL_BLOCKS - NAND_FTL_SPARE_BLOCKS) * FTL_PAGES_PER_BLOCK)
+#define FTL_UNMAPPED            0xFFFF
+#define FTL_NO_BLOCK            0xFFFF
+#define FTL_NO_PAGE             0xFFFF
+
+/* Logical page number of the erase count written to the first page of a block by a format */
+#define FTL_LPN_ERASES          0xFFFFFFFE
+
+/* Spare area layout */
+#define SPARE_BADBLOCK          0		/* Bad block marker, 0xFF in good blocks */
+#define SPARE_LPN               2		/* Logical page number */
+#define SPARE_SEQ               6		/* Write sequence number, the highest copy of a page is valid */
+#define SPARE_ERASES            10		/* Erase count of the block */
+#define SPARE_CRC               14		/* CRC16 of the bytes from SPARE_LPN to SPARE_CRC */
+#define SPARE_ECC               16		/* ECC codes of the page data */
+#define SPARE_ECCFAIL           (SPARE_ECC + (FTL_ECC_STEPS * NAND_FTL_ECC_BYTES))	/* 0 if copied from a page with an uncorrectable error */
+#define SPARE_META_ECC          (SPARE_ECCFAIL + 1)	/* ECC code of the bytes from SPARE_LPN to SPARE_ECC */
+#define FTL_META_SIZE           (SPARE_ECC - SPARE_LPN)
+
+/* Block states */
+#define BLOCK_FREE              0		/* Erased */
+#define BLOCK_USED              1		/* Holds pages, no more pages are written */
+#define BLOCK_ACTIVE            2		/* Pages are being written */
+#define BLOCK_RETIRE            3		/* Failed a program, moved and marked bad by the next collection */
+#define BLOCK_BAD               4		/* Never used */
+
+/* Logical to physical page map */
+static uint16_t pageMap[FTL_LOGICAL_PAGES];
+
+/* Block state, valid page count and erase count */
+static uint8_t blockState[NAND_FTL_BLOCKS];
+static uint8_t blockValid[NAND_FTL_BLOCKS];
+static uint32_t blockErases[NAND_FTL_BLOCKS];
+
+static uint8_t mounted;
+static uint32_t freeBlocks;
+static uint32_t activeBlock;
+static uint32_t activePage;
+static uint32_t writeSeq;
+
+/* Write cache and read buffer, each holding a page and its spare area */
+static uint32_t cacheBuf[(FTL_PAGE_SIZE + FTL_SPARE_SIZE) / 4];
+static uint32_t readBuf[(FTL_PAGE_SIZE + FTL_SPARE_SIZE) / 4];
+static uint32_t cacheLpn;
+static uint32_t cacheDirty;
+static uint32_t readLpn;
+
+static NAND_FTL_STATS_T stats;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint32_t ftlGet32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void ftlPut32(uint8_t *p, uint32_t value)
+{
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = value >> 24;
+}
+
+/* Hamming code of up to 256 bytes, see nand_ftl_ecc_calculate() */
+static void ftlEccCalculate(const uint8_t *data, uint32_t len, uint8_t *ecc)
+{
+	uint32_t idx;
+	uint8_t lineParity = 0, lineParityN = 0;
+	uint8_t colParity = 0, colParityN = 0;
+	uint8_t columns = 0;
+	uint8_t parity;
+
+	/* The line parities are the XOR of the indexes (and their complements)
+	   of the bytes with an odd number of set bits, the column parities the
+	   XOR of the bit numbers (and complements) set in the XOR of all bytes. A
+	   single bit error changes them by its byte index and bit number. */
+	for (idx = 0; idx < len; ++idx) {
+		parity = data[idx];
+		columns ^= parity;
+		parity ^= parity >> 4;
+		parity ^= parity >> 2;
+		parity ^= parity >> 1;
+		if (parity & 1) {
+			lineParity ^= idx;
+			lineParityN ^= ~idx;
+		}
+	}
+	for (idx = 0; idx < 8; ++idx) {
+		if (columns & (1 << idx)) {
+			colParity ^= idx;
+			colParityN ^= ~idx & 0x7;
+		}
+	}
+
+	/* Stored inverted so erased data has an erased code */
+	ecc[0] = ~lineParity;
+	ecc[1] = ~lineParityN;
+	ecc[2] = ~(colParity | (colParityN << 3));
+}
+
+/* Check and correct up to 256 bytes, see nand_ftl_ecc_correct() */
+static int ftlEccCorrect(uint8_t *data, uint32_t len, const uint8_t *ecc)
+{
+	uint8_t calc[NAND_FTL_ECC_BYTES];
+	uint32_t diff, bits;
+
+	ftlEccCalculate(data, len, calc);
+	diff = (calc[0] ^ ecc[0]) | ((calc[1] ^ ecc[1]) << 8) | (((calc[2] ^ ecc[2]) & 0x3F) << 16);
+	if (diff == 0) {
+		return 0;
+	}
+
+	/* A single data bit error flips each parity or its complement */
+	if (((((diff >> 8) ^ diff) & 0xFF) == 0xFF) && ((((diff >> 19) ^ (diff >> 16)) & 0x7) == 0x7)) {
+		if ((diff & 0xFF) >= len) {
+			return -1;
+		}
+		data[diff & 0xFF] ^= 1 << ((diff >> 16) & 0x7);
+		return 1;
+	}
+
+	/* A single bit error in the code */
+	for (bits = 0; diff != 0; diff &= diff - 1) {
+		bits++;
+	}
+	return (bits == 1) ? 1 : -1;
+}
+
+/* CRC16 (CCITT) of the spare area page description */
+static uint16_t ftlMetaCrc(const uint8_t *spare)
+{
+	uint16_t crc = 0xFFFF;
+	uint32_t idx, bit;
+
+	for (idx = SPARE_LPN; idx < SPARE_CRC; ++idx) {
+		crc ^= spare[idx] << 8;
+		for (bit = 0; bit < 8; ++bit) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+/* Fill in the CRC and ECC code of the page description */
+static void ftlMetaSeal(uint8_t *spare)
+{
+	uint16_t crc = ftlMetaCrc(spare);
+
+	spare[SPARE_CRC] = crc & 0xFF;
+	spare[SPARE_CRC + 1] = crc >> 8;
+	ftlEccCalculate(spare + SPARE_LPN, FTL_META_SIZE, spare + SPARE_META_ECC);
+}
+
+/* Correct the page description, return 1 if the spare area describes a page */
+static int ftlMetaCheck(uint8_t *spare)
+{
+	if (ftlEccCorrect(spare + SPARE_LPN, FTL_META_SIZE, spare + SPARE_META_ECC) < 0) {
+		return 0;
+	}
+	return ftlMetaCrc(spare) == (spare[SPARE_CRC] | (spare[SPARE_CRC + 1] << 8));
+}
+
+/* Return 1 if the spare area was never programmed */
+static int ftlMetaErased(const uint8_t *spare)
+{
+	uint32_t idx;
+
+	for (idx = SPARE_LPN; idx < SPARE_ECC; ++idx) {
+		if (spare[idx] != 0xFF) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Return 1 if the page data was copied with an uncorrectable error, a bit
+   flip in the marker doesn't change the result */
+static int ftlMetaEccFail(const uint8_t *spare)
+{
+	uint32_t marker = spare[SPARE_ECCFAIL];
+	uint32_t bits = 0;
+
+	while (marker) {
+		bits += marker & 1;
+		marker >>= 1;
+	}
+	return bits < 4;
+}
+
+/* Wait for the end of a program or erase and return the status */
+static uint8_t ftlWaitReady(void)
+{
+	uint8_t status;
+
+	do {
+		status = lpc_nandflash_read_status();
+	} while ((status & NANDFLASH_STATUS_DEV_READY) == 0);
+
+	return status;
+}
+
+static void ftlReadSpare(uint32_t block, uint32_t page, uint8_t *spare)
+{
+	lpc_nandflash_read_start(NAND_FTL_FIRST_BLOCK + block, page, FTL_PAGE_SIZE);
+	lpc_nandflash_read_data(spare, FTL_SPARE_SIZE);
+}
+
+/* Read a page and its spare area, correcting the data. Returns NAND_FTL_ERR_ECC
+   if a step can't be corrected or the data was copied with an error. */
+static NAND_FTL_ERR_T ftlReadPage(uint32_t phys, uint8_t *buf)
+{
+	NAND_FTL_ERR_T err = NAND_FTL_OK;
+	uint32_t step;
+	int result;
+
+	lpc_nandflash_read_start(NAND_FTL_FIRST_BLOCK + (phys / FTL_PAGES_PER_BLOCK), phys % FTL_PAGES_PER_BLOCK, 0);
+	lpc_nandflash_read_data(buf, FTL_PAGE_SIZE + FTL_SPARE_SIZE);
+
+	for (step = 0; step < FTL_ECC_STEPS; ++step) {
+		result = nand_ftl_ecc_correct(buf + (step * NAND_FTL_ECC_STEP),
+									  buf + FTL_PAGE_SIZE + SPARE_ECC + (step * NAND_FTL_ECC_BYTES));
+		if (result > 0) {
+			stats.eccCorrected++;
+		}
+		else if (result < 0) {
+			stats.eccFailed++;
+			err = NAND_FTL_ERR_ECC;
+		}
+	}
+	if (ftlMetaEccFail(buf + FTL_PAGE_SIZE)) {
+		err = NAND_FTL_ERR_ECC;
+	}
+
+	return err;
+}
+
+/* Program a page and its spare area, returns 0 on success */
+static int ftlProgram(uint32_t block, uint32_t page, uint8_t *buf)
+{
+	lpc_nandflash_write_page(NAND_FTL_FIRST_BLOCK + block, page, buf, FTL_PAGE_SIZE + FTL_SPARE_SIZE);
+	stats.nandPages++;
+
+	return (ftlWaitReady() & NANDFLASH_STATUS_PAGE_PROG_FAIL) != 0;
+}
+
+/* Erase a block, returns 0 on success */
+static int ftlErase(uint32_t block)
+{
+	lpc_nandflash_erase_block(NAND_FTL_FIRST_BLOCK + block);
+	stats.erases++;
+	blockErases[block]++;
+
+	return (ftlWaitReady() & NANDFLASH_STATUS_BLOCK_ERASE_FAIL) != 0;
+}
+
+/* Write the bad block marker of a block */
+static void ftlMarkBad(uint32_t block)
+{
+	uint8_t *buf = (uint8_t *) readBuf;
+
+	readLpn = FTL_UNMAPPED;
+	memset(buf, 0xFF, FTL_PAGE_SIZE + FTL_SPARE_SIZE);
+	buf[FTL_PAGE_SIZE + SPARE_BADBLOCK] = 0;
+	ftlProgram(block, 0, buf);
+
+	blockState[block] = BLOCK_BAD;
+	stats.badBlocks++;
+}
+
+/* Make the free block with the lowest erase count the active block */
+static void ftlAllocBlock(void)
+{
+	uint8_t spare[FTL_SPARE_SIZE];
+	uint32_t block;
+
+	activeBlock = FTL_NO_BLOCK;
+	for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+		if ((blockState[block] == BLOCK_FREE) &&
+			((activeBlock == FTL_NO_BLOCK) || (blockErases[block] < blockErases[activeBlock]))) {
+			activeBlock = block;
+		}
+	}
+
+	if (activeBlock != FTL_NO_BLOCK) {
+		/* The first page holds the erase count after a format */
+		ftlReadSpare(activeBlock, 0, spare);
+		blockState[activeBlock] = BLOCK_ACTIVE;
+		activePage = ftlMetaErased(spare) ? 0 : 1;
+		freeBlocks--;
+	}
+}
+
+/* Write the erase count of a freshly erased block to its first page, returns 0 on success */
+static int ftlWriteErases(uint32_t block)
+{
+	uint8_t *buf = (uint8_t *) readBuf;
+	uint8_t *spare = buf + FTL_PAGE_SIZE;
+
+	readLpn = FTL_UNMAPPED;
+	memset(buf, 0xFF, FTL_PAGE_SIZE + FTL_SPARE_SIZE);
+	ftlPut32(spare + SPARE_LPN, FTL_LPN_ERASES);
+	ftlPut32(spare + SPARE_SEQ, 0);
+	ftlPut32(spare + SPARE_ERASES, blockErases[block]);
+	ftlMetaSeal(spare);
+
+	return ftlProgram(block, 0, buf);
+}
+
+static NAND_FTL_ERR_T ftlCollect(void);
+
+/* Program the data of a logical page to the next free page. The spare area of
+   buf is filled in, marking the data bad when eccFail is set. Garbage is
+   collected first when needed and allowed. */
+static NAND_FTL_ERR_T ftlWritePage(uint32_t lpn, uint8_t *buf, uint8_t allowCollect, uint8_t eccFail)
+{
+	uint8_t *spare = buf + FTL_PAGE_SIZE;
+	uint32_t step;
+	uint32_t phys;
+	NAND_FTL_ERR_T err;
+
+	memset(spare, 0xFF, FTL_SPARE_SIZE);
+	ftlPut32(spare + SPARE_LPN, lpn);
+	if (eccFail) {
+		spare[SPARE_ECCFAIL] = 0;
+	}
+	for (step = 0; step < FTL_ECC_STEPS; ++step) {
+		nand_ftl_ecc_calculate(buf + (step * NAND_FTL_ECC_STEP), spare + SPARE_ECC + (step * NAND_FTL_ECC_BYTES));
+	}
+
+	while (1) {
+		if ((activeBlock != FTL_NO_BLOCK) && (activePage == FTL_PAGES_PER_BLOCK)) {
+			blockState[activeBlock] = BLOCK_USED;
+			activeBlock = FTL_NO_BLOCK;
+		}
+		if (activeBlock == FTL_NO_BLOCK) {
+			/* Keep a free block for the collector. The pages it moves open a
+			   block and may fill it, so the active block is checked again. */
+			if ((allowCollect) && (freeBlocks <= 1)) {
+				err = ftlCollect();
+				if (err != NAND_FTL_OK) {
+					return err;
+				}
+				continue;
+			}
+			ftlAllocBlock();
+			if (activeBlock == FTL_NO_BLOCK) {
+				return NAND_FTL_ERR_FULL;
+			}
+		}
+
+		ftlPut32(spare + SPARE_SEQ, ++writeSeq);
+		ftlPut32(spare + SPARE_ERASES, blockErases[activeBlock]);
+		ftlMetaSeal(spare);
+
+		if (ftlProgram(activeBlock, activePage, buf) == 0) {
+			break;
+		}
+
+		/* Its other pages are still readable, the block is retired by the
+		   next collection and the page written to another block */
+		blockState[activeBlock] = BLOCK_RETIRE;
+		activeBlock = FTL_NO_BLOCK;
+	}
+
+	phys = pageMap[lpn];
+	if (phys != FTL_UNMAPPED) {
+		blockValid[phys / FTL_PAGES_PER_BLOCK]--;
+	}
+	pageMap[lpn] = (activeBlock * FTL_PAGES_PER_BLOCK) + activePage;
+	blockValid[activeBlock]++;
+	activePage++;
+
+	return NAND_FTL_OK;
+}
+
+/* Move the valid pages of a block and erase it */
+static NAND_FTL_ERR_T ftlCollect(void)
+{
+	uint8_t *buf = (uint8_t *) readBuf;
+	uint8_t *spare = buf + FTL_PAGE_SIZE;
+	uint32_t victim = FTL_NO_BLOCK;
+	uint32_t maxErases = 0;
+	uint32_t block, page, lpn, phys;
+	NAND_FTL_ERR_T err;
+
+	for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+		if (blockState[block] == BLOCK_RETIRE) {
+			victim = block;
+			break;
+		}
+		if ((blockState[block] != BLOCK_BAD) && (blockErases[block] > maxErases)) {
+			maxErases = blockErases[block];
+		}
+	}
+
+	/* Static wear levelling, reclaim the least worn block */
+	if ((victim == FTL_NO_BLOCK) && ((stats.collections % NAND_FTL_WEAR_INTERVAL) == (NAND_FTL_WEAR_INTERVAL - 1))) {
+		for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+			if ((blockState[block] == BLOCK_USED) &&
+				((victim == FTL_NO_BLOCK) || (blockErases[block] < blockErases[victim]))) {
+				victim = block;
+			}
+		}
+		if ((victim != FTL_NO_BLOCK) && ((blockErases[victim] + NAND_FTL_WEAR_THRESHOLD) <= maxErases)) {
+			stats.wearMoves++;
+		}
+		else {
+			victim = FTL_NO_BLOCK;
+		}
+	}
+
+	/* Otherwise reclaim the block with the fewest valid pages */
+	if (victim == FTL_NO_BLOCK) {
+		for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+			if ((blockState[block] == BLOCK_USED) &&
+				((victim == FTL_NO_BLOCK) || (blockValid[block] < blockValid[victim]))) {
+				victim = block;
+			}
+		}
+		if ((victim == FTL_NO_BLOCK) || (blockValid[victim] == FTL_PAGES_PER_BLOCK)) {
+			return NAND_FTL_ERR_FULL;
+		}
+	}
+	stats.collections++;
+
+	/* Move the pages still mapped to the block. A page with an uncorrectable
+	   error is moved marked bad, so reading it still fails and the block can
+	   be reclaimed. */
+	readLpn = FTL_UNMAPPED;
+	for (page = 0; (page < FTL_PAGES_PER_BLOCK) && (blockValid[victim] != 0); ++page) {
+		phys = (victim * FTL_PAGES_PER_BLOCK) + page;
+		err = ftlReadPage(phys, buf);
+		if (ftlMetaErased(spare)) {
+			break;
+		}
+		if (!ftlMetaCheck(spare)) {
+			continue;
+		}
+		lpn = ftlGet32(spare + SPARE_LPN);
+		if ((lpn < FTL_LOGICAL_PAGES) && (pageMap[lpn] == phys)) {
+			err = ftlWritePage(lpn, buf, 0, err == NAND_FTL_ERR_ECC);
+			if (err != NAND_FTL_OK) {
+				return err;
+			}
+		}
+	}
+
+	if ((blockState[victim] == BLOCK_RETIRE) || (ftlErase(victim) != 0)) {
+		ftlMarkBad(victim);
+	}
+	else {
+		blockState[victim] = BLOCK_FREE;
+		freeBlocks++;
+	}
+	blockValid[victim] = 0;
+
+	return NAND_FTL_OK;
+}
+
+/* Build the block states and page map from the NAND, erasing all good blocks
+   when formatting. A page description that can't be corrected is only
+   expected in the last page written to a block, cut by a power loss. In an
+   earlier page it may hide the newest copy of a logical page, so the mount
+   fails rather than map an older copy. */
+static NAND_FTL_ERR_T ftlScan(uint8_t format)
+{
+	const lpc_nandflash_size_t *pSize = lpc_nandflash_get_size();
+	uint8_t *spare = (uint8_t *) readBuf;
+	uint8_t oldSpare[FTL_SPARE_SIZE];
+	uint32_t block, page, lpn, phys, seq;
+	uint32_t described, badPage;
+	uint32_t known = 0;
+	uint64_t total = 0;
+	NAND_FTL_ERR_T err = NAND_FTL_OK;
+
+	mounted = 0;
+	if ((pSize->page_size != FTL_PAGE_SIZE) || (pSize->spare_size != FTL_SPARE_SIZE) ||
+		(pSize->pages_per_block != FTL_PAGES_PER_BLOCK) ||
+		((NAND_FTL_FIRST_BLOCK + NAND_FTL_BLOCKS) > pSize->block_cnt)) {
+		return NAND_FTL_ERR_GEOMETRY;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	memset(pageMap, 0xFF, sizeof(pageMap));
+	memset(blockValid, 0, sizeof(blockValid));
+	writeSeq = 0;
+
+	for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+		blockState[block] = BLOCK_FREE;
+		if (!format) {
+			blockErases[block] = 0;
+		}
+
+		/* Factory bad blocks are marked in the first or second page */
+		ftlReadSpare(block, 1, spare);
+		if (spare[SPARE_BADBLOCK] != 0xFF) {
+			blockState[block] = BLOCK_BAD;
+			stats.badBlocks++;
+			continue;
+		}
+		ftlReadSpare(block, 0, spare);
+		if (spare[SPARE_BADBLOCK] != 0xFF) {
+			blockState[block] = BLOCK_BAD;
+			stats.badBlocks++;
+			continue;
+		}
+
+		/* The erase count of a formatted block survives in its first page */
+		if (format) {
+			if ((ftlErase(block) != 0) || (ftlWriteErases(block) != 0)) {
+				ftlMarkBad(block);
+			}
+			continue;
+		}
+
+		described = 0;
+		badPage = FTL_NO_PAGE;
+		for (page = 0; page < FTL_PAGES_PER_BLOCK; ++page) {
+			if (page != 0) {
+				ftlReadSpare(block, page, spare);
+			}
+			if (ftlMetaErased(spare)) {
+				break;
+			}
+			if (!ftlMetaCheck(spare)) {
+				blockState[block] = BLOCK_USED;
+				if (badPage == FTL_NO_PAGE) {
+					badPage = page;
+				}
+				continue;
+			}
+			described++;
+
+			if (blockErases[block] == 0) {
+				blockErases[block] = ftlGet32(spare + SPARE_ERASES);
+				total += blockErases[block];
+				known++;
+			}
+
+			lpn = ftlGet32(spare + SPARE_LPN);
+			if (lpn == FTL_LPN_ERASES) {
+				continue;
+			}
+			blockState[block] = BLOCK_USED;
+
+			/* The copy of a page written last is valid */
+			seq = ftlGet32(spare + SPARE_SEQ);
+			if (seq > writeSeq) {
+				writeSeq = seq;
+			}
+			if (lpn < FTL_LOGICAL_PAGES) {
+				phys = pageMap[lpn];
+				if (phys != FTL_UNMAPPED) {
+					ftlReadSpare(phys / FTL_PAGES_PER_BLOCK, phys % FTL_PAGES_PER_BLOCK, oldSpare);
+					ftlMetaCheck(oldSpare);
+					if (ftlGet32(oldSpare + SPARE_SEQ) > seq) {
+						continue;
+					}
+				}
+				pageMap[lpn] = (block * FTL_PAGES_PER_BLOCK) + page;
+			}
+		}
+
+		/* Blocks without any page description were written by other software */
+		if ((described != 0) && (badPage != FTL_NO_PAGE) && (badPage != (page - 1))) {
+			err = NAND_FTL_ERR_ECC;
+		}
+	}
+	readLpn = FTL_UNMAPPED;
+
+	/* Blocks without a page description get the average erase count */
+	freeBlocks = 0;
+	for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+		if ((!format) && (blockState[block] != BLOCK_BAD) && (blockErases[block] == 0) && (known != 0)) {
+			blockErases[block] = (uint32_t) (total / known);
+		}
+		if (blockState[block] == BLOCK_FREE) {
+			freeBlocks++;
+		}
+	}
+	for (lpn = 0; lpn < FTL_LOGICAL_PAGES; ++lpn) {
+		if (pageMap[lpn] != FTL_UNMAPPED) {
+			blockValid[pageMap[lpn] / FTL_PAGES_PER_BLOCK]++;
+		}
+	}
+
+	if (err != NAND_FTL_OK) {
+		return err;
+	}
+	if ((NAND_FTL_BLOCKS - stats.badBlocks) < ((FTL_LOGICAL_PAGES / FTL_PAGES_PER_BLOCK) + 2)) {
+		return NAND_FTL_ERR_BADBLOCKS;
+	}
+
+	activeBlock = FTL_NO_BLOCK;
+	cacheLpn = FTL_UNMAPPED;
+	cacheDirty = 0;
+	mounted = 1;
+
+	return NAND_FTL_OK;
+}
+
+/* Copy the data of a logical page into a page buffer */
+static NAND_FTL_ERR_T ftlLoadPage(uint32_t lpn, uint8_t *buf)
+{
+	if (pageMap[lpn] == FTL_UNMAPPED) {
+		memset(buf, 0xFF, FTL_PAGE_SIZE);
+		return NAND_FTL_OK;
+	}
+
+	return ftlReadPage(pageMap[lpn], buf);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Calculate the ECC code of one ECC step */
+void nand_ftl_ecc_calculate(const uint8_t *data, uint8_t *ecc)
+{
+	ftlEccCalculate(data, NAND_FTL_ECC_STEP, ecc);
+}
+
+/* Check and correct one ECC step */
+int nand_ftl_ecc_correct(uint8_t *data, const uint8_t *ecc)
+{
+	return ftlEccCorrect(data, NAND_FTL_ECC_STEP, ecc);
+}
+
+/* Mount the FTL */
+NAND_FTL_ERR_T nand_ftl_mount(void)
+{
+	return ftlScan(0);
+}
+
+/* Erase the FTL region and mount it */
+NAND_FTL_ERR_T nand_ftl_format(void)
+{
+	/* Erase counts are read from the NAND when the region isn't mounted, a
+	   region that doesn't mount still gives the counts it has */
+	if (!mounted) {
+		ftlScan(0);
+	}
+	return ftlScan(1);
+}
+
+/* Return the logical capacity */
+uint32_t nand_ftl_get_sector_count(void)
+{
+	return FTL_LOGICAL_PAGES * FTL_SECTORS_PER_PAGE;
+}
+
+/* Return the number of sectors in an erase block */
+uint32_t nand_ftl_get_block_sectors(void)
+{
+	return FTL_PAGES_PER_BLOCK * FTL_SECTORS_PER_PAGE;
+}
+
+/* Read sectors */
+NAND_FTL_ERR_T nand_ftl_read(uint8_t *buff, uint32_t sector, uint32_t count)
+{
+	NAND_FTL_ERR_T err;
+	uint32_t lpn;
+	uint8_t *src;
+
+	if (!mounted) {
+		return NAND_FTL_ERR_NOTMOUNTED;
+	}
+	if ((sector + count) > nand_ftl_get_sector_count()) {
+		return NAND_FTL_ERR_RANGE;
+	}
+
+	while (count) {
+		lpn = sector / FTL_SECTORS_PER_PAGE;
+		if (lpn == cacheLpn) {
+			src = (uint8_t *) cacheBuf;
+		}
+		else {
+			if (lpn != readLpn) {
+				readLpn = FTL_UNMAPPED;
+				err = ftlLoadPage(lpn, (uint8_t *) readBuf);
+				if (err != NAND_FTL_OK) {
+					return err;
+				}
+				readLpn = lpn;
+			}
+			src = (uint8_t *) readBuf;
+		}
+
+		memcpy(buff, src + ((sector % FTL_SECTORS_PER_PAGE) * NAND_FTL_SECTOR_SIZE), NAND_FTL_SECTOR_SIZE);
+		buff += NAND_FTL_SECTOR_SIZE;
+		sector++;
+		count--;
+	}
+
+	return NAND_FTL_OK;
+}
+
+/* Write sectors */
+NAND_FTL_ERR_T nand_ftl_write(const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+	NAND_FTL_ERR_T err;
+	uint32_t lpn;
+
+	if (!mounted) {
+		return NAND_FTL_ERR_NOTMOUNTED;
+	}
+	if ((sector + count) > nand_ftl_get_sector_count()) {
+		return NAND_FTL_ERR_RANGE;
+	}
+
+	while (count) {
+		lpn = sector / FTL_SECTORS_PER_PAGE;
+		if (lpn != cacheLpn) {
+			err = nand_ftl_sync();
+			if (err != NAND_FTL_OK) {
+				return err;
+			}
+
+			/* A page that is written whole isn't read first */
+			cacheLpn = FTL_UNMAPPED;
+			if (((sector % FTL_SECTORS_PER_PAGE) != 0) || (count < FTL_SECTORS_PER_PAGE)) {
+				if (lpn == readLpn) {
+					memcpy(cacheBuf, readBuf, FTL_PAGE_SIZE);
+				}
+				else {
+					err = ftlLoadPage(lpn, (uint8_t *) cacheBuf);
+					if (err != NAND_FTL_OK) {
+						return err;
+					}
+				}
+			}
+			cacheLpn = lpn;
+		}
+		if (lpn == readLpn) {
+			readLpn = FTL_UNMAPPED;
+		}
+
+		memcpy((uint8_t *) cacheBuf + ((sector % FTL_SECTORS_PER_PAGE) * NAND_FTL_SECTOR_SIZE), buff,
+			   NAND_FTL_SECTOR_SIZE);
+		cacheDirty = 1;
+		buff += NAND_FTL_SECTOR_SIZE;
+		sector++;
+		count--;
+	}
+
+	return NAND_FTL_OK;
+}
+
+/* Program the cached page */
+NAND_FTL_ERR_T nand_ftl_sync(void)
+{
+	NAND_FTL_ERR_T err;
+
+	if (!mounted) {
+		return NAND_FTL_ERR_NOTMOUNTED;
+	}
+	if (!cacheDirty) {
+		return NAND_FTL_OK;
+	}
+
+	err = ftlWritePage(cacheLpn, (uint8_t *) cacheBuf, 1, 0);
+	if (err == NAND_FTL_OK) {
+		cacheDirty = 0;
+		stats.hostPages++;
+	}
+	return err;
+}
+
+/* Return the FTL statistics */
+const NAND_FTL_STATS_T *nand_ftl_get_stats(void)
+{
+	uint32_t block;
+
+	stats.maxEraseCount = 0;
+	stats.minEraseCount = 0xFFFFFFFF;
+	for (block = 0; block < NAND_FTL_BLOCKS; ++block) {
+		if (blockState[block] != BLOCK_BAD) {
+			if (blockErases[block] > stats.maxEraseCount) {
+				stats.maxEraseCount = blockErases[block];
+			}
+			if (blockErases[block] < stats.minEraseCount) {
+				stats.minEraseCount = blockErases[block];
+			}
+		}
+	}
+	return &stats;
+}
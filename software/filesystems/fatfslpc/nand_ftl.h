@@ -0,0 +1,222 @@
+/*
+ * @brief NAND flash translation layer for the Chan FATFS disk interface
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2015
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __NAND_FTL_H_
+#define __NAND_FTL_H_
+
+#include "board.h"
+#include "lpc_nandflash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup LPCOPEN_FSLIBS_CHANFATFS_FSNAND NAND flash based file system support
+ * @ingroup LPCOPEN_FSLIBS_CHANFATFS
+ * A page mapped flash translation layer (FTL) presenting a region of a large
+ * page NAND flash (lpc_nandflash.h driver) as an array of 512 byte sectors.
+ * Each logical page is written to the next free physical page, with its
+ * logical page number, a write sequence number and the block erase count in
+ * the spare area, so the mapping is rebuilt by scanning the spare areas at
+ * mount. Each 256 bytes of a page, and the page description in the spare
+ * area, are protected by a 3 byte Hamming code (single bit correction, double
+ * bit detection). A description that can't be corrected is only accepted in
+ * the last page written to a block, where a power loss may have cut it.
+ * Format writes the erase count of each block to its first page.
+ *
+ * Blocks marked bad in the spare area of their first two pages, and blocks
+ * that fail to program or erase, are never used. Free blocks are allocated
+ * lowest erase count first, and the garbage collector reclaims the block with
+ * the fewest valid pages. Every @ref NAND_FTL_WEAR_INTERVAL collections, a
+ * block whose erase count is @ref NAND_FTL_WEAR_THRESHOLD below the highest
+ * count is reclaimed instead, so blocks holding static data are also worn.
+ * A page with an uncorrectable error is moved marked bad, reading it returns
+ * NAND_FTL_ERR_ECC until the page is written again.
+ *
+ * Writes are gathered per page in a one page cache that is programmed when
+ * another page is written, or on nand_ftl_sync(). The RAM needed is 2 bytes
+ * per logical page plus 6 bytes per block.
+ *
+ * The board layer must provide the Board_NANDFLash_* functions of
+ * lpc_nandflash.h. The LPCXpresso 4337 board has no NAND flash, so no
+ * project of this tree builds the FTL.
+ * @{
+ */
+
+/** First NAND block used by the FTL */
+#ifndef NAND_FTL_FIRST_BLOCK
+#define NAND_FTL_FIRST_BLOCK        0
+#endif
+
+/** Number of NAND blocks used by the FTL, at most 1023 */
+#ifndef NAND_FTL_BLOCKS
+#define NAND_FTL_BLOCKS             128
+#endif
+
+/** Number of blocks kept out of the logical capacity for bad blocks and garbage collection, at least 3 */
+#ifndef NAND_FTL_SPARE_BLOCKS
+#define NAND_FTL_SPARE_BLOCKS       8
+#endif
+
+/** Number of garbage collections between static wear levelling checks */
+#define NAND_FTL_WEAR_INTERVAL      16
+
+/** Erase count difference that makes a block a static wear levelling victim */
+#define NAND_FTL_WEAR_THRESHOLD     64
+
+/** Size of a logical sector */
+#define NAND_FTL_SECTOR_SIZE        512
+
+/** Size of the data protected by one ECC code */
+#define NAND_FTL_ECC_STEP           256
+
+/** Size of one ECC code */
+#define NAND_FTL_ECC_BYTES          3
+
+/**
+ * @brief	FTL error codes
+ */
+typedef enum {
+	NAND_FTL_OK = 0,				/*!< No error */
+	NAND_FTL_ERR_NOTMOUNTED,		/*!< nand_ftl_mount() was not called or failed */
+	NAND_FTL_ERR_GEOMETRY,			/*!< NAND geometry or FTL region not supported */
+	NAND_FTL_ERR_RANGE,				/*!< Sector out of the logical capacity */
+	NAND_FTL_ERR_ECC,				/*!< Uncorrectable data error */
+	NAND_FTL_ERR_BADBLOCKS,			/*!< Not enough good blocks for the logical capacity */
+	NAND_FTL_ERR_FULL				/*!< No block could be reclaimed */
+} NAND_FTL_ERR_T;
+
+/**
+ * @brief	FTL statistics, cleared by nand_ftl_mount()
+ */
+typedef struct {
+	uint32_t hostPages;				/*!< Logical pages written by the host */
+	uint32_t nandPages;				/*!< Physical pages programmed, including garbage collection */
+	uint32_t erases;				/*!< Blocks erased */
+	uint32_t collections;			/*!< Garbage collections run */
+	uint32_t wearMoves;				/*!< Collections made for static wear levelling */
+	uint32_t eccCorrected;			/*!< ECC steps with a corrected bit */
+	uint32_t eccFailed;				/*!< ECC steps with an uncorrectable error */
+	uint32_t badBlocks;				/*!< Bad blocks, factory marked or retired */
+	uint32_t maxEraseCount;			/*!< Highest block erase count */
+	uint32_t minEraseCount;			/*!< Lowest erase count of a good block */
+} NAND_FTL_STATS_T;
+
+/**
+ * @brief	Calculate the ECC code of one ECC step
+ * @param	data	: NAND_FTL_ECC_STEP bytes of data
+ * @param	ecc		: Where to store the NAND_FTL_ECC_BYTES bytes code
+ * @return	Nothing
+ * @note	The code of erased (all 0xFF) data is all 0xFF.
+ */
+void nand_ftl_ecc_calculate(const uint8_t *data, uint8_t *ecc);
+
+/**
+ * @brief	Check and correct one ECC step
+ * @param	data	: NAND_FTL_ECC_STEP bytes of data read back
+ * @param	ecc		: NAND_FTL_ECC_BYTES bytes code read back with the data
+ * @return	0 if the data is correct, 1 if a bit was corrected (in the data or
+ * the code) or -1 if the error can't be corrected
+ */
+int nand_ftl_ecc_correct(uint8_t *data, const uint8_t *ecc);
+
+/**
+ * @brief	Mount the FTL, rebuilding the page map from the spare areas
+ * @return	NAND_FTL_OK, NAND_FTL_ERR_GEOMETRY, NAND_FTL_ERR_ECC or NAND_FTL_ERR_BADBLOCKS
+ * @note	The NAND driver must have been initialized. A blank region mounts as
+ * an unformatted disk, and blocks written by other software are reclaimed.
+ * NAND_FTL_ERR_ECC is returned when a page description can't be corrected,
+ * as an older copy of the page would be used in its place.
+ */
+NAND_FTL_ERR_T nand_ftl_mount(void);
+
+/**
+ * @brief	Erase all good blocks of the FTL region and mount it empty
+ * @return	NAND_FTL_OK, NAND_FTL_ERR_GEOMETRY or NAND_FTL_ERR_BADBLOCKS
+ * @note	The erase counts are kept, they are read from the region first when
+ * it isn't mounted.
+ */
+NAND_FTL_ERR_T nand_ftl_format(void);
+
+/**
+ * @brief	Return the logical capacity
+ * @return	Number of NAND_FTL_SECTOR_SIZE sectors
+ */
+uint32_t nand_ftl_get_sector_count(void);
+
+/**
+ * @brief	Return the number of sectors sharing an erase block
+ * @return	Number of NAND_FTL_SECTOR_SIZE sectors
+ */
+uint32_t nand_ftl_get_block_sectors(void);
+
+/**
+ * @brief	Read sectors
+ * @param	buff	: Buffer to read into
+ * @param	sector	: First sector
+ * @param	count	: Number of sectors
+ * @return	NAND_FTL_OK or a NAND_FTL_ERR_* error
+ * @note	Sectors never written read as 0xFF.
+ */
+NAND_FTL_ERR_T nand_ftl_read(uint8_t *buff, uint32_t sector, uint32_t count);
+
+/**
+ * @brief	Write sectors
+ * @param	buff	: Data to write
+ * @param	sector	: First sector
+ * @param	count	: Number of sectors
+ * @return	NAND_FTL_OK or a NAND_FTL_ERR_* error
+ * @note	The last written page may be kept in the cache until nand_ftl_sync().
+ */
+NAND_FTL_ERR_T nand_ftl_write(const uint8_t *buff, uint32_t sector, uint32_t count);
+
+/**
+ * @brief	Program the cached page
+ * @return	NAND_FTL_OK or a NAND_FTL_ERR_* error
+ */
+NAND_FTL_ERR_T nand_ftl_sync(void);
+
+/**
+ * @brief	Return the FTL statistics
+ * @return	Pointer to the statistics
+ * @note	The write amplification is nandPages / hostPages.
+ */
+const NAND_FTL_STATS_T *nand_ftl_get_stats(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NAND_FTL_H_ */
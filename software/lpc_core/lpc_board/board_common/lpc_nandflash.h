@@ -40,6 +40,9 @@ extern "C" {
 
 /** @defgroup BOARD_NANDFLASH BOARD: Board specific NAND Flash drivers
  * @ingroup BOARD_Common
+ * The driver needs the Board_NANDFLash_* functions and, for the EMC paths,
+ * BOARD_NAND_DATA_ADDR from the board layer. No board in this tree has a
+ * NAND FLASH, so none provides them and no project builds this driver.
  * @{
  */
 
@@ -100,6 +103,7 @@ void lpc_nandflash_erase_block(uint32_t block);
  * @param	size	: the number of written bytes
  * @return	The number of written bytes
  * @note	After returning from this function, read the status to get the result.
+ * Data is written with word accesses when the board defines BOARD_NAND_DATA_ADDR.
  */
 uint32_t lpc_nandflash_write_page(uint32_t block, uint32_t page, uint8_t *data, uint32_t size);
 
@@ -109,6 +113,7 @@ uint32_t lpc_nandflash_write_page(uint32_t block, uint32_t page, uint8_t *data,
  * @param	page	: page index
  * @param	ofs		: offset in page
  * @return	Nothing
+ * @note	Returns once the page is loaded, data can be read with lpc_nandflash_read_data().
  */
 void lpc_nandflash_read_start(uint32_t block, uint32_t page, uint32_t ofs);
 
@@ -117,9 +122,28 @@ void lpc_nandflash_read_start(uint32_t block, uint32_t page, uint32_t ofs);
  * @param	data	: pointer to buffer to read
  * @param	size	: the number of read bytes
  * @return	Nothing
+ * @note	When the board defines BOARD_NAND_DATA_ADDR, the address of the NAND
+ * data port in the EMC window, data is moved with word accesses instead of
+ * Board_NANDFLash_ReadByte() calls. The data port must decode the four
+ * consecutive addresses the EMC uses to split a word access.
  */
 void lpc_nandflash_read_data(uint8_t *data, uint32_t size);
 
+#if defined(BOARD_NAND_DATA_ADDR)
+/**
+ * @brief	Read data from NAND FLASH with a GPDMA memory to memory transfer
+ * @param	data		: pointer to buffer to read
+ * @param	size		: the number of read bytes
+ * @param	ChannelNum	: free GPDMA channel, obtained with Chip_GPDMA_GetFreeChannel()
+ * @return	ERROR if the channel is busy, SUCCESS otherwise
+ * @note	Waits for the end of the transfer. Bytes before the first word
+ * boundary of @a data and after the last full word are read by the CPU.
+ * Chip_GPDMA_Init() must have been called.
+ */
+Status lpc_nandflash_read_data_dma(uint8_t *data, uint32_t size, uint8_t ChannelNum);
+
+#endif
+
 /**
  * @}
  */
@@ -44,6 +44,15 @@
 /* Get column address of a page in a block */
 #define COLUMN_ADDR(block, page)      (block *  K9F1G_PAGES_PER_BLOCK + page)
 
+#if defined(BOARD_NAND_DATA_ADDR)
+/* Data port, the EMC splits word accesses into four byte cycles in address order */
+#define NAND_DATA8                    (*(volatile uint8_t *) BOARD_NAND_DATA_ADDR)
+#define NAND_DATA32                   (*(volatile uint32_t *) BOARD_NAND_DATA_ADDR)
+
+/* Maximum number of words moved by one DMA descriptor */
+#define NAND_DMA_MAX_WORDS            0xFFC
+#endif
+
 /* NAND information */
 static const lpc_nandflash_size_t nandSize = {
 	K9F1G_PAGE_SIZE,  K9F1G_SPARE_SIZE,  K9F1G_PAGES_PER_BLOCK,  K9F1G_BLOCK_COUNT
@@ -149,10 +158,24 @@ uint32_t lpc_nandflash_write_page(uint32_t block, uint32_t page, uint8_t *data,
 	Board_NANDFLash_WriteAddr((row >> 8) & 0xFF);
 
 	/*Write data */
+#if defined(BOARD_NAND_DATA_ADDR)
+	while ((i < size) && (((uint32_t) data & 3) != 0)) {
+		NAND_DATA8 = *data++;
+		i++;
+	}
+	for (; (i + 4) <= size; i += 4) {
+		NAND_DATA32 = *(uint32_t *) data;
+		data += 4;
+	}
+	for (; i < size; i++) {
+		NAND_DATA8 = *data++;
+	}
+#else
 	for (i = 0; i < size; i++) {
 		Board_NANDFLash_WriteByte(*data);
 		data++;
 	}
+#endif
 
 	Board_NANDFLash_WriteCmd(K9F1G_PAGE_PROGRAM_2);
 #if defined(BOARD_NAND_LOCKEDCS)
@@ -178,6 +201,11 @@ void lpc_nandflash_read_start(uint32_t block, uint32_t page, uint32_t ofs)
 	Board_NANDFLash_WriteAddr((row >> 8) & 0xFF);
 
 	Board_NANDFLash_WriteCmd(K9F1G_READ_2);
+
+	/* Wait for the page to be loaded, then return to data output */
+	Board_NANDFLash_WriteCmd(K9F1G_READ_STATUS);
+	while ((Board_NANDFLash_ReadByte() & NANDFLASH_STATUS_DEV_READY) == 0) {}
+	Board_NANDFLash_WriteCmd(K9F1G_READ_1);
 #if defined(BOARD_NAND_LOCKEDCS)
 	Board_NANDFLash_CSLatch(false);
 #endif
@@ -191,15 +219,91 @@ void lpc_nandflash_read_data(uint8_t *data, uint32_t size)
 #if defined(BOARD_NAND_LOCKEDCS)
 	Board_NANDFLash_CSLatch(true);
 #endif
+#if defined(BOARD_NAND_DATA_ADDR)
+	while ((i < size) && (((uint32_t) data & 3) != 0)) {
+		*data++ = NAND_DATA8;
+		i++;
+	}
+	for (; (i + 16) <= size; i += 16) {
+		((uint32_t *) data)[0] = NAND_DATA32;
+		((uint32_t *) data)[1] = NAND_DATA32;
+		((uint32_t *) data)[2] = NAND_DATA32;
+		((uint32_t *) data)[3] = NAND_DATA32;
+		data += 16;
+	}
+	for (; (i + 4) <= size; i += 4) {
+		*(uint32_t *) data = NAND_DATA32;
+		data += 4;
+	}
+	for (; i < size; i++) {
+		*data++ = NAND_DATA8;
+	}
+#else
 	for (i = 0; i < size; i++) {
 		*data = Board_NANDFLash_ReadByte();
 		data++;
 	}
+#endif
 #if defined(BOARD_NAND_LOCKEDCS)
 	Board_NANDFLash_CSLatch(false);
 #endif
 }
 
+#if defined(BOARD_NAND_DATA_ADDR)
+/* Read data from flash with the GPDMA */
+Status lpc_nandflash_read_data_dma(uint8_t *data, uint32_t size, uint8_t ChannelNum)
+{
+	DMA_TransferDescriptor_t desc;
+	uint32_t words;
+	Status ret = SUCCESS;
+
+	/* The DMA moves the aligned words, the CPU the bytes around them */
+	while ((size != 0) && (((uint32_t) data & 3) != 0)) {
+		lpc_nandflash_read_data(data++, 1);
+		size--;
+	}
+
+#if defined(BOARD_NAND_LOCKEDCS)
+	Board_NANDFLash_CSLatch(true);
+#endif
+	while ((ret == SUCCESS) && (size >= 4)) {
+		words = size / 4;
+		if (words > NAND_DMA_MAX_WORDS) {
+			words = NAND_DMA_MAX_WORDS;
+		}
+
+		/* Fixed source address, the data port is the same for every word */
+		desc.src = BOARD_NAND_DATA_ADDR;
+		desc.dst = (uint32_t) data;
+		desc.lli = 0;
+		desc.ctrl = GPDMA_DMACCxControl_TransferSize(words)
+					| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4)
+					| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4)
+					| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD)
+					| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD)
+					| GPDMA_DMACCxControl_DI
+					| GPDMA_DMACCxControl_I;
+		ret = Chip_GPDMA_SGTransfer(LPC_GPDMA, ChannelNum, &desc, GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
+		if (ret == SUCCESS) {
+			/* The channel disables itself at the end of the transfer */
+			while (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, ChannelNum) == SET) {}
+			Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, ChannelNum);
+			data += words * 4;
+			size -= words * 4;
+		}
+	}
+#if defined(BOARD_NAND_LOCKEDCS)
+	Board_NANDFLash_CSLatch(false);
+#endif
+
+	if ((ret == SUCCESS) && (size != 0)) {
+		lpc_nandflash_read_data(data, size);
+	}
+	return ret;
+}
+
+#endif
+
 /**
  * @}
  */
@@ -40,6 +40,9 @@ extern "C" {
 
 /** @defgroup BOARD_NORFLASH BOARD: Board specific NOR Flash drivers
  * @ingroup BOARD_Common
+ * The driver needs the Board_NorFlash_* functions and, for the EMC paths,
+ * BOARD_NORFLASH_BASE_ADDR from the board layer. No board in this tree has
+ * a NOR FLASH, so none provides them and no project builds this driver.
  * @{
  */
 
@@ -106,10 +109,40 @@ void lpc_norflash_write_word(UNS_32 addr, UNS_16 data);
  * @param	data	: Pointer to data to write
  * @param	size	The number of  (bytes)
  * @return	The number of written bytes
- * @note	addr must be word-aligned.
+ * @note	addr must be word-aligned. 0xFFFF words are skipped, programming
+ * them leaves the flash unchanged. The SST39VF320 takes one word per program
+ * command and ignores commands until the word is programmed (about 7us), so
+ * words are not overlapped: each word is programmed, then polled until done.
  */
 UNS_32 lpc_norflash_write_buffer(UNS_32 addr, UNS_16 *data, UNS_32 size);
 
+/**
+ * @brief	Read buffer from flash
+ * @param	addr	: Address
+ * @param	data	: Pointer to where to place the data
+ * @param	size	: The number of bytes to read
+ * @return	Nothing
+ * @note	addr must be word-aligned. When the board defines BOARD_NORFLASH_BASE_ADDR,
+ * the address of the NOR FLASH in the EMC window, the flash is read with word
+ * accesses instead of Board_NorFlash_ReadWord() calls.
+ */
+void lpc_norflash_read_buffer(UNS_32 addr, UNS_16 *data, UNS_32 size);
+
+#if defined(BOARD_NORFLASH_BASE_ADDR)
+/**
+ * @brief	Read buffer from flash with a GPDMA memory to memory transfer
+ * @param	addr		: Address
+ * @param	data		: Pointer to where to place the data
+ * @param	size		: The number of bytes to read
+ * @param	ChannelNum	: free GPDMA channel, obtained with Chip_GPDMA_GetFreeChannel()
+ * @return	ERROR if the channel is busy, SUCCESS otherwise
+ * @note	Waits for the end of the transfer. Buffers that are not word aligned
+ * are read by the CPU. Chip_GPDMA_Init() must have been called.
+ */
+Status lpc_norflash_read_buffer_dma(UNS_32 addr, UNS_16 *data, UNS_32 size, uint8_t ChannelNum);
+
+#endif
+
 /**
  * @brief	Read data from flash
  * @param	addr	: Address
@@ -50,6 +50,11 @@
 /* Toggle bit */
 #define TOGGLE_BIT                   (1 << 6)		/* DQ6 */
 
+#if defined(BOARD_NORFLASH_BASE_ADDR)
+/* Maximum number of words moved by one DMA transfer */
+#define NOR_DMA_MAX_WORDS            0xFFC
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -142,14 +147,95 @@ void lpc_norflash_write_word(UNS_32 addr, UNS_16 data)
 UNS_32 lpc_norflash_write_buffer(UNS_32 addr, UNS_16 *data, UNS_32 size)
 {
 	UNS_32 i = 0;
+	UNS_16 value, prev, cur;
+
 	for (i = 0; i < size; i += 2) {
-		lpc_norflash_write_word(addr + i, *data);
-		while (!lpc_norflash_toggle_bit_check(addr + i)) {}
-		data++;
+		value = *data++;
+
+		/* Programming can only clear bits, 0xFFFF words are skipped */
+		if (value == 0xFFFF) {
+			continue;
+		}
+		lpc_norflash_write_word(addr + i, value);
+
+		/* Toggle bit polling with one read per poll, each read is compared
+		   with the previous one */
+		prev = Board_NorFlash_ReadWord(addr + i);
+		do {
+			cur = prev;
+			prev = Board_NorFlash_ReadWord(addr + i);
+		} while ((cur ^ prev) & TOGGLE_BIT);
 	}
 	return i;
 }
 
+/* Read buffer from flash */
+void lpc_norflash_read_buffer(UNS_32 addr, UNS_16 *data, UNS_32 size)
+{
+#if defined(BOARD_NORFLASH_BASE_ADDR)
+	const volatile UNS_16 *src = (const volatile UNS_16 *) (BOARD_NORFLASH_BASE_ADDR + addr);
+
+	/* Word reads are split into two halfword cycles by the EMC */
+	if ((((UNS_32) data & 3) == 0) && (((UNS_32) src & 3) == 0)) {
+		for (; size >= 16; size -= 16) {
+			((UNS_32 *) data)[0] = ((const volatile UNS_32 *) src)[0];
+			((UNS_32 *) data)[1] = ((const volatile UNS_32 *) src)[1];
+			((UNS_32 *) data)[2] = ((const volatile UNS_32 *) src)[2];
+			((UNS_32 *) data)[3] = ((const volatile UNS_32 *) src)[3];
+			data += 8;
+			src += 8;
+		}
+	}
+	for (; size >= 2; size -= 2) {
+		*data++ = *src++;
+	}
+#else
+	for (; size >= 2; size -= 2) {
+		*data++ = Board_NorFlash_ReadWord(addr);
+		addr += 2;
+	}
+#endif
+}
+
+#if defined(BOARD_NORFLASH_BASE_ADDR)
+/* Read buffer from flash with the GPDMA */
+Status lpc_norflash_read_buffer_dma(UNS_32 addr, UNS_16 *data, UNS_32 size, uint8_t ChannelNum)
+{
+	UNS_32 src = BOARD_NORFLASH_BASE_ADDR + addr;
+	UNS_32 len;
+
+	/* Unaligned buffers are read by the CPU */
+	if ((((UNS_32) data | src) & 3) != 0) {
+		lpc_norflash_read_buffer(addr, data, size);
+		return SUCCESS;
+	}
+
+	while (size >= 4) {
+		len = size & ~3;
+		if (len > (NOR_DMA_MAX_WORDS * 4)) {
+			len = NOR_DMA_MAX_WORDS * 4;
+		}
+		if (Chip_GPDMA_Transfer(LPC_GPDMA, ChannelNum, src, (UNS_32) data,
+								GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA, len) == ERROR) {
+			return ERROR;
+		}
+
+		/* The channel disables itself at the end of the transfer */
+		while (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, ChannelNum) == SET) {}
+		Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, ChannelNum);
+		src += len;
+		data += len / 2;
+		size -= len;
+	}
+
+	if (size >= 2) {
+		*data = *(const volatile UNS_16 *) src;
+	}
+	return SUCCESS;
+}
+
+#endif
+
 /* Read 16-bit data from flash */
 UNS_16 lpc_norflash_read_word(UNS_32 addr)
 {
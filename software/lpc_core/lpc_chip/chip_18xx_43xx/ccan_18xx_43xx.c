@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include "string.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -102,6 +103,393 @@ STATIC CHIP_CCU_CLK_T Chip_CCAN_GetClockIndex(LPC_CCAN_T *pCCAN)
 	return clkCCAN;
 }
 
+/* Mask the interrupts while the manager changes, frames may be sent from
+   any interrupt priority */
+STATIC INLINE uint32_t mgrLock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+STATIC INLINE void mgrUnlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Index of the highest set bit, the M0 core has no CLZ instruction */
+STATIC INLINE uint32_t mgrHighestBit(uint32_t bits)
+{
+#if (__CORTEX_M >= 0x03)
+	return 31 - __CLZ(bits);
+#else
+	uint32_t index = 0;
+
+	while (bits >>= 1) {
+		index++;
+	}
+	return index;
+#endif
+}
+
+/* Index of the lowest set bit */
+STATIC INLINE uint32_t mgrLowestBit(uint32_t bits)
+{
+	return mgrHighestBit(bits & (0 - bits));
+}
+
+/* Interrupt pending bits of the message objects, bit n for object n + 1 */
+STATIC INLINE uint32_t mgrGetIntPend(LPC_CCAN_T *pCCAN)
+{
+	return pCCAN->IR1 | (pCCAN->IR2 << 16);
+}
+
+/* Arbitration priority of a frame, lower wins: the 11 bit base ID, then a
+   standard frame before an extended one, then the rest of an extended ID */
+STATIC INLINE uint32_t mgrTxKey(uint32_t id)
+{
+	if (id & CCAN_MSG_ID_EXT_FLAG) {
+		return (((id >> 18) & CCAN_MSG_ID_STD_MASK) << 19) | (1UL << 18) | (id & 0x3FFFF);
+	}
+	return (id & CCAN_MSG_ID_STD_MASK) << 19;
+}
+
+/* Check if a transmit queue entry goes before another one */
+STATIC INLINE bool mgrTxBefore(const CCAN_TXQ_ENTRY_T *pA, const CCAN_TXQ_ENTRY_T *pB)
+{
+	return (pA->key < pB->key) || ((pA->key == pB->key) && ((int32_t) (pA->seq - pB->seq) < 0));
+}
+
+/* Add a frame to the transmit heap, called with the manager locked and a free entry */
+STATIC void mgrTxPush(CCAN_MGR_T *pMgr, const CCAN_MSG_OBJ_T *pMsg)
+{
+	CCAN_TXQ_ENTRY_T *pQ = pMgr->pTxQueue;
+	CCAN_TXQ_ENTRY_T entry;
+	uint32_t i, parent;
+
+	entry.key = mgrTxKey(pMsg->id);
+	entry.seq = pMgr->txSeq++;
+	entry.msg = *pMsg;
+
+	for (i = pMgr->txQueued++; i > 0; i = parent) {
+		parent = (i - 1) / 2;
+		if (!mgrTxBefore(&entry, &pQ[parent])) {
+			break;
+		}
+		pQ[i] = pQ[parent];
+	}
+	pQ[i] = entry;
+}
+
+/* Remove the first frame of the transmit heap, called with the manager locked
+   and the heap not empty */
+STATIC void mgrTxPop(CCAN_MGR_T *pMgr, CCAN_MSG_OBJ_T *pMsg)
+{
+	CCAN_TXQ_ENTRY_T *pQ = pMgr->pTxQueue;
+	CCAN_TXQ_ENTRY_T *pLast;
+	uint32_t i, child, count;
+
+	*pMsg = pQ[0].msg;
+	count = --pMgr->txQueued;
+	pLast = &pQ[count];
+
+	for (i = 0; (child = (2 * i) + 1) < count; i = child) {
+		if (((child + 1) < count) && mgrTxBefore(&pQ[child + 1], &pQ[child])) {
+			child++;
+		}
+		if (!mgrTxBefore(&pQ[child], pLast)) {
+			break;
+		}
+		pQ[i] = pQ[child];
+	}
+	pQ[i] = *pLast;
+}
+
+/* Move the first queued frames into the free transmit objects, called with
+   the manager locked. The controller sends the pending object with the
+   lowest number first, whatever its ID, so frames only go into objects above
+   the highest pending one. A freed object is refilled once the objects above
+   it are sent, and a loaded frame is never overtaken. */
+STATIC void mgrLoadTx(CCAN_MGR_T *pMgr)
+{
+	CCAN_MSG_OBJ_T msg;
+	uint32_t busy, avail, obj;
+
+	avail = pMgr->txFree;
+	busy = pMgr->txObjs & ~avail;
+	if (busy != 0) {
+		avail &= ~((2UL << (mgrHighestBit(busy))) - 1);
+	}
+
+	while ((avail != 0) && (pMgr->txQueued != 0)) {
+		obj = mgrLowestBit(avail);
+		avail &= avail - 1;
+		pMgr->txFree &= ~(1UL << obj);
+		mgrTxPop(pMgr, &msg);
+		Chip_CCAN_SetMsgObject(pMgr->pCCAN, CCAN_MSG_IF1, CCAN_TX_DIR, false, obj + 1, &msg);
+	}
+}
+
+/* Set up a receive object, eob false chains it to the next object */
+STATIC void mgrSetRxObject(LPC_CCAN_T *pCCAN, uint8_t msgNum, uint32_t id, uint32_t mask, bool eob)
+{
+	CCAN_IF_T *pIF = &pCCAN->IF[CCAN_MSG_IF1];
+	uint32_t mxtd = (mask & CCAN_MSG_ID_EXT_FLAG) ? CCAN_IF_MASK2_MXTD : 0;
+
+	pIF->MCTRL = CCAN_IF_MCTRL_UMSK | CCAN_IF_MCTRL_RXIE | (eob ? CCAN_IF_MCTRL_EOB : 0);
+	if (!(id & CCAN_MSG_ID_EXT_FLAG)) {
+		pIF->MSK2 = mxtd | ((mask & CCAN_MSG_ID_STD_MASK) << 2);
+		pIF->MSK1 = 0x0000;
+		pIF->ARB2 = CCAN_IF_ARB2_MSGVAL | ((id & CCAN_MSG_ID_STD_MASK) << 2);
+		pIF->ARB1 = 0x0000;
+	}
+	else {
+		pIF->MSK2 = mxtd | ((mask & CCAN_MSG_ID_EXT_MASK) >> 16);
+		pIF->MSK1 = mask & 0x0000FFFF;
+		pIF->ARB2 = CCAN_IF_ARB2_MSGVAL | CCAN_IF_ARB2_XTD | ((id & CCAN_MSG_ID_EXT_MASK) >> 16);
+		pIF->ARB1 = id & 0x0000FFFF;
+	}
+
+	Chip_CCAN_TransferMsgObject(pCCAN, CCAN_MSG_IF1, CCAN_IF_CMDMSK_WR | CCAN_IF_CMDMSK_TRANSFER_ALL, msgNum);
+}
+
+/* Make a message object unused */
+STATIC void mgrClearObject(LPC_CCAN_T *pCCAN, uint8_t msgNum)
+{
+	CCAN_IF_T *pIF = &pCCAN->IF[CCAN_MSG_IF1];
+
+	pIF->MCTRL = 0;
+	pIF->ARB2 = 0;
+	pIF->ARB1 = 0;
+	Chip_CCAN_TransferMsgObject(pCCAN, CCAN_MSG_IF1, CCAN_IF_CMDMSK_WR | CCAN_IF_CMDMSK_CTRL | CCAN_IF_CMDMSK_ARB,
+								msgNum);
+}
+
+/* Read a received frame into the ring buffer. The object is released for
+   the next frame, unless hold is set. */
+STATIC void mgrReadRxObject(CCAN_MGR_T *pMgr, uint8_t msgNum, bool hold)
+{
+	LPC_CCAN_T *pCCAN = pMgr->pCCAN;
+	CCAN_IF_T *pIF = &pCCAN->IF[CCAN_MSG_IF2];
+	CCAN_MSG_OBJ_T msg;
+	uint32_t *pData = (uint32_t *) msg.data;
+	uint32_t ctrl, arb;
+
+	Chip_CCAN_TransferMsgObject(pCCAN, CCAN_MSG_IF2,
+								CCAN_IF_CMDMSK_RD | CCAN_IF_CMDMSK_TRANSFER_ALL | CCAN_IF_CMDMSK_R_CLRINTPND |
+								(hold ? 0 : CCAN_IF_CMDMSK_R_NEWDAT), msgNum);
+	ctrl = pIF->MCTRL;
+	if (!(ctrl & CCAN_IF_MCTRL_NEWD)) {
+		return;
+	}
+
+	arb = pIF->ARB1 | (pIF->ARB2 << 16);
+	if (arb & (CCAN_IF_ARB2_XTD << 16)) {
+		msg.id = (arb & CCAN_MSG_ID_EXT_MASK) | CCAN_MSG_ID_EXT_FLAG;
+	}
+	else {
+		msg.id = (arb >> 18) & CCAN_MSG_ID_STD_MASK;
+	}
+	msg.dlc = ctrl & CCAN_IF_MCTRL_DLC_MSK;
+	*pData++ = (pIF->DA2 << 16) | pIF->DA1;
+	*pData = (pIF->DB2 << 16) | pIF->DB1;
+
+	/* A frame came in over an unread one */
+	if (ctrl & CCAN_IF_MCTRL_MLST) {
+		pMgr->stats.rxOverruns++;
+
+		/* A frame stored between the read and this write is lost as well,
+		   the object is only overwritten when the FIFO is full anyway */
+		pIF->MCTRL = ctrl & ~(CCAN_IF_MCTRL_MLST | CCAN_IF_MCTRL_INTP | (hold ? 0 : CCAN_IF_MCTRL_NEWD));
+		Chip_CCAN_TransferMsgObject(pCCAN, CCAN_MSG_IF2, CCAN_IF_CMDMSK_WR | CCAN_IF_CMDMSK_CTRL, msgNum);
+	}
+
+	if ((pMgr->pIdSet != NULL) && !Chip_CCAN_IdSet_Contains(pMgr->pIdSet, msg.id)) {
+		pMgr->stats.rxFiltered++;
+	}
+	else if (RingBuffer_Insert(pMgr->pRXRB, &msg)) {
+		pMgr->stats.rxFrames++;
+	}
+	else {
+		pMgr->stats.rxDrops++;
+	}
+}
+
+/* Read the FIFO frames in arrival order, called with the manager locked. The
+   controller stores a frame in the lowest FIFO object without new data. The
+   lower half objects keep their new data flag until the last of them is
+   read, so the frames arriving meanwhile fill the upper half in order. Upper
+   half objects are released as they are read. Frames pending above a gap
+   arrived before the objects below it were released, and are read first. */
+STATIC void mgrReadFifo(CCAN_MGR_T *pMgr)
+{
+	uint32_t pend, gap, obj;
+	uint32_t lowLast = 0xFF;
+
+	if (pMgr->fifoLowObjs != 0) {
+		lowLast = mgrHighestBit(pMgr->fifoLowObjs);
+	}
+
+	while ((pend = (mgrGetIntPend(pMgr->pCCAN) & pMgr->fifoObjs)) != 0) {
+		gap = ~pend & pMgr->fifoObjs & ((1UL << (mgrHighestBit(pend))) - 1);
+		if (gap != 0) {
+			pend &= ~((2UL << (mgrHighestBit(gap))) - 1);
+		}
+
+		while (pend != 0) {
+			obj = mgrLowestBit(pend);
+			pend &= pend - 1;
+			if (pMgr->fifoLowObjs & (1UL << obj)) {
+				mgrReadRxObject(pMgr, obj + 1, true);
+				if (obj == lowLast) {
+					for (gap = pMgr->fifoLowObjs; gap != 0; gap &= gap - 1) {
+						Chip_CCAN_ClearNewDataFlag(pMgr->pCCAN, CCAN_MSG_IF2, mgrLowestBit(gap) + 1);
+					}
+				}
+			}
+			else {
+				mgrReadRxObject(pMgr, obj + 1, false);
+			}
+		}
+	}
+}
+
+/* Handle a status interrupt, called with the manager locked */
+STATIC void mgrStatus(CCAN_MGR_T *pMgr)
+{
+	LPC_CCAN_T *pCCAN = pMgr->pCCAN;
+	uint32_t stat = Chip_CCAN_GetStatus(pCCAN);
+
+	if (stat & CCAN_STAT_BOFF) {
+		if (!(pMgr->status & CCAN_STAT_BOFF)) {
+			pMgr->stats.busOff++;
+		}
+
+		/* The controller sets INIT on bus off, clearing it starts the recovery */
+		pCCAN->CNTL &= ~CCAN_CTRL_INIT;
+	}
+	pMgr->status = stat;
+	Chip_CCAN_ClearStatus(pCCAN, (CCAN_STAT_RXOK | CCAN_STAT_TXOK));
+}
+
+/* Number of set bits */
+STATIC uint32_t filterBitCount(uint32_t bits)
+{
+	uint32_t count = 0;
+
+	for (; bits != 0; bits &= bits - 1) {
+		count++;
+	}
+	return count;
+}
+
+/* Make a filter of the frame format and the IDs with the bits of mask set as in id */
+STATIC INLINE void filterSet(CCAN_FILTER_T *pFilter, uint32_t id, uint32_t mask)
+{
+	pFilter->mask = mask | CCAN_MSG_ID_EXT_FLAG;
+	pFilter->id = id & pFilter->mask;
+}
+
+/* Smallest filter accepting the IDs of two filters, all frames if their
+   formats differ */
+STATIC void filterMerge(const CCAN_FILTER_T *pA, const CCAN_FILTER_T *pB, CCAN_FILTER_T *pOut)
+{
+	pOut->mask = pA->mask & pB->mask & ~(pA->id ^ pB->id);
+	pOut->id = pA->id & pOut->mask;
+	if (!(pOut->mask & CCAN_MSG_ID_EXT_FLAG)) {
+		pOut->id = 0;
+		pOut->mask = 0;
+	}
+}
+
+/* Check if a filter accepts all the IDs of another */
+STATIC INLINE bool filterContains(const CCAN_FILTER_T *pOuter, const CCAN_FILTER_T *pInner)
+{
+	return ((pInner->mask & pOuter->mask) == pOuter->mask) && ((pInner->id & pOuter->mask) == pOuter->id);
+}
+
+/* Remove the filters accepted by filter index, return the new filter count */
+STATIC uint32_t filterAbsorb(CCAN_FILTER_T *pFilters, uint32_t count, uint32_t index)
+{
+	uint32_t i = 0;
+
+	while (i < count) {
+		if ((i != index) && filterContains(&pFilters[index], &pFilters[i])) {
+			count--;
+			pFilters[i] = pFilters[count];
+			if (index == count) {
+				index = i;
+			}
+		}
+		else {
+			i++;
+		}
+	}
+	return count;
+}
+
+/* Find the two filters whose merge accepts the fewest IDs not accepted before.
+   Index count is the filter pExtra. Returns the number of IDs added. */
+STATIC int64_t filterBestMerge(const CCAN_FILTER_T *pFilters, uint32_t count, const CCAN_FILTER_T *pExtra,
+							   uint32_t *pIndexA, uint32_t *pIndexB)
+{
+	const CCAN_FILTER_T *pA, *pB;
+	CCAN_FILTER_T merged;
+	int64_t cost, best = INT64_MAX;
+	uint32_t a, b;
+
+	for (a = 0; a < count; a++) {
+		pA = &pFilters[a];
+		for (b = a + 1; b <= count; b++) {
+			pB = (b == count) ? pExtra : &pFilters[b];
+			if (pB == NULL) {
+				break;
+			}
+			filterMerge(pA, pB, &merged);
+			cost = (int64_t) Chip_CCAN_Filter_GetIdCount(&merged) - Chip_CCAN_Filter_GetIdCount(pA) -
+				   Chip_CCAN_Filter_GetIdCount(pB);
+			if (cost < best) {
+				best = cost;
+				*pIndexA = a;
+				*pIndexB = b;
+			}
+		}
+	}
+	return best;
+}
+
+/* Add a filter to the list, merging filters when the list is full. Returns the
+   new filter count. */
+STATIC uint32_t filterAdd(CCAN_FILTER_T *pFilters, uint32_t count, uint32_t maxFilters,
+						  const CCAN_FILTER_T *pNew)
+{
+	CCAN_FILTER_T merged;
+	uint32_t a, b, i;
+
+	for (i = 0; i < count; i++) {
+		if (filterContains(&pFilters[i], pNew)) {
+			return count;
+		}
+	}
+
+	if (count < maxFilters) {
+		pFilters[count] = *pNew;
+		return filterAbsorb(pFilters, count + 1, count);
+	}
+
+	filterBestMerge(pFilters, count, pNew, &a, &b);
+	if (b == count) {
+		filterMerge(&pFilters[a], pNew, &merged);
+	}
+	else {
+		filterMerge(&pFilters[a], &pFilters[b], &merged);
+		pFilters[b] = *pNew;
+	}
+	pFilters[a] = merged;
+	return filterAbsorb(pFilters, count, a);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -309,3 +697,318 @@ void Chip_CCAN_DeleteReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t
 	}
 }
 
+
+/* Compute the acceptance filters of a list of IDs and ranges */
+uint32_t Chip_CCAN_Filter_Compile(const CCAN_ID_RANGE_T *pRanges, uint32_t numRanges,
+								  CCAN_FILTER_T *pFilters, uint32_t maxFilters)
+{
+	CCAN_FILTER_T block, merged;
+	uint32_t idMask, first, last, size, count = 0;
+	uint32_t i, a, b;
+
+	if (maxFilters == 0) {
+		return 0;
+	}
+
+	/* Split each range into aligned blocks of a power of two IDs */
+	for (i = 0; i < numRanges; i++) {
+		idMask = (pRanges[i].first & CCAN_MSG_ID_EXT_FLAG) ? CCAN_MSG_ID_EXT_MASK : CCAN_MSG_ID_STD_MASK;
+		first = pRanges[i].first & idMask;
+		last = pRanges[i].last & idMask;
+		while (first <= last) {
+			size = (first != 0) ? (first & (0 - first)) : (idMask + 1);
+			while ((size - 1) > (last - first)) {
+				size >>= 1;
+			}
+			filterSet(&block, first | (pRanges[i].first & CCAN_MSG_ID_EXT_FLAG), idMask & ~(size - 1));
+			count = filterAdd(pFilters, count, maxFilters, &block);
+			if ((last - first) < size) {
+				break;
+			}
+			first += size;
+		}
+	}
+
+	/* Merge the filters that cost no other IDs, such as neighbouring blocks */
+	while ((count > 1) && (filterBestMerge(pFilters, count, NULL, &a, &b) <= 0)) {
+		filterMerge(&pFilters[a], &pFilters[b], &merged);
+		pFilters[a] = merged;
+		count = filterAbsorb(pFilters, count, a);
+	}
+
+	/* Widest first */
+	for (i = 1; i < count; i++) {
+		block = pFilters[i];
+		for (a = i; (a > 0) && (Chip_CCAN_Filter_GetIdCount(&pFilters[a - 1]) < Chip_CCAN_Filter_GetIdCount(&block)); a--) {
+			pFilters[a] = pFilters[a - 1];
+		}
+		pFilters[a] = block;
+	}
+
+	return count;
+}
+
+/* Return the number of IDs a filter accepts */
+uint32_t Chip_CCAN_Filter_GetIdCount(const CCAN_FILTER_T *pFilter)
+{
+	if (!(pFilter->mask & CCAN_MSG_ID_EXT_FLAG)) {
+		/* Both formats */
+		return (1UL << (11 - filterBitCount(pFilter->mask & CCAN_MSG_ID_STD_MASK))) +
+			   (1UL << (29 - filterBitCount(pFilter->mask & CCAN_MSG_ID_EXT_MASK)));
+	}
+	if (pFilter->id & CCAN_MSG_ID_EXT_FLAG) {
+		return 1UL << (29 - filterBitCount(pFilter->mask & CCAN_MSG_ID_EXT_MASK));
+	}
+	return 1UL << (11 - filterBitCount(pFilter->mask & CCAN_MSG_ID_STD_MASK));
+}
+
+/* Set up an ID set from a list of IDs and ranges */
+void Chip_CCAN_IdSet_Init(CCAN_ID_SET_T *pSet, CCAN_ID_RANGE_T *pRanges, uint32_t numRanges)
+{
+	CCAN_ID_RANGE_T range;
+	uint32_t i, j, id, numExt = 0;
+
+	memset(pSet->stdMap, 0, sizeof(pSet->stdMap));
+	for (i = 0; i < numRanges; i++) {
+		range = pRanges[i];
+		if (range.first & CCAN_MSG_ID_EXT_FLAG) {
+			if ((range.first & CCAN_MSG_ID_EXT_MASK) > (range.last & CCAN_MSG_ID_EXT_MASK)) {
+				continue;
+			}
+
+			/* Insertion sort of the extended ranges by their first ID */
+			for (j = numExt; (j > 0) && (pRanges[j - 1].first > range.first); j--) {
+				pRanges[j] = pRanges[j - 1];
+			}
+			pRanges[j] = range;
+			numExt++;
+		}
+		else {
+			for (id = range.first & CCAN_MSG_ID_STD_MASK; id <= (range.last & CCAN_MSG_ID_STD_MASK); id++) {
+				pSet->stdMap[id >> 5] |= 1UL << (id & 0x1F);
+			}
+		}
+	}
+
+	/* Merge the overlapping and adjacent ranges */
+	for (i = 0, j = 0; i < numExt; i++) {
+		if ((j > 0) && (pRanges[i].first <= (pRanges[j - 1].last + 1))) {
+			if (pRanges[i].last > pRanges[j - 1].last) {
+				pRanges[j - 1].last = pRanges[i].last;
+			}
+		}
+		else {
+			pRanges[j++] = pRanges[i];
+		}
+	}
+
+	pSet->pExtRanges = pRanges;
+	pSet->numExtRanges = j;
+}
+
+/* Check if an extended ID is in an ID set */
+bool Chip_CCAN_IdSet_ContainsExt(const CCAN_ID_SET_T *pSet, uint32_t id)
+{
+	const CCAN_ID_RANGE_T *pRanges = pSet->pExtRanges;
+	uint32_t low = 0, high = pSet->numExtRanges, mid;
+
+	/* Find the last range starting at or below the ID */
+	while (low < high) {
+		mid = (low + high) / 2;
+		if (pRanges[mid].first <= id) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return (low > 0) && (id <= pRanges[low - 1].last);
+}
+
+/* Take over a CCAN with an interrupt driven message object manager */
+Status Chip_CCAN_Mgr_Init(CCAN_MGR_T *pMgr, LPC_CCAN_T *pCCAN, RINGBUFF_T *pRXRB, uint8_t fifoCount,
+						  uint8_t txCount, CCAN_TXQ_ENTRY_T *pTxQueue, uint16_t txQueueSize)
+{
+	uint32_t first;
+	uint8_t i;
+
+	if ((fifoCount == 0) || (txCount == 0) || ((fifoCount + txCount) > CCAN_MSG_MAX_NUM) ||
+		(pTxQueue == NULL) || (txQueueSize == 0)) {
+		return ERROR;
+	}
+
+	memset(pMgr, 0, sizeof(*pMgr));
+	pMgr->pCCAN = pCCAN;
+	pMgr->pRXRB = pRXRB;
+	pMgr->pTxQueue = pTxQueue;
+	pMgr->txQueueSize = txQueueSize;
+
+	/* Transmit objects last, the FIFO just below them */
+	first = CCAN_MSG_MAX_NUM - txCount - fifoCount;
+	pMgr->fifoObjs = ((1UL << fifoCount) - 1) << first;
+	pMgr->fifoLowObjs = ((1UL << (fifoCount / 2)) - 1) << first;
+	pMgr->txObjs = ((1UL << txCount) - 1) << (CCAN_MSG_MAX_NUM - txCount);
+	pMgr->txFree = pMgr->txObjs;
+
+	Chip_CCAN_DisableInt(pCCAN, (CCAN_CTRL_IE | CCAN_CTRL_SIE | CCAN_CTRL_EIE));
+	for (i = 1; i <= CCAN_MSG_MAX_NUM; i++) {
+		mgrClearObject(pCCAN, i);
+	}
+	Chip_CCAN_Mgr_SetFifoFilter(pMgr, 0, 0);
+
+	pMgr->status = Chip_CCAN_GetStatus(pCCAN);
+	Chip_CCAN_ClearStatus(pCCAN, (CCAN_STAT_RXOK | CCAN_STAT_TXOK));
+	Chip_CCAN_EnableInt(pCCAN, (CCAN_CTRL_IE | CCAN_CTRL_EIE));
+
+	return SUCCESS;
+}
+
+/* Set the frames accepted by the receive FIFO */
+void Chip_CCAN_Mgr_SetFifoFilter(CCAN_MGR_T *pMgr, uint32_t id, uint32_t mask)
+{
+	uint32_t objs, obj, primask;
+
+	primask = mgrLock();
+	for (objs = pMgr->fifoObjs; objs != 0; objs &= objs - 1) {
+		obj = mgrLowestBit(objs);
+		mgrSetRxObject(pMgr->pCCAN, obj + 1, id, mask, (objs & (objs - 1)) == 0);
+	}
+	mgrUnlock(primask);
+}
+
+/* Receive the frames of an ID and mask in their own message object */
+uint8_t Chip_CCAN_Mgr_AddRxFilter(CCAN_MGR_T *pMgr, uint32_t id, uint32_t mask)
+{
+	uint32_t free, obj, primask;
+
+	primask = mgrLock();
+	free = ~(pMgr->filterObjs | pMgr->fifoObjs | pMgr->txObjs);
+	if (free == 0) {
+		mgrUnlock(primask);
+		return 0;
+	}
+
+	obj = mgrLowestBit(free);
+	pMgr->filterId[obj] = id;
+	pMgr->filterMask[obj] = mask;
+	pMgr->filterObjs |= 1UL << obj;
+	mgrSetRxObject(pMgr->pCCAN, obj + 1, id, mask, true);
+	mgrUnlock(primask);
+
+	return obj + 1;
+}
+
+/* Remove a filter added with Chip_CCAN_Mgr_AddRxFilter() */
+Status Chip_CCAN_Mgr_RemoveRxFilter(CCAN_MGR_T *pMgr, uint32_t id, uint32_t mask)
+{
+	Status status = ERROR;
+	uint32_t objs, obj, primask;
+
+	primask = mgrLock();
+	for (objs = pMgr->filterObjs; objs != 0; objs &= objs - 1) {
+		obj = mgrLowestBit(objs);
+		if ((pMgr->filterId[obj] == id) && (pMgr->filterMask[obj] == mask)) {
+			pMgr->filterObjs &= ~(1UL << obj);
+			mgrClearObject(pMgr->pCCAN, obj + 1);
+			status = SUCCESS;
+			break;
+		}
+	}
+	mgrUnlock(primask);
+
+	return status;
+}
+
+/* Drop the received frames whose ID is not in a set */
+void Chip_CCAN_Mgr_SetIdSet(CCAN_MGR_T *pMgr, const CCAN_ID_SET_T *pSet)
+{
+	uint32_t primask;
+
+	primask = mgrLock();
+	pMgr->pIdSet = pSet;
+	mgrUnlock(primask);
+}
+
+/* Queue a data frame for sending, without waiting */
+Status Chip_CCAN_Mgr_Send(CCAN_MGR_T *pMgr, const CCAN_MSG_OBJ_T *pMsg)
+{
+	Status status = SUCCESS;
+	uint32_t primask;
+
+	primask = mgrLock();
+	if (pMgr->txQueued >= pMgr->txQueueSize) {
+		pMgr->stats.txDrops++;
+		status = ERROR;
+	}
+	else {
+		mgrTxPush(pMgr, pMsg);
+		mgrLoadTx(pMgr);
+	}
+	mgrUnlock(primask);
+
+	return status;
+}
+
+/* Return the number of frames waiting to be sent */
+uint32_t Chip_CCAN_Mgr_GetTxPending(CCAN_MGR_T *pMgr)
+{
+	uint32_t busy, count, primask;
+
+	primask = mgrLock();
+	count = pMgr->txQueued;
+	for (busy = pMgr->txObjs & ~pMgr->txFree; busy != 0; busy &= busy - 1) {
+		count++;
+	}
+	mgrUnlock(primask);
+
+	return count;
+}
+
+/* CCAN manager interrupt handler */
+void Chip_CCAN_Mgr_IRQHandler(CCAN_MGR_T *pMgr)
+{
+	LPC_CCAN_T *pCCAN = pMgr->pCCAN;
+	uint32_t intId, objBit, primask;
+
+	while ((intId = Chip_CCAN_GetIntID(pCCAN)) != CCAN_INT_NO_PENDING) {
+		primask = mgrLock();
+		if (intId == CCAN_INT_STATUS) {
+			mgrStatus(pMgr);
+		}
+		else if (CCAN_INT_MSG_NUM(intId) <= CCAN_MSG_MAX_NUM) {
+			objBit = 1UL << (CCAN_INT_MSG_NUM(intId) - 1);
+			if (objBit & pMgr->fifoObjs) {
+				mgrReadFifo(pMgr);
+			}
+			else if (objBit & pMgr->filterObjs) {
+				mgrReadRxObject(pMgr, intId, false);
+			}
+			else {
+				Chip_CCAN_ClearMsgIntPend(pCCAN, CCAN_MSG_IF2, intId, CCAN_TX_DIR);
+				if (objBit & pMgr->txObjs) {
+					pMgr->txFree |= objBit;
+					pMgr->stats.txFrames++;
+					mgrLoadTx(pMgr);
+				}
+			}
+		}
+		else {
+			mgrUnlock(primask);
+			break;
+		}
+		mgrUnlock(primask);
+	}
+}
+
+/* Read the CCAN manager statistics */
+void Chip_CCAN_Mgr_GetStats(CCAN_MGR_T *pMgr, CCAN_MGR_STATS_T *pStats, bool clear)
+{
+	uint32_t primask;
+
+	primask = mgrLock();
+	*pStats = pMgr->stats;
+	if (clear) {
+		memset(&pMgr->stats, 0, sizeof(pMgr->stats));
+	}
+	mgrUnlock(primask);
+}
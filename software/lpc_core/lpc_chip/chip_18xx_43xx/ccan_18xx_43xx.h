@@ -32,6 +32,8 @@
 #ifndef __CCAN_18XX_43XX_H_
 #define __CCAN_18XX_43XX_H_
 
+#include "ring_buffer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -377,6 +379,7 @@ typedef enum {
 
 #define CCAN_MSG_ID_STD_MASK        0x07FF
 #define CCAN_MSG_ID_EXT_MASK        0x1FFFFFFF
+#define CCAN_MSG_ID_EXT_FLAG        (1UL << 30)		/* Set in CCAN_MSG_OBJ_T id for an extended frame */
 
 /**
  * @brief	Tranfer message object between IF registers and Message RAM
@@ -494,6 +497,243 @@ void Chip_CCAN_AddReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t id)
  */
 void Chip_CCAN_DeleteReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t id);
 
+/**
+ * @brief CCAN ID range, first and last included. Both have CCAN_MSG_ID_EXT_FLAG
+ * set for extended IDs, or both have it cleared for standard IDs.
+ */
+typedef struct {
+	uint32_t first;			/*!< First ID of the range */
+	uint32_t last;			/*!< Last ID of the range */
+} CCAN_ID_RANGE_T;
+
+/**
+ * @brief CCAN acceptance filter of a message object, a frame is accepted when
+ * the bits set in mask are the same in its ID and in id. CCAN_MSG_ID_EXT_FLAG
+ * set in mask matches the frame format too, as for Chip_CCAN_Mgr_AddRxFilter().
+ */
+typedef struct {
+	uint32_t id;			/*!< ID to match */
+	uint32_t mask;			/*!< ID bits that must match */
+} CCAN_FILTER_T;
+
+/**
+ * @brief CCAN ID set, the software check of the frames accepted by the filters
+ * @note	Standard IDs are looked up in a bitmap, extended IDs by a binary
+ * search of sorted ranges.
+ */
+typedef struct {
+	uint32_t stdMap[(CCAN_MSG_ID_STD_MASK + 1) / 32];	/*!< Bit n set if standard ID n is in the set */
+	const CCAN_ID_RANGE_T *pExtRanges;					/*!< Sorted extended ID ranges, without overlaps */
+	uint32_t numExtRanges;								/*!< Number of extended ID ranges */
+} CCAN_ID_SET_T;
+
+/**
+ * @brief	Compute the acceptance filters of a list of IDs and ranges
+ * @param	pRanges		: IDs to accept, as ranges of one or more IDs
+ * @param	numRanges	: Number of ranges in pRanges
+ * @param	pFilters	: Array receiving the filters
+ * @param	maxFilters	: Number of entries in pFilters, the message objects available
+ * @return	Number of filters set in pFilters
+ * @note	The filters accept every ID of the list. Each range is split into
+ * aligned blocks of IDs, one filter each, and while there are more blocks than
+ * maxFilters the two filters whose merge accepts the fewest other IDs are
+ * merged. The filters are returned widest first, the first one suits the
+ * manager FIFO and the others its filter objects. The frames of the other IDs
+ * accepted by the filters can be dropped with a CCAN_ID_SET_T. A list sorted
+ * by ID gives filters accepting fewer other IDs.
+ */
+uint32_t Chip_CCAN_Filter_Compile(const CCAN_ID_RANGE_T *pRanges, uint32_t numRanges,
+								  CCAN_FILTER_T *pFilters, uint32_t maxFilters);
+
+/**
+ * @brief	Return the number of IDs a filter accepts
+ * @param	pFilter	: Filter
+ * @return	Number of standard and extended IDs accepted
+ */
+uint32_t Chip_CCAN_Filter_GetIdCount(const CCAN_FILTER_T *pFilter);
+
+/**
+ * @brief	Set up an ID set from a list of IDs and ranges
+ * @param	pSet		: ID set to set up
+ * @param	pRanges		: IDs of the set, as ranges of one or more IDs
+ * @param	numRanges	: Number of ranges in pRanges
+ * @return	Nothing
+ * @note	The extended ID ranges are sorted and merged at the start of
+ * pRanges, which must be kept while the set is used.
+ */
+void Chip_CCAN_IdSet_Init(CCAN_ID_SET_T *pSet, CCAN_ID_RANGE_T *pRanges, uint32_t numRanges);
+
+/**
+ * @brief	Check if an extended ID is in an ID set
+ * @param	pSet	: ID set
+ * @param	id		: Extended ID, CCAN_MSG_ID_EXT_FLAG set
+ * @return	true if the ID is in the set
+ */
+bool Chip_CCAN_IdSet_ContainsExt(const CCAN_ID_SET_T *pSet, uint32_t id);
+
+/**
+ * @brief	Check if an ID is in an ID set
+ * @param	pSet	: ID set
+ * @param	id		: ID, with CCAN_MSG_ID_EXT_FLAG set for an extended ID
+ * @return	true if the ID is in the set
+ */
+STATIC INLINE bool Chip_CCAN_IdSet_Contains(const CCAN_ID_SET_T *pSet, uint32_t id)
+{
+	if (id & CCAN_MSG_ID_EXT_FLAG) {
+		return Chip_CCAN_IdSet_ContainsExt(pSet, id);
+	}
+	return (pSet->stdMap[(id & CCAN_MSG_ID_STD_MASK) >> 5] & (1UL << (id & 0x1F))) != 0;
+}
+
+/**
+ * @brief CCAN manager transmit queue entry, an array of them is given to Chip_CCAN_Mgr_Init()
+ */
+typedef struct {
+	uint32_t key;			/*!< Arbitration priority, lower is sent first */
+	uint32_t seq;			/*!< Submission order of frames with the same key */
+	CCAN_MSG_OBJ_T msg;		/*!< Frame to send */
+} CCAN_TXQ_ENTRY_T;
+
+/**
+ * @brief CCAN manager statistics
+ */
+typedef struct {
+	uint32_t rxFrames;		/*!< Frames put in the receive ring buffer */
+	uint32_t txFrames;		/*!< Frames sent */
+	uint32_t rxDrops;		/*!< Frames dropped, the receive ring buffer full */
+	uint32_t rxOverruns;	/*!< Overwrites seen in the message RAM, the FIFO or filter object full */
+	uint32_t txDrops;		/*!< Frames refused by Chip_CCAN_Mgr_Send(), the transmit queue full */
+	uint32_t busOff;		/*!< Bus off events, each followed by an automatic recovery */
+	uint32_t rxFiltered;	/*!< Frames dropped, their ID not in the set of Chip_CCAN_Mgr_SetIdSet() */
+} CCAN_MGR_STATS_T;
+
+/**
+ * @brief CCAN message object manager, used with Chip_CCAN_Mgr_Init()
+ * @note	All members are private to the driver. The use of each message
+ * object is kept in RAM, so finding a free object or a filter does not read
+ * the message RAM.
+ */
+typedef struct {
+	LPC_CCAN_T *pCCAN;						/*!< CCAN the manager owns */
+	RINGBUFF_T *pRXRB;						/*!< Received frames, items of CCAN_MSG_OBJ_T */
+	CCAN_TXQ_ENTRY_T *pTxQueue;				/*!< Transmit priority queue, a binary heap */
+	uint16_t txQueueSize;					/*!< Entries in pTxQueue */
+	uint16_t txQueued;						/*!< Frames in pTxQueue */
+	uint32_t txSeq;							/*!< Sequence number of the next queued frame */
+	uint32_t fifoObjs;						/*!< Receive FIFO objects, bit n for object n + 1 */
+	uint32_t fifoLowObjs;					/*!< Lower half of the FIFO, released together */
+	uint32_t filterObjs;					/*!< Objects of Chip_CCAN_Mgr_AddRxFilter() */
+	uint32_t txObjs;						/*!< Transmit objects */
+	uint32_t txFree;						/*!< Transmit objects without a frame */
+	uint32_t filterId[CCAN_MSG_MAX_NUM];	/*!< ID of each filter object */
+	uint32_t filterMask[CCAN_MSG_MAX_NUM];	/*!< Mask of each filter object */
+	const CCAN_ID_SET_T *pIdSet;			/*!< IDs received, NULL for all */
+	uint32_t status;						/*!< Last STAT register value */
+	CCAN_MGR_STATS_T stats;					/*!< Statistics */
+} CCAN_MGR_T;
+
+/**
+ * @brief	Take over a CCAN with an interrupt driven message object manager
+ * @param	pMgr		: Manager to initialize
+ * @param	pCCAN		: The base of CCAN peripheral on the chip, set up with Chip_CCAN_Init()
+ *                        and Chip_CCAN_SetBitRate()
+ * @param	pRXRB		: Ring buffer of CCAN_MSG_OBJ_T items receiving the frames
+ * @param	fifoCount	: Message objects chained into the receive FIFO, at least 1
+ * @param	txCount		: Message objects used to send, at least 1
+ * @param	pTxQueue	: Transmit queue entries
+ * @param	txQueueSize	: Number of entries in pTxQueue
+ * @return	ERROR if the objects do not fit in the message RAM, SUCCESS otherwise
+ * @note	The transmit objects are the last ones of the message RAM and the
+ * FIFO objects are just below them, the objects left are used by
+ * Chip_CCAN_Mgr_AddRxFilter(). The FIFO accepts all frames until
+ * Chip_CCAN_Mgr_SetFifoFilter() is called. Chip_CCAN_Mgr_IRQHandler() must
+ * be called from the CAN interrupt handler, and the interrupt enabled.
+ * Frames are read from the FIFO in arrival order, and at least
+ * fifoCount / 2 + 1 frames can arrive between two interrupts without loss.
+ */
+Status Chip_CCAN_Mgr_Init(CCAN_MGR_T *pMgr, LPC_CCAN_T *pCCAN, RINGBUFF_T *pRXRB, uint8_t fifoCount,
+						  uint8_t txCount, CCAN_TXQ_ENTRY_T *pTxQueue, uint16_t txQueueSize);
+
+/**
+ * @brief	Set the frames accepted by the receive FIFO
+ * @param	pMgr	: CCAN manager
+ * @param	id		: ID to match, with CCAN_MSG_ID_EXT_FLAG set for an extended ID
+ * @param	mask	: ID bits that must match, with CCAN_MSG_ID_EXT_FLAG set if
+ *                    the frame format must match too, 0 to accept all frames
+ * @return	Nothing
+ * @note	Frames stored in the FIFO may be lost while it changes.
+ */
+void Chip_CCAN_Mgr_SetFifoFilter(CCAN_MGR_T *pMgr, uint32_t id, uint32_t mask);
+
+/**
+ * @brief	Receive the frames of an ID and mask in their own message object
+ * @param	pMgr	: CCAN manager
+ * @param	id		: ID to match, with CCAN_MSG_ID_EXT_FLAG set for an extended ID
+ * @param	mask	: ID bits that must match, as for Chip_CCAN_Mgr_SetFifoFilter()
+ * @return	Message object number used, 0 if no object is free
+ * @note	Filter objects have lower numbers than the FIFO, so the frames they
+ * match never reach the FIFO. They are read into the same ring buffer.
+ */
+uint8_t Chip_CCAN_Mgr_AddRxFilter(CCAN_MGR_T *pMgr, uint32_t id, uint32_t mask);
+
+/**
+ * @brief	Remove a filter added with Chip_CCAN_Mgr_AddRxFilter()
+ * @param	pMgr	: CCAN manager
+ * @param	id		: ID of the filter
+ * @param	mask	: Mask of the filter
+ * @return	ERROR if there is no such filter, SUCCESS otherwise
+ */
+Status Chip_CCAN_Mgr_RemoveRxFilter(CCAN_MGR_T *pMgr, uint32_t id, uint32_t mask);
+
+/**
+ * @brief	Drop the received frames whose ID is not in a set
+ * @param	pMgr	: CCAN manager
+ * @param	pSet	: IDs to receive, NULL to receive all the frames accepted by the filters
+ * @return	Nothing
+ * @note	The set is checked in the interrupt handler before a frame is put
+ * in the ring buffer. It completes the filters of Chip_CCAN_Filter_Compile(),
+ * which may accept more IDs than asked for.
+ */
+void Chip_CCAN_Mgr_SetIdSet(CCAN_MGR_T *pMgr, const CCAN_ID_SET_T *pSet);
+
+/**
+ * @brief	Queue a data frame for sending, without waiting
+ * @param	pMgr	: CCAN manager
+ * @param	pMsg	: Frame to send, with CCAN_MSG_ID_EXT_FLAG set in id for an extended frame
+ * @return	ERROR if the transmit queue is full, SUCCESS otherwise
+ * @note	Queued frames are loaded into the transmit objects by CAN priority,
+ * the lowest ID first, and frames of the same ID in submission order. Up
+ * to txCount frames already in the transmit objects may go out before a
+ * frame of a higher priority queued after them.
+ */
+Status Chip_CCAN_Mgr_Send(CCAN_MGR_T *pMgr, const CCAN_MSG_OBJ_T *pMsg);
+
+/**
+ * @brief	Return the number of frames waiting to be sent
+ * @param	pMgr	: CCAN manager
+ * @return	Frames queued or in a transmit object
+ */
+uint32_t Chip_CCAN_Mgr_GetTxPending(CCAN_MGR_T *pMgr);
+
+/**
+ * @brief	CCAN manager interrupt handler
+ * @param	pMgr	: CCAN manager
+ * @return	Nothing
+ * @note	Call from CAN0_IRQHandler() or CAN1_IRQHandler(). It reads the
+ * received frames, refills the transmit objects from the queue and restarts
+ * the controller after a bus off.
+ */
+void Chip_CCAN_Mgr_IRQHandler(CCAN_MGR_T *pMgr);
+
+/**
+ * @brief	Read the CCAN manager statistics
+ * @param	pMgr	: CCAN manager
+ * @param	pStats	: Structure receiving the statistics
+ * @param	clear	: true to reset the statistics after reading them
+ * @return	Nothing
+ */
+void Chip_CCAN_Mgr_GetStats(CCAN_MGR_T *pMgr, CCAN_MGR_STATS_T *pStats, bool clear);
+
 /**
  * @}
  */
@@ -38,6 +38,13 @@
 /* Channel array to monitor free channel */
 static DMA_ChannelHandle_t ChannelHandlerArray[GPDMA_NUMBER_CHANNELS];
 
+/* Requests running on each channel, NULL on channels not used by Chip_GPDMA_Submit() */
+static GPDMA_REQ_T *ActiveReq[GPDMA_NUMBER_CHANNELS];
+
+/* Requests waiting for a free channel, one FIFO per priority */
+static GPDMA_REQ_T *QueueHead[GPDMA_PRIO_COUNT];
+static GPDMA_REQ_T *QueueTail[GPDMA_PRIO_COUNT];
+
 /* Optimized Peripheral Source and Destination burst size (18xx,43xx) */
 static const uint8_t GPDMA_LUTPerBurst[] = {
 	GPDMA_BSIZE_4,	/* MEMORY             */
@@ -69,7 +76,8 @@ static const uint8_t GPDMA_LUTPerBurst[] = {
 	GPDMA_BSIZE_4,	/* ADC 1              */
 	GPDMA_BSIZE_1,	/* DAC                */
 	GPDMA_BSIZE_32,	/* I2S channel 0      */
-	GPDMA_BSIZE_32	/* I2S channel 0      */
+	GPDMA_BSIZE_32,	/* I2S channel 0      */
+	GPDMA_BSIZE_4	/* SPIFI              */
 };
 
 /* Optimized Peripheral Source and Destination transfer width (18xx,43xx) */
@@ -103,7 +111,8 @@ static const uint8_t GPDMA_LUTPerWid[] = {
 	GPDMA_WIDTH_WORD,	/* ADC 1              */
 	GPDMA_WIDTH_WORD,	/* DAC                */
 	GPDMA_WIDTH_WORD,	/* I2S channel 0      */
-	GPDMA_WIDTH_WORD/* I2S channel 0      */
+	GPDMA_WIDTH_WORD,	/* I2S channel 0      */
+	GPDMA_WIDTH_WORD	/* SPIFI              */
 };
 
 /* Lookup Table of Connection Type matched with (18xx,43xx) Peripheral Data (FIFO) register base address */
@@ -137,9 +146,17 @@ volatile static const void *GPDMA_LUTPerAddr[] = {
 	(&LPC_ADC1->GDR),				/* ADC 1              */
 	(&LPC_DAC->CR),					/* DAC                */
 	(&LPC_I2S1->TXFIFO),			/* I2S1 Tx on channel 0 */
-	(&LPC_I2S1->RXFIFO)				/* I2S1 Rx on channel 1 */
+	(&LPC_I2S1->RXFIFO),			/* I2S1 Rx on channel 1 */
+	((uint32_t *) (LPC_SPIFI_BASE + 0x14))	/* SPIFI DAT register */
 };
 
+/* Connections on which the peripheral is the source of the data */
+#define GPDMA_CONN_SOURCE_MASK ((1UL << GPDMA_CONN_UART0_Rx) | (1UL << GPDMA_CONN_UART1_Rx) | \
+								(1UL << GPDMA_CONN_UART2_Rx) | (1UL << GPDMA_CONN_UART3_Rx) | \
+								(1UL << GPDMA_CONN_SSP0_Rx) | (1UL << GPDMA_CONN_SSP1_Rx) | \
+								(1UL << GPDMA_CONN_I2S_Rx_Channel_1) | (1UL << GPDMA_CONN_I2S1_Rx_Channel_1) | \
+								(1UL << GPDMA_CONN_ADC_0) | (1UL << GPDMA_CONN_ADC_1))
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -147,6 +164,28 @@ volatile static const void *GPDMA_LUTPerAddr[] = {
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
+/* Convert a peripheral data register address, as stored in a descriptor by
+   Chip_GPDMA_PrepareDescriptor(), back to its connection number. Values that
+   already are connection numbers are returned unchanged. */
+STATIC uint32_t getConnection(uint32_t addr, bool isSource)
+{
+	uint32_t conn;
+
+	if (addr <= GPDMA_CONN_SPIFI) {
+		return addr;
+	}
+
+	/* UART and SSP share one data register between Rx and Tx, SPIFI uses
+	   one connection for both directions */
+	for (conn = 1; conn < (sizeof(GPDMA_LUTPerAddr) / sizeof(GPDMA_LUTPerAddr[0])); conn++) {
+		if (((uint32_t) GPDMA_LUTPerAddr[conn] == addr) &&
+			((((GPDMA_CONN_SOURCE_MASK >> conn) & 1) == isSource) || (conn == GPDMA_CONN_SPIFI))) {
+			return conn;
+		}
+	}
+	return GPDMA_CONN_MEMORY;
+}
+
 /* Control which set of peripherals is connected to the DMA controller */
 STATIC uint8_t configDMAMux(uint32_t gpdma_peripheral_connection_number)
 {
@@ -298,6 +337,11 @@ STATIC uint8_t configDMAMux(uint32_t gpdma_peripheral_connection_number)
 		channel = 15;
 		break;
 
+	case GPDMA_CONN_SPIFI:
+		function = 0;
+		channel = 0;
+		break;
+
 	default:
 		function = 3;
 		channel = 15;
@@ -388,6 +432,11 @@ Status setupChannel(LPC_GPDMA_T *pGPDMA,
 {
 	GPDMA_CH_T *pDMAch;
 
+	if (GPDMAChannelConfig->ChannelNum >= GPDMA_NUMBER_CHANNELS) {
+		/* No channel, Chip_GPDMA_GetFreeChannel() returned GPDMA_NO_FREE_CHANNEL */
+		return ERROR;
+	}
+
 	if (pGPDMA->ENBLDCHNS & ((((1UL << (GPDMAChannelConfig->ChannelNum)) & 0xFF)))) {
 		/* This channel is enabled, return ERROR, need to release this channel first */
 		return ERROR;
@@ -422,6 +471,112 @@ Status setupChannel(LPC_GPDMA_T *pGPDMA,
 	return SUCCESS;
 }
 
+/* Mask the interrupts while the request queues and channel owners change,
+   requests may be submitted from any interrupt priority */
+STATIC INLINE uint32_t lockService(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+STATIC INLINE void unlockService(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Take a channel for a request, high priority requests use the low numbered
+   channels which have the highest priority on the bus */
+STATIC uint8_t allocChannel(LPC_GPDMA_T *pGPDMA, GPDMA_PRIO_T priority)
+{
+	uint8_t i, ch;
+
+	for (i = 0; i < GPDMA_NUMBER_CHANNELS; i++) {
+		ch = (priority == GPDMA_PRIO_HIGH) ? i : (GPDMA_NUMBER_CHANNELS - 1 - i);
+		if ((ChannelHandlerArray[ch].ChannelStatus == DISABLE) &&
+			!Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_ENABLED_CH, ch)) {
+			ChannelHandlerArray[ch].ChannelStatus = ENABLE;
+			return ch;
+		}
+	}
+	return GPDMA_NO_FREE_CHANNEL;
+}
+
+/* Give a channel back, called with the service locked */
+STATIC void releaseChannel(uint8_t ch)
+{
+	ActiveReq[ch] = NULL;
+	ChannelHandlerArray[ch].ChannelStatus = DISABLE;
+}
+
+/* Start a request on an allocated channel, called with the service locked */
+STATIC Status startRequest(LPC_GPDMA_T *pGPDMA, GPDMA_REQ_T *pReq, uint8_t ch)
+{
+	ActiveReq[ch] = pReq;
+	pReq->channel = ch;
+	pReq->state = GPDMA_REQ_ACTIVE;
+	if (Chip_GPDMA_SGTransfer(pGPDMA, ch, pReq->pDesc, pReq->TransferType) == ERROR) {
+		pReq->state = GPDMA_REQ_IDLE;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/* Returns true if a request at this or a higher priority is queued */
+STATIC bool isQueued(GPDMA_PRIO_T priority)
+{
+	int i;
+
+	for (i = 0; i <= (int) priority; i++) {
+		if (QueueHead[i] != NULL) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Give free channels to queued requests, highest priority first */
+STATIC void startQueued(LPC_GPDMA_T *pGPDMA)
+{
+	GPDMA_REQ_T *pReq;
+	uint32_t primask;
+	Status status;
+	int i;
+	uint8_t ch;
+
+	do {
+		pReq = NULL;
+		status = SUCCESS;
+		primask = lockService();
+		for (i = 0; (i < GPDMA_PRIO_COUNT) && (pReq == NULL); i++) {
+			if (QueueHead[i] == NULL) {
+				continue;
+			}
+			ch = allocChannel(pGPDMA, (GPDMA_PRIO_T) i);
+			if (ch == GPDMA_NO_FREE_CHANNEL) {
+				break;
+			}
+
+			pReq = QueueHead[i];
+			QueueHead[i] = pReq->pNext;
+			if (QueueHead[i] == NULL) {
+				QueueTail[i] = NULL;
+			}
+			status = startRequest(pGPDMA, pReq, ch);
+			if (status == ERROR) {
+				releaseChannel(ch);
+			}
+		}
+		unlockService(primask);
+
+		/* Report requests that could not be started */
+		if ((status == ERROR) && (pReq->callback != NULL)) {
+			pReq->callback(pReq, ERROR);
+		}
+	} while (pReq != NULL);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -445,6 +600,13 @@ void Chip_GPDMA_Init(LPC_GPDMA_T *pGPDMA)
 	/* Reset all channels are free */
 	for (i = 0; i < GPDMA_NUMBER_CHANNELS; i++) {
 		ChannelHandlerArray[i].ChannelStatus = DISABLE;
+		ActiveReq[i] = NULL;
+	}
+
+	/* Drop all queued requests */
+	for (i = 0; i < GPDMA_PRIO_COUNT; i++) {
+		QueueHead[i] = NULL;
+		QueueTail[i] = NULL;
 	}
 }
 
@@ -458,6 +620,10 @@ void Chip_GPDMA_DeInit(LPC_GPDMA_T *pGPDMA)
 void Chip_GPDMA_Stop(LPC_GPDMA_T *pGPDMA,
 					 uint8_t ChannelNum)
 {
+	if (ChannelNum >= GPDMA_NUMBER_CHANNELS) {
+		return;
+	}
+
 	Chip_GPDMA_ChannelCmd(pGPDMA, (ChannelNum), DISABLE);
 	if (Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_INTTC, ChannelNum)) {
 		/* Clear terminate counter Interrupt pending */
@@ -588,6 +754,10 @@ void Chip_GPDMA_ChannelCmd(LPC_GPDMA_T *pGPDMA, uint8_t channelNum, FunctionalSt
 {
 	GPDMA_CH_T *pDMAch;
 
+	if (channelNum >= GPDMA_NUMBER_CHANNELS) {
+		return;
+	}
+
 	/* Get Channel pointer */
 	pDMAch = (GPDMA_CH_T *) &(pGPDMA->CH[channelNum]);
 
@@ -700,6 +870,29 @@ Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
 	uint32_t src = DMADescriptor->src, dst = DMADescriptor->dst;
 	int ret;
 
+	/* Peripheral ends of the first descriptor hold register addresses */
+	switch (TransferType) {
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_PERIPHERAL:
+		dst = getConnection(dst, false);
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_PERIPHERAL:
+		src = getConnection(src, true);
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2P_CONTROLLER_DMA:
+	case GPDMA_TRANSFERTYPE_P2P_CONTROLLER_DestPERIPHERAL:
+	case GPDMA_TRANSFERTYPE_P2P_CONTROLLER_SrcPERIPHERAL:
+		src = getConnection(src, true);
+		dst = getConnection(dst, false);
+		break;
+
+	default:
+		break;
+	}
+
 	ret = Chip_GPDMA_InitChannelCfg(pGPDMA, &GPDMACfg, ChannelNum, src, dst, 0, TransferType);
 	if (ret < 0) {
 		return ERROR;
@@ -741,6 +934,259 @@ uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA,
 			return temp;
 		}
 	}
-	return 0;
+	return GPDMA_NO_FREE_CHANNEL;
 }
 
+/* Prepare a descriptor template for one transfer type and peripheral connection */
+Status Chip_GPDMA_InitDescTemplate(LPC_GPDMA_T *pGPDMA,
+								   GPDMA_DESC_TEMPLATE_T *pTmpl,
+								   uint32_t src,
+								   uint32_t dst,
+								   GPDMA_FLOW_CONTROL_T TransferType)
+{
+	GPDMA_CH_CFG_T GPDMACfg;
+	uint32_t ctrl;
+	int ret;
+
+	if ((src > GPDMA_CONN_SPIFI) || (dst > GPDMA_CONN_SPIFI)) {
+		return ERROR;
+	}
+
+	ret = Chip_GPDMA_InitChannelCfg(pGPDMA, &GPDMACfg, 0, src, dst, 0, TransferType);
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	/* Adjust src/dst index if they are memory */
+	pTmpl->srcIsMem = ret & 1;
+	pTmpl->dstIsMem = (ret >> 1) & 1;
+	if (pTmpl->srcIsMem) {
+		src = 0;
+	}
+	if (pTmpl->dstIsMem) {
+		dst = 0;
+	}
+
+	ctrl = makeCtrlWord(&GPDMACfg,
+						(uint32_t) GPDMA_LUTPerBurst[src],
+						(uint32_t) GPDMA_LUTPerBurst[dst],
+						(uint32_t) GPDMA_LUTPerWid[src],
+						(uint32_t) GPDMA_LUTPerWid[dst]);
+	pTmpl->ctrl = ctrl & ~(GPDMA_DMACCxControl_I | GPDMA_DMACCxControl_TransferSize(GPDMA_MAX_TRANSFER_SIZE));
+	pTmpl->src = GPDMACfg.SrcAddr;
+	pTmpl->dst = GPDMACfg.DstAddr;
+
+	/* Memory ends step by the width of the transfers */
+	pTmpl->srcStep = (ctrl & GPDMA_DMACCxControl_SI) ? (1 << ((ctrl >> 18) & 0x07)) : 0;
+	pTmpl->dstStep = (ctrl & GPDMA_DMACCxControl_DI) ? (1 << ((ctrl >> 21) & 0x07)) : 0;
+	pTmpl->sizeShift = (TransferType == GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA) ? 2 : 0;
+
+	return SUCCESS;
+}
+
+/* Build a linked list of descriptors for one transfer */
+int Chip_GPDMA_BuildDescList(const GPDMA_DESC_TEMPLATE_T *pTmpl,
+							 DMA_TransferDescriptor_t *pDesc,
+							 int maxDesc,
+							 uint32_t src,
+							 uint32_t dst,
+							 uint32_t Size,
+							 const DMA_TransferDescriptor_t *NextDescriptor)
+{
+	const uint32_t ctrl = pTmpl->ctrl | GPDMA_DMACCxControl_TransferSize(GPDMA_MAX_TRANSFER_SIZE);
+	const uint32_t srcInc = pTmpl->srcStep * GPDMA_MAX_TRANSFER_SIZE;
+	const uint32_t dstInc = pTmpl->dstStep * GPDMA_MAX_TRANSFER_SIZE;
+	uint32_t xfers = Size >> pTmpl->sizeShift;
+	int i, numDesc;
+
+	/* A size in bytes must be a whole number of transfers */
+	if ((Size & ((1UL << pTmpl->sizeShift) - 1)) != 0) {
+		return 0;
+	}
+
+	numDesc = (xfers + GPDMA_MAX_TRANSFER_SIZE - 1) / GPDMA_MAX_TRANSFER_SIZE;
+	if ((numDesc == 0) || (numDesc > maxDesc)) {
+		return 0;
+	}
+
+	if (!pTmpl->srcIsMem) {
+		src = pTmpl->src;
+	}
+	if (!pTmpl->dstIsMem) {
+		dst = pTmpl->dst;
+	}
+
+	/* All but the last descriptor are full */
+	for (i = 0; i < (numDesc - 1); i++) {
+		pDesc[i].src = src;
+		pDesc[i].dst = dst;
+		pDesc[i].lli = (uint32_t) &pDesc[i + 1];
+		pDesc[i].ctrl = ctrl;
+		src += srcInc;
+		dst += dstInc;
+	}
+
+	pDesc[i].src = src;
+	pDesc[i].dst = dst;
+	pDesc[i].lli = (uint32_t) NextDescriptor;
+	pDesc[i].ctrl = pTmpl->ctrl | GPDMA_DMACCxControl_I |
+					GPDMA_DMACCxControl_TransferSize(xfers - (i * GPDMA_MAX_TRANSFER_SIZE));
+
+	return numDesc;
+}
+
+/* Start a DMA request on a free channel, or queue it until one is free */
+Status Chip_GPDMA_Submit(LPC_GPDMA_T *pGPDMA, GPDMA_REQ_T *pReq)
+{
+	Status status = SUCCESS;
+	uint32_t primask;
+	uint8_t ch = GPDMA_NO_FREE_CHANNEL;
+
+	if ((pReq->pDesc == NULL) || ((uint32_t) pReq->priority >= GPDMA_PRIO_COUNT)) {
+		return ERROR;
+	}
+
+	primask = lockService();
+	if (pReq->state != GPDMA_REQ_IDLE) {
+		status = ERROR;
+	}
+	else {
+		/* Requests queued ahead of this one keep their turn */
+		if (!isQueued(pReq->priority)) {
+			ch = allocChannel(pGPDMA, pReq->priority);
+		}
+
+		if (ch != GPDMA_NO_FREE_CHANNEL) {
+			status = startRequest(pGPDMA, pReq, ch);
+			if (status == ERROR) {
+				releaseChannel(ch);
+			}
+		}
+		else {
+			pReq->pNext = NULL;
+			pReq->state = GPDMA_REQ_QUEUED;
+			if (QueueTail[pReq->priority] == NULL) {
+				QueueHead[pReq->priority] = pReq;
+			}
+			else {
+				QueueTail[pReq->priority]->pNext = pReq;
+			}
+			QueueTail[pReq->priority] = pReq;
+		}
+	}
+	unlockService(primask);
+
+	return status;
+}
+
+/* Cancel a queued or running DMA request */
+Status Chip_GPDMA_Cancel(LPC_GPDMA_T *pGPDMA, GPDMA_REQ_T *pReq)
+{
+	GPDMA_REQ_T **ppLink, *pPrev = NULL;
+	Status status = ERROR;
+	uint32_t primask;
+	bool freed = false;
+
+	primask = lockService();
+	if (pReq->state == GPDMA_REQ_QUEUED) {
+		for (ppLink = &QueueHead[pReq->priority]; *ppLink != NULL; ppLink = &(*ppLink)->pNext) {
+			if (*ppLink == pReq) {
+				*ppLink = pReq->pNext;
+				if (QueueTail[pReq->priority] == pReq) {
+					QueueTail[pReq->priority] = pPrev;
+				}
+				status = SUCCESS;
+				break;
+			}
+			pPrev = *ppLink;
+		}
+	}
+	else if ((pReq->state == GPDMA_REQ_ACTIVE) && (ActiveReq[pReq->channel] == pReq)) {
+		Chip_GPDMA_Stop(pGPDMA, pReq->channel);
+		releaseChannel(pReq->channel);
+		freed = true;
+		status = SUCCESS;
+	}
+	if (status == SUCCESS) {
+		pReq->state = GPDMA_REQ_IDLE;
+	}
+	unlockService(primask);
+
+	if (freed) {
+		startQueued(pGPDMA);
+	}
+	return status;
+}
+
+/* Handle DMA interrupts for requests started by Chip_GPDMA_Submit() */
+void Chip_GPDMA_ServiceIRQHandler(LPC_GPDMA_T *pGPDMA)
+{
+	GPDMA_REQ_T *pReq, *pChain;
+	Status status, chainStatus;
+	uint32_t primask, mask;
+	uint8_t ch;
+
+	for (ch = 0; ch < GPDMA_NUMBER_CHANNELS; ch++) {
+		mask = 1UL << ch;
+		pReq = ActiveReq[ch];
+		if ((pReq == NULL) || !(pGPDMA->INTSTAT & mask)) {
+			continue;
+		}
+
+		/* Terminal count of a descriptor inside the list, the channel carries on */
+		pGPDMA->INTTCCLEAR = mask;
+		if (pGPDMA->ENBLDCHNS & mask) {
+			continue;
+		}
+
+		/* Channels stop at the end of the list or on a bus error */
+		status = (pGPDMA->INTERRSTAT & mask) ? ERROR : SUCCESS;
+		pGPDMA->INTTCCLEAR = mask;
+		pGPDMA->INTERRCLR = mask;
+
+		/* Follow-up requests keep the channel */
+		pChain = (status == SUCCESS) ? pReq->pChain : NULL;
+		chainStatus = SUCCESS;
+		primask = lockService();
+		if (ActiveReq[ch] != pReq) {
+			/* Cancelled from a higher priority interrupt */
+			unlockService(primask);
+			continue;
+		}
+		pReq->state = GPDMA_REQ_IDLE;
+		if ((pChain != NULL) && (pChain->state == GPDMA_REQ_IDLE)) {
+			chainStatus = startRequest(pGPDMA, pChain, ch);
+		}
+		else {
+			pChain = NULL;
+		}
+		if ((pChain == NULL) || (chainStatus == ERROR)) {
+			releaseChannel(ch);
+		}
+		unlockService(primask);
+
+		if (pReq->callback != NULL) {
+			pReq->callback(pReq, status);
+		}
+		if ((chainStatus == ERROR) && (pChain->callback != NULL)) {
+			pChain->callback(pChain, ERROR);
+		}
+	}
+
+	startQueued(pGPDMA);
+}
+
+
+/* Return the current destination address of a running DMA request */
+uint32_t Chip_GPDMA_GetRequestDstAddr(LPC_GPDMA_T *pGPDMA, const GPDMA_REQ_T *pReq)
+{
+	uint32_t primask, addr = 0;
+
+	primask = lockService();
+	if ((pReq->state == GPDMA_REQ_ACTIVE) && (ActiveReq[pReq->channel] == pReq)) {
+		addr = pGPDMA->CH[pReq->channel].DESTADDR;
+	}
+	unlockService(primask);
+
+	return addr;
+}
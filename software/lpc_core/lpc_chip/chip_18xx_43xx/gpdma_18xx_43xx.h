@@ -207,6 +207,7 @@ typedef struct {
 #define GPDMA_CONN_DAC              ((27UL))		/**< DAC                */
 #define GPDMA_CONN_I2S1_Tx_Channel_0 ((28UL))		/**< I2S1 Tx on channel 0 */
 #define GPDMA_CONN_I2S1_Rx_Channel_1 ((29UL))		/**< I2S1 Rx on channel 0 */
+#define GPDMA_CONN_SPIFI            ((30UL))		/**< SPIFI command mode data, Rx or Tx (SPIFI_CTRL_DMAEN) */
 
 /**
  * @brief GPDMA Burst size in Source and Destination definitions
@@ -251,6 +252,79 @@ typedef struct DMA_TransferDescriptor {
 	uint32_t ctrl;	/*!< Control word that has transfer size, type etc. */
 } DMA_TransferDescriptor_t;
 
+/**
+ * @brief Largest number of transfers in one descriptor
+ */
+#define GPDMA_MAX_TRANSFER_SIZE 0xFFF
+
+/**
+ * @brief Descriptor template, the settings shared by the descriptors of a list
+ * @note	Filled by Chip_GPDMA_InitDescTemplate() and used by
+ * Chip_GPDMA_BuildDescList(). All members are private to the driver.
+ */
+typedef struct {
+	uint32_t src;		/*!< Source data register, for peripheral sources */
+	uint32_t dst;		/*!< Destination data register, for peripheral destinations */
+	uint32_t ctrl;		/*!< Control word without the transfer size and interrupt bit */
+	uint8_t srcStep;	/*!< Source address increment per transfer, 0 for peripherals */
+	uint8_t dstStep;	/*!< Destination address increment per transfer, 0 for peripherals */
+	uint8_t sizeShift;	/*!< Right shift converting the size to a number of transfers */
+	uint8_t srcIsMem;	/*!< Source address is taken from the build call */
+	uint8_t dstIsMem;	/*!< Destination address is taken from the build call */
+} GPDMA_DESC_TEMPLATE_T;
+
+/**
+ * @brief Value returned by Chip_GPDMA_GetFreeChannel() when all channels are in use
+ */
+#define GPDMA_NO_FREE_CHANNEL GPDMA_NUMBER_CHANNELS
+
+/**
+ * @brief GPDMA request priorities, used to order queued requests
+ */
+typedef enum {
+	GPDMA_PRIO_HIGH,		/*!< Started first, on the lowest free (highest priority) channel */
+	GPDMA_PRIO_NORMAL,		/*!< Started after queued high priority requests */
+	GPDMA_PRIO_LOW,			/*!< Started when no other request is queued */
+	GPDMA_PRIO_COUNT
+} GPDMA_PRIO_T;
+
+/**
+ * @brief GPDMA request states
+ */
+typedef enum {
+	GPDMA_REQ_IDLE,			/*!< Not submitted, or completed */
+	GPDMA_REQ_QUEUED,		/*!< Waiting for a free channel */
+	GPDMA_REQ_ACTIVE		/*!< Running on a channel */
+} GPDMA_REQ_STATE_T;
+
+struct GPDMA_REQ;
+
+/**
+ * @brief GPDMA request completion callback, called from Chip_GPDMA_ServiceIRQHandler()
+ * @note	Status is SUCCESS when the transfer completed, ERROR on a bus
+ * error or when the transfer could not be started. The request may be
+ * submitted again from the callback.
+ */
+typedef void (*GPDMA_REQ_CALLBACK_T)(struct GPDMA_REQ *pReq, Status status);
+
+/**
+ * @brief GPDMA transfer request, used with Chip_GPDMA_Submit()
+ * @note	The request and its descriptors must remain valid until the
+ * request is back to GPDMA_REQ_IDLE. Only the members up to pUserData
+ * are set by the caller, the others are private to the driver.
+ */
+typedef struct GPDMA_REQ {
+	const DMA_TransferDescriptor_t *pDesc;	/*!< First descriptor of the transfer, see Chip_GPDMA_PrepareDescriptor() */
+	GPDMA_FLOW_CONTROL_T TransferType;		/*!< Transfer controller and type of transfer */
+	GPDMA_PRIO_T priority;					/*!< Queue used while no channel is free */
+	GPDMA_REQ_CALLBACK_T callback;			/*!< Called when the request completes, or NULL */
+	struct GPDMA_REQ *pChain;				/*!< Request started on the same channel when this one succeeds, or NULL */
+	void *pUserData;						/*!< Caller data, not used by the driver */
+	struct GPDMA_REQ *pNext;				/*!< Queue link */
+	volatile uint8_t state;					/*!< One of GPDMA_REQ_STATE_T */
+	uint8_t channel;						/*!< Channel running the request */
+} GPDMA_REQ_T;
+
 /**
  * @brief	Initialize the GPDMA
  * @param	pGPDMA	: The base of GPDMA on the chip
@@ -343,7 +417,10 @@ void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T *pGPDMA, GPDMA_STATECLEAR_T type, ui
  * @brief	Get a free GPDMA channel for one DMA connection
  * @param	pGPDMA					: The base of GPDMA on the chip
  * @param	PeripheralConnection_ID	: Some chip fix each peripheral DMA connection on a specified channel ( have not used in 17xx/40xx )
- * @return	The channel number which is selected
+ * @return	The channel number which is selected, or GPDMA_NO_FREE_CHANNEL
+ * @note	The channel is owned by the caller until Chip_GPDMA_Stop() is
+ * called on it. Channels running requests from Chip_GPDMA_Submit() are
+ * not returned.
  */
 uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA,
 								  uint32_t PeripheralConnection_ID);
@@ -380,6 +457,8 @@ Status Chip_GPDMA_Transfer(LPC_GPDMA_T *pGPDMA,
  * @param	DMADescriptor	: First node in the linked list of descriptors
  * @param	TransferType	: Select the transfer controller and the type of transfer. (See, #GPDMA_FLOW_CONTROL_T)
  * @return	ERROR on error, SUCCESS on success
+ * @note	The peripheral end of the first descriptor may hold either the connection number
+ *			or the data register address set by Chip_GPDMA_PrepareDescriptor().
  */
 Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
 							 uint8_t ChannelNum,
@@ -407,6 +486,105 @@ Status Chip_GPDMA_PrepareDescriptor(LPC_GPDMA_T *pGPDMA,
 									GPDMA_FLOW_CONTROL_T TransferType,
 									const DMA_TransferDescriptor_t *NextDescriptor);
 
+/**
+ * @brief	Prepare a descriptor template for one transfer type and peripheral connection
+ * @param	pGPDMA			: The base of GPDMA on the chip
+ * @param	pTmpl			: Template to be initialized
+ * @param	src				: GPDMA_CONN_MEMORY or the PeripheralConnection_ID of the source
+ * @param	dst				: GPDMA_CONN_MEMORY or the PeripheralConnection_ID of the destination
+ * @param	TransferType	: Select the transfer controller and the type of transfer. (See, #GPDMA_FLOW_CONTROL_T)
+ * @return	ERROR on error, SUCCESS on success
+ * @note	The control word is computed once here, with the burst size
+ * and width that Chip_GPDMA_PrepareDescriptor() uses for the connection.
+ */
+Status Chip_GPDMA_InitDescTemplate(LPC_GPDMA_T *pGPDMA,
+								   GPDMA_DESC_TEMPLATE_T *pTmpl,
+								   uint32_t src,
+								   uint32_t dst,
+								   GPDMA_FLOW_CONTROL_T TransferType);
+
+/**
+ * @brief	Build a linked list of descriptors for one transfer
+ * @param	pTmpl			: Template from Chip_GPDMA_InitDescTemplate()
+ * @param	pDesc			: Array receiving the descriptors
+ * @param	maxDesc			: Number of descriptors in the array
+ * @param	src				: Source memory address, unused for peripheral sources
+ * @param	dst				: Destination memory address, unused for peripheral destinations
+ * @param	Size			: The number of DMA transfers, in bytes for memory to memory as for Chip_GPDMA_PrepareDescriptor()
+ * @param	NextDescriptor	: Descriptor run after the list (may be the list itself), or 0 to end the list
+ * @return	The number of descriptors used, or 0 if Size is 0, is not a multiple of
+ * 4 for memory to memory, or does not fit in maxDesc
+ * @note	The transfer is split into descriptors of GPDMA_MAX_TRANSFER_SIZE
+ * transfers. The controller does not change the descriptors, so a list is
+ * started as many times as needed without being built again.
+ * @note	Only the last descriptor of the list raises the terminal count
+ * interrupt, so the request callback runs once for the whole list, and once
+ * per pass when NextDescriptor loops back to the list.
+ */
+int Chip_GPDMA_BuildDescList(const GPDMA_DESC_TEMPLATE_T *pTmpl,
+							 DMA_TransferDescriptor_t *pDesc,
+							 int maxDesc,
+							 uint32_t src,
+							 uint32_t dst,
+							 uint32_t Size,
+							 const DMA_TransferDescriptor_t *NextDescriptor);
+
+/**
+ * @brief	Start a DMA request on a free channel, or queue it until one is free
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pReq	: Request to start, with pDesc, TransferType, priority, callback and pChain set
+ * @return	SUCCESS when started or queued, ERROR if the request is already
+ * submitted or could not be started
+ * @note	Completion is reported by the request callback, called from
+ * Chip_GPDMA_ServiceIRQHandler(), which must be called from DMA_IRQHandler()
+ * with the DMA interrupt enabled. Descriptors of one request can be linked
+ * to run back to back without an interrupt, by only setting the interrupt
+ * bit in the last one as Chip_GPDMA_PrepareDescriptor() does.
+ */
+Status Chip_GPDMA_Submit(LPC_GPDMA_T *pGPDMA, GPDMA_REQ_T *pReq);
+
+/**
+ * @brief	Cancel a queued or running DMA request
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pReq	: Request to cancel
+ * @return	SUCCESS if the request was cancelled, ERROR if it was not submitted
+ * @note	The request callback is not called, requests chained to it are
+ * not started.
+ */
+Status Chip_GPDMA_Cancel(LPC_GPDMA_T *pGPDMA, GPDMA_REQ_T *pReq);
+
+/**
+ * @brief	Handle DMA interrupts for requests started by Chip_GPDMA_Submit()
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @return	Nothing
+ * @note	Calls the callback of each completed request, starts the request
+ * chained to it on the same channel, then gives free channels to queued
+ * requests. Channels obtained with Chip_GPDMA_GetFreeChannel() are not
+ * touched, so Chip_GPDMA_Interrupt() may still be used for them.
+ */
+void Chip_GPDMA_ServiceIRQHandler(LPC_GPDMA_T *pGPDMA);
+
+/**
+ * @brief	Return the current destination address of a running DMA request
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pReq	: Request to check
+ * @return	The address the next transfer of the request is written to, or
+ * 0 if the request is not running on a channel
+ * @note	Used to find how much of a peripheral to memory transfer has
+ * already reached memory, before the request completes.
+ */
+uint32_t Chip_GPDMA_GetRequestDstAddr(LPC_GPDMA_T *pGPDMA, const GPDMA_REQ_T *pReq);
+
+/**
+ * @brief	Return the state of a DMA request
+ * @param	pReq	: Request to check
+ * @return	One of GPDMA_REQ_STATE_T
+ */
+STATIC INLINE GPDMA_REQ_STATE_T Chip_GPDMA_GetRequestState(const GPDMA_REQ_T *pReq)
+{
+	return (GPDMA_REQ_STATE_T) pReq->state;
+}
+
 /**
  * @}
  */
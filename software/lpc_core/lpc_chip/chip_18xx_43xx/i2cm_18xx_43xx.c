@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include "string.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -51,6 +52,102 @@ static CHIP_CCU_CLK_T i2cm_getClkId(LPC_I2C_T *pI2C)
 	return (pI2C == LPC_I2C0)? CLK_APB1_I2C0 : CLK_APB3_I2C1;
 }
 
+/* SCL clocks of a START or STOP condition, and of an address or data byte */
+#define I2CM_COND_CLOCKS    1
+#define I2CM_BYTE_CLOCKS    9
+
+/* Mask the interrupts while the queue changes, jobs may be submitted from
+   any interrupt priority */
+STATIC INLINE uint32_t queueLock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+STATIC INLINE void queueUnlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Queue a job on its device, and the device on the ready list if it was
+   not there yet, called with the queue locked */
+STATIC void queueAppend(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob)
+{
+	I2CM_DEVICE_T *pDev = (pJob->pDev != NULL) ? pJob->pDev : &pQueue->dev;
+
+	pJob->pNext = NULL;
+	pJob->state = I2CM_JOB_QUEUED;
+	if (pDev->pTail == NULL) {
+		pDev->pHead = pJob;
+	}
+	else {
+		pDev->pTail->pNext = pJob;
+	}
+	pDev->pTail = pJob;
+
+	if (!pDev->ready) {
+		pDev->ready = true;
+		pDev->pNextReady = NULL;
+		if (pQueue->pReadyTail == NULL) {
+			pQueue->pReadyHead = pDev;
+		}
+		else {
+			pQueue->pReadyTail->pNextReady = pDev;
+		}
+		pQueue->pReadyTail = pDev;
+	}
+}
+
+/* Take the next job of the next ready device, the device goes to the back of
+   the ready list while it has jobs left, called with the queue locked */
+STATIC I2CM_JOB_T *queueTakeNext(I2CM_QUEUE_T *pQueue)
+{
+	I2CM_DEVICE_T *pDev = pQueue->pReadyHead;
+	I2CM_JOB_T *pJob;
+
+	if (pDev == NULL) {
+		return NULL;
+	}
+	pQueue->pReadyHead = pDev->pNextReady;
+	if (pQueue->pReadyHead == NULL) {
+		pQueue->pReadyTail = NULL;
+	}
+
+	pJob = pDev->pHead;
+	pDev->pHead = pJob->pNext;
+	if (pDev->pHead == NULL) {
+		pDev->pTail = NULL;
+		pDev->ready = false;
+	}
+	else {
+		pDev->pNextReady = NULL;
+		if (pQueue->pReadyTail == NULL) {
+			pQueue->pReadyHead = pDev;
+		}
+		else {
+			pQueue->pReadyTail->pNextReady = pDev;
+		}
+		pQueue->pReadyTail = pDev;
+	}
+
+	return pJob;
+}
+
+/* Make a job the active one from its first transfer, the caller sends the
+   START, called with the queue locked */
+STATIC void queueActivate(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob)
+{
+	pQueue->pActive = pJob;
+	pQueue->xferIndex = 0;
+	pQueue->retries = 0;
+	pQueue->xfer = pJob->pXfers[0];
+	pQueue->xfer.status = I2CM_STATUS_BUSY;
+	pJob->status = I2CM_STATUS_BUSY;
+	pJob->state = I2CM_JOB_ACTIVE;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -266,3 +363,248 @@ uint32_t Chip_I2CM_Read(LPC_I2C_T *pI2C, uint8_t *buff, uint32_t len)
 
 	return rxLen;
 }
+
+/* Initialize an interrupt driven job queue on an I2C master */
+void Chip_I2CM_Queue_Init(I2CM_QUEUE_T *pQueue, LPC_I2C_T *pI2C)
+{
+	memset(pQueue, 0, sizeof(*pQueue));
+	pQueue->pI2C = pI2C;
+
+	Chip_I2CM_ResetControl(pI2C);
+	pI2C->CONSET = I2C_CON_I2EN;
+}
+
+/* Run a job on the bus, or queue it on its device */
+Status Chip_I2CM_Queue_Submit(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob)
+{
+	Status status = SUCCESS;
+	uint32_t primask;
+
+	if ((pJob->pXfers == NULL) || (pJob->numXfers == 0)) {
+		return ERROR;
+	}
+
+	primask = queueLock();
+	if (pJob->state != I2CM_JOB_IDLE) {
+		status = ERROR;
+	}
+	else if (pQueue->pActive == NULL) {
+		queueActivate(pQueue, pJob);
+		Chip_I2CM_ResetControl(pQueue->pI2C);
+		Chip_I2CM_SendStart(pQueue->pI2C);
+	}
+	else {
+		queueAppend(pQueue, pJob);
+	}
+	queueUnlock(primask);
+
+	return status;
+}
+
+/* Submit a job every period ticks of Chip_I2CM_Queue_Tick() */
+void Chip_I2CM_Queue_Schedule(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob, uint32_t period)
+{
+	uint32_t primask;
+
+	Chip_I2CM_Queue_Unschedule(pQueue, pJob);
+
+	primask = queueLock();
+	pJob->period = period;
+	pJob->countdown = period;
+	pJob->pNextPeriodic = pQueue->pPeriodic;
+	pQueue->pPeriodic = pJob;
+	queueUnlock(primask);
+}
+
+/* Stop submitting a periodic job */
+void Chip_I2CM_Queue_Unschedule(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob)
+{
+	I2CM_JOB_T **ppLink;
+	uint32_t primask;
+
+	primask = queueLock();
+	for (ppLink = &pQueue->pPeriodic; *ppLink != NULL; ppLink = &(*ppLink)->pNextPeriodic) {
+		if (*ppLink == pJob) {
+			*ppLink = pJob->pNextPeriodic;
+			break;
+		}
+	}
+	queueUnlock(primask);
+}
+
+/* Submit the periodic jobs that are due */
+void Chip_I2CM_Queue_Tick(I2CM_QUEUE_T *pQueue)
+{
+	I2CM_JOB_T *pJob;
+
+	for (pJob = pQueue->pPeriodic; pJob != NULL; pJob = pJob->pNextPeriodic) {
+		if ((pJob->period == 0) || (--pJob->countdown != 0)) {
+			continue;
+		}
+		pJob->countdown = pJob->period;
+		if (Chip_I2CM_Queue_Submit(pQueue, pJob) == ERROR) {
+			pQueue->stats.missed++;
+		}
+	}
+}
+
+/* I2C queue state change handler */
+void Chip_I2CM_Queue_IRQHandler(I2CM_QUEUE_T *pQueue)
+{
+	LPC_I2C_T *pI2C = pQueue->pI2C;
+	I2CM_XFER_T *xfer = &pQueue->xfer;
+	I2CM_JOB_T *pJob, *pNext;
+	uint32_t cclr = I2C_CON_FLAGS;
+	uint32_t primask, status = I2CM_STATUS_BUSY;
+
+	primask = queueLock();
+	pJob = pQueue->pActive;
+	if (pJob == NULL) {
+		Chip_I2CM_ClearSI(pI2C);
+		queueUnlock(primask);
+		return;
+	}
+
+	switch (Chip_I2CM_GetCurState(pI2C)) {
+	case 0x08:		/* Start condition on bus */
+	case 0x10:		/* Repeated start condition */
+		pI2C->DAT = (xfer->slaveAddr << 1) | (xfer->txSz == 0);
+		pQueue->stats.busClocks += I2CM_COND_CLOCKS + I2CM_BYTE_CLOCKS;
+		break;
+
+	/* Tx handling */
+	case 0x20:		/* SLA+W sent NAK received */
+	case 0x30:		/* DATA sent NAK received */
+		if ((xfer->options & I2CM_XFER_OPTION_IGNORE_NACK) == 0) {
+			status = (Chip_I2CM_GetCurState(pI2C) == 0x20) ? I2CM_STATUS_SLAVE_NAK : I2CM_STATUS_NAK;
+			break;
+		}
+
+	case 0x18:		/* SLA+W sent and ACK received */
+	case 0x28:		/* DATA sent and ACK received */
+		if (xfer->txSz) {
+			pI2C->DAT = *xfer->txBuff++;
+			xfer->txSz--;
+			pQueue->stats.busClocks += I2CM_BYTE_CLOCKS;
+		}
+		else if (xfer->rxSz) {
+			/* Turn around to reading with a repeated start */
+			cclr &= ~I2C_CON_STA;
+		}
+		else {
+			status = I2CM_STATUS_OK;
+		}
+		break;
+
+	/* Rx handling */
+	case 0x58:		/* Data Received and NACK sent */
+	case 0x50:		/* Data Received and ACK sent */
+		*xfer->rxBuff++ = pI2C->DAT;
+		xfer->rxSz--;
+
+	case 0x40:		/* SLA+R sent and ACK received */
+		if (xfer->rxSz == 0) {
+			status = I2CM_STATUS_OK;
+		}
+		else {
+			if ((xfer->rxSz > 1) || (xfer->options & I2CM_XFER_OPTION_LAST_RX_ACK)) {
+				cclr &= ~I2C_CON_AA;
+			}
+			pQueue->stats.busClocks += I2CM_BYTE_CLOCKS;
+		}
+		break;
+
+	/* NAK Handling */
+	case 0x48:		/* SLA+R sent NAK received */
+		status = I2CM_STATUS_SLAVE_NAK;
+		break;
+
+	case 0x38:		/* Arbitration lost */
+		pQueue->stats.arbLost++;
+		if (pQueue->retries < I2CM_JOB_ARB_RETRIES) {
+			/* Run the job again from its first transfer once the bus is free */
+			pQueue->retries++;
+			pQueue->xferIndex = 0;
+			pQueue->xfer = pJob->pXfers[0];
+			cclr &= ~I2C_CON_STA;
+		}
+		else {
+			status = I2CM_STATUS_ARBLOST;
+		}
+		break;
+
+	case 0x00:		/* Bus Error */
+		status = I2CM_STATUS_BUS_ERROR;
+		break;
+
+	case 0xF8:		/* No state change */
+		queueUnlock(primask);
+		return;
+
+	default:
+		status = I2CM_STATUS_ERROR;
+		break;
+	}
+
+	if (status == I2CM_STATUS_OK) {
+		pJob->pXfers[pQueue->xferIndex].status = I2CM_STATUS_OK;
+		pQueue->stats.xfers++;
+
+		/* Chain the next transfer of the job with a repeated start */
+		if (++pQueue->xferIndex < pJob->numXfers) {
+			pQueue->xfer = pJob->pXfers[pQueue->xferIndex];
+			cclr &= ~I2C_CON_STA;
+			status = I2CM_STATUS_BUSY;
+		}
+	}
+	else if (status != I2CM_STATUS_BUSY) {
+		pJob->pXfers[pQueue->xferIndex].status = status;
+	}
+
+	pNext = NULL;
+	if (status != I2CM_STATUS_BUSY) {
+		/* End the job with a STOP, unless the bus was lost to another master */
+		if (status != I2CM_STATUS_ARBLOST) {
+			cclr &= ~I2C_CON_STO;
+			pQueue->stats.busClocks += I2CM_COND_CLOCKS;
+		}
+		pQueue->stats.jobs++;
+		if (status != I2CM_STATUS_OK) {
+			pQueue->stats.errors++;
+		}
+		pJob->status = status;
+		pJob->state = I2CM_JOB_IDLE;
+		pQueue->pActive = NULL;
+
+		/* STO and STA together send the START of the next job right after the STOP */
+		pNext = queueTakeNext(pQueue);
+		if (pNext != NULL) {
+			queueActivate(pQueue, pNext);
+			cclr &= ~I2C_CON_STA;
+		}
+	}
+
+	/* Set clear control flags */
+	pI2C->CONSET = cclr ^ I2C_CON_FLAGS;
+	/* Stop flag should not be cleared as it is a reserved bit */
+	pI2C->CONCLR = cclr & (I2C_CON_AA | I2C_CON_SI | I2C_CON_STA);
+	queueUnlock(primask);
+
+	/* Called with the bus already busy again, the callback may submit */
+	if ((status != I2CM_STATUS_BUSY) && (pJob->callback != NULL)) {
+		pJob->callback(pJob, status);
+	}
+}
+
+/* Read the I2C queue statistics */
+void Chip_I2CM_Queue_GetStats(I2CM_QUEUE_T *pQueue, I2CM_QUEUE_STATS_T *pStats, bool clear)
+{
+	uint32_t primask;
+
+	primask = queueLock();
+	*pStats = pQueue->stats;
+	if (clear) {
+		memset(&pQueue->stats, 0, sizeof(pQueue->stats));
+	}
+	queueUnlock(primask);
+}
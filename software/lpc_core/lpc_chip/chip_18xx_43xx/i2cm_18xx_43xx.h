@@ -408,6 +408,177 @@ uint32_t Chip_I2CM_Write(LPC_I2C_T *pI2C, const uint8_t *buff, uint32_t len);
  */
 uint32_t Chip_I2CM_Read(LPC_I2C_T *pI2C, uint8_t *buff, uint32_t len);
 
+/**
+ * @brief Restarts of an I2C queue job that loses arbitration before it fails
+ */
+#define I2CM_JOB_ARB_RETRIES    3
+
+/**
+ * @brief I2C queue job states
+ */
+typedef enum {
+	I2CM_JOB_IDLE,			/*!< Not submitted, or completed */
+	I2CM_JOB_QUEUED,		/*!< Waiting for its turn on the bus */
+	I2CM_JOB_ACTIVE			/*!< Running on the bus */
+} I2CM_JOB_STATE_T;
+
+struct I2CM_JOB;
+struct I2CM_DEVICE;
+
+/**
+ * @brief I2C queue job completion callback, called from the I2C interrupt
+ * @note	Status is I2CM_STATUS_OK, or the status of the transfer that
+ * failed. The job may be submitted again from the callback.
+ */
+typedef void (*I2CM_JOB_CALLBACK_T)(struct I2CM_JOB *pJob, uint32_t status);
+
+/**
+ * @brief I2C queue job, transfers joined by repeated starts and ended by one STOP
+ * @note	Each transfer runs as described for Chip_I2CM_Xfer(), with its own
+ * slave address and options. The queue works on a copy of the running
+ * transfer and only sets the status member of the transfers, so a job can
+ * be submitted again as it is. The job, its transfers and their buffers must
+ * remain valid until the job is back to I2CM_JOB_IDLE. Only the members up
+ * to pUserData are set by the caller, the others are private to the driver.
+ *
+ *          S Addr0 Wr [A] txBuff0 [A] S Addr0 Rd [A] [rxBuff0] NA
+ *              S Addr1 Wr [A] ... P
+ */
+typedef struct I2CM_JOB {
+	I2CM_XFER_T *pXfers;			/*!< Transfers run in order */
+	uint8_t numXfers;				/*!< Number of transfers */
+	struct I2CM_DEVICE *pDev;		/*!< Device the job is queued on, or NULL for the queue's own */
+	I2CM_JOB_CALLBACK_T callback;	/*!< Called when the job completes, or NULL */
+	void *pUserData;				/*!< Caller data, not used by the driver */
+	struct I2CM_JOB *pNext;			/*!< Device queue link */
+	struct I2CM_JOB *pNextPeriodic;	/*!< Periodic job list link */
+	uint32_t period;				/*!< Ticks between periodic submissions */
+	uint32_t countdown;				/*!< Ticks left to the next periodic submission */
+	volatile uint8_t state;			/*!< One of I2CM_JOB_STATE_T */
+	uint16_t status;				/*!< Status of the last run */
+} I2CM_JOB_T;
+
+/**
+ * @brief I2C queue device, usually one per slave
+ * @note	The jobs of a device run in submission order. Devices with queued
+ * jobs take turns on the bus one job at a time, so a device with many jobs
+ * queued does not hold up the others. Clear the structure before its first
+ * use, all members are private to the driver.
+ */
+typedef struct I2CM_DEVICE {
+	I2CM_JOB_T *pHead;				/*!< First queued job */
+	I2CM_JOB_T *pTail;				/*!< Last queued job */
+	struct I2CM_DEVICE *pNextReady;	/*!< Ready device list link */
+	bool ready;						/*!< On the ready device list */
+} I2CM_DEVICE_T;
+
+/**
+ * @brief I2C queue statistics
+ */
+typedef struct {
+	uint32_t jobs;			/*!< Jobs completed */
+	uint32_t xfers;			/*!< Transfers completed without error */
+	uint32_t errors;		/*!< Jobs completed with an error */
+	uint32_t arbLost;		/*!< Arbitration losses, retried or not */
+	uint32_t missed;		/*!< Periodic submissions skipped, the job still pending */
+	uint32_t busClocks;		/*!< SCL clocks used by START, address, data and STOP */
+} I2CM_QUEUE_STATS_T;
+
+/**
+ * @brief I2C job queue of one I2C bus, used with Chip_I2CM_Queue_Init()
+ * @note	All members are private to the driver.
+ */
+typedef struct {
+	LPC_I2C_T *pI2C;				/*!< I2C running the jobs */
+	I2CM_JOB_T *pActive;			/*!< Job on the bus */
+	I2CM_DEVICE_T *pReadyHead;		/*!< Next device to run a job */
+	I2CM_DEVICE_T *pReadyTail;		/*!< Last device to run a job */
+	I2CM_DEVICE_T dev;				/*!< Device of the jobs without one */
+	I2CM_JOB_T *pPeriodic;			/*!< Periodic jobs */
+	I2CM_XFER_T xfer;				/*!< Copy of the running transfer */
+	uint8_t xferIndex;				/*!< Index of the running transfer in its job */
+	uint8_t retries;				/*!< Restarts of the active job */
+	I2CM_QUEUE_STATS_T stats;		/*!< Statistics */
+} I2CM_QUEUE_T;
+
+/**
+ * @brief	Initialize an interrupt driven job queue on an I2C master
+ * @param	pQueue	: Queue to initialize
+ * @param	pI2C	: Pointer to selected I2C peripheral, set up with Chip_I2CM_Init()
+ *                    and Chip_I2CM_SetBusSpeed()
+ * @return	Nothing
+ * @note	Chip_I2CM_Queue_IRQHandler() must be called from the interrupt
+ * handler of the I2C, and the interrupt enabled. No other transfer may be
+ * run on the I2C while the queue uses it.
+ */
+void Chip_I2CM_Queue_Init(I2CM_QUEUE_T *pQueue, LPC_I2C_T *pI2C);
+
+/**
+ * @brief	Run a job on the bus, or queue it on its device
+ * @param	pQueue	: I2C queue
+ * @param	pJob	: Job to run
+ * @return	SUCCESS when started or queued, ERROR if the job is already
+ * submitted or has no transfers
+ */
+Status Chip_I2CM_Queue_Submit(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob);
+
+/**
+ * @brief	Submit a job every period ticks of Chip_I2CM_Queue_Tick()
+ * @param	pQueue	: I2C queue
+ * @param	pJob	: Job to add to the periodic jobs
+ * @param	period	: Ticks between submissions, the first one is a period away
+ * @return	Nothing
+ */
+void Chip_I2CM_Queue_Schedule(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob, uint32_t period);
+
+/**
+ * @brief	Stop submitting a periodic job
+ * @param	pQueue	: I2C queue
+ * @param	pJob	: Job to remove from the periodic jobs
+ * @return	Nothing
+ * @note	A run already submitted still completes.
+ */
+void Chip_I2CM_Queue_Unschedule(I2CM_QUEUE_T *pQueue, I2CM_JOB_T *pJob);
+
+/**
+ * @brief	Submit the periodic jobs that are due
+ * @param	pQueue	: I2C queue
+ * @return	Nothing
+ * @note	Call from a timer interrupt, such as SysTick_Handler(). A job
+ * still pending when it is due skips that period.
+ */
+void Chip_I2CM_Queue_Tick(I2CM_QUEUE_T *pQueue);
+
+/**
+ * @brief	I2C queue state change handler
+ * @param	pQueue	: I2C queue
+ * @return	Nothing
+ * @note	Call from I2C0_IRQHandler() or I2C1_IRQHandler(). The end of a
+ * job and the start of the next one are sent together as STOP and START.
+ */
+void Chip_I2CM_Queue_IRQHandler(I2CM_QUEUE_T *pQueue);
+
+/**
+ * @brief	Read the I2C queue statistics
+ * @param	pQueue	: I2C queue
+ * @param	pStats	: Structure receiving the statistics
+ * @param	clear	: true to reset the statistics after reading them
+ * @return	Nothing
+ * @note	The bus utilisation over a time is busClocks divided by the
+ * number of SCL periods in that time.
+ */
+void Chip_I2CM_Queue_GetStats(I2CM_QUEUE_T *pQueue, I2CM_QUEUE_STATS_T *pStats, bool clear);
+
+/**
+ * @brief	Return the state of an I2C queue job
+ * @param	pJob	: Job to check
+ * @return	One of I2CM_JOB_STATE_T
+ */
+static INLINE I2CM_JOB_STATE_T Chip_I2CM_Queue_GetJobState(const I2CM_JOB_T *pJob)
+{
+	return (I2CM_JOB_STATE_T) pJob->state;
+}
+
 /**
  * @}
  */
@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include "string.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -130,6 +131,212 @@ STATIC CHIP_CCU_CLK_T Chip_SSP_GetPeriphClockIndex(LPC_SSP_T *pSSP)
 
 	return clkSSP;
 }
+
+/* Find the clock divider and prescaler giving the highest rate not above bitRate */
+STATIC void SSP_FindClockRate(LPC_SSP_T *pSSP, uint32_t bitRate, uint32_t *pDiv, uint32_t *pPrescale)
+{
+	uint32_t ssp_clk, cr0_div, cmp_clk, prescale;
+
+	ssp_clk = Chip_Clock_GetRate(Chip_SSP_GetPeriphClockIndex(pSSP));
+
+	cr0_div = 0;
+	cmp_clk = 0xFFFFFFFF;
+	prescale = 2;
+
+	while (cmp_clk > bitRate) {
+		cmp_clk = ssp_clk / ((cr0_div + 1) * prescale);
+		if (cmp_clk > bitRate) {
+			cr0_div++;
+			if (cr0_div > 0xFF) {
+				cr0_div = 0;
+				prescale += 2;
+			}
+		}
+	}
+
+	*pDiv = cr0_div;
+	*pPrescale = prescale;
+}
+
+/* Sent by jobs without tx_data */
+static const uint16_t SSP_QueueOnes = 0xFFFF;
+
+/* Mask the interrupts while the queue changes, jobs may be submitted from
+   any interrupt priority */
+STATIC INLINE uint32_t queueLock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+STATIC INLINE void queueUnlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Drive the chip select of a job */
+STATIC INLINE void queueSetCS(const SSP_JOB_T *pJob, bool level)
+{
+	if (pJob->cs.port != SSP_JOB_NO_CS) {
+		Chip_GPIO_SetPinState(LPC_GPIO_PORT, pJob->cs.port, pJob->cs.pin, level);
+	}
+}
+
+/* Change a byte template to move 16-bit frames */
+STATIC void queueWiden(GPDMA_DESC_TEMPLATE_T *pTmpl)
+{
+	pTmpl->ctrl &= ~(GPDMA_DMACCxControl_SWidth(7) | GPDMA_DMACCxControl_DWidth(7));
+	pTmpl->ctrl |= GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_HALFWORD) |
+				   GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_HALFWORD);
+	if (pTmpl->srcStep != 0) {
+		pTmpl->srcStep = 2;
+	}
+	if (pTmpl->dstStep != 0) {
+		pTmpl->dstStep = 2;
+	}
+}
+
+/* Start a job on the idle bus, called with the queue locked. The job is
+   left active when it fails to start, for queueFinish() to end it. */
+STATIC Status queueStart(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob)
+{
+	LPC_SSP_T *pSSP = pQueue->pSSP;
+	GPDMA_DESC_TEMPLATE_T rxTmpl = pQueue->rxTmpl;
+	GPDMA_DESC_TEMPLATE_T txTmpl = pQueue->txTmpl;
+	uint32_t rxAddr = (uint32_t) pJob->rx_data;
+	uint32_t txAddr = (uint32_t) pJob->tx_data;
+
+	pQueue->pActive = pJob;
+	pJob->state = SSP_JOB_ACTIVE;
+
+	/* The bus is idle between jobs, its settings can change */
+	pSSP->CR0 = pJob->cr0;
+	pSSP->CPSR = pJob->cpsr;
+	while (Chip_SSP_GetStatus(pSSP, SSP_STAT_RNE)) {
+		Chip_SSP_ReceiveFrame(pSSP);
+	}
+	Chip_SSP_ClearIntPending(pSSP, SSP_INT_CLEAR_BITMASK);
+
+	if (pJob->bits > SSP_BITS_8) {
+		queueWiden(&rxTmpl);
+		queueWiden(&txTmpl);
+	}
+	if (pJob->rx_data == NULL) {
+		rxTmpl.ctrl &= ~GPDMA_DMACCxControl_DI;
+		rxTmpl.dstStep = 0;
+		rxAddr = (uint32_t) &pQueue->dummy;
+	}
+	if (pJob->tx_data == NULL) {
+		txTmpl.ctrl &= ~GPDMA_DMACCxControl_SI;
+		txTmpl.srcStep = 0;
+		txAddr = (uint32_t) &SSP_QueueOnes;
+	}
+	/* A job changed since it was submitted may not fit the descriptors */
+	if ((Chip_GPDMA_BuildDescList(&rxTmpl, pQueue->rxDesc, SSP_JOB_MAX_DESC, 0, rxAddr, pJob->length, NULL) == 0) ||
+		(Chip_GPDMA_BuildDescList(&txTmpl, pQueue->txDesc, SSP_JOB_MAX_DESC, txAddr, 0, pJob->length, NULL) == 0)) {
+		return ERROR;
+	}
+
+	queueSetCS(pJob, false);
+
+	/* Receive has the higher priority, transmit is queued behind it by the
+	   DMA service and never starts first */
+	pQueue->pending = 2;
+	if (Chip_GPDMA_Submit(pQueue->pGPDMA, &pQueue->rxReq) == ERROR) {
+		pQueue->pending = 0;
+		return ERROR;
+	}
+	if (Chip_GPDMA_Submit(pQueue->pGPDMA, &pQueue->txReq) == ERROR) {
+		Chip_GPDMA_Cancel(pQueue->pGPDMA, &pQueue->rxReq);
+		pQueue->pending = 0;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/* End the active job and start the next one, called with the queue locked.
+   Jobs that fail to start are ended in turn by the same loop. */
+STATIC void queueFinish(SSP_QUEUE_T *pQueue, Status status)
+{
+	SSP_JOB_T *pJob;
+	SSP_JOB_T *pNext;
+
+	do {
+		pJob = pQueue->pActive;
+		queueSetCS(pJob, true);
+		if (Chip_SSP_GetRawIntStatus(pQueue->pSSP, SSP_RORRIS) == SET) {
+			status = ERROR;
+		}
+
+		pQueue->stats.jobs++;
+		if (status == SUCCESS) {
+			pQueue->stats.frames += pJob->length;
+		}
+		else {
+			pQueue->stats.errors++;
+		}
+		pJob->status = status;
+		pJob->state = SSP_JOB_IDLE;
+		pQueue->pActive = NULL;
+
+		/* Keep the bus busy before calling back, the callback may submit again */
+		pNext = pQueue->pHead;
+		if (pNext != NULL) {
+			pQueue->pHead = pNext->pNext;
+			if (pQueue->pHead == NULL) {
+				pQueue->pTail = NULL;
+			}
+			if (queueStart(pQueue, pNext) == SUCCESS) {
+				pNext = NULL;
+			}
+		}
+
+		if (pJob->callback != NULL) {
+			pJob->callback(pJob, pJob->status);
+		}
+		status = ERROR;
+	} while (pNext != NULL);
+}
+
+/* DMA completion of the receive or transmit half of the active job */
+STATIC void queueDmaDone(GPDMA_REQ_T *pReq, Status status)
+{
+	SSP_QUEUE_T *pQueue = (SSP_QUEUE_T *) pReq->pUserData;
+	uint32_t primask;
+
+	primask = queueLock();
+	if (pQueue->pending > 0) {
+		if (status == ERROR) {
+			/* The other half would never complete */
+			Chip_GPDMA_Cancel(pQueue->pGPDMA, &pQueue->rxReq);
+			Chip_GPDMA_Cancel(pQueue->pGPDMA, &pQueue->txReq);
+			pQueue->pending = 0;
+			queueFinish(pQueue, ERROR);
+		}
+		else if (--pQueue->pending == 0) {
+			queueFinish(pQueue, SUCCESS);
+		}
+	}
+	queueUnlock(primask);
+}
+
+/* Set up a DMA request of the queue */
+STATIC void queueInitReq(SSP_QUEUE_T *pQueue, GPDMA_REQ_T *pReq, DMA_TransferDescriptor_t *pDesc,
+						 GPDMA_FLOW_CONTROL_T TransferType, GPDMA_PRIO_T priority)
+{
+	pReq->pDesc = pDesc;
+	pReq->TransferType = TransferType;
+	pReq->priority = priority;
+	pReq->callback = queueDmaDone;
+	pReq->pChain = NULL;
+	pReq->pUserData = pQueue;
+	pReq->pNext = NULL;
+	pReq->state = GPDMA_REQ_IDLE;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -424,25 +631,9 @@ void Chip_SSP_SetMaster(LPC_SSP_T *pSSP, bool master)
 /* Set the clock frequency for SSP interface */
 void Chip_SSP_SetBitRate(LPC_SSP_T *pSSP, uint32_t bitRate)
 {
-	uint32_t ssp_clk, cr0_div, cmp_clk, prescale;
-
-	ssp_clk = Chip_Clock_GetRate(Chip_SSP_GetPeriphClockIndex(pSSP));
-
-	cr0_div = 0;
-	cmp_clk = 0xFFFFFFFF;
-	prescale = 2;
-
-	while (cmp_clk > bitRate) {
-		cmp_clk = ssp_clk / ((cr0_div + 1) * prescale);
-		if (cmp_clk > bitRate) {
-			cr0_div++;
-			if (cr0_div > 0xFF) {
-				cr0_div = 0;
-				prescale += 2;
-			}
-		}
-	}
+	uint32_t cr0_div, prescale;
 
+	SSP_FindClockRate(pSSP, bitRate, &cr0_div, &prescale);
 	Chip_SSP_SetClockRate(pSSP, cr0_div, prescale);
 }
 
@@ -467,3 +658,142 @@ void Chip_SSP_DeInit(LPC_SSP_T *pSSP)
 	
 }
 
+/* Initialize a DMA driven job queue on an SSP in master mode */
+Status Chip_SSP_Queue_Init(SSP_QUEUE_T *pQueue, LPC_SSP_T *pSSP, LPC_GPDMA_T *pGPDMA)
+{
+	uint32_t rxConn = (pSSP == LPC_SSP1) ? GPDMA_CONN_SSP1_Rx : GPDMA_CONN_SSP0_Rx;
+	uint32_t txConn = (pSSP == LPC_SSP1) ? GPDMA_CONN_SSP1_Tx : GPDMA_CONN_SSP0_Tx;
+
+	if ((Chip_GPDMA_InitDescTemplate(pGPDMA, &pQueue->rxTmpl, rxConn, GPDMA_CONN_MEMORY,
+									 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) ||
+		(Chip_GPDMA_InitDescTemplate(pGPDMA, &pQueue->txTmpl, GPDMA_CONN_MEMORY, txConn,
+									 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR)) {
+		return ERROR;
+	}
+
+	pQueue->pSSP = pSSP;
+	pQueue->pGPDMA = pGPDMA;
+	pQueue->pActive = NULL;
+	pQueue->pHead = NULL;
+	pQueue->pTail = NULL;
+	pQueue->pPeriodic = NULL;
+	pQueue->pending = 0;
+	memset(&pQueue->stats, 0, sizeof(pQueue->stats));
+	queueInitReq(pQueue, &pQueue->rxReq, pQueue->rxDesc, GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+				 GPDMA_PRIO_HIGH);
+	queueInitReq(pQueue, &pQueue->txReq, pQueue->txDesc, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+				 GPDMA_PRIO_NORMAL);
+
+	Chip_SSP_Set_Mode(pSSP, SSP_MODE_MASTER);
+	Chip_SSP_DMA_Enable(pSSP);
+	Chip_SSP_Enable(pSSP);
+
+	return SUCCESS;
+}
+
+/* Run a job on the bus, or queue it behind the running jobs */
+Status Chip_SSP_Queue_Submit(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob)
+{
+	Status status = SUCCESS;
+	uint32_t primask, cr0_div, prescale;
+
+	if ((pJob->length == 0) || (pJob->length > SSP_JOB_MAX_FRAMES) ||
+		(pJob->bits < SSP_BITS_4) || (pJob->bits > SSP_BITS_16) || (pJob->bitRate == 0)) {
+		return ERROR;
+	}
+
+	/* The divider search is too slow for the interrupt starting the job */
+	if (pJob->rateCached != pJob->bitRate) {
+		SSP_FindClockRate(pQueue->pSSP, pJob->bitRate, &cr0_div, &prescale);
+		pJob->cpsr = prescale;
+		pJob->cr0 = SSP_CR0_SCR(cr0_div);
+		pJob->rateCached = pJob->bitRate;
+	}
+	pJob->cr0 = (pJob->cr0 & SSP_CR0_SCR(0xFF)) | pJob->bits | SSP_FRAMEFORMAT_SPI | pJob->clockMode;
+
+	primask = queueLock();
+	if (pJob->state != SSP_JOB_IDLE) {
+		status = ERROR;
+	}
+	else if (pQueue->pActive == NULL) {
+		if (queueStart(pQueue, pJob) == ERROR) {
+			queueFinish(pQueue, ERROR);
+		}
+	}
+	else {
+		pJob->pNext = NULL;
+		pJob->state = SSP_JOB_QUEUED;
+		if (pQueue->pTail == NULL) {
+			pQueue->pHead = pJob;
+		}
+		else {
+			pQueue->pTail->pNext = pJob;
+		}
+		pQueue->pTail = pJob;
+	}
+	queueUnlock(primask);
+
+	return status;
+}
+
+/* Submit a job every period ticks of Chip_SSP_Queue_Tick() */
+void Chip_SSP_Queue_Schedule(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob, uint32_t period)
+{
+	uint32_t primask;
+
+	Chip_SSP_Queue_Unschedule(pQueue, pJob);
+
+	primask = queueLock();
+	pJob->period = period;
+	pJob->countdown = period;
+	pJob->pNextPeriodic = pQueue->pPeriodic;
+	pQueue->pPeriodic = pJob;
+	queueUnlock(primask);
+}
+
+/* Stop submitting a periodic job */
+void Chip_SSP_Queue_Unschedule(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob)
+{
+	SSP_JOB_T **ppLink;
+	uint32_t primask;
+
+	primask = queueLock();
+	for (ppLink = &pQueue->pPeriodic; *ppLink != NULL; ppLink = &(*ppLink)->pNextPeriodic) {
+		if (*ppLink == pJob) {
+			*ppLink = pJob->pNextPeriodic;
+			break;
+		}
+	}
+	queueUnlock(primask);
+}
+
+/* Submit the periodic jobs that are due */
+void Chip_SSP_Queue_Tick(SSP_QUEUE_T *pQueue)
+{
+	SSP_JOB_T *pJob;
+
+	for (pJob = pQueue->pPeriodic; pJob != NULL; pJob = pJob->pNextPeriodic) {
+		if ((pJob->period == 0) || (--pJob->countdown != 0)) {
+			continue;
+		}
+		pJob->countdown = pJob->period;
+
+		/* A job that is not valid fails without being counted as missed */
+		if ((Chip_SSP_Queue_Submit(pQueue, pJob) == ERROR) && (pJob->state != SSP_JOB_IDLE)) {
+			pQueue->stats.missed++;
+		}
+	}
+}
+
+/* Read the SSP queue statistics */
+void Chip_SSP_Queue_GetStats(SSP_QUEUE_T *pQueue, SSP_QUEUE_STATS_T *pStats, bool clear)
+{
+	uint32_t primask;
+
+	primask = queueLock();
+	*pStats = pQueue->stats;
+	if (clear) {
+		memset(&pQueue->stats, 0, sizeof(pQueue->stats));
+	}
+	queueUnlock(primask);
+}
@@ -587,6 +587,166 @@ void Chip_SSP_SetMaster(LPC_SSP_T *pSSP, bool master);
  */
 void Chip_SSP_SetBitRate(LPC_SSP_T *pSSP, uint32_t bitRate);
 
+/**
+ * @brief Largest number of frames in one SSP queue job
+ */
+#define SSP_JOB_MAX_DESC        4
+#define SSP_JOB_MAX_FRAMES      (SSP_JOB_MAX_DESC * GPDMA_MAX_TRANSFER_SIZE)
+
+/**
+ * @brief SSP_JOB_T chip select port value for jobs without a GPIO chip select
+ */
+#define SSP_JOB_NO_CS           0xFF
+
+/**
+ * @brief SSP queue job states
+ */
+typedef enum {
+	SSP_JOB_IDLE,			/*!< Not submitted, or completed */
+	SSP_JOB_QUEUED,			/*!< Waiting for the jobs ahead of it */
+	SSP_JOB_ACTIVE			/*!< Running on the bus */
+} SSP_JOB_STATE_T;
+
+struct SSP_JOB;
+
+/**
+ * @brief SSP queue job completion callback, called from the DMA interrupt
+ * @note	Status is ERROR on a DMA error, a receive overrun or when the
+ * DMA transfers of the job could not be started. The job may be submitted
+ * again from the callback.
+ */
+typedef void (*SSP_JOB_CALLBACK_T)(struct SSP_JOB *pJob, Status status);
+
+/**
+ * @brief SSP queue job, one chip select assertion on the bus
+ * @note	The job and its buffers must remain valid until the job is back
+ * to SSP_JOB_IDLE. Only the members up to pUserData are set by the caller,
+ * the others are private to the driver. Frames of 9 bits or more are held
+ * in 16-bit words.
+ */
+typedef struct SSP_JOB {
+	const void *tx_data;			/*!< Frames to send, or NULL to send all ones */
+	void *rx_data;					/*!< Buffer for the received frames, or NULL to drop them */
+	uint32_t length;				/*!< Number of frames, up to SSP_JOB_MAX_FRAMES */
+	uint32_t bitRate;				/*!< SPI clock rate of the job */
+	CHIP_SSP_BITS_T bits;			/*!< Frame size, SSP_BITS_4 to SSP_BITS_16 */
+	CHIP_SSP_CLOCK_MODE_T clockMode;/*!< Clock phase and polarity */
+	SPI_Address_t cs;				/*!< GPIO driven low during the job, port SSP_JOB_NO_CS for none */
+	SSP_JOB_CALLBACK_T callback;	/*!< Called when the job completes, or NULL */
+	void *pUserData;				/*!< Caller data, not used by the driver */
+	struct SSP_JOB *pNext;			/*!< Queue link */
+	struct SSP_JOB *pNextPeriodic;	/*!< Periodic job list link */
+	uint32_t rateCached;			/*!< Bit rate the clock settings below are computed for */
+	uint32_t cr0;					/*!< CR0 value of the job */
+	uint32_t cpsr;					/*!< CPSR value of the job */
+	uint32_t period;				/*!< Ticks between periodic submissions */
+	uint32_t countdown;				/*!< Ticks left to the next periodic submission */
+	volatile uint8_t state;			/*!< One of SSP_JOB_STATE_T */
+	Status status;					/*!< Status of the last run */
+} SSP_JOB_T;
+
+/**
+ * @brief SSP queue statistics
+ */
+typedef struct {
+	uint32_t jobs;			/*!< Jobs completed */
+	uint32_t frames;		/*!< Frames transferred by completed jobs */
+	uint32_t errors;		/*!< Jobs completed with an error */
+	uint32_t missed;		/*!< Periodic submissions skipped, the job still running */
+} SSP_QUEUE_STATS_T;
+
+/**
+ * @brief SSP job queue of one SSP bus, used with Chip_SSP_Queue_Init()
+ * @note	All members are private to the driver.
+ */
+typedef struct {
+	LPC_SSP_T *pSSP;									/*!< SSP running the jobs */
+	LPC_GPDMA_T *pGPDMA;								/*!< DMA controller */
+	GPDMA_DESC_TEMPLATE_T rxTmpl;						/*!< Receive descriptor template */
+	GPDMA_DESC_TEMPLATE_T txTmpl;						/*!< Transmit descriptor template */
+	DMA_TransferDescriptor_t rxDesc[SSP_JOB_MAX_DESC];	/*!< Receive descriptors of the active job */
+	DMA_TransferDescriptor_t txDesc[SSP_JOB_MAX_DESC];	/*!< Transmit descriptors of the active job */
+	GPDMA_REQ_T rxReq;									/*!< Receive DMA request */
+	GPDMA_REQ_T txReq;									/*!< Transmit DMA request */
+	SSP_JOB_T *pActive;									/*!< Job on the bus */
+	SSP_JOB_T *pHead;									/*!< First queued job */
+	SSP_JOB_T *pTail;									/*!< Last queued job */
+	SSP_JOB_T *pPeriodic;								/*!< Periodic jobs */
+	uint8_t pending;									/*!< DMA requests of the active job still running */
+	uint32_t dummy;										/*!< Receives the frames of jobs without rx_data */
+	SSP_QUEUE_STATS_T stats;							/*!< Statistics */
+} SSP_QUEUE_T;
+
+/**
+ * @brief	Initialize a DMA driven job queue on an SSP in master mode
+ * @param	pQueue	: Queue to initialize
+ * @param	pSSP	: The base of SSP peripheral on the chip, set up with Chip_SSP_Init()
+ * @param	pGPDMA	: The base of GPDMA on the chip, already initialized
+ * @return	ERROR if the DMA connections cannot be set up, SUCCESS otherwise
+ * @note	Jobs run back to back, with the clock rate, frame size and mode
+ * of each job set between them and the frames moved by two DMA channels.
+ * Chip_GPDMA_ServiceIRQHandler() must be called from DMA_IRQHandler(). The
+ * chip select pins must be set up as GPIO outputs driven high.
+ */
+Status Chip_SSP_Queue_Init(SSP_QUEUE_T *pQueue, LPC_SSP_T *pSSP, LPC_GPDMA_T *pGPDMA);
+
+/**
+ * @brief	Run a job on the bus, or queue it behind the running jobs
+ * @param	pQueue	: SSP queue
+ * @param	pJob	: Job to run
+ * @return	SUCCESS when started or queued, ERROR if the job is already
+ * submitted or its settings are not valid
+ * @note	The clock settings of a job are computed when it is first
+ * submitted and again only when its bitRate changes.
+ */
+Status Chip_SSP_Queue_Submit(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob);
+
+/**
+ * @brief	Submit a job every period ticks of Chip_SSP_Queue_Tick()
+ * @param	pQueue	: SSP queue
+ * @param	pJob	: Job to add to the periodic jobs
+ * @param	period	: Ticks between submissions, the first one is a period away
+ * @return	Nothing
+ */
+void Chip_SSP_Queue_Schedule(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob, uint32_t period);
+
+/**
+ * @brief	Stop submitting a periodic job
+ * @param	pQueue	: SSP queue
+ * @param	pJob	: Job to remove from the periodic jobs
+ * @return	Nothing
+ * @note	A run already submitted still completes.
+ */
+void Chip_SSP_Queue_Unschedule(SSP_QUEUE_T *pQueue, SSP_JOB_T *pJob);
+
+/**
+ * @brief	Submit the periodic jobs that are due
+ * @param	pQueue	: SSP queue
+ * @return	Nothing
+ * @note	Call from a timer interrupt, such as SysTick_Handler(). A job
+ * still running when it is due skips that period.
+ */
+void Chip_SSP_Queue_Tick(SSP_QUEUE_T *pQueue);
+
+/**
+ * @brief	Read the SSP queue statistics
+ * @param	pQueue	: SSP queue
+ * @param	pStats	: Structure receiving the statistics
+ * @param	clear	: true to reset the statistics after reading them
+ * @return	Nothing
+ */
+void Chip_SSP_Queue_GetStats(SSP_QUEUE_T *pQueue, SSP_QUEUE_STATS_T *pStats, bool clear);
+
+/**
+ * @brief	Return the state of an SSP queue job
+ * @param	pJob	: Job to check
+ * @return	One of SSP_JOB_STATE_T
+ */
+STATIC INLINE SSP_JOB_STATE_T Chip_SSP_Queue_GetJobState(const SSP_JOB_T *pJob)
+{
+	return (SSP_JOB_STATE_T) pJob->state;
+}
+
 /**
  * @}
  */
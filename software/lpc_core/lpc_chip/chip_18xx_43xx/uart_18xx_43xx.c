@@ -88,6 +88,169 @@ STATIC void Chip_UART_ABIntHandler(LPC_USART_T *pUART)
 	}
 }
 
+/* GPDMA connections of the UARTs, in Chip_UART_GetIndex() order */
+static const uint8_t UART_DMARxConn[] = {GPDMA_CONN_UART0_Rx, GPDMA_CONN_UART1_Rx, GPDMA_CONN_UART2_Rx, GPDMA_CONN_UART3_Rx};
+static const uint8_t UART_DMATxConn[] = {GPDMA_CONN_UART0_Tx, GPDMA_CONN_UART1_Tx, GPDMA_CONN_UART2_Tx, GPDMA_CONN_UART3_Tx};
+
+/* Mask the interrupts while the DMA context changes, it is used from the
+   UART and DMA interrupts and from the application */
+STATIC INLINE uint32_t dmaLock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+STATIC INLINE void dmaUnlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Commit the bytes the receive transfer has written up to pos */
+STATIC void dmaCommitRx(UART_DMA_T *pDMA, uint32_t pos)
+{
+	if (pos > pDMA->rxDone) {
+		RingBuffer_CommitWrite(pDMA->pRxRB, pos - pDMA->rxDone);
+		pDMA->stats.rxBytes += pos - pDMA->rxDone;
+		pDMA->rxDone = pos;
+	}
+}
+
+/* Commit what the running receive transfer has already written */
+STATIC void dmaSyncRx(UART_DMA_T *pDMA)
+{
+	uint32_t primask, addr;
+
+	primask = dmaLock();
+	addr = Chip_GPDMA_GetRequestDstAddr(pDMA->pGPDMA, &pDMA->rxReq);
+	if ((addr >= pDMA->rxStart) && (addr <= (pDMA->rxStart + pDMA->rxLen))) {
+		dmaCommitRx(pDMA, addr - pDMA->rxStart);
+	}
+	dmaUnlock(primask);
+}
+
+/* Start a receive transfer into the free part of the ring buffer, called
+   with the context locked */
+STATIC void dmaStartRx(UART_DMA_T *pDMA)
+{
+	uint8_t *pData;
+	int len;
+
+	len = RingBuffer_GetWriteRegion(pDMA->pRxRB, (void **) &pData);
+	if (len > GPDMA_MAX_TRANSFER_SIZE) {
+		len = GPDMA_MAX_TRANSFER_SIZE;
+	}
+	pDMA->rxStart = (uint32_t) pData;
+	pDMA->rxLen = len;
+	pDMA->rxDone = 0;
+
+	if ((len > 0) &&
+		(Chip_GPDMA_BuildDescList(&pDMA->rxTmpl, &pDMA->rxDesc, 1, 0, (uint32_t) pData, len, NULL) == 1) &&
+		(Chip_GPDMA_Submit(pDMA->pGPDMA, &pDMA->rxReq) == SUCCESS)) {
+		pDMA->stats.rxBlocks++;
+		if (pDMA->rxStalled) {
+			pDMA->rxStalled = false;
+			Chip_UART_IntEnable(pDMA->pUART, UART_IER_RBRINT);
+		}
+	}
+	else if (!pDMA->rxStalled) {
+		/* Nothing drains the FIFO until the application reads, the
+		   receive interrupts would not stop */
+		pDMA->rxStalled = true;
+		pDMA->stats.rxStalls++;
+		Chip_UART_IntDisable(pDMA->pUART, UART_IER_RBRINT);
+	}
+}
+
+/* Send the next contiguous part of the transmit ring buffer, called with
+   the context locked */
+STATIC void dmaStartTx(UART_DMA_T *pDMA)
+{
+	uint8_t *pData;
+	int len;
+
+	if (Chip_GPDMA_GetRequestState(&pDMA->txReq) != GPDMA_REQ_IDLE) {
+		return;
+	}
+
+	len = RingBuffer_GetReadRegion(pDMA->pTxRB, (void **) &pData);
+	if (len > GPDMA_MAX_TRANSFER_SIZE) {
+		len = GPDMA_MAX_TRANSFER_SIZE;
+	}
+	if (len > 0) {
+		pDMA->txLen = len;
+		Chip_GPDMA_BuildDescList(&pDMA->txTmpl, &pDMA->txDesc, 1, (uint32_t) pData, 0, len, NULL);
+		if (Chip_GPDMA_Submit(pDMA->pGPDMA, &pDMA->txReq) == SUCCESS) {
+			pDMA->stats.txBlocks++;
+		}
+	}
+}
+
+/* Receive transfer completion, the ring buffer part is full */
+STATIC void dmaRxDone(GPDMA_REQ_T *pReq, Status status)
+{
+	UART_DMA_T *pDMA = (UART_DMA_T *) pReq->pUserData;
+	uint32_t primask;
+
+	primask = dmaLock();
+	if (status == SUCCESS) {
+		dmaCommitRx(pDMA, pDMA->rxLen);
+	}
+	else {
+		pDMA->stats.dmaErrors++;
+	}
+	dmaStartRx(pDMA);
+	dmaUnlock(primask);
+}
+
+/* Transmit transfer completion */
+STATIC void dmaTxDone(GPDMA_REQ_T *pReq, Status status)
+{
+	UART_DMA_T *pDMA = (UART_DMA_T *) pReq->pUserData;
+	uint32_t primask;
+
+	primask = dmaLock();
+	if (status != SUCCESS) {
+		/* The bytes are dropped rather than sent again */
+		pDMA->stats.dmaErrors++;
+	}
+	else {
+		pDMA->stats.txBytes += pDMA->txLen;
+	}
+	RingBuffer_ReleaseRead(pDMA->pTxRB, pDMA->txLen);
+	dmaStartTx(pDMA);
+	dmaUnlock(primask);
+}
+
+/* Reset the statistics of a context */
+STATIC void dmaClearStats(UART_DMA_STATS_T *pStats)
+{
+	pStats->rxBytes = 0;
+	pStats->txBytes = 0;
+	pStats->rxBlocks = 0;
+	pStats->txBlocks = 0;
+	pStats->idleEvents = 0;
+	pStats->rxOverruns = 0;
+	pStats->rxStalls = 0;
+	pStats->dmaErrors = 0;
+}
+
+/* Set up a DMA request of the context */
+STATIC void dmaInitReq(UART_DMA_T *pDMA, GPDMA_REQ_T *pReq, DMA_TransferDescriptor_t *pDesc,
+					   GPDMA_FLOW_CONTROL_T TransferType, GPDMA_PRIO_T priority,
+					   GPDMA_REQ_CALLBACK_T callback)
+{
+	pReq->pDesc = pDesc;
+	pReq->TransferType = TransferType;
+	pReq->priority = priority;
+	pReq->callback = callback;
+	pReq->pChain = NULL;
+	pReq->pUserData = pDMA;
+	pReq->pNext = NULL;
+	pReq->state = GPDMA_REQ_IDLE;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -246,11 +409,27 @@ uint32_t Chip_UART_SetBaud(LPC_USART_T *pUART, uint32_t baudrate)
 /* UART receive-only interrupt handler for ring buffers */
 void Chip_UART_RXIntHandlerRB(LPC_USART_T *pUART, RINGBUFF_T *pRB)
 {
+	uint8_t *pData;
+	int cnt = 0, len;
+
+	/* Bytes go straight into the ring and are committed once */
+	len = RingBuffer_GetWriteRegion(pRB, (void **) &pData);
+
 	/* New data will be ignored if data not popped in time */
 	while (Chip_UART_ReadLineStatus(pUART) & UART_LSR_RDR) {
 		uint8_t ch = Chip_UART_ReadByte(pUART);
-		RingBuffer_Insert(pRB, &ch);
+
+		if (cnt == len) {
+			/* End of the ring memory, continue at its start */
+			RingBuffer_CommitWrite(pRB, cnt);
+			cnt = 0;
+			len = RingBuffer_GetWriteRegion(pRB, (void **) &pData);
+		}
+		if (cnt < len) {
+			pData[cnt++] = ch;
+		}
 	}
+	RingBuffer_CommitWrite(pRB, cnt);
 }
 
 /* UART transmit-only interrupt handler for ring buffers */
@@ -321,6 +500,135 @@ void Chip_UART_IRQRBHandler(LPC_USART_T *pUART, RINGBUFF_T *pRXRB, RINGBUFF_T *p
     Chip_UART_ABIntHandler(pUART);
 }
 
+/* Start DMA driven transmit and receive with ring buffers */
+Status Chip_UART_DMA_Init(UART_DMA_T *pDMA, LPC_USART_T *pUART, LPC_GPDMA_T *pGPDMA,
+						  RINGBUFF_T *pRXRB, RINGBUFF_T *pTXRB, uint32_t trigLevel)
+{
+	int index = Chip_UART_GetIndex(pUART);
+	uint32_t primask;
+
+	if ((pRXRB->itemSz != 1) || (pTXRB->itemSz != 1)) {
+		return ERROR;
+	}
+
+	pDMA->pUART = pUART;
+	pDMA->pGPDMA = pGPDMA;
+	pDMA->pRxRB = pRXRB;
+	pDMA->pTxRB = pTXRB;
+	pDMA->rxStart = 0;
+	pDMA->rxLen = 0;
+	pDMA->rxDone = 0;
+	pDMA->txLen = 0;
+	pDMA->rxStalled = false;
+	dmaClearStats(&pDMA->stats);
+
+	Chip_GPDMA_InitDescTemplate(pGPDMA, &pDMA->rxTmpl, UART_DMARxConn[index], GPDMA_CONN_MEMORY,
+								GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA);
+	Chip_GPDMA_InitDescTemplate(pGPDMA, &pDMA->txTmpl, GPDMA_CONN_MEMORY, UART_DMATxConn[index],
+								GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA);
+
+	/* Receive has the higher priority, the FIFO overruns if it waits */
+	dmaInitReq(pDMA, &pDMA->rxReq, &pDMA->rxDesc, GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+			   GPDMA_PRIO_HIGH, dmaRxDone);
+	dmaInitReq(pDMA, &pDMA->txReq, &pDMA->txDesc, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+			   GPDMA_PRIO_NORMAL, dmaTxDone);
+
+	Chip_UART_SetupFIFOS(pUART, (UART_FCR_FIFO_EN | UART_FCR_RX_RS | UART_FCR_TX_RS |
+								 UART_FCR_DMAMODE_SEL | trigLevel));
+
+	primask = dmaLock();
+	Chip_UART_IntEnable(pUART, (UART_IER_RBRINT | UART_IER_RLSINT));
+	dmaStartRx(pDMA);
+	dmaStartTx(pDMA);
+	dmaUnlock(primask);
+
+	return SUCCESS;
+}
+
+/* Stop DMA driven transmit and receive */
+void Chip_UART_DMA_DeInit(UART_DMA_T *pDMA)
+{
+	uint32_t primask;
+
+	Chip_UART_IntDisable(pDMA->pUART, (UART_IER_RBRINT | UART_IER_RLSINT));
+
+	primask = dmaLock();
+	dmaSyncRx(pDMA);
+	Chip_GPDMA_Cancel(pDMA->pGPDMA, &pDMA->rxReq);
+	Chip_GPDMA_Cancel(pDMA->pGPDMA, &pDMA->txReq);
+	dmaUnlock(primask);
+
+	Chip_UART_SetupFIFOS(pDMA->pUART, UART_FCR_FIFO_EN);
+}
+
+/* UART interrupt handler for DMA driven ring buffers */
+void Chip_UART_DMA_IRQHandler(UART_DMA_T *pDMA)
+{
+	uint32_t iir, lsr;
+
+	iir = Chip_UART_ReadIntIDReg(pDMA->pUART);
+	if ((iir & UART_IIR_INTID_MASK) == UART_IIR_INTID_CTI) {
+		pDMA->stats.idleEvents++;
+	}
+
+	/* Only the bytes the DMA has already written are committed. Bytes still
+	   in the FIFO are moved by the DMA request raised on the same time-out,
+	   and committed on the next interrupt. Reading the line status clears
+	   the errors. */
+	lsr = Chip_UART_ReadLineStatus(pDMA->pUART);
+	if (lsr & UART_LSR_OE) {
+		pDMA->stats.rxOverruns++;
+	}
+
+	dmaSyncRx(pDMA);
+}
+
+/* Queue data for DMA driven transmit */
+uint32_t Chip_UART_DMA_Send(UART_DMA_T *pDMA, const void *data, int bytes)
+{
+	uint32_t ret, primask;
+
+	ret = RingBuffer_InsertMult(pDMA->pTxRB, data, bytes);
+
+	primask = dmaLock();
+	dmaStartTx(pDMA);
+	dmaUnlock(primask);
+
+	return ret;
+}
+
+/* Copy data received by DMA from the receive ring buffer */
+int Chip_UART_DMA_Read(UART_DMA_T *pDMA, void *data, int bytes)
+{
+	uint32_t primask;
+	int ret;
+
+	ret = RingBuffer_PopMult(pDMA->pRxRB, data, bytes);
+
+	if (pDMA->rxStalled) {
+		primask = dmaLock();
+		if (pDMA->rxStalled) {
+			dmaStartRx(pDMA);
+		}
+		dmaUnlock(primask);
+	}
+
+	return ret;
+}
+
+/* Read the UART DMA statistics */
+void Chip_UART_DMA_GetStats(UART_DMA_T *pDMA, UART_DMA_STATS_T *pStats, bool clear)
+{
+	uint32_t primask;
+
+	primask = dmaLock();
+	*pStats = pDMA->stats;
+	if (clear) {
+		dmaClearStats(&pDMA->stats);
+	}
+	dmaUnlock(primask);
+}
+
 /* Determines and sets best dividers to get a target baud rate */
 uint32_t Chip_UART_SetBaudFDR(LPC_USART_T *pUART, uint32_t baud)
 {
@@ -796,6 +796,113 @@ int Chip_UART_ReadRB(LPC_USART_T *pUART, RINGBUFF_T *pRB, void *data, int bytes)
  */
 void Chip_UART_IRQRBHandler(LPC_USART_T *pUART, RINGBUFF_T *pRXRB, RINGBUFF_T *pTXRB);
 
+/**
+ * @brief UART DMA ring buffer statistics
+ */
+typedef struct {
+	uint32_t rxBytes;		/*!< Bytes committed to the receive ring buffer */
+	uint32_t txBytes;		/*!< Bytes sent from the transmit ring buffer */
+	uint32_t rxBlocks;		/*!< Receive DMA transfers started */
+	uint32_t txBlocks;		/*!< Transmit DMA transfers started */
+	uint32_t idleEvents;	/*!< Character time-out interrupts */
+	uint32_t rxOverruns;	/*!< Receive FIFO overruns reported in the line status */
+	uint32_t rxStalls;		/*!< Times receive stopped on a full receive ring buffer */
+	uint32_t dmaErrors;		/*!< DMA transfers that ended with an error */
+} UART_DMA_STATS_T;
+
+/**
+ * @brief UART DMA ring buffer context, used with Chip_UART_DMA_Init()
+ * @note	All members are private to the driver, use Chip_UART_DMA_GetStats()
+ * to read the statistics.
+ */
+typedef struct {
+	LPC_USART_T *pUART;					/*!< UART using the DMA */
+	LPC_GPDMA_T *pGPDMA;				/*!< DMA controller */
+	RINGBUFF_T *pRxRB;					/*!< Receive ring buffer, filled by the DMA */
+	RINGBUFF_T *pTxRB;					/*!< Transmit ring buffer, emptied by the DMA */
+	GPDMA_DESC_TEMPLATE_T rxTmpl;		/*!< Receive descriptor template */
+	GPDMA_DESC_TEMPLATE_T txTmpl;		/*!< Transmit descriptor template */
+	DMA_TransferDescriptor_t rxDesc;	/*!< Descriptor of the running receive transfer */
+	DMA_TransferDescriptor_t txDesc;	/*!< Descriptor of the running transmit transfer */
+	GPDMA_REQ_T rxReq;					/*!< Receive DMA request */
+	GPDMA_REQ_T txReq;					/*!< Transmit DMA request */
+	uint32_t rxStart;					/*!< Ring buffer address the receive transfer starts at */
+	uint32_t rxLen;						/*!< Size of the receive transfer */
+	uint32_t rxDone;					/*!< Bytes of the receive transfer already committed */
+	uint32_t txLen;						/*!< Size of the transmit transfer */
+	volatile bool rxStalled;			/*!< Receive stopped on a full ring buffer */
+	UART_DMA_STATS_T stats;				/*!< Statistics */
+} UART_DMA_T;
+
+/**
+ * @brief	Start DMA driven transmit and receive with ring buffers
+ * @param	pDMA		: UART DMA context to initialize
+ * @param	pUART		: Pointer to selected UART peripheral, already set up
+ * @param	pGPDMA		: The base of GPDMA on the chip, already initialized
+ * @param	pRXRB		: Receive ring buffer, with 1 byte items
+ * @param	pTXRB		: Transmit ring buffer, with 1 byte items
+ * @param	trigLevel	: Receive FIFO trigger level, UART_FCR_TRG_LEV0 to UART_FCR_TRG_LEV3
+ * @return	ERROR if a ring buffer does not hold bytes, SUCCESS otherwise
+ * @note	The DMA moves bytes between the FIFOs and the ring buffer memory,
+ * the transmit side sends each contiguous part of the ring buffer as one
+ * transfer. Received bytes are committed to the ring buffer when a transfer
+ * ends and from Chip_UART_DMA_IRQHandler(), on the character time-out and
+ * on each trigger level interrupt. A high trigger level gives fewer
+ * interrupts, received bytes are then committed on the time-out after the
+ * line goes idle. Chip_GPDMA_ServiceIRQHandler() must be called from
+ * DMA_IRQHandler().
+ */
+Status Chip_UART_DMA_Init(UART_DMA_T *pDMA, LPC_USART_T *pUART, LPC_GPDMA_T *pGPDMA,
+						  RINGBUFF_T *pRXRB, RINGBUFF_T *pTXRB, uint32_t trigLevel);
+
+/**
+ * @brief	Stop DMA driven transmit and receive
+ * @param	pDMA	: UART DMA context
+ * @return	Nothing
+ * @note	Bytes already received are committed to the receive ring
+ * buffer, bytes not yet sent stay in the transmit ring buffer.
+ */
+void Chip_UART_DMA_DeInit(UART_DMA_T *pDMA);
+
+/**
+ * @brief	UART interrupt handler for DMA driven ring buffers
+ * @param	pDMA	: UART DMA context
+ * @return	Nothing
+ * @note	Call from the UART IRQ handler. It doesn't wait for the DMA to
+ * empty the receive FIFO, a byte the DMA moves after the handler returns is
+ * committed on the next interrupt. It may also be called from a periodic
+ * timer to bound the receive latency independently of the UART interrupts.
+ */
+void Chip_UART_DMA_IRQHandler(UART_DMA_T *pDMA);
+
+/**
+ * @brief	Queue data for DMA driven transmit
+ * @param	pDMA	: UART DMA context
+ * @param	data	: Pointer to buffer to move to the transmit ring buffer
+ * @param	bytes	: Number of bytes to move
+ * @return	The number of bytes placed into the ring buffer
+ */
+uint32_t Chip_UART_DMA_Send(UART_DMA_T *pDMA, const void *data, int bytes);
+
+/**
+ * @brief	Copy data received by DMA from the receive ring buffer
+ * @param	pDMA	: UART DMA context
+ * @param	data	: Pointer to buffer to fill from the ring buffer
+ * @param	bytes	: Size of the passed buffer in bytes
+ * @return	The number of bytes copied
+ * @note	Restarts receive if it stopped on a full ring buffer.
+ */
+int Chip_UART_DMA_Read(UART_DMA_T *pDMA, void *data, int bytes);
+
+/**
+ * @brief	Read the UART DMA statistics
+ * @param	pDMA	: UART DMA context
+ * @param	pStats	: Structure receiving the statistics
+ * @param	clear	: true to reset the statistics after reading them
+ * @return	Nothing
+ */
+void Chip_UART_DMA_GetStats(UART_DMA_T *pDMA, UART_DMA_STATS_T *pStats, bool clear);
+
 /**
  * @brief	Returns the Auto Baud status
  * @param	pUART	: Pointer to selected UART peripheral
@@ -0,0 +1,664 @@
+/*
+ * @brief COBS, SLIP and HDLC frame encoder and decoder with CRC
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "frame_codec.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* SLIP special bytes */
+#define SLIP_END            0xC0
+#define SLIP_ESC            0xDB
+#define SLIP_ESC_END        0xDC
+#define SLIP_ESC_ESC        0xDD
+
+/* HDLC special bytes */
+#define HDLC_FLAG           0x7E
+#define HDLC_ESC            0x7D
+#define HDLC_XOR            0x20
+
+/* Largest COBS block code, a block of 254 bytes without zero */
+#define COBS_MAX_CODE       0xFF
+
+/* Output of the encoder, the free space of a buffer or of a ring in up to
+   two parts */
+typedef struct {
+	uint8_t *p;				/* Next byte of the current part */
+	uint32_t left;			/* Bytes left in the current part */
+	uint8_t *pNext;			/* Second part */
+	uint32_t nextLeft;		/* Size of the second part */
+	uint32_t used;			/* Bytes written */
+	bool full;				/* The frame did not fit */
+} FRAME_OUT_T;
+
+/* Encoder state */
+typedef struct {
+	FRAME_OUT_T out;		/* Output */
+	uint8_t *pCode;			/* COBS: where the code of the current block goes */
+	uint8_t code;			/* COBS: code of the current block */
+} FRAME_ENC_T;
+
+/* CRC-16/X-25 table, reflected polynomial 0x8408 */
+static const uint16_t Frame_CRC16Table[256] = {
+	0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
+	0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
+	0x1081, 0x0108, 0x3393, 0x221A, 0x56A5, 0x472C, 0x75B7, 0x643E,
+	0x9CC9, 0x8D40, 0xBFDB, 0xAE52, 0xDAED, 0xCB64, 0xF9FF, 0xE876,
+	0x2102, 0x308B, 0x0210, 0x1399, 0x6726, 0x76AF, 0x4434, 0x55BD,
+	0xAD4A, 0xBCC3, 0x8E58, 0x9FD1, 0xEB6E, 0xFAE7, 0xC87C, 0xD9F5,
+	0x3183, 0x200A, 0x1291, 0x0318, 0x77A7, 0x662E, 0x54B5, 0x453C,
+	0xBDCB, 0xAC42, 0x9ED9, 0x8F50, 0xFBEF, 0xEA66, 0xD8FD, 0xC974,
+	0x4204, 0x538D, 0x6116, 0x709F, 0x0420, 0x15A9, 0x2732, 0x36BB,
+	0xCE4C, 0xDFC5, 0xED5E, 0xFCD7, 0x8868, 0x99E1, 0xAB7A, 0xBAF3,
+	0x5285, 0x430C, 0x7197, 0x601E, 0x14A1, 0x0528, 0x37B3, 0x263A,
+	0xDECD, 0xCF44, 0xFDDF, 0xEC56, 0x98E9, 0x8960, 0xBBFB, 0xAA72,
+	0x6306, 0x728F, 0x4014, 0x519D, 0x2522, 0x34AB, 0x0630, 0x17B9,
+	0xEF4E, 0xFEC7, 0xCC5C, 0xDDD5, 0xA96A, 0xB8E3, 0x8A78, 0x9BF1,
+	0x7387, 0x620E, 0x5095, 0x411C, 0x35A3, 0x242A, 0x16B1, 0x0738,
+	0xFFCF, 0xEE46, 0xDCDD, 0xCD54, 0xB9EB, 0xA862, 0x9AF9, 0x8B70,
+	0x8408, 0x9581, 0xA71A, 0xB693, 0xC22C, 0xD3A5, 0xE13E, 0xF0B7,
+	0x0840, 0x19C9, 0x2B52, 0x3ADB, 0x4E64, 0x5FED, 0x6D76, 0x7CFF,
+	0x9489, 0x8500, 0xB79B, 0xA612, 0xD2AD, 0xC324, 0xF1BF, 0xE036,
+	0x18C1, 0x0948, 0x3BD3, 0x2A5A, 0x5EE5, 0x4F6C, 0x7DF7, 0x6C7E,
+	0xA50A, 0xB483, 0x8618, 0x9791, 0xE32E, 0xF2A7, 0xC03C, 0xD1B5,
+	0x2942, 0x38CB, 0x0A50, 0x1BD9, 0x6F66, 0x7EEF, 0x4C74, 0x5DFD,
+	0xB58B, 0xA402, 0x9699, 0x8710, 0xF3AF, 0xE226, 0xD0BD, 0xC134,
+	0x39C3, 0x284A, 0x1AD1, 0x0B58, 0x7FE7, 0x6E6E, 0x5CF5, 0x4D7C,
+	0xC60C, 0xD785, 0xE51E, 0xF497, 0x8028, 0x91A1, 0xA33A, 0xB2B3,
+	0x4A44, 0x5BCD, 0x6956, 0x78DF, 0x0C60, 0x1DE9, 0x2F72, 0x3EFB,
+	0xD68D, 0xC704, 0xF59F, 0xE416, 0x90A9, 0x8120, 0xB3BB, 0xA232,
+	0x5AC5, 0x4B4C, 0x79D7, 0x685E, 0x1CE1, 0x0D68, 0x3FF3, 0x2E7A,
+	0xE70E, 0xF687, 0xC41C, 0xD595, 0xA12A, 0xB0A3, 0x8238, 0x93B1,
+	0x6B46, 0x7ACF, 0x4854, 0x59DD, 0x2D62, 0x3CEB, 0x0E70, 0x1FF9,
+	0xF78F, 0xE606, 0xD49D, 0xC514, 0xB1AB, 0xA022, 0x92B9, 0x8330,
+	0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78
+};
+
+/* CRC-32 table, reflected polynomial 0xEDB88320 */
+static const uint32_t Frame_CRC32Table[256] = {
+	0x00000000UL, 0x77073096UL, 0xEE0E612CUL, 0x990951BAUL,
+	0x076DC419UL, 0x706AF48FUL, 0xE963A535UL, 0x9E6495A3UL,
+	0x0EDB8832UL, 0x79DCB8A4UL, 0xE0D5E91EUL, 0x97D2D988UL,
+	0x09B64C2BUL, 0x7EB17CBDUL, 0xE7B82D07UL, 0x90BF1D91UL,
+	0x1DB71064UL, 0x6AB020F2UL, 0xF3B97148UL, 0x84BE41DEUL,
+	0x1ADAD47DUL, 0x6DDDE4EBUL, 0xF4D4B551UL, 0x83D385C7UL,
+	0x136C9856UL, 0x646BA8C0UL, 0xFD62F97AUL, 0x8A65C9ECUL,
+	0x14015C4FUL, 0x63066CD9UL, 0xFA0F3D63UL, 0x8D080DF5UL,
+	0x3B6E20C8UL, 0x4C69105EUL, 0xD56041E4UL, 0xA2677172UL,
+	0x3C03E4D1UL, 0x4B04D447UL, 0xD20D85FDUL, 0xA50AB56BUL,
+	0x35B5A8FAUL, 0x42B2986CUL, 0xDBBBC9D6UL, 0xACBCF940UL,
+	0x32D86CE3UL, 0x45DF5C75UL, 0xDCD60DCFUL, 0xABD13D59UL,
+	0x26D930ACUL, 0x51DE003AUL, 0xC8D75180UL, 0xBFD06116UL,
+	0x21B4F4B5UL, 0x56B3C423UL, 0xCFBA9599UL, 0xB8BDA50FUL,
+	0x2802B89EUL, 0x5F058808UL, 0xC60CD9B2UL, 0xB10BE924UL,
+	0x2F6F7C87UL, 0x58684C11UL, 0xC1611DABUL, 0xB6662D3DUL,
+	0x76DC4190UL, 0x01DB7106UL, 0x98D220BCUL, 0xEFD5102AUL,
+	0x71B18589UL, 0x06B6B51FUL, 0x9FBFE4A5UL, 0xE8B8D433UL,
+	0x7807C9A2UL, 0x0F00F934UL, 0x9609A88EUL, 0xE10E9818UL,
+	0x7F6A0DBBUL, 0x086D3D2DUL, 0x91646C97UL, 0xE6635C01UL,
+	0x6B6B51F4UL, 0x1C6C6162UL, 0x856530D8UL, 0xF262004EUL,
+	0x6C0695EDUL, 0x1B01A57BUL, 0x8208F4C1UL, 0xF50FC457UL,
+	0x65B0D9C6UL, 0x12B7E950UL, 0x8BBEB8EAUL, 0xFCB9887CUL,
+	0x62DD1DDFUL, 0x15DA2D49UL, 0x8CD37CF3UL, 0xFBD44C65UL,
+	0x4DB26158UL, 0x3AB551CEUL, 0xA3BC0074UL, 0xD4BB30E2UL,
+	0x4ADFA541UL, 0x3DD895D7UL, 0xA4D1C46DUL, 0xD3D6F4FBUL,
+	0x4369E96AUL, 0x346ED9FCUL, 0xAD678846UL, 0xDA60B8D0UL,
+	0x44042D73UL, 0x33031DE5UL, 0xAA0A4C5FUL, 0xDD0D7CC9UL,
+	0x5005713CUL, 0x270241AAUL, 0xBE0B1010UL, 0xC90C2086UL,
+	0x5768B525UL, 0x206F85B3UL, 0xB966D409UL, 0xCE61E49FUL,
+	0x5EDEF90EUL, 0x29D9C998UL, 0xB0D09822UL, 0xC7D7A8B4UL,
+	0x59B33D17UL, 0x2EB40D81UL, 0xB7BD5C3BUL, 0xC0BA6CADUL,
+	0xEDB88320UL, 0x9ABFB3B6UL, 0x03B6E20CUL, 0x74B1D29AUL,
+	0xEAD54739UL, 0x9DD277AFUL, 0x04DB2615UL, 0x73DC1683UL,
+	0xE3630B12UL, 0x94643B84UL, 0x0D6D6A3EUL, 0x7A6A5AA8UL,
+	0xE40ECF0BUL, 0x9309FF9DUL, 0x0A00AE27UL, 0x7D079EB1UL,
+	0xF00F9344UL, 0x8708A3D2UL, 0x1E01F268UL, 0x6906C2FEUL,
+	0xF762575DUL, 0x806567CBUL, 0x196C3671UL, 0x6E6B06E7UL,
+	0xFED41B76UL, 0x89D32BE0UL, 0x10DA7A5AUL, 0x67DD4ACCUL,
+	0xF9B9DF6FUL, 0x8EBEEFF9UL, 0x17B7BE43UL, 0x60B08ED5UL,
+	0xD6D6A3E8UL, 0xA1D1937EUL, 0x38D8C2C4UL, 0x4FDFF252UL,
+	0xD1BB67F1UL, 0xA6BC5767UL, 0x3FB506DDUL, 0x48B2364BUL,
+	0xD80D2BDAUL, 0xAF0A1B4CUL, 0x36034AF6UL, 0x41047A60UL,
+	0xDF60EFC3UL, 0xA867DF55UL, 0x316E8EEFUL, 0x4669BE79UL,
+	0xCB61B38CUL, 0xBC66831AUL, 0x256FD2A0UL, 0x5268E236UL,
+	0xCC0C7795UL, 0xBB0B4703UL, 0x220216B9UL, 0x5505262FUL,
+	0xC5BA3BBEUL, 0xB2BD0B28UL, 0x2BB45A92UL, 0x5CB36A04UL,
+	0xC2D7FFA7UL, 0xB5D0CF31UL, 0x2CD99E8BUL, 0x5BDEAE1DUL,
+	0x9B64C2B0UL, 0xEC63F226UL, 0x756AA39CUL, 0x026D930AUL,
+	0x9C0906A9UL, 0xEB0E363FUL, 0x72076785UL, 0x05005713UL,
+	0x95BF4A82UL, 0xE2B87A14UL, 0x7BB12BAEUL, 0x0CB61B38UL,
+	0x92D28E9BUL, 0xE5D5BE0DUL, 0x7CDCEFB7UL, 0x0BDBDF21UL,
+	0x86D3D2D4UL, 0xF1D4E242UL, 0x68DDB3F8UL, 0x1FDA836EUL,
+	0x81BE16CDUL, 0xF6B9265BUL, 0x6FB077E1UL, 0x18B74777UL,
+	0x88085AE6UL, 0xFF0F6A70UL, 0x66063BCAUL, 0x11010B5CUL,
+	0x8F659EFFUL, 0xF862AE69UL, 0x616BFFD3UL, 0x166CCF45UL,
+	0xA00AE278UL, 0xD70DD2EEUL, 0x4E048354UL, 0x3903B3C2UL,
+	0xA7672661UL, 0xD06016F7UL, 0x4969474DUL, 0x3E6E77DBUL,
+	0xAED16A4AUL, 0xD9D65ADCUL, 0x40DF0B66UL, 0x37D83BF0UL,
+	0xA9BCAE53UL, 0xDEBB9EC5UL, 0x47B2CF7FUL, 0x30B5FFE9UL,
+	0xBDBDF21CUL, 0xCABAC28AUL, 0x53B39330UL, 0x24B4A3A6UL,
+	0xBAD03605UL, 0xCDD70693UL, 0x54DE5729UL, 0x23D967BFUL,
+	0xB3667A2EUL, 0xC4614AB8UL, 0x5D681B02UL, 0x2A6F2B94UL,
+	0xB40BBE37UL, 0xC30C8EA1UL, 0x5A05DF1BUL, 0x2D02EF8DUL
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Returns the size of the CRC appended to the frames */
+STATIC INLINE uint32_t crcSize(FRAME_CRC_T crcType)
+{
+	return (crcType == FRAME_CRC32) ? 4 : ((crcType == FRAME_CRC16) ? 2 : 0);
+}
+
+/* Returns the index of the first byte equal to a or b, or n if there is none.
+   Aligned words are checked 4 bytes at a time for a zero byte in (w ^ a) or
+   (w ^ b). */
+STATIC uint32_t scanSpecial(const uint8_t *p, uint32_t n, uint8_t a, uint8_t b)
+{
+	uint32_t i = 0, w, x, y;
+	uint32_t ma = a * 0x01010101UL, mb = b * 0x01010101UL;
+
+	while ((i < n) && (((uint32_t) &p[i] & 3) != 0)) {
+		if ((p[i] == a) || (p[i] == b)) {
+			return i;
+		}
+		i++;
+	}
+
+	while ((i + 4) <= n) {
+		w = *(const uint32_t *) &p[i];
+		x = w ^ ma;
+		y = w ^ mb;
+		if ((((x - 0x01010101UL) & ~x) | ((y - 0x01010101UL) & ~y)) & 0x80808080UL) {
+			break;
+		}
+		i += 4;
+	}
+
+	while (i < n) {
+		if ((p[i] == a) || (p[i] == b)) {
+			break;
+		}
+		i++;
+	}
+	return i;
+}
+
+/* Take one output byte, NULL once the output is full */
+STATIC uint8_t *outReserve(FRAME_OUT_T *pOut)
+{
+	if (pOut->left == 0) {
+		pOut->p = pOut->pNext;
+		pOut->left = pOut->nextLeft;
+		pOut->nextLeft = 0;
+		if (pOut->left == 0) {
+			pOut->full = true;
+			return NULL;
+		}
+	}
+	pOut->left--;
+	pOut->used++;
+	return pOut->p++;
+}
+
+/* Write one output byte */
+STATIC INLINE void outByte(FRAME_OUT_T *pOut, uint8_t byte)
+{
+	uint8_t *p = outReserve(pOut);
+
+	if (p != NULL) {
+		*p = byte;
+	}
+}
+
+/* Write a run of output bytes */
+STATIC void outRun(FRAME_OUT_T *pOut, const uint8_t *p, uint32_t n)
+{
+	uint32_t part;
+
+	while ((n > 0) && !pOut->full) {
+		if (pOut->left == 0) {
+			pOut->p = pOut->pNext;
+			pOut->left = pOut->nextLeft;
+			pOut->nextLeft = 0;
+			if (pOut->left == 0) {
+				pOut->full = true;
+				break;
+			}
+		}
+		part = (n < pOut->left) ? n : pOut->left;
+		memcpy(pOut->p, p, part);
+		pOut->p += part;
+		pOut->left -= part;
+		pOut->used += part;
+		p += part;
+		n -= part;
+	}
+}
+
+/* End the current COBS block and start the next one */
+STATIC void cobsNextBlock(FRAME_ENC_T *pEnc)
+{
+	if (pEnc->pCode != NULL) {
+		*pEnc->pCode = pEnc->code;
+	}
+	pEnc->pCode = outReserve(&pEnc->out);
+	pEnc->code = 1;
+}
+
+/* Stuff and write payload bytes */
+STATIC void encodeData(FRAME_ENC_T *pEnc, FRAME_TYPE_T type, const uint8_t *p, uint32_t n)
+{
+	uint32_t run, max;
+	uint8_t flag, esc;
+
+	if (type == FRAME_COBS) {
+		while (n > 0) {
+			max = COBS_MAX_CODE - pEnc->code;
+			run = scanSpecial(p, (n < max) ? n : max, 0, 0);
+			outRun(&pEnc->out, p, run);
+			pEnc->code += run;
+			p += run;
+			n -= run;
+			if (pEnc->code == COBS_MAX_CODE) {
+				cobsNextBlock(pEnc);
+			}
+			else if (n > 0) {
+				/* The zero is replaced by the block code */
+				cobsNextBlock(pEnc);
+				p++;
+				n--;
+			}
+		}
+		return;
+	}
+
+	flag = (type == FRAME_SLIP) ? SLIP_END : HDLC_FLAG;
+	esc = (type == FRAME_SLIP) ? SLIP_ESC : HDLC_ESC;
+	while (n > 0) {
+		run = scanSpecial(p, n, flag, esc);
+		outRun(&pEnc->out, p, run);
+		p += run;
+		n -= run;
+		if (n > 0) {
+			outByte(&pEnc->out, esc);
+			if (type == FRAME_SLIP) {
+				outByte(&pEnc->out, (*p == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC);
+			}
+			else {
+				outByte(&pEnc->out, *p ^ HDLC_XOR);
+			}
+			p++;
+			n--;
+		}
+	}
+}
+
+/* Encode a frame with its CRC and delimiters */
+STATIC uint32_t encodeFrame(FRAME_ENC_T *pEnc, FRAME_TYPE_T type, FRAME_CRC_T crcType,
+							const uint8_t *data, uint32_t len)
+{
+	uint8_t fcs[4];
+	uint32_t crc;
+
+	if (type == FRAME_COBS) {
+		pEnc->pCode = outReserve(&pEnc->out);
+		pEnc->code = 1;
+	}
+	else {
+		outByte(&pEnc->out, (type == FRAME_SLIP) ? SLIP_END : HDLC_FLAG);
+	}
+
+	encodeData(pEnc, type, data, len);
+
+	if (crcType == FRAME_CRC16) {
+		crc = ~Frame_CRC16Update(FRAME_CRC16_INIT, data, len);
+		fcs[0] = (uint8_t) crc;
+		fcs[1] = (uint8_t) (crc >> 8);
+		encodeData(pEnc, type, fcs, 2);
+	}
+	else if (crcType == FRAME_CRC32) {
+		crc = ~Frame_CRC32Update(FRAME_CRC32_INIT, data, len);
+		fcs[0] = (uint8_t) crc;
+		fcs[1] = (uint8_t) (crc >> 8);
+		fcs[2] = (uint8_t) (crc >> 16);
+		fcs[3] = (uint8_t) (crc >> 24);
+		encodeData(pEnc, type, fcs, 4);
+	}
+
+	if (type == FRAME_COBS) {
+		if (pEnc->pCode != NULL) {
+			*pEnc->pCode = pEnc->code;
+		}
+		outByte(&pEnc->out, 0);
+	}
+	else {
+		outByte(&pEnc->out, (type == FRAME_SLIP) ? SLIP_END : HDLC_FLAG);
+	}
+
+	return pEnc->out.full ? 0 : pEnc->out.used;
+}
+
+/* Start decoding a new frame */
+STATIC void decReset(FRAME_DEC_T *pDec)
+{
+	pDec->len = 0;
+	pDec->crc = (pDec->crcType == FRAME_CRC32) ? FRAME_CRC32_INIT : FRAME_CRC16_INIT;
+	pDec->esc = 0;
+	pDec->cobsLeft = 0;
+	pDec->cobsZero = 0;
+	pDec->discard = 0;
+}
+
+/* Drop the current frame on a bad encoding */
+STATIC void decBad(FRAME_DEC_T *pDec)
+{
+	if (!pDec->discard) {
+		pDec->stats.badFrames++;
+		pDec->discard = 1;
+	}
+}
+
+/* Add decoded bytes to the frame buffer and to the CRC */
+STATIC void decPut(FRAME_DEC_T *pDec, const uint8_t *p, uint32_t n)
+{
+	if (pDec->discard || (n == 0)) {
+		return;
+	}
+	if (n > (pDec->size - pDec->len)) {
+		pDec->stats.overflows++;
+		pDec->discard = 1;
+		return;
+	}
+
+	memcpy(&pDec->pBuf[pDec->len], p, n);
+	pDec->len += n;
+	if (pDec->crcType == FRAME_CRC16) {
+		pDec->crc = Frame_CRC16Update((uint16_t) pDec->crc, p, n);
+	}
+	else if (pDec->crcType == FRAME_CRC32) {
+		pDec->crc = Frame_CRC32Update(pDec->crc, p, n);
+	}
+}
+
+/* End of frame delimiter, deliver the frame if it is good */
+STATIC void decEnd(FRAME_DEC_T *pDec)
+{
+	uint32_t fcsLen = crcSize((FRAME_CRC_T) pDec->crcType);
+
+	/* Empty frames are delimiters sent back to back */
+	if (!pDec->discard && (pDec->len > 0)) {
+		if (pDec->len < fcsLen) {
+			pDec->stats.badFrames++;
+		}
+		else if (((pDec->crcType == FRAME_CRC16) && (pDec->crc != FRAME_CRC16_GOOD)) ||
+				 ((pDec->crcType == FRAME_CRC32) && (pDec->crc != FRAME_CRC32_GOOD))) {
+			pDec->stats.crcErrors++;
+		}
+		else {
+			pDec->frameLen = pDec->len - fcsLen;
+			pDec->ready = 1;
+			pDec->stats.frames++;
+		}
+	}
+	decReset(pDec);
+}
+
+/* Decode COBS bytes, block runs are copied as they are */
+STATIC uint32_t decodeCOBS(FRAME_DEC_T *pDec, const uint8_t *p, uint32_t n)
+{
+	uint32_t i = 0, run, zero;
+	uint8_t code;
+	static const uint8_t zeroByte = 0;
+
+	while (i < n) {
+		if (pDec->cobsLeft == 0) {
+			code = p[i++];
+			if (code == 0) {
+				decEnd(pDec);
+				if (pDec->ready) {
+					break;
+				}
+				continue;
+			}
+			if (pDec->cobsZero) {
+				decPut(pDec, &zeroByte, 1);
+			}
+			pDec->cobsLeft = code - 1;
+			pDec->cobsZero = (code != COBS_MAX_CODE);
+			continue;
+		}
+
+		run = n - i;
+		if (run > pDec->cobsLeft) {
+			run = pDec->cobsLeft;
+		}
+		zero = scanSpecial(&p[i], run, 0, 0);
+		decPut(pDec, &p[i], zero);
+		pDec->cobsLeft -= zero;
+		i += zero;
+		if (zero < run) {
+			/* Delimiter inside a block, the frame is cut short */
+			i++;
+			decBad(pDec);
+			decReset(pDec);
+		}
+	}
+	return i;
+}
+
+/* Decode SLIP or HDLC bytes, runs without special bytes are copied as they are */
+STATIC uint32_t decodeEsc(FRAME_DEC_T *pDec, const uint8_t *p, uint32_t n)
+{
+	uint32_t i = 0, run;
+	uint8_t flag, esc, byte;
+	bool slip = (pDec->type == FRAME_SLIP);
+
+	flag = slip ? SLIP_END : HDLC_FLAG;
+	esc = slip ? SLIP_ESC : HDLC_ESC;
+	while (i < n) {
+		if (pDec->esc) {
+			pDec->esc = 0;
+			byte = p[i];
+			if (byte == flag) {
+				/* Aborted frame, the delimiter starts the next one */
+				i++;
+				decBad(pDec);
+				decReset(pDec);
+				continue;
+			}
+			if (!slip) {
+				byte ^= HDLC_XOR;
+			}
+			else if (byte == SLIP_ESC_END) {
+				byte = SLIP_END;
+			}
+			else if (byte == SLIP_ESC_ESC) {
+				byte = SLIP_ESC;
+			}
+			else {
+				decBad(pDec);
+			}
+			decPut(pDec, &byte, 1);
+			i++;
+			continue;
+		}
+
+		run = scanSpecial(&p[i], n - i, flag, esc);
+		decPut(pDec, &p[i], run);
+		i += run;
+		if (i < n) {
+			if (p[i++] == esc) {
+				pDec->esc = 1;
+			}
+			else {
+				decEnd(pDec);
+				if (pDec->ready) {
+					break;
+				}
+			}
+		}
+	}
+	return i;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Update a CRC-16/X-25 with more data */
+uint16_t Frame_CRC16Update(uint16_t crc, const void *data, uint32_t len)
+{
+	const uint8_t *p = (const uint8_t *) data;
+
+	while (len-- > 0) {
+		crc = (crc >> 8) ^ Frame_CRC16Table[(crc ^ *p++) & 0xFF];
+	}
+	return crc;
+}
+
+/* Update a CRC-32 with more data */
+uint32_t Frame_CRC32Update(uint32_t crc, const void *data, uint32_t len)
+{
+	const uint8_t *p = (const uint8_t *) data;
+
+	while (len-- > 0) {
+		crc = (crc >> 8) ^ Frame_CRC32Table[(crc ^ *p++) & 0xFF];
+	}
+	return crc;
+}
+
+/* Return the largest encoded size of a frame */
+uint32_t Frame_GetMaxEncodedSize(FRAME_TYPE_T type, FRAME_CRC_T crcType, uint32_t len)
+{
+	len += crcSize(crcType);
+	if (type == FRAME_COBS) {
+		/* A code per 254 bytes, then the delimiter */
+		return len + (len / (COBS_MAX_CODE - 1)) + 2;
+	}
+
+	/* Each byte escaped, between two delimiters */
+	return (2 * len) + 2;
+}
+
+/* Encode a frame into a buffer */
+uint32_t Frame_Encode(FRAME_TYPE_T type, FRAME_CRC_T crcType, const void *data, uint32_t len,
+					  void *out, uint32_t outSize)
+{
+	FRAME_ENC_T enc;
+
+	enc.out.p = (uint8_t *) out;
+	enc.out.left = outSize;
+	enc.out.pNext = NULL;
+	enc.out.nextLeft = 0;
+	enc.out.used = 0;
+	enc.out.full = false;
+
+	return encodeFrame(&enc, type, crcType, (const uint8_t *) data, len);
+}
+
+/* Encode a frame into a byte ring buffer */
+uint32_t Frame_EncodeRB(FRAME_TYPE_T type, FRAME_CRC_T crcType, RINGBUFF_T *pRB,
+						const void *data, uint32_t len)
+{
+	FRAME_ENC_T enc;
+	uint32_t used;
+	int free, linear;
+
+	if (pRB->itemSz != 1) {
+		return 0;
+	}
+
+	/* The free space runs up to the end of the ring memory, then from its start */
+	free = RingBuffer_GetFree(pRB);
+	linear = RingBuffer_GetWriteRegion(pRB, (void **) &enc.out.p);
+	enc.out.left = linear;
+	enc.out.pNext = (uint8_t *) pRB->data;
+	enc.out.nextLeft = free - linear;
+	enc.out.used = 0;
+	enc.out.full = false;
+
+	used = encodeFrame(&enc, type, crcType, (const uint8_t *) data, len);
+	if (used > 0) {
+		RingBuffer_CommitWrite(pRB, used);
+	}
+	return used;
+}
+
+/* Initialize a frame decoder */
+void Frame_InitDecoder(FRAME_DEC_T *pDec, FRAME_TYPE_T type, FRAME_CRC_T crcType,
+					   void *buffer, uint32_t size)
+{
+	pDec->pBuf = (uint8_t *) buffer;
+	pDec->size = size;
+	pDec->frameLen = 0;
+	pDec->type = type;
+	pDec->crcType = crcType;
+	pDec->ready = 0;
+	memset(&pDec->stats, 0, sizeof(pDec->stats));
+	decReset(pDec);
+}
+
+/* Decode encoded bytes until the end of a frame */
+uint32_t Frame_Decode(FRAME_DEC_T *pDec, const void *data, uint32_t len)
+{
+	pDec->ready = 0;
+	if (pDec->type == FRAME_COBS) {
+		return decodeCOBS(pDec, (const uint8_t *) data, len);
+	}
+	return decodeEsc(pDec, (const uint8_t *) data, len);
+}
+
+/* Decode bytes from a byte ring buffer until the end of a frame */
+bool Frame_DecodeRB(FRAME_DEC_T *pDec, RINGBUFF_T *pRB)
+{
+	uint8_t *pData;
+	uint32_t used;
+	int len;
+
+	pDec->ready = 0;
+	while ((len = RingBuffer_GetReadRegion(pRB, (void **) &pData)) > 0) {
+		used = Frame_Decode(pDec, pData, len);
+		RingBuffer_ReleaseRead(pRB, used);
+		if (pDec->ready) {
+			return true;
+		}
+	}
+	return false;
+}
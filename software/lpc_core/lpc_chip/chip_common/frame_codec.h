@@ -0,0 +1,233 @@
+/*
+ * @brief COBS, SLIP and HDLC frame encoder and decoder with CRC
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __FRAME_CODEC_H_
+#define __FRAME_CODEC_H_
+
+#include "lpc_types.h"
+#include "ring_buffer.h"
+
+/** @defgroup Frame_Codec CHIP: COBS, SLIP and HDLC framing with CRC
+ * @ingroup CHIP_Common
+ * @{
+ */
+
+/**
+ * @brief Frame byte stuffing methods
+ */
+typedef enum {
+	FRAME_COBS,		/*!< Consistent overhead byte stuffing, frames end with 0x00 */
+	FRAME_SLIP,		/*!< RFC 1055 SLIP, frames start and end with 0xC0 */
+	FRAME_HDLC		/*!< RFC 1662 asynchronous HDLC, frames start and end with 0x7E */
+} FRAME_TYPE_T;
+
+/**
+ * @brief Frame check sequences, appended to the payload least significant byte first
+ */
+typedef enum {
+	FRAME_CRC_NONE,	/*!< No frame check sequence */
+	FRAME_CRC16,	/*!< CRC-16/X-25, the HDLC FCS-16 */
+	FRAME_CRC32		/*!< CRC-32, the HDLC FCS-32 and Ethernet CRC */
+} FRAME_CRC_T;
+
+/**
+ * @def		FRAME_CRC16_INIT
+ * Initial value of an incremental CRC-16, see Frame_CRC16Update()
+ */
+#define FRAME_CRC16_INIT        0xFFFF
+
+/**
+ * @def		FRAME_CRC16_GOOD
+ * CRC-16 of a payload followed by its own CRC-16, before the final inversion
+ */
+#define FRAME_CRC16_GOOD        0xF0B8
+
+/**
+ * @def		FRAME_CRC32_INIT
+ * Initial value of an incremental CRC-32, see Frame_CRC32Update()
+ */
+#define FRAME_CRC32_INIT        0xFFFFFFFFUL
+
+/**
+ * @def		FRAME_CRC32_GOOD
+ * CRC-32 of a payload followed by its own CRC-32, before the final inversion
+ */
+#define FRAME_CRC32_GOOD        0xDEBB20E3UL
+
+/**
+ * @brief Frame decoder statistics
+ */
+typedef struct {
+	uint32_t frames;		/*!< Frames delivered */
+	uint32_t crcErrors;		/*!< Frames dropped on a bad CRC */
+	uint32_t overflows;		/*!< Frames dropped as larger than the frame buffer */
+	uint32_t badFrames;		/*!< Frames dropped on a bad encoding, an abort or a missing CRC */
+} FRAME_STATS_T;
+
+/**
+ * @brief Frame decoder, set up with Frame_InitDecoder()
+ * @note	All members except stats are private to the decoder.
+ */
+typedef struct {
+	uint8_t *pBuf;			/*!< Frame buffer receiving the decoded bytes */
+	uint32_t size;			/*!< Size of the frame buffer */
+	uint32_t len;			/*!< Bytes decoded in the current frame */
+	uint32_t frameLen;		/*!< Payload size of the delivered frame */
+	uint32_t crc;			/*!< CRC of the bytes decoded in the current frame */
+	uint8_t type;			/*!< One of FRAME_TYPE_T */
+	uint8_t crcType;		/*!< One of FRAME_CRC_T */
+	uint8_t esc;			/*!< SLIP and HDLC: the last byte was an escape */
+	uint8_t cobsLeft;		/*!< COBS: bytes left in the current block */
+	uint8_t cobsZero;		/*!< COBS: a zero follows the current block */
+	uint8_t discard;		/*!< The current frame is dropped, wait for its end */
+	uint8_t ready;			/*!< A frame is delivered in the frame buffer */
+	FRAME_STATS_T stats;	/*!< Decoder statistics */
+} FRAME_DEC_T;
+
+/**
+ * @brief	Update a CRC-16/X-25 with more data
+ * @param	crc		: CRC of the previous data, FRAME_CRC16_INIT to start
+ * @param	data	: Pointer to the data
+ * @param	len		: Number of bytes
+ * @return	The updated CRC, to be inverted once all data is added
+ * @note	Table driven, the LPC18xx/43xx have no CRC engine.
+ */
+uint16_t Frame_CRC16Update(uint16_t crc, const void *data, uint32_t len);
+
+/**
+ * @brief	Update a CRC-32 with more data
+ * @param	crc		: CRC of the previous data, FRAME_CRC32_INIT to start
+ * @param	data	: Pointer to the data
+ * @param	len		: Number of bytes
+ * @return	The updated CRC, to be inverted once all data is added
+ */
+uint32_t Frame_CRC32Update(uint32_t crc, const void *data, uint32_t len);
+
+/**
+ * @brief	Return the largest encoded size of a frame
+ * @param	type	: Byte stuffing method
+ * @param	crcType	: Frame check sequence
+ * @param	len		: Payload size
+ * @return	The encoded size of the worst case payload, with the delimiters
+ */
+uint32_t Frame_GetMaxEncodedSize(FRAME_TYPE_T type, FRAME_CRC_T crcType, uint32_t len);
+
+/**
+ * @brief	Encode a frame into a buffer
+ * @param	type	: Byte stuffing method
+ * @param	crcType	: Frame check sequence
+ * @param	data	: Pointer to the payload
+ * @param	len		: Payload size
+ * @param	out		: Buffer receiving the encoded frame
+ * @param	outSize	: Size of the buffer
+ * @return	The encoded size, or 0 if the frame does not fit in the buffer
+ */
+uint32_t Frame_Encode(FRAME_TYPE_T type, FRAME_CRC_T crcType, const void *data, uint32_t len,
+					  void *out, uint32_t outSize);
+
+/**
+ * @brief	Encode a frame into a byte ring buffer
+ * @param	type	: Byte stuffing method
+ * @param	crcType	: Frame check sequence
+ * @param	pRB		: Ring buffer with 1 byte items, written as its producer
+ * @param	data	: Pointer to the payload
+ * @param	len		: Payload size
+ * @return	The encoded size, or 0 if the frame does not fit in the free space
+ * @note	The frame is encoded straight into the free space of the ring
+ * and committed at once, so the consumer never sees part of a frame.
+ * Nothing is inserted when the frame does not fit.
+ */
+uint32_t Frame_EncodeRB(FRAME_TYPE_T type, FRAME_CRC_T crcType, RINGBUFF_T *pRB,
+						const void *data, uint32_t len);
+
+/**
+ * @brief	Initialize a frame decoder
+ * @param	pDec	: Decoder to initialize
+ * @param	type	: Byte stuffing method
+ * @param	crcType	: Frame check sequence, checked and removed from each frame
+ * @param	buffer	: Frame buffer, large enough for the payload and its CRC
+ * @param	size	: Size of the frame buffer
+ * @return	Nothing
+ * @note	Bytes before the first delimiter are decoded as a frame, which
+ * the CRC normally rejects. Frames with an empty payload are only
+ * delivered when a CRC is used.
+ */
+void Frame_InitDecoder(FRAME_DEC_T *pDec, FRAME_TYPE_T type, FRAME_CRC_T crcType,
+					   void *buffer, uint32_t size);
+
+/**
+ * @brief	Decode encoded bytes until the end of a frame
+ * @param	pDec	: Decoder
+ * @param	data	: Pointer to the encoded bytes
+ * @param	len		: Number of encoded bytes
+ * @return	The number of bytes used, which stops after the end of a
+ * delivered frame
+ * @note	Runs of bytes without delimiters or escapes are found a word
+ * at a time, copied once into the frame buffer and added to the CRC. A
+ * delivered frame is read with Frame_GetFrame() until the next decode call.
+ */
+uint32_t Frame_Decode(FRAME_DEC_T *pDec, const void *data, uint32_t len);
+
+/**
+ * @brief	Decode bytes from a byte ring buffer until the end of a frame
+ * @param	pDec	: Decoder
+ * @param	pRB		: Ring buffer with 1 byte items, read as its consumer
+ * @return	true when a frame was delivered, false when the ring was
+ * emptied without completing a frame
+ * @note	The decoder reads the linear regions of the ring, without
+ * popping the bytes into a separate buffer. Call again until false is
+ * returned to deliver all the frames in the ring, each frame is read with
+ * Frame_GetFrame().
+ */
+bool Frame_DecodeRB(FRAME_DEC_T *pDec, RINGBUFF_T *pRB);
+
+/**
+ * @brief	Return the frame delivered by the last decode call
+ * @param	pDec	: Decoder
+ * @param	pLen	: Pointer to where the payload size is stored
+ * @return	Pointer to the payload in the frame buffer, or NULL if no
+ * frame was delivered
+ */
+STATIC INLINE uint8_t *Frame_GetFrame(FRAME_DEC_T *pDec, uint32_t *pLen)
+{
+	if (!pDec->ready) {
+		*pLen = 0;
+		return NULL;
+	}
+	*pLen = pDec->frameLen;
+	return pDec->pBuf;
+}
+
+/**
+ * @}
+ */
+
+#endif /* __FRAME_CODEC_H_ */
@@ -36,9 +36,6 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
-#define RB_INDH(rb)                ((rb)->head & ((rb)->count - 1))
-#define RB_INDT(rb)                ((rb)->tail & ((rb)->count - 1))
-
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -59,21 +56,26 @@ int RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count)
 	RingBuff->itemSz = itemSize;
 	RingBuff->head = RingBuff->tail = 0;
 
-	return 1;
+	/* Indexes are masked, not wrapped */
+	return (count >= 2) && ((count & (count - 1)) == 0);
 }
 
 /* Insert a single item into Ring Buffer */
 int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data)
 {
 	uint8_t *ptr = RingBuff->data;
+	uint32_t head = RingBuff->head;
 
 	/* We cannot insert when queue is full */
-	if (RingBuffer_IsFull(RingBuff))
+	if ((head - RB_VTAIL(RingBuff)) >= (uint32_t) RingBuff->count)
 		return 0;
 
-	ptr += RB_INDH(RingBuff) * RingBuff->itemSz;
+	/* The slot is not written before the consumer is done with it */
+	RB_BARRIER();
+	ptr += (head & (RingBuff->count - 1)) * RingBuff->itemSz;
 	memcpy(ptr, data, RingBuff->itemSz);
-	RingBuff->head++;
+	RB_BARRIER();
+	RB_VHEAD(RingBuff) = head + 1;
 
 	return 1;
 }
@@ -81,51 +83,38 @@ int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data)
 /* Insert multiple items into Ring Buffer */
 int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num)
 {
-	uint8_t *ptr = RingBuff->data;
-	int cnt1, cnt2;
-
-	/* We cannot insert when queue is full */
-	if (RingBuffer_IsFull(RingBuff))
-		return 0;
+	void *ptr;
+	int cnt, total = 0;
 
-	/* Calculate the segment lengths */
-	cnt1 = cnt2 = RingBuffer_GetFree(RingBuff);
-	if (RB_INDH(RingBuff) + cnt1 >= RingBuff->count)
-		cnt1 = RingBuff->count - RB_INDH(RingBuff);
-	cnt2 -= cnt1;
+	/* At most two segments, up to the ring end and from the ring start */
+	while ((num > 0) && ((cnt = RingBuffer_GetWriteRegion(RingBuff, &ptr)) > 0)) {
+		cnt = MIN(cnt, num);
+		memcpy(ptr, data, cnt * RingBuff->itemSz);
+		RingBuffer_CommitWrite(RingBuff, cnt);
 
-	cnt1 = MIN(cnt1, num);
-	num -= cnt1;
+		data = (const uint8_t *) data + cnt * RingBuff->itemSz;
+		num -= cnt;
+		total += cnt;
+	}
 
-	cnt2 = MIN(cnt2, num);
-	num -= cnt2;
-
-	/* Write segment 1 */
-	ptr += RB_INDH(RingBuff) * RingBuff->itemSz;
-	memcpy(ptr, data, cnt1 * RingBuff->itemSz);
-	RingBuff->head += cnt1;
-
-	/* Write segment 2 */
-	ptr = (uint8_t *) RingBuff->data + RB_INDH(RingBuff) * RingBuff->itemSz;
-	data = (const uint8_t *) data + cnt1 * RingBuff->itemSz;
-	memcpy(ptr, data, cnt2 * RingBuff->itemSz);
-	RingBuff->head += cnt2;
-
-	return cnt1 + cnt2;
+	return total;
 }
 
 /* Pop single item from Ring Buffer */
 int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data)
 {
 	uint8_t *ptr = RingBuff->data;
+	uint32_t tail = RingBuff->tail;
 
 	/* We cannot pop when queue is empty */
-	if (RingBuffer_IsEmpty(RingBuff))
+	if (RB_VHEAD(RingBuff) == tail)
 		return 0;
 
-	ptr += RB_INDT(RingBuff) * RingBuff->itemSz;
+	RB_BARRIER();
+	ptr += (tail & (RingBuff->count - 1)) * RingBuff->itemSz;
 	memcpy(data, ptr, RingBuff->itemSz);
-	RingBuff->tail++;
+	RB_BARRIER();
+	RB_VTAIL(RingBuff) = tail + 1;
 
 	return 1;
 }
@@ -133,35 +122,61 @@ int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data)
 /* Pop multiple items from Ring buffer */
 int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num)
 {
-	uint8_t *ptr = RingBuff->data;
-	int cnt1, cnt2;
+	void *ptr;
+	int cnt, total = 0;
 
-	/* We cannot insert when queue is empty */
-	if (RingBuffer_IsEmpty(RingBuff))
-		return 0;
+	/* At most two segments, up to the ring end and from the ring start */
+	while ((num > 0) && ((cnt = RingBuffer_GetReadRegion(RingBuff, &ptr)) > 0)) {
+		cnt = MIN(cnt, num);
+		memcpy(data, ptr, cnt * RingBuff->itemSz);
+		RingBuffer_ReleaseRead(RingBuff, cnt);
 
-	/* Calculate the segment lengths */
-	cnt1 = cnt2 = RingBuffer_GetCount(RingBuff);
-	if (RB_INDT(RingBuff) + cnt1 >= RingBuff->count)
-		cnt1 = RingBuff->count - RB_INDT(RingBuff);
-	cnt2 -= cnt1;
+		data = (uint8_t *) data + cnt * RingBuff->itemSz;
+		num -= cnt;
+		total += cnt;
+	}
 
-	cnt1 = MIN(cnt1, num);
-	num -= cnt1;
+	return total;
+}
 
-	cnt2 = MIN(cnt2, num);
-	num -= cnt2;
+/* Return the free space at the head that is contiguous in memory */
+int RingBuffer_GetWriteRegion(RINGBUFF_T *RingBuff, void **ppData)
+{
+	uint32_t head = RingBuff->head;
+	uint32_t idx = head & (RingBuff->count - 1);
+	uint32_t cnt = RingBuff->count - (head - RB_VTAIL(RingBuff));
+
+	/* Items are not written before the consumer is done with them */
+	RB_BARRIER();
+	*ppData = (uint8_t *) RingBuff->data + idx * RingBuff->itemSz;
 
-	/* Write segment 1 */
-	ptr += RB_INDT(RingBuff) * RingBuff->itemSz;
-	memcpy(data, ptr, cnt1 * RingBuff->itemSz);
-	RingBuff->tail += cnt1;
+	return MIN(cnt, RingBuff->count - idx);
+}
 
-	/* Write segment 2 */
-	ptr = (uint8_t *) RingBuff->data + RB_INDT(RingBuff) * RingBuff->itemSz;
-	data = (uint8_t *) data + cnt1 * RingBuff->itemSz;
-	memcpy(data, ptr, cnt2 * RingBuff->itemSz);
-	RingBuff->tail += cnt2;
+/* Make items written in the write region visible */
+void RingBuffer_CommitWrite(RINGBUFF_T *RingBuff, int num)
+{
+	RB_BARRIER();
+	RB_VHEAD(RingBuff) = RingBuff->head + num;
+}
 
-	return cnt1 + cnt2;
+/* Return the items at the tail that are contiguous in memory */
+int RingBuffer_GetReadRegion(RINGBUFF_T *RingBuff, void **ppData)
+{
+	uint32_t tail = RingBuff->tail;
+	uint32_t idx = tail & (RingBuff->count - 1);
+	uint32_t cnt = RB_VHEAD(RingBuff) - tail;
+
+	/* Items are not read before the producer committed them */
+	RB_BARRIER();
+	*ppData = (uint8_t *) RingBuff->data + idx * RingBuff->itemSz;
+
+	return MIN(cnt, RingBuff->count - idx);
+}
+
+/* Free items used from the read region */
+void RingBuffer_ReleaseRead(RINGBUFF_T *RingBuff, int num)
+{
+	RB_BARRIER();
+	RB_VTAIL(RingBuff) = RingBuff->tail + num;
 }
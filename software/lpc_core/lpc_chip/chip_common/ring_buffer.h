@@ -41,6 +41,12 @@
 
 /**
  * @brief Ring buffer structure
+ * @note	The ring is lock free for one producer and one consumer, which
+ * may run in different interrupts or on different cores. Only the
+ * producer calls the insert and write region functions and changes head,
+ * only the consumer calls the pop and read region functions and changes
+ * tail. RingBuffer_Init() and RingBuffer_Flush() must not run while the
+ * other side is using the ring.
  */
 typedef struct {
 	void *data;
@@ -62,6 +68,22 @@ typedef struct {
  */
 #define RB_VTAIL(rb)              (*(volatile uint32_t *) &(rb)->tail)
 
+/**
+ * @def		RB_BARRIER()
+ * Memory barrier ordering the item accesses with the index updates, so
+ * the ring may be shared with the other core or a DMA master
+ */
+#ifndef RB_BARRIER
+#if defined(__CC_ARM)
+#define RB_BARRIER()              __dmb(0xF)
+#elif defined(__ICCARM__)
+#include <intrinsics.h>
+#define RB_BARRIER()              __DMB()
+#else
+#define RB_BARRIER()              __asm volatile ("dmb" ::: "memory")
+#endif
+#endif
+
 /**
  * @brief	Initialize ring buffer
  * @param	RingBuff	: Pointer to ring buffer to initialize
@@ -71,7 +93,7 @@ typedef struct {
  * @note	Memory pointed by @a buffer must have correct alignment of
  * 			@a itemSize, and @a count must be a power of 2 and must at
  * 			least be 2 or greater.
- * @return	Nothing
+ * @return	1 on success, 0 if @a count is not a power of 2
  */
 int RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count);
 
@@ -180,6 +202,117 @@ int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data);
  */
 int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num);
 
+/**
+ * @brief	Return the free space at the head that is contiguous in memory
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	ppData		: Pointer to where the address of the space is stored
+ * @return	Number of items that can be written at *ppData
+ * @note	Producer side. The items are filled in place, by the CPU or a
+ *			DMA, then made visible with RingBuffer_CommitWrite(). The space
+ *			stops at the end of the ring memory, a second call after the
+ *			commit returns the space at its start.
+ */
+int RingBuffer_GetWriteRegion(RINGBUFF_T *RingBuff, void **ppData);
+
+/**
+ * @brief	Make items written in the region from RingBuffer_GetWriteRegion() visible
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	num			: Number of items written, at most the size of the region
+ * @return	Nothing
+ */
+void RingBuffer_CommitWrite(RINGBUFF_T *RingBuff, int num);
+
+/**
+ * @brief	Return the items at the tail that are contiguous in memory
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	ppData		: Pointer to where the address of the items is stored
+ * @return	Number of items that can be read at *ppData
+ * @note	Consumer side. The items are used in place, by the CPU or a
+ *			DMA, then freed with RingBuffer_ReleaseRead(). The items stop at
+ *			the end of the ring memory, a second call after the release
+ *			returns the items at its start.
+ */
+int RingBuffer_GetReadRegion(RINGBUFF_T *RingBuff, void **ppData);
+
+/**
+ * @brief	Free items used from the region from RingBuffer_GetReadRegion()
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	num			: Number of items used, at most the size of the region
+ * @return	Nothing
+ */
+void RingBuffer_ReleaseRead(RINGBUFF_T *RingBuff, int num);
+
+/**
+ * @brief	Insert a byte into a byte ring of a known size
+ * @param	RingBuff	: Pointer to ring buffer, with items of 1 byte
+ * @param	byte		: Byte to insert
+ * @param	size		: Size of the ring, must be RingBuff->count
+ * @return	1 when inserted, 0 when the ring is full
+ * @note	With @a size a constant the index mask is folded at compile time,
+ *			for interrupt handlers moving one byte at a time.
+ */
+STATIC INLINE int RingBuffer_InsertByteN(RINGBUFF_T *RingBuff, uint8_t byte, const uint32_t size)
+{
+	uint32_t head = RingBuff->head;
+
+	if ((head - RB_VTAIL(RingBuff)) >= size) {
+		return 0;
+	}
+
+	/* The slot is not written before the consumer is done with it */
+	RB_BARRIER();
+	((uint8_t *) RingBuff->data)[head & (size - 1)] = byte;
+	RB_BARRIER();
+	RB_VHEAD(RingBuff) = head + 1;
+
+	return 1;
+}
+
+/**
+ * @brief	Pop a byte from a byte ring of a known size
+ * @param	RingBuff	: Pointer to ring buffer, with items of 1 byte
+ * @param	pByte		: Pointer to where the byte is stored
+ * @param	size		: Size of the ring, must be RingBuff->count
+ * @return	1 when a byte was popped, 0 when the ring is empty
+ */
+STATIC INLINE int RingBuffer_PopByteN(RINGBUFF_T *RingBuff, uint8_t *pByte, const uint32_t size)
+{
+	uint32_t tail = RingBuff->tail;
+
+	if (RB_VHEAD(RingBuff) == tail) {
+		return 0;
+	}
+
+	RB_BARRIER();
+	*pByte = ((uint8_t *) RingBuff->data)[tail & (size - 1)];
+	RB_BARRIER();
+	RB_VTAIL(RingBuff) = tail + 1;
+
+	return 1;
+}
+
+/**
+ * @brief	Insert a byte into a byte ring
+ * @param	RingBuff	: Pointer to ring buffer, with items of 1 byte
+ * @param	byte		: Byte to insert
+ * @return	1 when inserted, 0 when the ring is full
+ */
+STATIC INLINE int RingBuffer_InsertByte(RINGBUFF_T *RingBuff, uint8_t byte)
+{
+	return RingBuffer_InsertByteN(RingBuff, byte, RingBuff->count);
+}
+
+/**
+ * @brief	Pop a byte from a byte ring
+ * @param	RingBuff	: Pointer to ring buffer, with items of 1 byte
+ * @param	pByte		: Pointer to where the byte is stored
+ * @return	1 when a byte was popped, 0 when the ring is empty
+ */
+STATIC INLINE int RingBuffer_PopByte(RINGBUFF_T *RingBuff, uint8_t *pByte)
+{
+	return RingBuffer_PopByteN(RingBuff, pByte, RingBuff->count);
+}
+
 
 /**
  * @}
@@ -297,6 +297,61 @@ static INLINE SPIFI_ERR_T spifiDevRead(const SPIFI_HANDLE_T *pHandle, uint32_t a
 	return pHandle->pFamFx->read(pHandle, addr, readBuff, bytes);
 }
 
+/**
+ * @brief	Start a read or page program whose data is moved by a DMA engine
+ * @param	pHandle	: Pointer to a LPCSPIFILIB device handle
+ * @param	addr	: LPCSPIFILIB device address to start the transfer at
+ * @param	bytes	: Number of bytes to transfer, a multiple of 4. Must not exceed
+ *					  the max single read size for a read or the page size for a program
+ * @param	write	: 0 to read from the device, non-zero to program it
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	The command is issued with DMA requests enabled (SPIFI_CTRL_DMAEN). The
+ * caller must have a DMA channel ready to move bytes / 4 words between memory
+ * and the controller data register, and must call spifiDevDMAEnd() once the
+ * channel is done. SPIFI_ERR_NOTSUPPORTED is returned if the family driver
+ * does not support DMA transfers.
+ */
+SPIFI_ERR_T spifiDevDMAStart(const SPIFI_HANDLE_T *pHandle, uint32_t addr, uint32_t bytes, uint8_t write);
+
+/**
+ * @brief	Complete a transfer started with spifiDevDMAStart()
+ * @param	pHandle	: Pointer to a LPCSPIFILIB device handle
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	This waits for the controller to finish the command and disables the
+ * DMA requests. A page program is still in progress in the device after this
+ * returns, use spifiDevPollBusyStart() or the device status to wait for it.
+ */
+SPIFI_ERR_T spifiDevDMAEnd(const SPIFI_HANDLE_T *pHandle);
+
+/**
+ * @brief	Abort a transfer started with spifiDevDMAStart()
+ * @param	pHandle	: Pointer to a LPCSPIFILIB device handle
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	Used instead of spifiDevDMAEnd() when the DMA channel could not be
+ * started or failed, as the command would never complete. The DMA requests
+ * are disabled and the controller is reset, ending the command. The device
+ * may have started programming the data of an aborted page program.
+ */
+SPIFI_ERR_T spifiDevDMAAbort(const SPIFI_HANDLE_T *pHandle);
+
+/**
+ * @brief	Start polling of the device busy status by the controller
+ * @param	pHandle	: Pointer to a LPCSPIFILIB device handle
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	The controller keeps reading the device status without CPU involvement
+ * until the pending program or erase completes. No other command may be issued
+ * until spifiDevPollBusyEnd() returns something other than SPIFI_ERR_BUSY.
+ */
+SPIFI_ERR_T spifiDevPollBusyStart(const SPIFI_HANDLE_T *pHandle);
+
+/**
+ * @brief	Check for the end of the polling started with spifiDevPollBusyStart()
+ * @param	pHandle	: Pointer to a LPCSPIFILIB device handle
+ * @return	SPIFI_ERR_BUSY while the device is busy, else the result of the
+ * program or erase operation (SPIFI_ERR_NONE, SPIFI_ERR_PROGERR or SPIFI_ERR_ERASEERR)
+ */
+SPIFI_ERR_T spifiDevPollBusyEnd(const SPIFI_HANDLE_T *pHandle);
+
 /**
  * @brief	Reset the device
  * @param	pHandle	: Pointer to a LPCSPIFILIB device handle
@@ -380,10 +435,12 @@ uint32_t spifiGetSubBlockFromBlock(const SPIFI_HANDLE_T *pHandle, uint32_t block
  * @brief	Program the device with the passed buffer
  * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
  * @param	addr		: LPCSPIFILIB device address to start write at
- * @param	writeBuff	: Address of buffer to write, must be 32-bit aligned
+ * @param	writeBuff	: Address of buffer to write
  * @param	bytes		: Number of bytes to write
  * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
- * @note	This function has no size limit. This function only works in blocking mode.
+ * @note	This function has no size limit. Writes are split on page boundaries.
+ * An unaligned buffer, or one left unaligned by a split, is copied to the stack.
+ * This function only works in blocking mode.
  */
 SPIFI_ERR_T spifiProgram(const SPIFI_HANDLE_T *pHandle, uint32_t addr, const uint32_t *writeBuff, uint32_t bytes);
 
@@ -418,11 +475,88 @@ SPIFI_ERR_T spifiErase(const SPIFI_HANDLE_T *pHandle, uint32_t firstBlock, uint3
  * @param	lastAddr	: Ending address range for block erase
  * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
  * @note	This function will erase blocks inside the passed address
- * range if and only if the address range is valid.
+ * range if and only if the address range is valid. Each block is erased
+ * with a block erase or with sub-block erases, and the full device with a
+ * device erase, whichever is faster (see spifiErasePlan()).
  * This function only works in blocking mode.
  */
 SPIFI_ERR_T spifiEraseByAddr(const SPIFI_HANDLE_T *pHandle, uint32_t firstAddr, uint32_t lastAddr);
 
+#define SPIFI_ERASE_WHOLE_BLOCKS    (1 << 0)	/**< Erase every block the range touches (spifiEraseByAddr() behavior) */
+#define SPIFI_ERASE_OVERERASE       (1 << 1)	/**< Erase a whole block partially outside the range when faster than its sub-blocks */
+#define SPIFI_ERASE_PRESERVE        (1 << 2)	/**< Restore the bytes outside the range of the first and last erased sectors */
+
+/** Sub-block and block erase times used when the device data has none (in mS) */
+#define SPIFI_ERASE_DEF_SUBBLK_TIME (50)
+#define SPIFI_ERASE_DEF_BLK_TIME    (500)
+
+/**
+ * @brief A run of consecutive erases of the same size
+ */
+typedef struct {
+	uint32_t        first;						/**< First block or sub-block number */
+	uint32_t        count;						/**< Number of blocks or sub-blocks, 0 if the segment is not used */
+	uint8_t         subBlocks;					/**< The segment is erased with sub-block erases */
+} SPIFI_ERASE_SEG_T;
+
+/**
+ * @brief Erase plan for an address range, built by spifiErasePlan()
+ */
+typedef struct {
+	uint8_t         eraseAll;					/**< The device is erased with a full device erase */
+	SPIFI_ERASE_SEG_T seg[3];					/**< First partial block, full blocks and last partial block */
+	uint32_t        firstAddr;					/**< First address that will be erased */
+	uint32_t        lastAddr;					/**< Last address that will be erased */
+	uint32_t        headBytes;					/**< Bytes restored from firstAddr (SPIFI_ERASE_PRESERVE) */
+	uint32_t        tailBytes;					/**< Bytes restored up to lastAddr (SPIFI_ERASE_PRESERVE) */
+	uint32_t        bufBytes;					/**< Size of the buffer spifiErasePlanRun() needs to restore them */
+	uint32_t        eraseTime;					/**< Modelled erase time in mS */
+} SPIFI_ERASE_PLAN_T;
+
+/**
+ * @brief	Plan the fastest erase of an address range
+ * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
+ * @param	firstAddr	: First address to erase
+ * @param	lastAddr	: Last address to erase
+ * @param	flags		: OR'ed SPIFI_ERASE_* values, or 0
+ * @param	pPlan		: Pointer to the plan to fill
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	Without flags, the range is covered with the smallest sectors
+ * (sub-blocks where supported) at its ends and with block or sub-block erases,
+ * whichever is faster, for the blocks it fully covers. A device erase is used
+ * when the whole device must be erased and it is faster. The erase times come
+ * from the device data, SPIFI_ERASE_DEF_* is used for devices without them.
+ * The modelled time does not include restoring preserved bytes.
+ */
+SPIFI_ERR_T spifiErasePlan(const SPIFI_HANDLE_T *pHandle, uint32_t firstAddr, uint32_t lastAddr,
+						   uint32_t flags, SPIFI_ERASE_PLAN_T *pPlan);
+
+/**
+ * @brief	Run an erase plan
+ * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
+ * @param	pPlan		: Plan built by spifiErasePlan()
+ * @param	pBuf		: 32-bit aligned buffer of at least pPlan->bufBytes bytes, NULL if bufBytes is 0
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	This function only works in blocking mode.
+ */
+SPIFI_ERR_T spifiErasePlanRun(const SPIFI_HANDLE_T *pHandle, const SPIFI_ERASE_PLAN_T *pPlan, uint32_t *pBuf);
+
+/**
+ * @brief	Erase an address range with the fastest mix of erase sizes
+ * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
+ * @param	firstAddr	: First address to erase
+ * @param	lastAddr	: Last address to erase
+ * @param	flags		: OR'ed SPIFI_ERASE_* values, or 0
+ * @param	pBuf		: 32-bit aligned buffer for SPIFI_ERASE_PRESERVE, it must hold
+ * two sub-blocks (two blocks on devices without sub-blocks), or NULL
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	Combines spifiErasePlan() and spifiErasePlanRun(). Without
+ * SPIFI_ERASE_PRESERVE, bytes outside the range in the first and last erased
+ * sectors are lost. This function only works in blocking mode.
+ */
+SPIFI_ERR_T spifiEraseRange(const SPIFI_HANDLE_T *pHandle, uint32_t firstAddr, uint32_t lastAddr,
+							uint32_t flags, uint32_t *pBuf);
+
 /**
  * @}
  */
@@ -179,6 +179,7 @@ typedef enum {
 
 	FX_spifiDeviceDataSetOptsQuadModeBit9,		/**< Set bit 9 when enabling Quad mode */
 	FX_spifiDeviceDataSetOptsQuadModeBit6,		/**< Set bit 6 when enabling Quad mode */
+	FX_spifiDeviceDataSetOptsNone,				/**< No register change when enabling Quad mode */
 
 	FX_spifiDeviceInitReadCommand,				/**< General return cmdReg value for read */
 	FX_spifiDevice4BInitReadCommand,			/**< General return cmdReg value for read w/ 4Byte address */
@@ -280,6 +281,15 @@ typedef struct SPIFI_FAM_FX {
 	devSetOptsFx devSetOpts;			/**< run-time assigned Fx* to set quad mode */
 	devGetReadCmdFx devGetReadCmd;		/**< run-time assigned Fx* to return read cmd */
 	devGetWriteCmdFx devGetWriteCmd;	/**< run-time assigned Fx* to return write cmd */
+
+	/* Command mode transfers moved by an external DMA engine */
+	SPIFI_ERR_T (*dmaStart)(const struct SPIFI_HANDLE *, uint32_t, uint32_t, uint8_t);	/**< (NULL allowed) Start a DMA read or page program */
+
+	SPIFI_ERR_T (*dmaEnd)(const struct SPIFI_HANDLE *);										/**< (NULL allowed) Complete a DMA read or page program */
+
+	SPIFI_ERR_T (*pollBusyStart)(const struct SPIFI_HANDLE *);									/**< (NULL allowed) Start controller polling of the busy status */
+
+	SPIFI_ERR_T (*pollBusyEnd)(const struct SPIFI_HANDLE *);									/**< (NULL allowed) Check for the end of busy polling */
 } SPIFI_FAM_FX_T;
 
 /**
@@ -316,6 +326,9 @@ typedef struct SPIFI_DEVICE_DATA {
 	uint8_t setOptionsFxId;					/**< setOptions fx_id */
 	uint8_t getReadCmdFxId;					/**< getReadCommand fx_id */
 	uint8_t getWriteCmdFxId;					/**< getWriteCommand fx_id */
+	uint16_t subBlkEraseTime;					/**< (in mS) typical sub-block erase time, 0 if not known */
+	uint16_t blkEraseTime;						/**< (in mS) typical block erase time, 0 if not known */
+	uint32_t chipEraseTime;						/**< (in mS) typical full device erase time, 0 if not known */
 } SPIFI_DEVICE_DATA_T;
 
 /**
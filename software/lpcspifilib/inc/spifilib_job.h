@@ -0,0 +1,166 @@
+/*
+ * @brief LPCSPIFILIB non-blocking erase and program jobs
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#ifndef __SPIFILIB_JOB_H_
+#define __SPIFILIB_JOB_H_
+
+#include "spifilib_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup LPCSPIFILIB_JOBAPI LPCSPIFILIB non-blocking erase and program jobs
+ * @ingroup LPCSPIFILIB_API
+ * A job erases or programs an address range one device operation (a block
+ * erase or a page program) at a time without waiting for the device. Each
+ * operation is started in non-blocking mode and the controller is left
+ * polling the device status (status register polling) when the family
+ * supports it, so spifiJobPoll() only has to check the controller state.
+ * spifiJobPoll() should be called periodically, e.g. from a timer tick, and
+ * starts the next operation once the current one is done.<br>
+ * While a job is running, the device must not be accessed by any other
+ * LPCSPIFILIB function and memory mode must not be entered. Only one job per
+ * device can run at a time.
+ * @{
+ */
+
+/**
+ * @brief Job types
+ */
+typedef enum {
+	SPIFI_JOB_NONE = 0,							/**< No job running */
+	SPIFI_JOB_ERASE,							/**< Erasing blocks */
+	SPIFI_JOB_PROGRAM							/**< Programming pages */
+} SPIFI_JOB_TYPE_T;
+
+/**
+ * @brief Job progress callback, called after each completed device operation
+ * @param	cbData		: Callback data passed when the job was started
+ * @param	doneBytes	: Number of bytes erased or programmed so far
+ * @param	totalBytes	: Number of bytes erased or programmed by the job
+ */
+typedef void (*SPIFI_JOB_PROGRESS_T)(void *cbData, uint32_t doneBytes, uint32_t totalBytes);
+
+/**
+ * @brief Job completion callback
+ * @param	cbData	: Callback data passed when the job was started
+ * @param	err		: SPIFI_ERR_NONE if the job completed, or the error that stopped it
+ */
+typedef void (*SPIFI_JOB_DONE_T)(void *cbData, SPIFI_ERR_T err);
+
+/**
+ * @brief Job context, the fields are private to the job functions
+ */
+typedef struct {
+	const SPIFI_HANDLE_T *pHandle;				/**< Device the job runs on */
+	SPIFI_JOB_TYPE_T type;						/**< Job type, SPIFI_JOB_NONE when idle */
+	uint8_t         waiting;					/**< A device operation is in progress */
+	uint8_t         hwPoll;						/**< The controller is polling the device status */
+	uint32_t        addr;						/**< Address of the next device operation */
+	const uint8_t   *pBuf;						/**< Data of the next device operation (program only) */
+	uint32_t        remaining;					/**< Bytes left to erase or program */
+	uint32_t        total;						/**< Bytes erased or programmed by the job */
+	uint32_t        opBytes;					/**< Bytes covered by the device operation in progress */
+	SPIFI_JOB_PROGRESS_T progressCb;			/**< Progress callback or NULL */
+	SPIFI_JOB_DONE_T doneCb;					/**< Completion callback or NULL */
+	void            *cbData;					/**< Data passed to the callbacks */
+	SPIFI_ERR_T     lastErr;					/**< Result of the last completed job */
+} SPIFI_JOB_T;
+
+/**
+ * @brief	Start erasing multiple blocks by address range
+ * @param	pJob		: Pointer to an idle job context
+ * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
+ * @param	firstAddr	: Starting address range for block erase
+ * @param	lastAddr	: Ending address range for block erase
+ * @param	progressCb	: Called after each erased block, or NULL
+ * @param	doneCb		: Called when the job ends, or NULL
+ * @param	cbData		: Data passed to the callbacks
+ * @return	SPIFI_ERR_NONE if the job was started, or a SPIFI_ERR_xxx error code
+ * @note	Erases the same blocks as spifiEraseByAddr(). The first erase is
+ * started by this call. The callbacks are not called if the job is not started.
+ */
+SPIFI_ERR_T spifiJobErase(SPIFI_JOB_T *pJob, const SPIFI_HANDLE_T *pHandle,
+						  uint32_t firstAddr, uint32_t lastAddr,
+						  SPIFI_JOB_PROGRESS_T progressCb, SPIFI_JOB_DONE_T doneCb, void *cbData);
+
+/**
+ * @brief	Start programming the device with the passed buffer
+ * @param	pJob		: Pointer to an idle job context
+ * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
+ * @param	addr		: LPCSPIFILIB device address to start write at
+ * @param	writeBuff	: Address of buffer to write
+ * @param	bytes		: Number of bytes to write
+ * @param	progressCb	: Called after each programmed page, or NULL
+ * @param	doneCb		: Called when the job ends, or NULL
+ * @param	cbData		: Data passed to the callbacks
+ * @return	SPIFI_ERR_NONE if the job was started, or a SPIFI_ERR_xxx error code
+ * @note	The buffer must be kept unchanged until the job ends. Writes are split
+ * on page boundaries, so addr does not need to be page aligned. Data at an
+ * unaligned buffer address is copied to a word aligned buffer on the stack,
+ * at most 256 bytes per page program. The first page program is started by
+ * this call. The callbacks are not called if the job is not started.
+ */
+SPIFI_ERR_T spifiJobProgram(SPIFI_JOB_T *pJob, const SPIFI_HANDLE_T *pHandle,
+							uint32_t addr, const uint32_t *writeBuff, uint32_t bytes,
+							SPIFI_JOB_PROGRESS_T progressCb, SPIFI_JOB_DONE_T doneCb, void *cbData);
+
+/**
+ * @brief	Advance a job
+ * @param	pJob	: Pointer to a job context
+ * @return	SPIFI_ERR_BUSY while the job is running, otherwise the result of the
+ * last job (SPIFI_ERR_NONE if it completed)
+ * @note	Should be called periodically, e.g. from a timer tick. The progress and
+ * completion callbacks are called from this function.
+ */
+SPIFI_ERR_T spifiJobPoll(SPIFI_JOB_T *pJob);
+
+/**
+ * @brief	Returns the state of a job
+ * @param	pJob	: Pointer to a job context
+ * @return	true if a job is running, otherwise false
+ */
+static INLINE uint8_t spifiJobIsBusy(const SPIFI_JOB_T *pJob)
+{
+	return pJob->type != SPIFI_JOB_NONE;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPIFILIB_JOB_H_ */
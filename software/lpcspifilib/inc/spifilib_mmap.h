@@ -0,0 +1,190 @@
+/*
+ * @brief LPCSPIFILIB memory mapped reads with command mode coherency
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#ifndef __SPIFILIB_MMAP_H_
+#define __SPIFILIB_MMAP_H_
+
+#include "spifilib_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup LPCSPIFILIB_MMAPAPI LPCSPIFILIB memory mapped access
+ * @ingroup LPCSPIFILIB_API
+ * A memory map context keeps the controller in memory mode whenever the
+ * device is idle, so reads are served straight from the mapped address space
+ * through the controller cache and prefetch buffer. Programs and erases made
+ * through the context leave memory mode for the duration of the operation and
+ * enter it again afterwards, which also clears the controller cache, so reads
+ * never return stale data.<br>
+ * Code that accesses the device in command mode by other means (DMA transfers,
+ * jobs, other LPCSPIFILIB functions) must do so between spifiMMapBeginCmd() and
+ * spifiMMapEndCmd(). Reads made inside such a section use command mode.
+ * @{
+ */
+
+/**
+ * @brief Prefetch options for spifiMMapSetPrefetch()
+ */
+#define SPIFI_MMAP_PREFETCH_CODE    (1 << 0)	/**< Prefetch the next cache line on sequential reads */
+#define SPIFI_MMAP_PREFETCH_DATA    (1 << 1)	/**< Keep reading ahead while a memory mode read is pending */
+
+/**
+ * @brief Memory map context, the fields are private to the memory map functions
+ */
+typedef struct {
+	const SPIFI_HANDLE_T *pHandle;				/**< Device the context maps */
+	uint8_t         cmdDepth;					/**< Nesting level of command mode sections */
+	uint32_t        prefetch;					/**< SPIFI_MMAP_PREFETCH_* options in use */
+	uint32_t        memReads;					/**< Reads served from the mapped address space */
+	uint32_t        cmdReads;					/**< Reads served in command mode */
+	uint32_t        remaps;						/**< Number of times memory mode was entered again */
+} SPIFI_MMAP_T;
+
+/**
+ * @brief	Initialize a memory map context and enter memory mode
+ * @param	pMap		: Pointer to a memory map context
+ * @param	pHandle		: Pointer to a LPCSPIFILIB device handle
+ * @param	prefetch	: SPIFI_MMAP_PREFETCH_* options to enable
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ */
+SPIFI_ERR_T spifiMMapInit(SPIFI_MMAP_T *pMap, const SPIFI_HANDLE_T *pHandle, uint32_t prefetch);
+
+/**
+ * @brief	Select the controller prefetch options
+ * @param	pMap		: Pointer to a memory map context
+ * @param	prefetch	: SPIFI_MMAP_PREFETCH_* options to enable, the others are disabled
+ * @return	Nothing
+ * @note	Prefetching helps sequential reads and code execution. Random reads
+ * of small items may be faster with prefetching disabled, as the controller
+ * doesn't have to finish a read ahead before starting the next read.
+ */
+void spifiMMapSetPrefetch(SPIFI_MMAP_T *pMap, uint32_t prefetch);
+
+/**
+ * @brief	Limit the region read through the controller cache
+ * @param	pMap	: Pointer to a memory map context
+ * @param	addr	: Mapped address from which memory mode reads are not cached
+ * @return	Nothing
+ * @note	Data that is rewritten often can be placed above the limit, so
+ * that the code and constant data below it keep their cache lines.
+ */
+void spifiMMapSetCacheLimit(SPIFI_MMAP_T *pMap, uint32_t addr);
+
+/**
+ * @brief	Leave memory mode to access the device in command mode
+ * @param	pMap	: Pointer to a memory map context
+ * @return	Nothing
+ * @note	Calls can be nested, memory mode is entered again by the
+ * spifiMMapEndCmd() call matching the first call. Code and data must not
+ * be fetched from the device until then.
+ */
+void spifiMMapBeginCmd(SPIFI_MMAP_T *pMap);
+
+/**
+ * @brief	End a command mode section and enter memory mode again
+ * @param	pMap	: Pointer to a memory map context
+ * @return	Nothing
+ * @note	Entering memory mode clears the controller cache.
+ */
+void spifiMMapEndCmd(SPIFI_MMAP_T *pMap);
+
+/**
+ * @brief	Read the device
+ * @param	pMap		: Pointer to a memory map context
+ * @param	addr		: Mapped address to start reading at
+ * @param	readBuff	: Address of buffer to read into, must be 32-bit aligned
+ * @param	bytes		: Number of bytes to read
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	Reads are copied from the mapped address space, or made in command
+ * mode inside a command mode section.
+ */
+SPIFI_ERR_T spifiMMapRead(SPIFI_MMAP_T *pMap, uint32_t addr, uint32_t *readBuff, uint32_t bytes);
+
+/**
+ * @brief	Program the device and return to memory mode
+ * @param	pMap		: Pointer to a memory map context
+ * @param	addr		: Mapped address to start writing at
+ * @param	writeBuff	: Address of buffer to write, must be 32-bit aligned
+ * @param	bytes		: Number of bytes to write
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	Same as spifiProgram(). The buffer must not be located in the device.
+ */
+SPIFI_ERR_T spifiMMapProgram(SPIFI_MMAP_T *pMap, uint32_t addr, const uint32_t *writeBuff, uint32_t bytes);
+
+/**
+ * @brief	Erase an address range and return to memory mode
+ * @param	pMap		: Pointer to a memory map context
+ * @param	firstAddr	: Starting address of the range to erase
+ * @param	lastAddr	: Ending address of the range to erase
+ * @param	flags		: SPIFI_ERASE_* planning options
+ * @param	pBuf		: Buffer used with SPIFI_ERASE_PRESERVE, or NULL
+ * @return	A SPIFI_ERR_xxx error code (SPIFI_ERR_NONE is no errors)
+ * @note	Same as spifiEraseRange().
+ */
+SPIFI_ERR_T spifiMMapErase(SPIFI_MMAP_T *pMap, uint32_t firstAddr, uint32_t lastAddr,
+						   uint32_t flags, uint32_t *pBuf);
+
+/**
+ * @brief	Discard cached device data after the device was changed
+ * @param	pMap	: Pointer to a memory map context
+ * @param	addr	: Mapped address of the changed range
+ * @param	bytes	: Size of the changed range
+ * @return	Nothing
+ * @note	Only needed when the device was changed without a command mode
+ * section, e.g. by a second bus master. The controller cache can only be
+ * cleared as a whole, so nothing is done for ranges above the cache limit.
+ */
+void spifiMMapInvalidate(SPIFI_MMAP_T *pMap, uint32_t addr, uint32_t bytes);
+
+/**
+ * @brief	Returns a pointer to device data in the mapped address space
+ * @param	pMap	: Pointer to a memory map context
+ * @param	addr	: Mapped address of the data
+ * @return	Pointer to the data, or NULL inside a command mode section
+ * @note	The pointer stays valid until the next command mode section.
+ */
+static INLINE const void *spifiMMapGetPtr(const SPIFI_MMAP_T *pMap, uint32_t addr)
+{
+	return (pMap->cmdDepth == 0) ? (const void *) addr : (const void *) 0;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPIFILIB_MMAP_H_ */
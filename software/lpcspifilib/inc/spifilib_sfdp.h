@@ -0,0 +1,151 @@
+/*
+ * @brief LPCSPIFILIB SFDP (JESD216) parameter table parser
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#ifndef __SPIFILIB_SFDP_H_
+#define __SPIFILIB_SFDP_H_
+
+#include "spifilib_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup LPCSPIFILIB_SFDP LPCSPIFILIB SFDP parameter table parser
+ * @ingroup LPCSPIFILIB_DEV
+ * Parses the Serial Flash Discoverable Parameters (JESD216, revisions A and
+ * B) of a device into the geometry, erase times and read commands needed to
+ * drive it with the common command set. The parser only accesses the table
+ * through a read function, so it can be run on any copy of the table.
+ * @{
+ */
+
+/**
+ * @brief SFDP read command opcode, 3 byte address and 8 dummy clocks
+ */
+#define SPIFI_SFDP_OPCODE               0x5A
+
+/**
+ * @brief SFDP signature, "SFDP" read as a little endian word
+ */
+#define SPIFI_SFDP_SIGNATURE            0x50444653
+
+/**
+ * @brief Quad enable requirements (JESD216B basic table DWORD 15)
+ */
+typedef enum {
+	SPIFI_SFDP_QER_NONE = 0,					/**< No quad enable bit */
+	SPIFI_SFDP_QER_SR2BIT1,						/**< Bit 1 of status register 2, written with 2 status bytes */
+	SPIFI_SFDP_QER_SR1BIT6,						/**< Bit 6 of status register 1 */
+	SPIFI_SFDP_QER_SR2BIT7,						/**< Bit 7 of status register 2, with its own read and write commands */
+	SPIFI_SFDP_QER_SR2BIT1_NOCLR,				/**< As SPIFI_SFDP_QER_SR2BIT1, a 1 byte write keeps status register 2 */
+	SPIFI_SFDP_QER_SR2BIT1_RD35,				/**< As SPIFI_SFDP_QER_SR2BIT1, status register 2 is read with 0x35 */
+	SPIFI_SFDP_QER_SR2BIT1_WR31,				/**< Bit 1 of status register 2, read with 0x35 and written with 0x31 */
+	SPIFI_SFDP_QER_RESERVED,					/**< Reserved encoding */
+	SPIFI_SFDP_QER_UNKNOWN = 0xFF				/**< Not given by the table (JESD216 revision A) */
+} SPIFI_SFDP_QER_T;
+
+/**
+ * @brief Read command described by the basic parameter table
+ */
+typedef struct {
+	uint8_t         opcode;						/**< Read opcode, 0 if the read mode is not supported */
+	uint8_t         addrLines;					/**< Number of lines used for the address and mode bits (1, 2 or 4) */
+	uint8_t         dataLines;					/**< Number of lines used for the data (2 or 4) */
+	uint8_t         modeClocks;					/**< Clocks of mode bits after the address */
+	uint8_t         dummyClocks;				/**< Dummy clocks after the mode bits */
+} SPIFI_SFDP_READ_T;
+
+/**
+ * @brief Device description parsed from the SFDP tables
+ */
+typedef struct {
+	uint8_t         revMajor;					/**< Basic parameter table major revision */
+	uint8_t         revMinor;					/**< Basic parameter table minor revision */
+	uint8_t         qer;						/**< Quad enable requirement, a SPIFI_SFDP_QER_T value */
+	uint8_t         contRead;					/**< 1 when 0-4-4 (continuous) quad reads can be entered and left with mode bits */
+	uint8_t         dtrRead;					/**< 1 when DTR reads are supported */
+	uint32_t        devSize;					/**< Device size in bytes */
+	uint32_t        pageSize;					/**< Program page size in bytes */
+	uint32_t        blkSize;					/**< Size of the block erased with 0xD8 */
+	uint32_t        subBlkSize;					/**< Size of the sub-block erased with 0x20, 0 if not supported */
+	uint16_t        subBlkEraseTime;			/**< (in mS) typical sub-block erase time, 0 if not known */
+	uint16_t        blkEraseTime;				/**< (in mS) typical block erase time, 0 if not known */
+	uint32_t        chipEraseTime;				/**< (in mS) typical full device erase time, 0 if not known */
+	SPIFI_SFDP_READ_T dualRead;					/**< Fastest dual read command */
+	SPIFI_SFDP_READ_T quadRead;					/**< Fastest quad read command */
+} SPIFI_SFDP_INFO_T;
+
+/**
+ * @brief Function reading bytes of the SFDP address space
+ * @param	pCtx	: Context passed to spifiSFDPParse()
+ * @param	addr	: SFDP address to read from
+ * @param	pBuf	: Buffer to read into
+ * @param	bytes	: Number of bytes to read
+ */
+typedef void (*SPIFI_SFDP_READFX_T)(void *pCtx, uint32_t addr, uint8_t *pBuf, uint32_t bytes);
+
+/**
+ * @brief	Parse the SFDP tables of a device
+ * @param	readFx	: Function reading the SFDP address space
+ * @param	pCtx	: Context passed to readFx
+ * @param	pInfo	: Where to store the device description
+ * @return	SPIFI_ERR_NONE if the device can be driven with the common command
+ * set, SPIFI_ERR_NOTSUPPORTED otherwise
+ * @note	Devices without a valid SFDP header or basic parameter table,
+ * larger than 16MB or without a 0xD8 block erase are not supported. Of the
+ * dual and quad reads, the one with the fewest clocks before the data that
+ * the SPIFI controller can issue is selected.
+ */
+SPIFI_ERR_T spifiSFDPParse(SPIFI_SFDP_READFX_T readFx, void *pCtx, SPIFI_SFDP_INFO_T *pInfo);
+
+/**
+ * @brief	Family registration function for SFDP described devices
+ * @return	A pointer to a persistent SPIFI_FAM_NODE_T initialized for the family.
+ * @note	Any device with SFDP tables the parser accepts is detected and
+ * driven with the common command set, using the geometry, erase times and
+ * read commands from its tables. The family should be registered before the
+ * families with device tables, so that it is only used for devices they don't
+ * know (the last registered family is checked first). Only one SFDP device
+ * can be in use at a time. This function MUST NOT be called directly and
+ * should only be passed to the registration function spifiRegisterFamily()
+ */
+SPIFI_FAM_NODE_T *spifi_REG_FAMILY_SFDP(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPIFILIB_SFDP_H_ */
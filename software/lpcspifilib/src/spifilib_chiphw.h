@@ -291,6 +291,17 @@ static INLINE void spifi_HW_SetMEMCMD(LPC_SPIFI_CHIPHW_T *pSpifi, uint32_t cmd)
 	pSpifi->MEMCMD = cmd;
 }
 
+/**
+ * @brief	Write cache limit register
+ * @param	pSpifi	: Base address of SPIFI controller
+ * @param	limit	: Offset in the device above which memory mode reads are not cached
+ * @return	Nothing
+ */
+static INLINE void spifi_HW_SetCacheLimit(LPC_SPIFI_CHIPHW_T *pSpifi, uint32_t limit)
+{
+	pSpifi->CACHELIMIT = limit;
+}
+
 /**
  * @}
  */
@@ -43,6 +43,9 @@
 #define LIBRARY_VERSION_MAJOR (1)
 #define LIBRARY_VERSION_MINOR (01)
 
+/* Size of the stack copy of an unaligned program buffer, a common page size */
+#define SPIFI_PROG_BOUNCE_SIZE (256)
+
 /* device node count and linked list header */
 static uint32_t famCount = 0;
 static SPIFI_FAM_NODE_T famListHead = {0};
@@ -246,6 +249,23 @@ static void spifiPrvInitContext(SPIFI_DEV_ENUMERATOR_T *pContext, SPIFI_FAM_NODE
 	}
 }
 
+/* Take the device out of continuous read with mode bits of FFh. The address
+   is all ones so a device not in continuous read sees an FFh opcode. */
+static void spifiPrvExitContRead(const SPIFI_HANDLE_T *pHandle)
+{
+	uint32_t cmdValue;
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pHandle->pInfoData->spifiCtrlAddr;
+
+	spifi_HW_SetIDATA(pSpifiCtrlAddr, 0xFF);
+
+	pHandle->pFamFx->devGetReadCmd(pHandle, 1, &cmdValue, NULL);
+	if ((cmdValue & SPIFI_CMD_FRAMEFORM(7)) == SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_NOOP_3ADDRESS)) {
+		spifi_HW_SetAddr(pSpifiCtrlAddr, 0xFFFFFF);
+		spifi_HW_SetCmd(pSpifiCtrlAddr, cmdValue);
+		spifi_HW_WaitCMD(pSpifiCtrlAddr);
+	}
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -493,6 +513,10 @@ SPIFI_ERR_T spifiDevSetMemMode(const SPIFI_HANDLE_T *pHandle, uint8_t enMMode)
 	}
 	spifi_HW_SetCtrl(pSpifiCtrlAddr, ctrlReg);
 
+	/* The controller reset does not end a continuous read in the device, it
+	   would take the next opcode as address bits */
+	spifiPrvExitContRead(pHandle);
+
 	if (enMMode) {
 		/* Get the device specific memory mode command and iData values */
 		pHandle->pFamFx->devGetReadCmd(pHandle, enMMode, &cmdValue, &iDataValue);
@@ -500,13 +524,19 @@ SPIFI_ERR_T spifiDevSetMemMode(const SPIFI_HANDLE_T *pHandle, uint8_t enMMode)
 		/* Specify the intermediate data byte. */
 		spifi_HW_SetIDATA(pSpifiCtrlAddr, iDataValue);
 
-		/* Set the appropriate values in the command reg. */
-		spifi_HW_SetCmd(pSpifiCtrlAddr, cmdValue);
+		/* Set the appropriate values in the command reg. A continuous read
+		   (no opcode) memory command is entered by sending the opcode once. */
+		if ((cmdValue & SPIFI_CMD_FRAMEFORM(7)) == SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_NOOP_3ADDRESS)) {
+			spifi_HW_SetCmd(pSpifiCtrlAddr, (cmdValue & ~SPIFI_CMD_FRAMEFORM(7)) |
+							SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OP_3ADDRESS));
+		}
+		else {
+			spifi_HW_SetCmd(pSpifiCtrlAddr, cmdValue);
+		}
 		spifi_HW_WaitCMD(pSpifiCtrlAddr);
 		spifi_HW_SetMEMCMD(pSpifiCtrlAddr, cmdValue);
 	}
 	else {
-		spifi_HW_SetIDATA(pSpifiCtrlAddr, 0xFF);
 		spifi_HW_SetMEMCMD(pSpifiCtrlAddr, 0);
 
 		/* RESET the memMode controller */
@@ -781,22 +811,93 @@ uint32_t spifiGetSubBlockFromBlock(const SPIFI_HANDLE_T *pHandle, uint32_t block
 	return subBlock;
 }
 
+/* Start a read or page program whose data is moved by a DMA engine */
+SPIFI_ERR_T spifiDevDMAStart(const SPIFI_HANDLE_T *pHandle, uint32_t addr, uint32_t bytes, uint8_t write)
+{
+	if (!pHandle->pFamFx->dmaStart) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+
+	return pHandle->pFamFx->dmaStart(pHandle, addr, bytes, write);
+}
+
+/* Complete a transfer started with spifiDevDMAStart() */
+SPIFI_ERR_T spifiDevDMAEnd(const SPIFI_HANDLE_T *pHandle)
+{
+	if (!pHandle->pFamFx->dmaEnd) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+
+	return pHandle->pFamFx->dmaEnd(pHandle);
+}
+
+/* Abort a transfer started with spifiDevDMAStart() */
+SPIFI_ERR_T spifiDevDMAAbort(const SPIFI_HANDLE_T *pHandle)
+{
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pHandle->pInfoData->spifiCtrlAddr;
+
+	spifi_HW_SetCtrl(pSpifiCtrlAddr, spifi_HW_GetCtrl(pSpifiCtrlAddr) & ~SPIFI_CTRL_DMAEN(1));
+
+	/* The reset ends the command waiting for data */
+	spifi_HW_ResetController(pSpifiCtrlAddr);
+	spifi_HW_WaitRESET(pSpifiCtrlAddr);
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Start polling of the device busy status by the controller */
+SPIFI_ERR_T spifiDevPollBusyStart(const SPIFI_HANDLE_T *pHandle)
+{
+	if (!pHandle->pFamFx->pollBusyStart) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+
+	return pHandle->pFamFx->pollBusyStart(pHandle);
+}
+
+/* Check for the end of the busy status polling */
+SPIFI_ERR_T spifiDevPollBusyEnd(const SPIFI_HANDLE_T *pHandle)
+{
+	if (!pHandle->pFamFx->pollBusyEnd) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+
+	return pHandle->pFamFx->pollBusyEnd(pHandle);
+}
+
 /* Program the device with the passed buffer */
 SPIFI_ERR_T spifiProgram(const SPIFI_HANDLE_T *pHandle, uint32_t addr, const uint32_t *writeBuff, uint32_t bytes)
 {
 	uint32_t sendBytes;
+	uint32_t pageSize = pHandle->pInfoData->pageSize;
+	const uint8_t *writeBuff8 = (const uint8_t *) writeBuff;
+	uint32_t bounce[SPIFI_PROG_BOUNCE_SIZE / sizeof(uint32_t)];
+	uint32_t idx;
 	SPIFI_ERR_T err = SPIFI_ERR_NONE;
 
-	/* Program using up to page size */
+	/* Program up to the end of each page, the device wraps around within a page */
 	while ((bytes > 0) && (err == SPIFI_ERR_NONE)) {
-		sendBytes = bytes;
-		if (sendBytes > pHandle->pInfoData->pageSize) {
-			sendBytes = pHandle->pInfoData->pageSize;
+		sendBytes = pageSize - (addr & (pageSize - 1));
+		if (sendBytes > bytes) {
+			sendBytes = bytes;
 		}
 
-		err = pHandle->pFamFx->pageProgram(pHandle, addr, writeBuff, sendBytes);
+		/* Whole words are read from the buffer as words, which faults on the
+		   M0 core when a page split left the buffer unaligned */
+		if ((((uint32_t) writeBuff8 & 0x3) != 0) && ((sendBytes & 0x3) == 0)) {
+			if (sendBytes > sizeof(bounce)) {
+				sendBytes = sizeof(bounce);
+			}
+			for (idx = 0; idx < sendBytes; ++idx) {
+				((uint8_t *) bounce)[idx] = writeBuff8[idx];
+			}
+			err = pHandle->pFamFx->pageProgram(pHandle, addr, bounce, sendBytes);
+		}
+		else {
+			err = pHandle->pFamFx->pageProgram(pHandle, addr, (const uint32_t *) writeBuff8, sendBytes);
+		}
 		addr += sendBytes;
-		writeBuff += (sendBytes >> 2);
+		writeBuff8 += sendBytes;
 		bytes -= sendBytes;
 	}
 
@@ -848,16 +949,192 @@ SPIFI_ERR_T spifiErase(const SPIFI_HANDLE_T *pHandle, uint32_t firstBlock, uint3
 /* Erase multiple blocks by address range */
 SPIFI_ERR_T spifiEraseByAddr(const SPIFI_HANDLE_T *pHandle, uint32_t firstAddr, uint32_t lastAddr)
 {
-	uint32_t firstBlock, lastBlock;
-	SPIFI_ERR_T err = SPIFI_ERR_RANGE;
+	SPIFI_ERASE_PLAN_T plan;
+	SPIFI_ERR_T err;
+
+	/* Limit to legal address range */
+	err = spifiErasePlan(pHandle, firstAddr, lastAddr, SPIFI_ERASE_WHOLE_BLOCKS, &plan);
+	if (err == SPIFI_ERR_NONE) {
+		err = spifiErasePlanRun(pHandle, &plan, NULL);
+	}
+
+	return err;
+}
+
+/* Plan the fastest erase of an address range */
+SPIFI_ERR_T spifiErasePlan(const SPIFI_HANDLE_T *pHandle, uint32_t firstAddr, uint32_t lastAddr,
+						   uint32_t flags, SPIFI_ERASE_PLAN_T *pPlan)
+{
+	const SPIFI_DEVICE_DATA_T *pDevData = pHandle->pInfoData->pDeviceData;
+	uint32_t blockSize = pHandle->pInfoData->blockSize;
+	uint32_t firstBlock, lastBlock, block;
+	uint32_t subBlockSize, subPerBlock, fullSub;
+	uint32_t subTime, blkTime, chipTime, fullTime, eraseTime;
+	uint32_t blockAddr, lo, hi, firstSub, numSub;
+	uint32_t eraseFirst = 0, eraseLast = 0;
+	uint8_t whole;
+	SPIFI_ERASE_SEG_T *pSeg;
 
 	/* Get block numbers for addresses */
 	firstBlock = spifiGetBlockFromAddr(pHandle, firstAddr);
 	lastBlock = spifiGetBlockFromAddr(pHandle, lastAddr);
+	if ((firstBlock == ~0UL) || (lastBlock == ~0UL) || (lastAddr < firstAddr)) {
+		return SPIFI_ERR_RANGE;
+	}
 
-	/* Limit to legal address range */
-	if ((firstBlock != ~0UL) && (lastBlock != ~0UL)) {
-		err = spifiErase(pHandle, firstBlock, ((lastBlock - firstBlock) + 1));
+	spifiPrvMemset(pPlan, 0, sizeof(SPIFI_ERASE_PLAN_T));
+
+	/* Sub-blocks are only used when they evenly split the blocks */
+	subBlockSize = 0;
+	subPerBlock = 0;
+	if (((pDevData->caps & SPIFI_CAP_SUBBLKERASE) != 0) && (!pHandle->pFamFx->subBlockCmd) &&
+		(pHandle->pInfoData->subBlockSize != 0)) {
+		subBlockSize = pHandle->pInfoData->subBlockSize;
+		subPerBlock = blockSize / subBlockSize;
+	}
+
+	/* Erase times of the device, a device erase is never preferred if its time is not known */
+	subTime = (pDevData->subBlkEraseTime) ? pDevData->subBlkEraseTime : SPIFI_ERASE_DEF_SUBBLK_TIME;
+	blkTime = (pDevData->blkEraseTime) ? pDevData->blkEraseTime : SPIFI_ERASE_DEF_BLK_TIME;
+	chipTime = (pDevData->chipEraseTime) ? pDevData->chipEraseTime : (pHandle->pInfoData->numBlocks * blkTime);
+
+	/* Fastest way to erase a whole block */
+	fullSub = (subPerBlock != 0) && ((subPerBlock * subTime) < blkTime);
+	fullTime = (fullSub) ? (subPerBlock * subTime) : blkTime;
+
+	eraseTime = 0;
+	for (block = firstBlock; block <= lastBlock; ++block) {
+		/* Part of the range in this block */
+		blockAddr = spifiGetAddrFromBlock(pHandle, block);
+		lo = (firstAddr > blockAddr) ? firstAddr : blockAddr;
+		hi = (lastAddr < (blockAddr + blockSize - 1)) ? lastAddr : (blockAddr + blockSize - 1);
+
+		whole = ((flags & SPIFI_ERASE_WHOLE_BLOCKS) != 0) || (subBlockSize == 0) ||
+				((lo == blockAddr) && (hi == (blockAddr + blockSize - 1)));
+		firstSub = 0;
+		numSub = 0;
+		if (!whole) {
+			firstSub = spifiGetSubBlockFromAddr(pHandle, lo);
+			numSub = (spifiGetSubBlockFromAddr(pHandle, hi) - firstSub) + 1;
+			if (((flags & (SPIFI_ERASE_OVERERASE | SPIFI_ERASE_PRESERVE)) == SPIFI_ERASE_OVERERASE) &&
+				(blkTime < (numSub * subTime))) {
+				whole = 1;
+			}
+		}
+
+		if (whole) {
+			/* Whole blocks form the middle segment */
+			pSeg = &pPlan->seg[1];
+			if (pSeg->count == 0) {
+				pSeg->subBlocks = fullSub;
+				pSeg->first = (fullSub) ? (block * subPerBlock) : block;
+			}
+			pSeg->count += (fullSub) ? subPerBlock : 1;
+			eraseTime += fullTime;
+			lo = blockAddr;
+			hi = blockAddr + blockSize - 1;
+		}
+		else {
+			/* Only the first and last blocks can be partially erased */
+			pSeg = &pPlan->seg[(block == firstBlock) ? 0 : 2];
+			pSeg->subBlocks = 1;
+			pSeg->first = firstSub;
+			pSeg->count = numSub;
+			eraseTime += numSub * subTime;
+			lo = spifiGetAddrFromSubBlock(pHandle, firstSub);
+			hi = lo + (numSub * subBlockSize) - 1;
+		}
+
+		if (block == firstBlock) {
+			eraseFirst = lo;
+		}
+		eraseLast = hi;
+	}
+
+	/* Use a device erase when the whole device is erased and it is faster */
+	if ((eraseFirst == pHandle->pInfoData->baseAddr) &&
+		(eraseLast == (pHandle->pInfoData->baseAddr + (pHandle->pInfoData->numBlocks * blockSize) - 1)) &&
+		(chipTime < eraseTime)) {
+		spifiPrvMemset(pPlan->seg, 0, sizeof(pPlan->seg));
+		pPlan->eraseAll = 1;
+		eraseTime = chipTime;
+	}
+
+	pPlan->firstAddr = eraseFirst;
+	pPlan->lastAddr = eraseLast;
+	pPlan->eraseTime = eraseTime;
+	if (flags & SPIFI_ERASE_PRESERVE) {
+		pPlan->headBytes = firstAddr - eraseFirst;
+		pPlan->tailBytes = eraseLast - lastAddr;
+		pPlan->bufBytes = ((pPlan->headBytes + 3) & ~3UL) + pPlan->tailBytes;
+	}
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Run an erase plan */
+SPIFI_ERR_T spifiErasePlanRun(const SPIFI_HANDLE_T *pHandle, const SPIFI_ERASE_PLAN_T *pPlan, uint32_t *pBuf)
+{
+	uint32_t idx, seg;
+	uint32_t *pTail = NULL;
+	uint32_t tailAddr = (pPlan->lastAddr - pPlan->tailBytes) + 1;
+	const SPIFI_ERASE_SEG_T *pSeg;
+	SPIFI_ERR_T err = SPIFI_ERR_NONE;
+
+	if (pPlan->bufBytes) {
+		if (!pBuf) {
+			return SPIFI_ERR_GEN;
+		}
+		pTail = pBuf + ((pPlan->headBytes + 3) >> 2);
+	}
+
+	/* Save the bytes outside the range */
+	if (pPlan->headBytes) {
+		err = spifiRead(pHandle, pPlan->firstAddr, pBuf, pPlan->headBytes);
+	}
+	if ((pPlan->tailBytes) && (err == SPIFI_ERR_NONE)) {
+		err = spifiRead(pHandle, tailAddr, pTail, pPlan->tailBytes);
+	}
+	if (err != SPIFI_ERR_NONE) {
+		return err;
+	}
+
+	if (pPlan->eraseAll) {
+		err = pHandle->pFamFx->eraseAll(pHandle);
+	}
+	for (seg = 0; (seg < 3) && (err == SPIFI_ERR_NONE); ++seg) {
+		pSeg = &pPlan->seg[seg];
+		for (idx = 0; (idx < pSeg->count) && (err == SPIFI_ERR_NONE); ++idx) {
+			if (pSeg->subBlocks) {
+				err = pHandle->pFamFx->eraseSubBlock(pHandle, pSeg->first + idx);
+			}
+			else {
+				err = pHandle->pFamFx->eraseBlock(pHandle, pSeg->first + idx);
+			}
+		}
+	}
+
+	/* Restore the saved bytes */
+	if ((pPlan->headBytes) && (err == SPIFI_ERR_NONE)) {
+		err = spifiProgram(pHandle, pPlan->firstAddr, pBuf, pPlan->headBytes);
+	}
+	if ((pPlan->tailBytes) && (err == SPIFI_ERR_NONE)) {
+		err = spifiProgram(pHandle, tailAddr, pTail, pPlan->tailBytes);
+	}
+
+	return err;
+}
+
+/* Erase an address range with the fastest mix of erase sizes */
+SPIFI_ERR_T spifiEraseRange(const SPIFI_HANDLE_T *pHandle, uint32_t firstAddr, uint32_t lastAddr,
+							uint32_t flags, uint32_t *pBuf)
+{
+	SPIFI_ERASE_PLAN_T plan;
+	SPIFI_ERR_T err;
+
+	err = spifiErasePlan(pHandle, firstAddr, lastAddr, flags, &plan);
+	if (err == SPIFI_ERR_NONE) {
+		err = spifiErasePlanRun(pHandle, &plan, pBuf);
 	}
 
 	return err;
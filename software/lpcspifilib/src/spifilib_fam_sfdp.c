@@ -0,0 +1,345 @@
+/*
+ * @brief SFDP (JESD216) described device Family driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2015
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+#include <string.h>
+
+#include "spifilib_dev.h"
+#include "spifilib_sfdp.h"
+#include "spifilib_chiphw.h"
+
+/* need access to the device register Fx without importing the whole API */
+extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T *pDevData);
+
+/* Common command set device setup, in spifilib_fam_standard_cmd.c */
+extern SPIFI_ERR_T spifiFamFxCommonCmdSetup(SPIFI_HANDLE_T *pHandle, uint32_t spifiCtrlAddr, uint32_t baseAddr);
+
+/** @defgroup LPCSPIFILIB_CONFIG_SFDP LPCSPIFILIB SFDP described device driver
+ * @ingroup LPCSPIFILIB_DRIVERS
+ * This driver detects any device whose SFDP tables are accepted by
+ * spifiSFDPParse() and drives it with the common command set.<br>
+ *
+ * Driver Feature Specifics:<br>
+ * - geometry, page size and erase times read from the device<br>
+ * - fastest dual and quad read the SPIFI controller can issue<br>
+ * - continuous (0-4-4) quad reads in memory mode when supported<br>
+ * - quad enable bit from the quad enable requirements (JESD216B)<br>
+ *
+ * The common command set driver must have SPIFI_DEVICE_ALL or
+ * SPIFI_DEVICE_SFDP set.
+ * @{
+ */
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Clock rates used for all SFDP devices, as the tables don't describe them */
+#define SFDP_MAX_CLOCK              50
+
+#define MAX_SINGLE_READ             16128
+
+/* Command definitions. Only used commands are defined. */
+#define CMD_0B_FAST_READ            0x0B		/**< Read Data bytes at Fast Speed */
+#define CMD_9F_RDID                 0x9F		/**< Read Identification */
+#define CMD_FF_MODE_RESET           0xFF		/**< Continuous read mode reset */
+
+/* Mode bits entering and leaving continuous reads */
+#define SFDP_MODE_CONTINUOUS        0xA5
+#define SFDP_MODE_EXIT              0xFF
+
+/* Description of the detected device */
+static SPIFI_SFDP_INFO_T sfdpInfo;
+
+/* Device data built from the description, 0 JEDEC ID until a device is parsed */
+static SPIFI_DEVICE_DATA_T sfdpDevData;
+
+/* Single (serial) fast read, used when dual and quad reads are not enabled */
+static const SPIFI_SFDP_READ_T sfdpFastRead = {CMD_0B_FAST_READ, 1, 1, 0, 8};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Read the SFDP address space in command mode */
+static void spifiSFDPPrvRead(void *pCtx, uint32_t addr, uint8_t *pBuf, uint32_t bytes)
+{
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pCtx;
+
+	spifi_HW_SetIDATA(pSpifiCtrlAddr, 0xFF);
+	spifi_HW_SetAddr(pSpifiCtrlAddr, addr);
+	spifi_HW_SetCmd(pSpifiCtrlAddr,
+					(SPIFI_CMD_OPCODE(SPIFI_SFDP_OPCODE) |
+					 SPIFI_CMD_DATALEN(bytes) |
+					 SPIFI_CMD_INTER(1) |
+					 SPIFI_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+					 SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OP_3ADDRESS)));
+
+	while (bytes) {
+		*pBuf = spifi_HW_GetData8(pSpifiCtrlAddr);
+		++pBuf;
+		--bytes;
+	}
+
+	spifi_HW_WaitCMD(pSpifiCtrlAddr);
+}
+
+/* Fill the device data from the SFDP description */
+static void spifiSFDPPrvSetDevData(void)
+{
+	sfdpDevData.caps = SPIFI_CAP_FULLLOCK | SPIFI_CAP_NOBLOCK;
+	if (sfdpInfo.dualRead.opcode) {
+		sfdpDevData.caps |= SPIFI_CAP_DUAL_READ;
+	}
+
+	/* Status register functions from the quad enable requirements. Quad reads
+	   are only used when the quad enable bit is known. */
+	sfdpDevData.setOptionsFxId = FX_spifiDeviceDataSetOptsNone;
+	sfdpDevData.getStatusFxId = FX_spifiDeviceDataGetStatusMX25L3235E;
+	sfdpDevData.setStatusFxId = FX_spifiDeviceDataSetStatusMX25L3235E;
+	switch (sfdpInfo.qer) {
+	case SPIFI_SFDP_QER_SR2BIT1:
+	case SPIFI_SFDP_QER_SR2BIT1_NOCLR:
+	case SPIFI_SFDP_QER_SR2BIT1_RD35:
+	case SPIFI_SFDP_QER_SR2BIT1_WR31:
+		sfdpDevData.setOptionsFxId = FX_spifiDeviceDataSetOptsQuadModeBit9;
+		sfdpDevData.getStatusFxId = FX_spifiDeviceDataGetStatusW25Q80BV;
+		sfdpDevData.setStatusFxId = FX_spifiDeviceDataSetStatusS25FL032P;
+		break;
+
+	case SPIFI_SFDP_QER_SR1BIT6:
+		sfdpDevData.setOptionsFxId = FX_spifiDeviceDataSetOptsQuadModeBit6;
+		break;
+
+	case SPIFI_SFDP_QER_NONE:
+		break;
+
+	default:
+		sfdpInfo.quadRead.opcode = 0;
+		sfdpInfo.contRead = 0;
+		break;
+	}
+	if (sfdpInfo.quadRead.opcode) {
+		sfdpDevData.caps |= SPIFI_CAP_QUAD_READ;
+	}
+
+	sfdpDevData.blks = sfdpInfo.devSize / sfdpInfo.blkSize;
+	sfdpDevData.blkSize = sfdpInfo.blkSize;
+	sfdpDevData.subBlks = 0;
+	sfdpDevData.subBlkSize = 0;
+	if (sfdpInfo.subBlkSize) {
+		sfdpDevData.caps |= SPIFI_CAP_SUBBLKERASE;
+		sfdpDevData.subBlks = sfdpInfo.devSize / sfdpInfo.subBlkSize;
+		sfdpDevData.subBlkSize = sfdpInfo.subBlkSize;
+	}
+	sfdpDevData.pageSize = sfdpInfo.pageSize;
+	sfdpDevData.subBlkEraseTime = sfdpInfo.subBlkEraseTime;
+	sfdpDevData.blkEraseTime = sfdpInfo.blkEraseTime;
+	sfdpDevData.chipEraseTime = sfdpInfo.chipEraseTime;
+}
+
+/* Read the JEDEC ID and describe the device from its SFDP tables */
+static void spifiSFDPPrvDevGetID(uint32_t spifiAddr, SPIFI_DEVICE_ID_T *pID)
+{
+	uint8_t idx;
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) spifiAddr;
+
+	/* Leave a continuous read. A device that isn't in one only sees a serial
+	   mode reset opcode. */
+	spifi_HW_SetIDATA(pSpifiCtrlAddr, SFDP_MODE_EXIT);
+	spifi_HW_SetAddr(pSpifiCtrlAddr, 0xFFFFFF);
+	spifi_HW_SetCmd(pSpifiCtrlAddr,
+					(SPIFI_CMD_OPCODE(CMD_FF_MODE_RESET) |
+					 SPIFI_CMD_INTER(1) |
+					 SPIFI_CMD_FIELDFORM(SPIFI_FIELDFORM_NO_SERIAL) |
+					 SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OP_3ADDRESS)));
+	spifi_HW_WaitCMD(pSpifiCtrlAddr);
+
+	/* Read ID command, plus read 3 bytes on data */
+	spifi_HW_SetCmd(pSpifiCtrlAddr,
+					(SPIFI_CMD_OPCODE(CMD_9F_RDID) |
+					 SPIFI_CMD_DATALEN(3 + pID->extCount) |
+					 SPIFI_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+					 SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OP)));
+
+	pID->mfgId[0] = spifi_HW_GetData8(pSpifiCtrlAddr);	/* Manufacturers ID */
+	pID->mfgId[1] = spifi_HW_GetData8(pSpifiCtrlAddr);	/* Memory Type */
+	pID->mfgId[2] = spifi_HW_GetData8(pSpifiCtrlAddr);	/* Memmory Capacity */
+	for (idx = 0; idx < pID->extCount; ++idx) {
+		pID->extId[idx] = spifi_HW_GetData8(pSpifiCtrlAddr);
+	}
+
+	spifi_HW_WaitCMD(pSpifiCtrlAddr);
+
+	/* Only parse the tables once per device */
+	if (memcmp(pID->mfgId, sfdpDevData.id.mfgId, sizeof(pID->mfgId)) == 0) {
+		return;
+	}
+
+	/* The device node only matches the ID of a device the parser accepts */
+	if (spifiSFDPParse(spifiSFDPPrvRead, pSpifiCtrlAddr, &sfdpInfo) == SPIFI_ERR_NONE) {
+		spifiSFDPPrvSetDevData();
+		memcpy(sfdpDevData.id.mfgId, pID->mfgId, sizeof(pID->mfgId));
+	}
+	else {
+		sfdpDevData.id.mfgId[0] = ~pID->mfgId[0];
+	}
+}
+
+/* Function to return spifi controller read cmd */
+static void spifiSFDPDeviceReadCommand(const SPIFI_HANDLE_T *pHandle, uint8_t enable,
+									   uint32_t *cmd, uint32_t *iData)
+{
+	const SPIFI_SFDP_READ_T *pRead = &sfdpFastRead;
+	uint32_t fieldForm = SPIFI_FIELDFORM_ALL_SERIAL;
+	uint32_t frameForm = SPIFI_FRAMEFORM_OP_3ADDRESS;
+
+	if (iData) {
+		*iData = 0xFF;
+	}
+
+	if (pHandle->pInfoData->opts & SPIFI_CAP_QUAD_READ) {
+		pRead = &sfdpInfo.quadRead;
+
+		/* Memory mode reads skip the opcode after the first read */
+		if ((enable) && (sfdpInfo.contRead)) {
+			frameForm = SPIFI_FRAMEFORM_NOOP_3ADDRESS;
+			if (iData) {
+				*iData = SFDP_MODE_CONTINUOUS;
+			}
+		}
+	}
+	else if (pHandle->pInfoData->opts & SPIFI_CAP_DUAL_READ) {
+		pRead = &sfdpInfo.dualRead;
+	}
+
+	if (pRead->addrLines > 1) {
+		fieldForm = SPIFI_FIELDFORM_SERIAL_OPCODE;
+	}
+	else if (pRead->dataLines > 1) {
+		fieldForm = SPIFI_FIELDFORM_SERIAL_OPCODE_ADDRESS;
+	}
+
+	/* Mode and dummy clocks are sent as intermediate bytes on the address lines */
+	*cmd = (SPIFI_CMD_OPCODE(pRead->opcode) |
+			SPIFI_CMD_DOUT(0) |
+			SPIFI_CMD_INTER(((pRead->modeClocks + pRead->dummyClocks) * pRead->addrLines) >> 3) |
+			SPIFI_CMD_FIELDFORM(fieldForm) |
+			SPIFI_CMD_FRAMEFORM(frameForm));
+}
+
+/*****************************************************************************
+ * Semi-Private family functions
+ * Functions may be assigned to SPIFI_FAM_FX_T function pointers.
+ ****************************************************************************/
+
+/* Setup a device */
+static SPIFI_ERR_T spifiSFDPFamFxDeviceSetup(SPIFI_HANDLE_T *pHandle, uint32_t spifiCtrlAddr, uint32_t baseAddr)
+{
+	/* SFDP family function table, the common command set one with its own reads */
+	static SPIFI_FAM_FX_T fxTable;
+	SPIFI_ERR_T err;
+
+	err = spifiFamFxCommonCmdSetup(pHandle, spifiCtrlAddr, baseAddr);
+	if (err == SPIFI_ERR_NONE) {
+		fxTable = *pHandle->pFamFx;
+		fxTable.devGetReadCmd = spifiSFDPDeviceReadCommand;
+
+		/* save pointer to family function table */
+		pHandle->pFamFx = &fxTable;
+	}
+
+	return err;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+SPIFI_FAM_NODE_T *spifi_REG_FAMILY_SFDP(void)
+{
+	/* Variables declared static so they will persist after function returns. */
+	/* All members are assigned at run-time so that position independent code
+	   will know the address */
+	static SPIFI_DEV_NODE_T devListBase = {0};	/* List base to hold devices */
+	static SPIFI_FAM_NODE_T devFamily;			/* Family node to hold family descriptor */
+	static SPIFI_FAM_DESC_T famDesc;			/* Family descriptor (holds all info about family) */
+	static SPIFI_DEV_NODE_T data;				/* Node of the SFDP device */
+	static uint32_t devCount = 0;				/* Variable to keep track of # registered devices */
+
+	/* Protect against multiple calls to register the same family */
+	if (devCount) {
+		return NULL;
+	}
+
+	/* Make sure that the base list is empty and the count reflects 0 */
+	devListBase.pNext = NULL;
+	devCount = 0;
+
+	/* Store the device specific info so it can be returned */
+	famDesc.pFamName = "SFDP (JESD216) devices";
+
+	/* Save the pointer to the device list and count */
+	famDesc.pDevList = &devListBase;
+	famDesc.pDevCount = &devCount;
+
+	famDesc.prvContextSize = 0;					/* Reserve space for private data (this family doesn't need any)*/
+	famDesc.pPrvDevGetID = spifiSFDPPrvDevGetID;	/* Read ID and SFDP tables */
+	famDesc.pPrvDevSetup = spifiSFDPFamFxDeviceSetup;	/* Provide Fx to handle setup */
+
+	/* Save the descriptor in the handle */
+	devFamily.pDesc = &famDesc;
+
+	/* The single device is described at detection, until then it matches no ID */
+	memset(&sfdpDevData, 0, sizeof(sfdpDevData));
+	sfdpDevData.pDevName = "SFDP device";
+	sfdpDevData.maxReadSize = MAX_SINGLE_READ;
+	sfdpDevData.maxClkRate = SFDP_MAX_CLOCK;
+	sfdpDevData.maxReadRate = SFDP_MAX_CLOCK;
+	sfdpDevData.maxHSReadRate = SFDP_MAX_CLOCK;
+	sfdpDevData.maxProgramRate = SFDP_MAX_CLOCK;
+	sfdpDevData.maxHSProgramRate = SFDP_MAX_CLOCK;
+	sfdpDevData.initDeInitFxId = FX_spifiDeviceDataInitDeinit;
+	sfdpDevData.clearStatusFxId = FX_spifiDeviceDataClearStatusNone;
+	sfdpDevData.getReadCmdFxId = FX_spifiDeviceInitReadCommand;
+	sfdpDevData.getWriteCmdFxId = FX_spifiDeviceInitWriteCommand;
+
+	data.pDevData = &sfdpDevData;			/* save the data in the node */
+	spifiDevRegister(&devFamily, &data);	/* Register the new device */
+
+	/* finally return the family device structure */
+	return &devFamily;
+}
+
+/**
+ * @}
+ */
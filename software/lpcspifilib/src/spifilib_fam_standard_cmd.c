@@ -54,6 +54,8 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
  * W25Q32FV<br>
  * W25Q64FV<br>
  * W25Q80BV<br>
+ * Devices described by their SFDP tables are handled with this command set
+ * by the SFDP family (spifilib_fam_sfdp.c).<br>
  *
  * Driver Feature Specifics:<br>
  * - common command set<br>
@@ -94,6 +96,7 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 #define SPIFI_DEVICE_W25Q32FV           0		/**< Enables Winbond W25Q32FV device */
 #define SPIFI_DEVICE_W25Q64FV           0		/**< Enables Winbond W25Q32V device */
 #define SPIFI_DEVICE_W25Q80BV           0		/**< Enables Winbond W25Q80BV device */
+#define SPIFI_DEVICE_SFDP               0		/**< Enables SFDP described devices (spifilib_fam_sfdp.c) */
 
 /* Required private data size for this family */
 #define PRVDATASIZE 0
@@ -165,12 +168,14 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 												 SPIFI_DEVICE_MX25L1635E | \
 												 SPIFI_DEVICE_MX25L3235E | \
 												 SPIFI_DEVICE_MX25L8035E | \
-												 SPIFI_DEVICE_MX25L6435E)
+												 SPIFI_DEVICE_MX25L6435E | \
+												 SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataGetStatusW25Q80BV (SPIFI_DEVICE_ALL | \
 											   SPIFI_DEVICE_W25Q80BV | \
 											   SPIFI_DEVICE_W25Q32FV | \
-											   SPIFI_DEVICE_W25Q64FV)
+											   SPIFI_DEVICE_W25Q64FV | \
+											   SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataClearStatusNone (SPIFI_DEVICE_ALL |	\
 											 SPIFI_DEVICE_W25Q80BV | \
@@ -179,7 +184,8 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 											 SPIFI_DEVICE_MX25L1635E | \
 											 SPIFI_DEVICE_MX25L3235E | \
 											 SPIFI_DEVICE_MX25L8035E | \
-											 SPIFI_DEVICE_MX25L6435E)
+											 SPIFI_DEVICE_MX25L6435E | \
+											 SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataClearStatusS25FL032P (SPIFI_DEVICE_ALL | \
 												  SPIFI_DEVICE_S25FL016K | \
@@ -203,7 +209,8 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 												SPIFI_DEVICE_S25FL512S | \
 												SPIFI_DEVICE_W25Q80BV |	\
 												SPIFI_DEVICE_W25Q32FV |	\
-												SPIFI_DEVICE_W25Q64FV)
+												SPIFI_DEVICE_W25Q64FV | \
+												SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataSetStatusS25FL164K (SPIFI_DEVICE_ALL |	\
 												SPIFI_DEVICE_S25FL164K)
@@ -212,13 +219,15 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 												 SPIFI_DEVICE_MX25L1635E | \
 												 SPIFI_DEVICE_MX25L3235E | \
 												 SPIFI_DEVICE_MX25L8035E | \
-												 SPIFI_DEVICE_MX25L6435E)
+												 SPIFI_DEVICE_MX25L6435E | \
+												 SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataSetOptsQuadModeBit6 (SPIFI_DEVICE_ALL |	\
 												 SPIFI_DEVICE_MX25L1635E | \
 												 SPIFI_DEVICE_MX25L3235E | \
 												 SPIFI_DEVICE_MX25L8035E | \
-												 SPIFI_DEVICE_MX25L6435E)
+												 SPIFI_DEVICE_MX25L6435E | \
+												 SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataSetOptsQuadModeBit9 (SPIFI_DEVICE_ALL |	\
 												 SPIFI_DEVICE_S25FL016K | \
@@ -232,7 +241,11 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 												 SPIFI_DEVICE_S25FL512S | \
 												 SPIFI_DEVICE_W25Q80BV | \
 												 SPIFI_DEVICE_W25Q32FV | \
-												 SPIFI_DEVICE_W25Q64FV)
+												 SPIFI_DEVICE_W25Q64FV | \
+												 SPIFI_DEVICE_SFDP)
+
+#define NEED_spifiDeviceDataSetOptsNone (SPIFI_DEVICE_ALL |	\
+										 SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataInitDeinit (SPIFI_DEVICE_ALL |	\
 										SPIFI_DEVICE_S25FL016K | \
@@ -249,7 +262,8 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 										SPIFI_DEVICE_MX25L1635E | \
 										SPIFI_DEVICE_MX25L3235E | \
 										SPIFI_DEVICE_MX25L8035E | \
-										SPIFI_DEVICE_MX25L6435E)
+										SPIFI_DEVICE_MX25L6435E | \
+										SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceDataInitDeinitS25FL164K (SPIFI_DEVICE_ALL |	\
 												 SPIFI_DEVICE_S25FL164K)
@@ -270,7 +284,8 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 										 SPIFI_DEVICE_MX25L1635E | \
 										 SPIFI_DEVICE_MX25L3235E | \
 										 SPIFI_DEVICE_MX25L8035E | \
-										 SPIFI_DEVICE_MX25L6435E)
+										 SPIFI_DEVICE_MX25L6435E | \
+										 SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceInitWriteCommand (SPIFI_DEVICE_ALL |	\
 										  SPIFI_DEVICE_S25FL016K | \
@@ -285,7 +300,8 @@ extern SPIFI_ERR_T spifiDevRegister(SPIFI_FAM_NODE_T *pFamily, SPIFI_DEV_NODE_T
 										  SPIFI_DEVICE_W25Q80BV | \
 										  SPIFI_DEVICE_W25Q32FV | \
 										  SPIFI_DEVICE_W25Q64FV | \
-										  SPIFI_DEVICE_MX25L8035E)
+										  SPIFI_DEVICE_MX25L8035E | \
+										  SPIFI_DEVICE_SFDP)
 
 #define NEED_spifiDeviceInitWriteCommandMacronix (SPIFI_DEVICE_ALL |	\
 												  SPIFI_DEVICE_MX25L1635E |	\
@@ -614,6 +630,15 @@ static SPIFI_ERR_T spifiDeviceDataSetOptsQuadModeBit9(const SPIFI_HANDLE_T *pHan
 
 #endif
 
+/* Function for devices that need no register change to use Quad mode */
+#if NEED_spifiDeviceDataSetOptsNone
+static SPIFI_ERR_T spifiDeviceDataSetOptsNone(const SPIFI_HANDLE_T *pHandle, uint32_t opts, uint32_t enMode)
+{
+	return SPIFI_ERR_NONE;
+}
+
+#endif
+
 /* Initialize SPIFI device for the following device(s) */
 #if NEED_spifiDeviceDataInitDeinit
 static SPIFI_ERR_T spifiDeviceDataInitDeinit(const SPIFI_HANDLE_T *pHandle, uint32_t init)
@@ -819,6 +844,11 @@ static devSetOptsFx spifiDeviceAssignFxSetOptions(SPIFI_HANDLE_T *pHandle)
 	else if (pHandle->pInfoData->pDeviceData->setOptionsFxId == FX_spifiDeviceDataSetOptsQuadModeBit6) {
 #if NEED_spifiDeviceDataSetOptsQuadModeBit6
 		return spifiDeviceDataSetOptsQuadModeBit6;
+#endif
+	}
+	else if (pHandle->pInfoData->pDeviceData->setOptionsFxId == FX_spifiDeviceDataSetOptsNone) {
+#if NEED_spifiDeviceDataSetOptsNone
+		return spifiDeviceDataSetOptsNone;
 #endif
 	}
 	return (devSetOptsFx) spifiDeviceFxError;
@@ -1177,6 +1207,111 @@ static SPIFI_ERR_T spifiFamFxReadDevice(const SPIFI_HANDLE_T *pHandle,
 	return status;
 }
 
+/* Start a read or page program whose data is moved by a DMA engine */
+static SPIFI_ERR_T spifiFamFxDMAStart(const SPIFI_HANDLE_T *pHandle,
+									  uint32_t addr,
+									  uint32_t bytes,
+									  uint8_t write)
+{
+	SPIFI_ERR_T status = SPIFI_ERR_ALIGNERR;
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pHandle->pInfoData->spifiCtrlAddr;
+	uint32_t cmdOnlyValue;
+
+	/* The DMA engine moves whole dwords through the data register */
+	if ((bytes != 0) && ((bytes & 0x3) == 0)) {
+		if (write) {
+			status = SPIFI_ERR_PAGESIZE;
+			if (bytes <= pHandle->pInfoData->pageSize) {
+				status = spifiPrvCheckWriteState(pHandle);
+				if (status == SPIFI_ERR_NONE) {
+					/* Get the program cmd value for this device */
+					pHandle->pFamFx->devGetWriteCmd(pHandle, &cmdOnlyValue);
+
+					/* Only clear status if the device requires it and set write enable */
+					pHandle->pFamFx->devClearStatus(pHandle);
+					spifiPrvSetWREN(pSpifiCtrlAddr);
+
+					/* Data is clocked out as the DMA engine fills the data register */
+					spifi_HW_SetAddr(pSpifiCtrlAddr, addr);
+					spifi_HW_SetCtrl(pSpifiCtrlAddr, spifi_HW_GetCtrl(pSpifiCtrlAddr) | SPIFI_CTRL_DMAEN(1));
+					spifi_HW_SetCmd(pSpifiCtrlAddr, cmdOnlyValue | SPIFI_CMD_DATALEN(bytes));
+				}
+			}
+		}
+		else {
+			status = SPIFI_ERR_RANGE;
+			if (bytes <= pHandle->pInfoData->maxReadSize) {
+				/* Get the command value to program the SPIFI controller */
+				pHandle->pFamFx->devGetReadCmd(pHandle, 0, &cmdOnlyValue, NULL);
+
+				/* Specify the intermediate data byte (turn off). */
+				spifi_HW_SetIDATA(pSpifiCtrlAddr, 0xFF);
+
+				/* Data is clocked in as the DMA engine empties the data register */
+				spifi_HW_SetAddr(pSpifiCtrlAddr, addr);
+				spifi_HW_SetCtrl(pSpifiCtrlAddr, spifi_HW_GetCtrl(pSpifiCtrlAddr) | SPIFI_CTRL_DMAEN(1));
+				spifi_HW_SetCmd(pSpifiCtrlAddr, cmdOnlyValue | SPIFI_CMD_DATALEN(bytes));
+				status = SPIFI_ERR_NONE;
+			}
+		}
+	}
+
+	return status;
+}
+
+/* Complete a DMA read or page program once the DMA engine is done */
+static SPIFI_ERR_T spifiFamFxDMAEnd(const SPIFI_HANDLE_T *pHandle)
+{
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pHandle->pInfoData->spifiCtrlAddr;
+
+	/* Program data may still be in the controller FIFO */
+	spifi_HW_WaitCMD(pSpifiCtrlAddr);
+	spifi_HW_SetCtrl(pSpifiCtrlAddr, spifi_HW_GetCtrl(pSpifiCtrlAddr) & ~SPIFI_CTRL_DMAEN(1));
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Let the controller poll the device until the program or erase completes */
+static SPIFI_ERR_T spifiFamFxPollBusyStart(const SPIFI_HANDLE_T *pHandle)
+{
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pHandle->pInfoData->spifiCtrlAddr;
+
+	/* Status register 1 is read until bit 0 (WIP) reads 0, the command
+	   then ends by itself */
+	spifi_HW_SetCmd(pSpifiCtrlAddr,
+					(SPIFI_CMD_OPCODE(CMD_05_RDSR1) |
+					 SPIFI_CMD_POLLRS(1) |
+					 SPIFI_CMD_DATALEN(0) |
+					 SPIFI_CMD_FIELDFORM(SPIFI_FIELDFORM_ALL_SERIAL) |
+					 SPIFI_CMD_FRAMEFORM(SPIFI_FRAMEFORM_OP)));
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Check whether the controller polling started by spifiFamFxPollBusyStart() ended */
+static SPIFI_ERR_T spifiFamFxPollBusyEnd(const SPIFI_HANDLE_T *pHandle)
+{
+	uint32_t stat;
+	SPIFI_ERR_T status = SPIFI_ERR_BUSY;
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = (LPC_SPIFI_CHIPHW_T *) pHandle->pInfoData->spifiCtrlAddr;
+
+	if ((spifi_HW_GetStat(pSpifiCtrlAddr) & SPIFI_STAT_CMD) == 0) {
+		/* Read status and check error bits */
+		stat = spifiFamFxGetDeviceStatus(pHandle, 0);
+		if ((stat & SPIFI_STAT_PROGERR) != 0) {
+			status = SPIFI_ERR_PROGERR;
+		}
+		else if ((stat & SPIFI_STAT_ERASEERR) != 0) {
+			status = SPIFI_ERR_ERASEERR;
+		}
+		else {
+			status = SPIFI_ERR_NONE;
+		}
+	}
+
+	return status;
+}
+
 /* Enable or disable software write protect state */
 static SPIFI_ERR_T spifiFamFxResetDevice(const SPIFI_HANDLE_T *pHandle)
 {
@@ -1198,6 +1333,10 @@ static SPIFI_ERR_T spifiFamFxDeviceSetup(SPIFI_HANDLE_T *pHandle, uint32_t spifi
 	fxTable.reset = spifiFamFxResetDevice;
 	fxTable.getStatus = spifiFamFxGetDeviceStatus;
 	fxTable.subBlockCmd = NULL;	/* Use generic handler in spifilib_dev_common.c */
+	fxTable.dmaStart = spifiFamFxDMAStart;
+	fxTable.dmaEnd = spifiFamFxDMAEnd;
+	fxTable.pollBusyStart = spifiFamFxPollBusyStart;
+	fxTable.pollBusyEnd = spifiFamFxPollBusyEnd;
 
 	/* Initialize the device specific function pointers */
 	fxTable.devInitDeInit = spifiDeviceAssignFxInitDeInit(pHandle);
@@ -1217,6 +1356,12 @@ static SPIFI_ERR_T spifiFamFxDeviceSetup(SPIFI_HANDLE_T *pHandle, uint32_t spifi
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
+/* Setup a device described by another family with the common command set */
+SPIFI_ERR_T spifiFamFxCommonCmdSetup(SPIFI_HANDLE_T *pHandle, uint32_t spifiCtrlAddr, uint32_t baseAddr)
+{
+	return spifiFamFxDeviceSetup(pHandle, spifiCtrlAddr, baseAddr);
+}
+
 SPIFI_FAM_NODE_T *spifi_REG_FAMILY_CommonCommandSet(void)
 {
 	/* Variables declared static so they will persist after function returns. */
@@ -1309,7 +1454,10 @@ SPIFI_FAM_NODE_T *spifi_REG_FAMILY_CommonCommandSet(void)
 			FX_spifiDeviceDataSetStatusS25FL032P,	/* (Fx Id) setStatus (uses S25FL032P variant) */
 			FX_spifiDeviceDataSetOptsQuadModeBit9,	/* (Fx Id) to set/clr options */
 			FX_spifiDeviceInitReadCommand,	/* (Fx Id) to get memoryMode Cmd */
-			FX_spifiDeviceInitWriteCommand		/* (Fx Id) to get program Cmd */
+			FX_spifiDeviceInitWriteCommand,	/* (Fx Id) to get program Cmd */
+			45,					/* typical sub-block erase time in mS */
+			150,				/* typical block erase time in mS */
+			20000				/* typical full device erase time in mS */
 		};
 		static SPIFI_DEV_NODE_T data;			/* Create persistent node */
 
@@ -1342,7 +1490,10 @@ SPIFI_FAM_NODE_T *spifi_REG_FAMILY_CommonCommandSet(void)
 			FX_spifiDeviceDataSetStatusS25FL032P,	/* (Fx Id) setStatus (uses S25FL032P variant) */
 			FX_spifiDeviceDataSetOptsQuadModeBit9,	/* (Fx Id) to set/clr options */
 			FX_spifiDeviceInitReadCommand,	/* (Fx Id) to get memoryMode Cmd */
-			FX_spifiDeviceInitWriteCommand		/* (Fx Id) to get program Cmd */
+			FX_spifiDeviceInitWriteCommand,	/* (Fx Id) to get program Cmd */
+			45,					/* typical sub-block erase time in mS */
+			150,				/* typical block erase time in mS */
+			10000				/* typical full device erase time in mS */
 		};
 		static SPIFI_DEV_NODE_T data;			/* Create persistent node */
 
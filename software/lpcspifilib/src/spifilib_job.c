@@ -0,0 +1,264 @@
+/*
+ * @brief LPCSPIFILIB non-blocking erase and program jobs
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#include "spifilib_job.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+#ifndef NULL
+#define NULL 0L
+#endif
+
+/* Bounce buffer for unaligned program data, on the stack */
+#define SPIFI_JOB_BOUNCE_SIZE (256)
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Start the next device operation of a job without waiting for the device */
+static SPIFI_ERR_T spifiJobPrvIssue(SPIFI_JOB_T *pJob)
+{
+	SPIFI_ERR_T err;
+	const SPIFI_HANDLE_T *pHandle = pJob->pHandle;
+	uint32_t opts = pHandle->pInfoData->opts;
+	uint32_t pageSize;
+	uint32_t bounce[SPIFI_JOB_BOUNCE_SIZE / sizeof(uint32_t)];
+	uint32_t idx;
+
+	pHandle->pInfoData->opts |= SPIFI_OPT_NOBLOCK;
+	if (pJob->type == SPIFI_JOB_ERASE) {
+		pJob->opBytes = pHandle->pInfoData->blockSize;
+		err = pHandle->pFamFx->eraseBlock(pHandle, spifiGetBlockFromAddr(pHandle, pJob->addr));
+	}
+	else {
+		/* Never cross a page boundary, the device would wrap around */
+		pageSize = pHandle->pInfoData->pageSize;
+		pJob->opBytes = pageSize - (pJob->addr & (pageSize - 1));
+		if (pJob->opBytes > pJob->remaining) {
+			pJob->opBytes = pJob->remaining;
+		}
+
+		/* Whole words are read from the buffer as words, which faults on the
+		   M0 core when a page split left the buffer unaligned. The data is
+		   sent before pageProgram() returns, so the copy can be dropped then. */
+		if ((((uint32_t) pJob->pBuf & 0x3) != 0) && ((pJob->opBytes & 0x3) == 0)) {
+			if (pJob->opBytes > sizeof(bounce)) {
+				pJob->opBytes = sizeof(bounce);
+			}
+			for (idx = 0; idx < pJob->opBytes; ++idx) {
+				((uint8_t *) bounce)[idx] = pJob->pBuf[idx];
+			}
+			err = pHandle->pFamFx->pageProgram(pHandle, pJob->addr, bounce, pJob->opBytes);
+		}
+		else {
+			err = pHandle->pFamFx->pageProgram(pHandle, pJob->addr, (const uint32_t *) pJob->pBuf, pJob->opBytes);
+		}
+	}
+	pHandle->pInfoData->opts = opts;
+
+	if (err == SPIFI_ERR_NONE) {
+		pJob->waiting = 1;
+
+		/* Fall back to reading the device status if the controller can't poll it */
+		pJob->hwPoll = (spifiDevPollBusyStart(pHandle) == SPIFI_ERR_NONE);
+	}
+
+	return err;
+}
+
+/* Check whether the device operation in progress is done */
+static SPIFI_ERR_T spifiJobPrvCheckDone(SPIFI_JOB_T *pJob)
+{
+	uint32_t stat;
+
+	if (pJob->hwPoll) {
+		return spifiDevPollBusyEnd(pJob->pHandle);
+	}
+
+	stat = spifiDevGetInfo(pJob->pHandle, SPIFI_INFO_STATUS_RETAIN);
+	if ((stat & SPIFI_STAT_BUSY) != 0) {
+		return SPIFI_ERR_BUSY;
+	}
+	else if ((stat & SPIFI_STAT_PROGERR) != 0) {
+		return SPIFI_ERR_PROGERR;
+	}
+	else if ((stat & SPIFI_STAT_ERASEERR) != 0) {
+		return SPIFI_ERR_ERASEERR;
+	}
+
+	return SPIFI_ERR_NONE;
+}
+
+/* End a job and report its result */
+static SPIFI_ERR_T spifiJobPrvFinish(SPIFI_JOB_T *pJob, SPIFI_ERR_T err)
+{
+	pJob->type = SPIFI_JOB_NONE;
+	pJob->waiting = 0;
+	pJob->lastErr = err;
+	pJob->pHandle->pInfoData->lastErr = err;
+
+	if (pJob->doneCb) {
+		pJob->doneCb(pJob->cbData, err);
+	}
+
+	return err;
+}
+
+/* Common job setup, starts the first device operation */
+static SPIFI_ERR_T spifiJobPrvStart(SPIFI_JOB_T *pJob, SPIFI_JOB_TYPE_T type)
+{
+	SPIFI_ERR_T err;
+
+	pJob->type = type;
+	pJob->waiting = 0;
+	pJob->total = pJob->remaining;
+
+	err = spifiJobPrvIssue(pJob);
+	if ((err != SPIFI_ERR_NONE) && (err != SPIFI_ERR_BUSY)) {
+		/* Not started, no callbacks */
+		pJob->type = SPIFI_JOB_NONE;
+		return err;
+	}
+
+	/* A busy device only delays the first operation to the next poll */
+	return SPIFI_ERR_NONE;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start erasing multiple blocks by address range */
+SPIFI_ERR_T spifiJobErase(SPIFI_JOB_T *pJob, const SPIFI_HANDLE_T *pHandle,
+						  uint32_t firstAddr, uint32_t lastAddr,
+						  SPIFI_JOB_PROGRESS_T progressCb, SPIFI_JOB_DONE_T doneCb, void *cbData)
+{
+	uint32_t firstBlock, lastBlock;
+
+	if (spifiJobIsBusy(pJob)) {
+		return SPIFI_ERR_BUSY;
+	}
+	if (spifiDevGetMemoryMode(pHandle)) {
+		return SPIFI_ERR_MEMMODE;
+	}
+
+	/* Get block numbers for addresses */
+	firstBlock = spifiGetBlockFromAddr(pHandle, firstAddr);
+	lastBlock = spifiGetBlockFromAddr(pHandle, lastAddr);
+	if ((firstBlock == ~0UL) || (lastBlock == ~0UL) || (lastBlock < firstBlock)) {
+		return SPIFI_ERR_RANGE;
+	}
+
+	pJob->pHandle = pHandle;
+	pJob->addr = spifiGetAddrFromBlock(pHandle, firstBlock);
+	pJob->pBuf = NULL;
+	pJob->remaining = ((lastBlock - firstBlock) + 1) * pHandle->pInfoData->blockSize;
+	pJob->progressCb = progressCb;
+	pJob->doneCb = doneCb;
+	pJob->cbData = cbData;
+
+	return spifiJobPrvStart(pJob, SPIFI_JOB_ERASE);
+}
+
+/* Start programming the device with the passed buffer */
+SPIFI_ERR_T spifiJobProgram(SPIFI_JOB_T *pJob, const SPIFI_HANDLE_T *pHandle,
+							uint32_t addr, const uint32_t *writeBuff, uint32_t bytes,
+							SPIFI_JOB_PROGRESS_T progressCb, SPIFI_JOB_DONE_T doneCb, void *cbData)
+{
+	if (spifiJobIsBusy(pJob)) {
+		return SPIFI_ERR_BUSY;
+	}
+	if (spifiDevGetMemoryMode(pHandle)) {
+		return SPIFI_ERR_MEMMODE;
+	}
+	if ((bytes == 0) || (spifiGetBlockFromAddr(pHandle, addr) == ~0UL) ||
+		(spifiGetBlockFromAddr(pHandle, addr + bytes - 1) == ~0UL)) {
+		return SPIFI_ERR_RANGE;
+	}
+
+	pJob->pHandle = pHandle;
+	pJob->addr = addr;
+	pJob->pBuf = (const uint8_t *) writeBuff;
+	pJob->remaining = bytes;
+	pJob->progressCb = progressCb;
+	pJob->doneCb = doneCb;
+	pJob->cbData = cbData;
+
+	return spifiJobPrvStart(pJob, SPIFI_JOB_PROGRAM);
+}
+
+/* Advance a job */
+SPIFI_ERR_T spifiJobPoll(SPIFI_JOB_T *pJob)
+{
+	SPIFI_ERR_T err;
+
+	if (!spifiJobIsBusy(pJob)) {
+		return pJob->lastErr;
+	}
+
+	if (pJob->waiting) {
+		err = spifiJobPrvCheckDone(pJob);
+		if (err == SPIFI_ERR_BUSY) {
+			return err;
+		}
+		pJob->waiting = 0;
+		if (err != SPIFI_ERR_NONE) {
+			return spifiJobPrvFinish(pJob, err);
+		}
+
+		pJob->addr += pJob->opBytes;
+		if (pJob->pBuf) {
+			pJob->pBuf += pJob->opBytes;
+		}
+		pJob->remaining -= pJob->opBytes;
+		if (pJob->progressCb) {
+			pJob->progressCb(pJob->cbData, pJob->total - pJob->remaining, pJob->total);
+		}
+		if (pJob->remaining == 0) {
+			return spifiJobPrvFinish(pJob, SPIFI_ERR_NONE);
+		}
+	}
+
+	/* Start the next operation right away, retry later if the device is busy */
+	err = spifiJobPrvIssue(pJob);
+	if ((err != SPIFI_ERR_NONE) && (err != SPIFI_ERR_BUSY)) {
+		return spifiJobPrvFinish(pJob, err);
+	}
+
+	return SPIFI_ERR_BUSY;
+}
@@ -0,0 +1,199 @@
+/*
+ * @brief LPCSPIFILIB memory mapped reads with command mode coherency
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#include "spifilib_mmap.h"
+#include "spifilib_chiphw.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static LPC_SPIFI_CHIPHW_T *spifiMMapPrvCtrl(const SPIFI_MMAP_T *pMap)
+{
+	return (LPC_SPIFI_CHIPHW_T *) pMap->pHandle->pInfoData->spifiCtrlAddr;
+}
+
+/* Enter memory mode, the controller reset also clears its cache */
+static void spifiMMapPrvRemap(SPIFI_MMAP_T *pMap)
+{
+	spifiDevSetMemMode(pMap->pHandle, 1);
+	pMap->remaps++;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize a memory map context and enter memory mode */
+SPIFI_ERR_T spifiMMapInit(SPIFI_MMAP_T *pMap, const SPIFI_HANDLE_T *pHandle, uint32_t prefetch)
+{
+	pMap->pHandle = pHandle;
+	pMap->cmdDepth = 0;
+
+	/* Leave the whole device cacheable */
+	spifiMMapBeginCmd(pMap);
+	spifi_HW_SetCacheLimit(spifiMMapPrvCtrl(pMap), 0xFFFFFFFF);
+	spifiMMapSetPrefetch(pMap, prefetch);
+	spifiMMapEndCmd(pMap);
+
+	pMap->memReads = 0;
+	pMap->cmdReads = 0;
+	pMap->remaps = 0;
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Select the controller prefetch options */
+void spifiMMapSetPrefetch(SPIFI_MMAP_T *pMap, uint32_t prefetch)
+{
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = spifiMMapPrvCtrl(pMap);
+	uint32_t ctrl;
+
+	/* The control register is only changed in command mode */
+	spifiMMapBeginCmd(pMap);
+
+	ctrl = spifi_HW_GetCtrl(pSpifiCtrlAddr) &
+		   ~(SPIFI_CTRL_PREFETCH_DISABLE(1) | SPIFI_CTRL_DATA_PREFETCH_DISABLE(1));
+	if ((prefetch & SPIFI_MMAP_PREFETCH_CODE) == 0) {
+		ctrl |= SPIFI_CTRL_PREFETCH_DISABLE(1);
+	}
+	if ((prefetch & SPIFI_MMAP_PREFETCH_DATA) == 0) {
+		ctrl |= SPIFI_CTRL_DATA_PREFETCH_DISABLE(1);
+	}
+	spifi_HW_SetCtrl(pSpifiCtrlAddr, ctrl);
+	pMap->prefetch = prefetch;
+
+	spifiMMapEndCmd(pMap);
+}
+
+/* Limit the region read through the controller cache */
+void spifiMMapSetCacheLimit(SPIFI_MMAP_T *pMap, uint32_t addr)
+{
+	spifiMMapBeginCmd(pMap);
+	spifi_HW_SetCacheLimit(spifiMMapPrvCtrl(pMap), addr - pMap->pHandle->pInfoData->baseAddr);
+	spifiMMapEndCmd(pMap);
+}
+
+/* Leave memory mode to access the device in command mode */
+void spifiMMapBeginCmd(SPIFI_MMAP_T *pMap)
+{
+	if (pMap->cmdDepth++ == 0) {
+		spifiDevSetMemMode(pMap->pHandle, 0);
+	}
+}
+
+/* End a command mode section and enter memory mode again */
+void spifiMMapEndCmd(SPIFI_MMAP_T *pMap)
+{
+	if ((pMap->cmdDepth != 0) && (--pMap->cmdDepth == 0)) {
+		spifiMMapPrvRemap(pMap);
+	}
+}
+
+/* Read the device */
+SPIFI_ERR_T spifiMMapRead(SPIFI_MMAP_T *pMap, uint32_t addr, uint32_t *readBuff, uint32_t bytes)
+{
+	const uint8_t *pSrc8;
+	uint8_t *pDest8;
+
+	if (pMap->cmdDepth != 0) {
+		pMap->cmdReads++;
+		return spifiRead(pMap->pHandle, addr, readBuff, bytes);
+	}
+	pMap->memReads++;
+
+	/* Word reads make the fewest bus accesses to the controller */
+	if ((addr & 0x3) == 0) {
+		const uint32_t *pSrc32 = (const uint32_t *) addr;
+
+		while (bytes >= sizeof(uint32_t)) {
+			*readBuff++ = *pSrc32++;
+			bytes -= sizeof(uint32_t);
+		}
+		addr = (uint32_t) pSrc32;
+	}
+
+	pSrc8 = (const uint8_t *) addr;
+	pDest8 = (uint8_t *) readBuff;
+	while (bytes--) {
+		*pDest8++ = *pSrc8++;
+	}
+
+	return SPIFI_ERR_NONE;
+}
+
+/* Program the device and return to memory mode */
+SPIFI_ERR_T spifiMMapProgram(SPIFI_MMAP_T *pMap, uint32_t addr, const uint32_t *writeBuff, uint32_t bytes)
+{
+	SPIFI_ERR_T err;
+
+	spifiMMapBeginCmd(pMap);
+	err = spifiProgram(pMap->pHandle, addr, writeBuff, bytes);
+	spifiMMapEndCmd(pMap);
+
+	return err;
+}
+
+/* Erase an address range and return to memory mode */
+SPIFI_ERR_T spifiMMapErase(SPIFI_MMAP_T *pMap, uint32_t firstAddr, uint32_t lastAddr,
+						   uint32_t flags, uint32_t *pBuf)
+{
+	SPIFI_ERR_T err;
+
+	spifiMMapBeginCmd(pMap);
+	err = spifiEraseRange(pMap->pHandle, firstAddr, lastAddr, flags, pBuf);
+	spifiMMapEndCmd(pMap);
+
+	return err;
+}
+
+/* Discard cached device data after the device was changed */
+void spifiMMapInvalidate(SPIFI_MMAP_T *pMap, uint32_t addr, uint32_t bytes)
+{
+	LPC_SPIFI_CHIPHW_T *pSpifiCtrlAddr = spifiMMapPrvCtrl(pMap);
+
+	/* Nothing is cached inside a command mode section or above the limit */
+	if ((pMap->cmdDepth != 0) || (bytes == 0) ||
+		((addr - pMap->pHandle->pInfoData->baseAddr) >= pSpifiCtrlAddr->CACHELIMIT)) {
+		return;
+	}
+
+	spifiMMapPrvRemap(pMap);
+}
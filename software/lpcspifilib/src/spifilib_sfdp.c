@@ -0,0 +1,249 @@
+/*
+ * @brief LPCSPIFILIB SFDP (JESD216) parameter table parser
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2014
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+
+#include <string.h>
+
+#include "spifilib_sfdp.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* SFDP header and parameter header sizes */
+#define SFDP_HDR_BYTES              8
+#define SFDP_PARAM_HDR_BYTES        8
+
+/* Basic flash parameter table DWORDs used, JESD216 revision A has 9 */
+#define SFDP_BASIC_MIN_DWORDS       9
+#define SFDP_BASIC_DWORDS           16
+
+/* Largest device that can be addressed with 3 address bytes */
+#define SFDP_MAX_DEVSIZE            (16 * 1024 * 1024)
+
+/* Erase opcodes used by the common command set */
+#define SFDP_BLOCK_ERASE_OPCODE     0xD8
+#define SFDP_SUBBLOCK_ERASE_OPCODE  0x20
+
+/* Erase time units in mS, JESD216B DWORD 10 and 11 */
+static const uint16_t sfdpEraseUnits[4] = {1, 16, 128, 1000};
+static const uint16_t sfdpChipEraseUnits[4] = {16, 256, 4000, 64000};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Fill a read command from its 16-bit basic table field */
+static void sfdpPrvGetRead(SPIFI_SFDP_READ_T *pRead, uint32_t field, uint8_t addrLines, uint8_t dataLines)
+{
+	pRead->dummyClocks = field & 0x1F;
+	pRead->modeClocks = (field >> 5) & 0x7;
+	pRead->opcode = (field >> 8) & 0xFF;
+	pRead->addrLines = addrLines;
+	pRead->dataLines = dataLines;
+}
+
+/* Clocks from the opcode to the data of a read, 0 if the controller can't
+   issue it. Mode and dummy clocks are sent by the controller as whole
+   intermediate bytes on the address lines, up to 7 bytes. */
+static uint32_t sfdpPrvReadClocks(const SPIFI_SFDP_READ_T *pRead)
+{
+	uint32_t clocks = pRead->modeClocks + pRead->dummyClocks;
+
+	if ((pRead->opcode == 0) || (((clocks * pRead->addrLines) & 0x7) != 0) ||
+		(((clocks * pRead->addrLines) >> 3) > 7)) {
+		return 0;
+	}
+
+	return 8 + (24 / pRead->addrLines) + clocks;
+}
+
+/* Keep the read with the fewest clocks before the data */
+static void sfdpPrvSelectRead(SPIFI_SFDP_READ_T *pBest, uint32_t field, uint8_t addrLines, uint8_t dataLines)
+{
+	SPIFI_SFDP_READ_T read;
+	uint32_t clocks;
+
+	sfdpPrvGetRead(&read, field, addrLines, dataLines);
+	clocks = sfdpPrvReadClocks(&read);
+	if ((clocks != 0) && ((pBest->opcode == 0) || (clocks < sfdpPrvReadClocks(pBest)))) {
+		*pBest = read;
+	}
+}
+
+/* Typical time of an erase from its 7-bit count and units field */
+static uint32_t sfdpPrvEraseTime(uint32_t field, const uint16_t *pUnits)
+{
+	return ((field & 0x1F) + 1) * pUnits[(field >> 5) & 0x3];
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Parse the SFDP tables of a device */
+SPIFI_ERR_T spifiSFDPParse(SPIFI_SFDP_READFX_T readFx, void *pCtx, SPIFI_SFDP_INFO_T *pInfo)
+{
+	uint8_t hdr[SFDP_PARAM_HDR_BYTES];
+	uint8_t raw[SFDP_BASIC_DWORDS * 4];
+	uint32_t dw[SFDP_BASIC_DWORDS];
+	uint32_t idx, params, field, density;
+	uint32_t dwords = 0;
+	uint32_t tablePtr = 0;
+	int32_t blkType = -1;
+	int32_t subBlkType = -1;
+
+	memset(pInfo, 0, sizeof(SPIFI_SFDP_INFO_T));
+
+	/* Signature and major revision 1 (JESD216, A and B) */
+	readFx(pCtx, 0, hdr, SFDP_HDR_BYTES);
+	if ((((uint32_t) hdr[0] | ((uint32_t) hdr[1] << 8) | ((uint32_t) hdr[2] << 16) |
+		  ((uint32_t) hdr[3] << 24)) != SPIFI_SFDP_SIGNATURE) || (hdr[5] != 1)) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+	params = hdr[6] + 1;
+
+	/* Use the newest JEDEC basic flash parameter table */
+	for (idx = 0; idx < params; ++idx) {
+		readFx(pCtx, SFDP_HDR_BYTES + (idx * SFDP_PARAM_HDR_BYTES), hdr, SFDP_PARAM_HDR_BYTES);
+		if ((hdr[0] == 0x00) && (hdr[7] == 0xFF) && (hdr[2] == 1) && (hdr[3] >= SFDP_BASIC_MIN_DWORDS) &&
+			((dwords == 0) || (hdr[1] >= pInfo->revMinor))) {
+			pInfo->revMajor = hdr[2];
+			pInfo->revMinor = hdr[1];
+			dwords = hdr[3];
+			tablePtr = hdr[4] | (hdr[5] << 8) | (hdr[6] << 16);
+		}
+	}
+	if (dwords == 0) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+	if (dwords > SFDP_BASIC_DWORDS) {
+		dwords = SFDP_BASIC_DWORDS;
+	}
+
+	readFx(pCtx, tablePtr, raw, dwords * 4);
+	for (idx = 0; idx < SFDP_BASIC_DWORDS; ++idx) {
+		dw[idx] = 0;
+		if (idx < dwords) {
+			dw[idx] = raw[idx * 4] | (raw[(idx * 4) + 1] << 8) | (raw[(idx * 4) + 2] << 16) |
+					  ((uint32_t) raw[(idx * 4) + 3] << 24);
+		}
+	}
+
+	/* DWORD 1 and 2: 3 byte addressing and density */
+	if (((dw[0] >> 17) & 0x3) == 2) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+	density = dw[1] & 0x7FFFFFFF;
+	if (dw[1] & 0x80000000) {
+		if ((density < 3) || (density > 27)) {
+			return SPIFI_ERR_NOTSUPPORTED;
+		}
+		pInfo->devSize = 1UL << (density - 3);
+	}
+	else {
+		if (density >= (SFDP_MAX_DEVSIZE * 8)) {
+			return SPIFI_ERR_NOTSUPPORTED;
+		}
+		pInfo->devSize = (density + 1) >> 3;
+	}
+
+	/* DWORD 8 and 9: erase types, the common command set uses 0xD8 and 0x20 */
+	for (idx = 0; idx < 4; ++idx) {
+		field = (dw[7 + (idx >> 1)] >> ((idx & 1) * 16)) & 0xFFFF;
+		if ((field & 0xFF) == 0) {
+			continue;
+		}
+		if ((field >> 8) == SFDP_BLOCK_ERASE_OPCODE) {
+			pInfo->blkSize = 1UL << (field & 0xFF);
+			blkType = idx;
+		}
+		else if ((field >> 8) == SFDP_SUBBLOCK_ERASE_OPCODE) {
+			pInfo->subBlkSize = 1UL << (field & 0xFF);
+			subBlkType = idx;
+		}
+	}
+	if ((subBlkType < 0) && ((dw[0] & 0x3) == 1) && (((dw[0] >> 8) & 0xFF) == SFDP_SUBBLOCK_ERASE_OPCODE)) {
+		pInfo->subBlkSize = 4096;
+	}
+	if ((pInfo->blkSize == 0) || (pInfo->blkSize > pInfo->devSize) || ((pInfo->devSize % pInfo->blkSize) != 0)) {
+		return SPIFI_ERR_NOTSUPPORTED;
+	}
+	if ((pInfo->subBlkSize >= pInfo->blkSize) || (pInfo->subBlkSize > 0xFFFF)) {
+		pInfo->subBlkSize = 0;
+		subBlkType = -1;
+	}
+
+	/* DWORD 10 and 11 (revision B): erase and program times and page size */
+	pInfo->pageSize = 256;
+	if (dwords >= 11) {
+		if (blkType >= 0) {
+			pInfo->blkEraseTime = sfdpPrvEraseTime(dw[9] >> (4 + (7 * blkType)), sfdpEraseUnits);
+		}
+		if (subBlkType >= 0) {
+			pInfo->subBlkEraseTime = sfdpPrvEraseTime(dw[9] >> (4 + (7 * subBlkType)), sfdpEraseUnits);
+		}
+		pInfo->chipEraseTime = sfdpPrvEraseTime(dw[10] >> 24, sfdpChipEraseUnits);
+		pInfo->pageSize = 1UL << ((dw[10] >> 4) & 0xF);
+	}
+
+	/* DWORD 1, 3 and 4: fast reads */
+	pInfo->dtrRead = (dw[0] >> 19) & 1;
+	if (dw[0] & (1 << 16)) {
+		sfdpPrvSelectRead(&pInfo->dualRead, dw[3], 1, 2);
+	}
+	if (dw[0] & (1 << 20)) {
+		sfdpPrvSelectRead(&pInfo->dualRead, dw[3] >> 16, 2, 2);
+	}
+	if (dw[0] & (1 << 22)) {
+		sfdpPrvSelectRead(&pInfo->quadRead, dw[2] >> 16, 1, 4);
+	}
+	if (dw[0] & (1 << 21)) {
+		sfdpPrvSelectRead(&pInfo->quadRead, dw[2], 4, 4);
+	}
+
+	/* DWORD 15 (revision B): quad enable and continuous read entry / exit */
+	pInfo->qer = SPIFI_SFDP_QER_UNKNOWN;
+	if (dwords >= 15) {
+		pInfo->qer = (dw[14] >> 20) & 0x7;
+
+		/* Entered with mode bits A5h or Axh, left with other mode bits */
+		pInfo->contRead = ((dw[14] & (1 << 9)) != 0) && (((dw[14] >> 16) & 0x5) != 0) &&
+						  (((dw[14] >> 10) & 0x1) != 0) && (pInfo->quadRead.addrLines == 4) &&
+						  (pInfo->quadRead.modeClocks == 2);
+	}
+
+	return SPIFI_ERR_NONE;
+}
@@ -34,6 +34,8 @@
 #include <string.h>
 #include "board.h"
 #include "spifilib_api.h"
+#include "spifilib_job.h"
+#include "spifilib_sfdp.h"
 #include "stopwatch.h"
 
 /*****************************************************************************
@@ -68,6 +70,86 @@ static uint32_t largeTestBuffer[(LARGE_TEST_BUFFSIZE >> 2)];
 
 static uint32_t blinkToggleRate = 500;
 
+/* Job progress reported by the job battery callbacks */
+static uint32_t jobProgress;
+static uint32_t jobProgressCalls;
+static SPIFI_ERR_T jobResult;
+
+/* SFDP tables of the SFDP parser test corpus, header and basic table as
+   little endian words */
+static const uint32_t sfdpW25Q64[] = {
+	0x50444653, 0xFF000106, 0x10010600, 0xFF000010,
+	0xFFF120E5, 0x03FFFFFF, 0x6B08EB44, 0xBB803B08, 0xFFFFFFEE, 0xFF00FFFF, 0xFF00FFFF, 0x520F200C,
+	0x0000D810, 0x00A53A22, 0x44000081, 0x00000000, 0x00000000, 0x00000000, 0x00410600, 0x00000000
+};
+static const uint32_t sfdpMX25L32[] = {
+	0x50444653, 0xFF000106, 0x10010600, 0xFF000010,
+	0xFF2120E5, 0x01FFFFFF, 0xFFFFEB44, 0xFFFF3B08, 0xFFFFFFEE, 0xFF00FFFF, 0xFF00FFFF, 0xD810200C,
+	0x00000000, 0x000151D0, 0x00000081, 0x00000000, 0x00000000, 0x00000000, 0x00200000, 0x00000000
+};
+static const uint32_t sfdpRevA[] = {
+	0x50444653, 0xFF000100, 0x09010000, 0xFF000010,
+	0xFF8120E5, 0x00FFFFFF, 0xFFFFFFFF, 0xFFFF3B08, 0xFFFFFFEE, 0xFF00FFFF, 0xFF00FFFF, 0xD810200C,
+	0x00000000
+};
+static const uint32_t sfdpBadSignature[] = {
+	0x50444654, 0xFF000106, 0x10010600, 0xFF000010
+};
+static const uint32_t sfdpTooLarge[] = {
+	0x50444653, 0xFF000100, 0x09010000, 0xFF000010,
+	0xFF8120E5, 0x8000001C, 0xFFFFFFFF, 0xFFFF3B08, 0xFFFFFFEE, 0xFF00FFFF, 0xFF00FFFF, 0x520F200C,
+	0x0000D810
+};
+static const uint32_t sfdpNoBlockErase[] = {
+	0x50444653, 0xFF000100, 0x09010000, 0xFF000010,
+	0xFF8120E5, 0x00FFFFFF, 0xFFFFFFFF, 0xFFFF3B08, 0xFFFFFFEE, 0xFF00FFFF, 0xFF00FFFF, 0x520F200C,
+	0x00000000
+};
+
+typedef struct {
+	const char *pName;
+	const uint32_t *pTable;
+	uint32_t bytes;
+	SPIFI_ERR_T err;
+	uint32_t devSize;
+	uint32_t subBlkSize;
+	uint32_t subBlkEraseTime;
+	uint8_t qer;
+	uint8_t contRead;
+	uint8_t dualOpcode;
+	uint8_t quadOpcode;
+} SFDP_TEST_CASE_T;
+
+#define SFDP_TEST_TABLE(t)  (t), sizeof(t)
+
+static const SFDP_TEST_CASE_T sfdpTests[] = {
+	{"W25Q64 rev B", SFDP_TEST_TABLE(sfdpW25Q64), SPIFI_ERR_NONE, 0x800000, 0x1000, 48,
+	 SPIFI_SFDP_QER_SR2BIT1_NOCLR, 1, 0xBB, 0xEB},
+	{"MX25L32 rev B", SFDP_TEST_TABLE(sfdpMX25L32), SPIFI_ERR_NONE, 0x400000, 0x1000, 30,
+	 SPIFI_SFDP_QER_SR1BIT6, 0, 0x3B, 0xEB},
+	{"rev A", SFDP_TEST_TABLE(sfdpRevA), SPIFI_ERR_NONE, 0x200000, 0x1000, 0,
+	 SPIFI_SFDP_QER_UNKNOWN, 0, 0x3B, 0},
+	{"bad signature", SFDP_TEST_TABLE(sfdpBadSignature), SPIFI_ERR_NOTSUPPORTED},
+	{"32MB", SFDP_TEST_TABLE(sfdpTooLarge), SPIFI_ERR_NOTSUPPORTED},
+	{"no 0xD8 erase", SFDP_TEST_TABLE(sfdpNoBlockErase), SPIFI_ERR_NOTSUPPORTED}
+};
+
+/* Read a corpus SFDP table, erased bytes past its end */
+static void sfdpTestRead(void *pCtx, uint32_t addr, uint8_t *pBuf, uint32_t bytes)
+{
+	const SFDP_TEST_CASE_T *pTest = (const SFDP_TEST_CASE_T *) pCtx;
+
+	while (bytes) {
+		*pBuf = 0xFF;
+		if (addr < pTest->bytes) {
+			*pBuf = ((const uint8_t *) pTest->pTable)[addr];
+		}
+		++pBuf;
+		++addr;
+		--bytes;
+	}
+}
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -97,6 +179,37 @@ static void populateDeviceData(SPIFI_HANDLE_T *pSpifi, DEVICE_TEST_DATA_T *devDa
 	}
 }
 
+/* Job battery progress callback */
+static void jobProgressCallback(void *cbData, uint32_t doneBytes, uint32_t totalBytes)
+{
+	if ((doneBytes <= jobProgress) || (doneBytes > totalBytes)) {
+		test_suiteError("Job progress", SPIFI_ERR_GEN);
+	}
+	jobProgress = doneBytes;
+	++jobProgressCalls;
+}
+
+/* Job battery completion callback */
+static void jobDoneCallback(void *cbData, SPIFI_ERR_T err)
+{
+	jobResult = err;
+}
+
+/* Poll a job to completion, returns the number of polls that found it busy */
+static uint32_t runJob(SPIFI_JOB_T *pJob)
+{
+	uint32_t polls = 0;
+
+	while (spifiJobPoll(pJob) == SPIFI_ERR_BUSY) {
+		++polls;
+	}
+	if ((jobResult != SPIFI_ERR_NONE) || (pJob->lastErr != SPIFI_ERR_NONE)) {
+		test_suiteError("Job result", pJob->lastErr);
+	}
+
+	return polls;
+}
+
 static void bulkEraseDevice(DEVICE_TEST_DATA_T *devData, uint8_t useAddrMode, uint8_t verify)
 {
 	SPIFI_ERR_T errCode;
@@ -658,6 +771,152 @@ void test_suiteLockUnlockBattery(SPIFI_HANDLE_T *pSpifi)
 	DEBUGOUT("Lock-Unlock Test Battery Complete!\r\n\r\n");
 }
 
+void test_suiteJobBattery(SPIFI_HANDLE_T *pSpifi)
+{
+	DEVICE_TEST_DATA_T devData;
+	SPIFI_JOB_T job;
+	SPIFI_ERR_T errCode;
+	uint32_t addr;
+	uint32_t polls;
+	uint32_t idx;
+
+	DEBUGOUT("Begin Job Test Battery\r\n");
+	populateDeviceData(pSpifi, &devData, 0);
+	memset(&job, 0, sizeof(job));
+
+	/* Non-blocking erase of blocks 1 and 2 */
+	jobProgress = 0;
+	jobProgressCalls = 0;
+	jobResult = SPIFI_ERR_GEN;
+	addr = spifiGetAddrFromBlock(pSpifi, 1);
+	errCode = spifiJobErase(&job, pSpifi, addr, addr + (2 * devData.blockSize) - 1,
+							jobProgressCallback, jobDoneCallback, NULL);
+	if (errCode != SPIFI_ERR_NONE) {
+		test_suiteError("spifiJobErase", errCode);
+	}
+	if (spifiJobErase(&job, pSpifi, addr, addr, NULL, NULL, NULL) != SPIFI_ERR_BUSY) {
+		test_suiteError("spifiJobErase while busy", SPIFI_ERR_GEN);
+	}
+	polls = runJob(&job);
+	if ((jobProgressCalls != 2) || (jobProgress != (2 * devData.blockSize))) {
+		test_suiteError("Job erase progress", SPIFI_ERR_GEN);
+	}
+	test_suiteVerifyBlockErased(pSpifi, 1, false);
+	test_suiteVerifyBlockErased(pSpifi, 2, false);
+	DEBUGOUT("Erased 2 blocks in %d busy polls\r\n", polls);
+
+	/* Non-blocking program that is not page aligned */
+	for (idx = 0; idx < (TEST_BUFFSIZE >> 2); ++idx) {
+		test_suiteGetBuffer(TEST_TX_BUFFER_ID)[idx] = idx ^ 0x5a5aa5a5;
+	}
+	jobProgress = 0;
+	jobProgressCalls = 0;
+	jobResult = SPIFI_ERR_GEN;
+	addr += 16;
+	errCode = spifiJobProgram(&job, pSpifi, addr, test_suiteGetBuffer(TEST_TX_BUFFER_ID), TEST_BUFFSIZE,
+							  jobProgressCallback, jobDoneCallback, NULL);
+	if (errCode != SPIFI_ERR_NONE) {
+		test_suiteError("spifiJobProgram", errCode);
+	}
+	polls = runJob(&job);
+	if ((jobProgressCalls != ((TEST_BUFFSIZE / devData.pageSize) + 1)) || (jobProgress != TEST_BUFFSIZE)) {
+		test_suiteError("Job program progress", SPIFI_ERR_GEN);
+	}
+	errCode = spifiRead(pSpifi, addr, test_suiteGetBuffer(TEST_RX_BUFFER_ID), TEST_BUFFSIZE);
+	if (errCode != SPIFI_ERR_NONE) {
+		test_suiteError("spifiRead", errCode);
+	}
+	test_suiteCompareTestBuffers(TEST_RX_BUFFER_ID, TEST_TX_BUFFER_ID, TEST_BUFFSIZE);
+	DEBUGOUT("Programmed %d bytes in %d busy polls\r\n", TEST_BUFFSIZE, polls);
+
+	DEBUGOUT("Job Test Battery Complete!\r\n\r\n");
+}
+
+void test_suiteErasePlanBattery(SPIFI_HANDLE_T *pSpifi)
+{
+	static const uint32_t imageSizes[] = {24 * 1024, 100 * 1024, 300 * 1024, 1024 * 1024};
+	DEVICE_TEST_DATA_T devData;
+	SPIFI_ERASE_PLAN_T legacyPlan;
+	SPIFI_ERASE_PLAN_T plan;
+	SPIFI_ERR_T errCode;
+	uint32_t idx;
+	uint32_t firstAddr;
+	uint32_t lastAddr;
+
+	DEBUGOUT("Begin Erase Plan Test Battery\r\n");
+	populateDeviceData(pSpifi, &devData, 0);
+
+	/* Report the modelled erase time of typical update images, placed after a
+	   4KB header so they don't start on a block boundary */
+	for (idx = 0; idx < (sizeof(imageSizes) / sizeof(imageSizes[0])); ++idx) {
+		firstAddr = devData.baseAddress + 0x1000;
+		lastAddr = firstAddr + imageSizes[idx] - 1;
+		if (spifiErasePlan(pSpifi, firstAddr, lastAddr, SPIFI_ERASE_WHOLE_BLOCKS, &legacyPlan) != SPIFI_ERR_NONE) {
+			continue;
+		}
+		errCode = spifiErasePlan(pSpifi, firstAddr, lastAddr, 0, &plan);
+		if ((errCode != SPIFI_ERR_NONE) || (plan.eraseTime > legacyPlan.eraseTime)) {
+			test_suiteError("spifiErasePlan", errCode);
+		}
+		DEBUGOUT("Image %dKB: whole blocks %d mS, planned %d mS (%d bytes erased)\r\n",
+				 imageSizes[idx] / 1024, legacyPlan.eraseTime, plan.eraseTime,
+				 (plan.lastAddr - plan.firstAddr) + 1);
+	}
+
+	/* Erase an unaligned range inside block 1 and check the bytes around it are kept */
+	firstAddr = spifiGetAddrFromBlock(pSpifi, 1) + 100;
+	lastAddr = firstAddr + (2 * devData.pageSize) + 50;
+	errCode = spifiErasePlan(pSpifi, firstAddr, lastAddr, SPIFI_ERASE_PRESERVE, &plan);
+	if (errCode != SPIFI_ERR_NONE) {
+		test_suiteError("spifiErasePlan", errCode);
+	}
+	if (plan.bufBytes <= LARGE_TEST_BUFFSIZE) {
+		test_suiteEraseBlocks(pSpifi, 1, 1);
+		test_suiteFillBuffer(test_suiteGetBuffer(TEST_TX_BUFFER_ID), 0x5a5a5a5a, TEST_BUFFSIZE);
+		test_suiteWriteBlock(pSpifi, 1, TEST_TX_BUFFER_ID, TEST_BUFFSIZE);
+
+		errCode = spifiErasePlanRun(pSpifi, &plan, largeTestBuffer);
+		if (errCode != SPIFI_ERR_NONE) {
+			test_suiteError("spifiErasePlanRun", errCode);
+		}
+		test_suiteVerifyPattern(pSpifi, plan.firstAddr, plan.headBytes, 0x5a);
+		test_suiteVerifyPattern(pSpifi, firstAddr, (lastAddr - firstAddr) + 1, 0xff);
+		test_suiteVerifyPattern(pSpifi, lastAddr + 1, plan.tailBytes, 0x5a);
+		DEBUGOUT("Preserved %d + %d bytes around the erased range\r\n", plan.headBytes, plan.tailBytes);
+	}
+
+	DEBUGOUT("Erase Plan Test Battery Complete!\r\n\r\n");
+}
+
+void test_suiteSFDPBattery(void)
+{
+	const SFDP_TEST_CASE_T *pTest;
+	SPIFI_SFDP_INFO_T info;
+	SPIFI_ERR_T errCode;
+	uint32_t idx;
+
+	DEBUGOUT("Begin SFDP Test Battery\r\n");
+
+	for (idx = 0; idx < (sizeof(sfdpTests) / sizeof(sfdpTests[0])); ++idx) {
+		pTest = &sfdpTests[idx];
+		errCode = spifiSFDPParse(sfdpTestRead, (void *) pTest, &info);
+		if (errCode != pTest->err) {
+			test_suiteError("spifiSFDPParse", errCode);
+		}
+		if ((errCode == SPIFI_ERR_NONE) &&
+			((info.devSize != pTest->devSize) || (info.blkSize != 0x10000) ||
+			 (info.subBlkSize != pTest->subBlkSize) || (info.subBlkEraseTime != pTest->subBlkEraseTime) ||
+			 (info.qer != pTest->qer) || (info.contRead != pTest->contRead) ||
+			 (info.dualRead.opcode != pTest->dualOpcode) || (info.quadRead.opcode != pTest->quadOpcode))) {
+			test_suiteError("spifiSFDPParse result", SPIFI_ERR_VAL);
+		}
+		DEBUGOUT("%s: err %d, dual 0x%02x, quad 0x%02x\r\n", pTest->pName, errCode,
+				 info.dualRead.opcode, info.quadRead.opcode);
+	}
+
+	DEBUGOUT("SFDP Test Battery Complete!\r\n\r\n");
+}
+
 void test_suiteMemModeTestBattery(SPIFI_HANDLE_T *pSpifi,
 								  uint32_t baseAddr,
 								  uint8_t enableQuadRead,
@@ -71,6 +71,12 @@ void test_suiteMemModeTestBattery(SPIFI_HANDLE_T *pSpifi,
 
 void test_suiteLockUnlockBattery(SPIFI_HANDLE_T *pSpifi);
 
+void test_suiteJobBattery(SPIFI_HANDLE_T *pSpifi);
+
+void test_suiteErasePlanBattery(SPIFI_HANDLE_T *pSpifi);
+
+void test_suiteSFDPBattery(void);
+
 void test_suitePerformanceBattery(SPIFI_HANDLE_T *pSpifi);
 
 void test_suiteDeInitBattery(SPIFI_HANDLE_T *pSpifi);
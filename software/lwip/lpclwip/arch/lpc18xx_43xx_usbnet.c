@@ -0,0 +1,556 @@
+/*
+ * @brief LPC18xx/43xx LWIP USB RNDIS/CDC-ECM network driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/mem.h"
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "netif/etharp.h"
+
+#include "arch/lpc18xx_43xx_usbnet.h"
+
+#include "chip.h"
+
+#include <string.h>
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error The USB network driver needs custom pbufs, set IP_FRAG_USES_STATIC_BUF to 0
+#endif
+
+/** @ingroup NET_LWIP_LPC18XX43XX_USBNET_DRIVER
+ * @{
+ */
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/** @brief	Number of receive buffers
+ * Buffers are lent to LWIP while the received packets are processed, the
+ * host is NAKed once all of them are in use. */
+#ifndef LPC_USBNET_NUM_RXBUFS
+#define LPC_USBNET_NUM_RXBUFS 4
+#endif
+
+/** @brief	Number of packets queued for transmission */
+#ifndef LPC_USBNET_NUM_TXPBUFS
+#define LPC_USBNET_NUM_TXPBUFS 8
+#endif
+
+#if LPC_USBNET_NUM_RXBUFS < 2
+#error LPC_USBNET_NUM_RXBUFS must be at least 2
+#endif
+
+/* RNDIS packet message header size */
+#define USBNET_RNDIS_HLEN       sizeof(RNDIS_Packet_Message_t)
+
+/* Largest data transfer, RNDIS header and a full size Ethernet frame */
+#define USBNET_XFER_SIZE        ((USBNET_RNDIS_HLEN + 1514 + 3) & ~3)
+
+/* Receive buffer states */
+#define USBNET_RXBUF_FREE       0	/* Available for the next OUT transfer */
+#define USBNET_RXBUF_QUEUED     1	/* Queued to the OUT endpoint */
+#define USBNET_RXBUF_DONE       2	/* Holds a received transfer */
+#define USBNET_RXBUF_LWIP       3	/* Lent to LWIP */
+
+/* Receive buffer, the custom pbuf must be the first member */
+struct lpc_usbnet_rxbuf {
+	struct pbuf_custom pc;		/**< Custom pbuf passed to LWIP */
+	volatile u32_t state;		/**< Buffer state */
+	u32_t len;					/**< Received transfer size */
+	u32_t data[USBNET_XFER_SIZE / 4];	/**< Transfer data */
+};
+
+/* LPC USB network driver data structure */
+struct lpc_usbnetdata {
+	struct netif *netif;		/**< Reference back to LWIP parent netif */
+	struct lpc_usbnetcfg cfg;	/**< USB function configuration */
+	int link_up;				/**< Data transfers running */
+	int netif_up;				/**< Link state reported to LWIP */
+	int ecm_up;					/**< Link state requested for CDC-ECM */
+
+	struct lpc_usbnet_rxbuf rxbufs[LPC_USBNET_NUM_RXBUFS];	/**< Receive buffers */
+	u32_t rx_queue_idx;			/**< Receive buffer queued, or to queue next, to the OUT endpoint */
+	u32_t rx_get_idx;			/**< Next receive buffer to pass to LWIP */
+	volatile u32_t rx_stalled;	/**< No receive buffer is queued */
+
+	struct pbuf *txpbufs[LPC_USBNET_NUM_TXPBUFS];	/**< Packets queued for transmission */
+	u8_t *txdata[LPC_USBNET_NUM_TXPBUFS];	/**< Data of queued packets, as queued */
+	u16_t txlen[LPC_USBNET_NUM_TXPBUFS];	/**< Size of queued packets, as queued */
+	u32_t tx_fill_idx;			/**< Number of packets queued */
+	volatile u32_t tx_send_idx;	/**< Number of packets sent */
+	u32_t tx_reclaim_idx;		/**< Number of packets freed */
+	volatile u32_t tx_busy;		/**< A transfer is queued to the IN endpoint */
+	volatile u32_t tx_zlp;		/**< A zero length packet ends the current transfer */
+};
+
+/* LPC USB network driver work data */
+static struct lpc_usbnetdata lpc_usbnetdata;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Transfer state is shared with the USB interrupt */
+static u32_t lpc_usbnet_lock(void)
+{
+	u32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+static void lpc_usbnet_unlock(u32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Queues the next receive buffer to the OUT endpoint, interrupts must be disabled */
+static void lpc_rxqueue_buf(struct lpc_usbnetdata *lpc_netifdata)
+{
+	struct lpc_usbnet_rxbuf *b = &lpc_netifdata->rxbufs[lpc_netifdata->rx_queue_idx];
+
+	/* Buffers are queued in order, the host is NAKed until this one is free */
+	if ((!lpc_netifdata->link_up) || (b->state != USBNET_RXBUF_FREE)) {
+		lpc_netifdata->rx_stalled = 1;
+		return;
+	}
+
+	b->state = USBNET_RXBUF_QUEUED;
+	lpc_netifdata->rx_stalled = 0;
+	DcdDataTransfer(lpc_netifdata->cfg.corenum, 2 * lpc_netifdata->cfg.out_ep,
+					(uint8_t *) b->data, USBNET_XFER_SIZE);
+}
+
+/* Custom pbuf free function, returns the buffer to the receive pool */
+static void lpc_rxbuf_free(struct pbuf *p)
+{
+	struct lpc_usbnet_rxbuf *b = (struct lpc_usbnet_rxbuf *) p;
+	u32_t primask = lpc_usbnet_lock();
+
+	b->state = USBNET_RXBUF_FREE;
+	if (lpc_usbnetdata.rx_stalled) {
+		lpc_rxqueue_buf(&lpc_usbnetdata);
+	}
+
+	lpc_usbnet_unlock(primask);
+}
+
+/* Queues the next packet to the IN endpoint, interrupts must be disabled */
+static void lpc_tx_start(struct lpc_usbnetdata *lpc_netifdata)
+{
+	u32_t idx;
+
+	if (lpc_netifdata->tx_send_idx == lpc_netifdata->tx_fill_idx) {
+		lpc_netifdata->tx_busy = 0;
+		return;
+	}
+
+	idx = lpc_netifdata->tx_send_idx % LPC_USBNET_NUM_TXPBUFS;
+
+	/* The host only sees the end of a transfer on a short packet */
+	lpc_netifdata->tx_busy = 1;
+	lpc_netifdata->tx_zlp = ((lpc_netifdata->txlen[idx] % lpc_netifdata->cfg.in_ep_size) == 0);
+	DcdDataTransfer(lpc_netifdata->cfg.corenum, 2 * lpc_netifdata->cfg.in_ep + 1,
+					lpc_netifdata->txdata[idx], lpc_netifdata->txlen[idx]);
+}
+
+/* Frees the pbufs of sent packets */
+static void lpc_tx_reclaim(struct lpc_usbnetdata *lpc_netifdata)
+{
+	while (lpc_netifdata->tx_reclaim_idx != lpc_netifdata->tx_send_idx) {
+		pbuf_free(lpc_netifdata->txpbufs[lpc_netifdata->tx_reclaim_idx % LPC_USBNET_NUM_TXPBUFS]);
+		lpc_netifdata->tx_reclaim_idx++;
+	}
+}
+
+/* Stops the data transfers, interrupts must be disabled. Packets not yet
+   handed over are dropped, the sent ones are freed by lpc_tx_reclaim(). */
+static void lpc_usbnet_stop(struct lpc_usbnetdata *lpc_netifdata)
+{
+	u32_t idx;
+
+	lpc_netifdata->link_up = 0;
+
+	/* Cancel queued transfers */
+	USB_REG(lpc_netifdata->cfg.corenum)->ENDPTFLUSH = (1 << lpc_netifdata->cfg.out_ep) |
+													  (1 << (lpc_netifdata->cfg.in_ep + 16));
+	while (USB_REG(lpc_netifdata->cfg.corenum)->ENDPTFLUSH) {}
+
+	for (idx = 0; idx < LPC_USBNET_NUM_RXBUFS; idx++) {
+		if (lpc_netifdata->rxbufs[idx].state != USBNET_RXBUF_LWIP) {
+			lpc_netifdata->rxbufs[idx].state = USBNET_RXBUF_FREE;
+		}
+	}
+	lpc_netifdata->rx_queue_idx = lpc_netifdata->rx_get_idx = 0;
+	lpc_netifdata->rx_stalled = 1;
+
+	lpc_netifdata->tx_send_idx = lpc_netifdata->tx_fill_idx;
+	lpc_netifdata->tx_busy = 0;
+	lpc_netifdata->tx_zlp = 0;
+}
+
+/* Follows the link state, starting and stopping the data transfers */
+static void lpc_usbnet_link(struct lpc_usbnetdata *lpc_netifdata, int up)
+{
+	u32_t primask;
+
+	primask = lpc_usbnet_lock();
+	if ((up) && (!lpc_netifdata->link_up)) {
+		lpc_netifdata->link_up = 1;
+
+		/* The driver owns the OUT endpoint, stop the stack priming its own buffer on NAK */
+		USB_REG(lpc_netifdata->cfg.corenum)->ENDPTNAKEN &= ~(1 << lpc_netifdata->cfg.out_ep);
+		lpc_rxqueue_buf(lpc_netifdata);
+	}
+	else if ((!up) && (lpc_netifdata->link_up)) {
+		lpc_usbnet_stop(lpc_netifdata);
+	}
+	lpc_usbnet_unlock(primask);
+
+	/* A USB reset may have stopped the transfers since the last call */
+	lpc_tx_reclaim(lpc_netifdata);
+
+	if (up != lpc_netifdata->netif_up) {
+		lpc_netifdata->netif_up = up;
+		if (up) {
+			netif_set_link_up(lpc_netifdata->netif);
+		}
+		else {
+			netif_set_link_down(lpc_netifdata->netif);
+		}
+	}
+}
+
+/* Gets the next received packet and wraps it in a custom pbuf */
+static struct pbuf *lpc_low_level_input(struct netif *netif) {
+	struct lpc_usbnetdata *lpc_netifdata = netif->state;
+	struct lpc_usbnet_rxbuf *b;
+	RNDIS_Packet_Message_t *hdr;
+	u8_t *payload;
+	u32_t len, primask;
+
+	while (1) {
+		/* A USB reset may drop the received buffers meanwhile */
+		primask = lpc_usbnet_lock();
+		b = &lpc_netifdata->rxbufs[lpc_netifdata->rx_get_idx];
+		if (b->state != USBNET_RXBUF_DONE) {
+			lpc_usbnet_unlock(primask);
+			return NULL;
+		}
+
+		b->state = USBNET_RXBUF_LWIP;
+		lpc_netifdata->rx_get_idx++;
+		if (lpc_netifdata->rx_get_idx >= LPC_USBNET_NUM_RXBUFS) {
+			lpc_netifdata->rx_get_idx = 0;
+		}
+		lpc_usbnet_unlock(primask);
+
+		payload = (u8_t *) b->data;
+		len = b->len;
+
+		/* Strip the RNDIS packet message header */
+		if (lpc_netifdata->cfg.framing == LPC_USBNET_RNDIS) {
+			hdr = (RNDIS_Packet_Message_t *) b->data;
+			if ((len < USBNET_RNDIS_HLEN) ||
+				(le32_to_cpu(hdr->MessageType) != REMOTE_NDIS_PACKET_MSG) ||
+				((le32_to_cpu(hdr->DataOffset) + 8 + le32_to_cpu(hdr->DataLength)) > len)) {
+				len = 0;
+			}
+			else {
+				payload += le32_to_cpu(hdr->DataOffset) + 8;
+				len = le32_to_cpu(hdr->DataLength);
+			}
+		}
+
+		if (len < SIZEOF_ETH_HDR) {
+			LINK_STATS_INC(link.lenerr);
+			LINK_STATS_INC(link.drop);
+			lpc_rxbuf_free(&b->pc.pbuf);
+			continue;
+		}
+
+		LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE,
+					("lpc_low_level_input: Packet received, %d bytes\n", len));
+
+		LINK_STATS_INC(link.recv);
+		return pbuf_alloced_custom(PBUF_RAW, (u16_t) len, PBUF_REF, &b->pc, payload, (u16_t) len);
+	}
+}
+
+/* Low level output of a packet. A CDC-ECM packet that is a single pbuf not
+   referenced elsewhere is sent from its own payload, other packets from a
+   copy. The data sent is recorded when the packet is queued, as LWIP may
+   move the payload of a pbuf it keeps, such as a TCP segment. */
+static err_t lpc_low_level_output(struct netif *netif, struct pbuf *p)
+{
+	struct lpc_usbnetdata *lpc_netifdata = netif->state;
+	RNDIS_Packet_Message_t *hdr;
+	struct pbuf *q;
+	u16_t hlen;
+	u32_t idx, primask;
+
+	if (!lpc_netifdata->link_up) {
+		return ERR_CONN;
+	}
+
+	lpc_tx_reclaim(lpc_netifdata);
+	if ((lpc_netifdata->tx_fill_idx - lpc_netifdata->tx_reclaim_idx) >= LPC_USBNET_NUM_TXPBUFS) {
+		LINK_STATS_INC(link.memerr);
+		LINK_STATS_INC(link.drop);
+		return ERR_MEM;
+	}
+
+	hlen = (lpc_netifdata->cfg.framing == LPC_USBNET_RNDIS) ? USBNET_RNDIS_HLEN : 0;
+
+	if ((hlen == 0) && (p->next == NULL) && (p->ref == 1)) {
+		/* Keep the packet until it is sent */
+		q = p;
+		pbuf_ref(q);
+	}
+	else {
+		q = pbuf_alloc(PBUF_RAW, (u16_t) (p->tot_len + hlen), PBUF_RAM);
+		if (q == NULL) {
+			LINK_STATS_INC(link.memerr);
+			LINK_STATS_INC(link.drop);
+			return ERR_MEM;
+		}
+		pbuf_copy_partial(p, (u8_t *) q->payload + hlen, p->tot_len, 0);
+	}
+
+	if (hlen) {
+		hdr = (RNDIS_Packet_Message_t *) q->payload;
+		memset(hdr, 0, USBNET_RNDIS_HLEN);
+		hdr->MessageType   = cpu_to_le32(REMOTE_NDIS_PACKET_MSG);
+		hdr->MessageLength = cpu_to_le32(q->len);
+		hdr->DataOffset    = cpu_to_le32(USBNET_RNDIS_HLEN - sizeof(RNDIS_Message_Header_t));
+		hdr->DataLength    = cpu_to_le32(q->len - USBNET_RNDIS_HLEN);
+	}
+
+	idx = lpc_netifdata->tx_fill_idx % LPC_USBNET_NUM_TXPBUFS;
+	lpc_netifdata->txpbufs[idx] = q;
+	lpc_netifdata->txdata[idx] = q->payload;
+	lpc_netifdata->txlen[idx] = q->len;
+
+	LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE,
+				("lpc_low_level_output: pbuf packet %p queued, size %d, %s\n",
+				 p, q->len, (q == p) ? "zero-copy" : "copied"));
+
+	primask = lpc_usbnet_lock();
+	lpc_netifdata->tx_fill_idx++;
+	if (!lpc_netifdata->tx_busy) {
+		lpc_tx_start(lpc_netifdata);
+	}
+	lpc_usbnet_unlock(primask);
+
+	LINK_STATS_INC(link.xmit);
+
+	return ERR_OK;
+}
+
+/* This function is the ethernet packet send function. It calls
+   etharp_output after checking link status */
+static err_t lpc_etharp_output(struct netif *netif, struct pbuf *q,
+							   ip_addr_t *ipaddr)
+{
+	/* Only send packet is link is up */
+	if (netif->flags & NETIF_FLAG_LINK_UP) {
+		return etharp_output(netif, q, ipaddr);
+	}
+
+	return ERR_CONN;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Pass received packets to LWIP, reclaim sent packets and follow the link state */
+void lpc_usbnetif_input(struct netif *netif)
+{
+	struct lpc_usbnetdata *lpc_netifdata = netif->state;
+	struct eth_hdr *ethhdr;
+	struct pbuf *p;
+	int up;
+
+	up = (USB_DeviceState[lpc_netifdata->cfg.corenum] == DEVICE_STATE_Configured);
+	if (lpc_netifdata->cfg.rndis != NULL) {
+		up = up && (lpc_netifdata->cfg.rndis->State.CurrRNDISState == RNDIS_Data_Initialized);
+	}
+	else {
+		up = up && lpc_netifdata->ecm_up;
+	}
+	lpc_usbnet_link(lpc_netifdata, up);
+
+	while ((p = lpc_low_level_input(netif)) != NULL) {
+		/* points to packet payload, which starts with an Ethernet header */
+		ethhdr = p->payload;
+
+		switch (htons(ethhdr->type)) {
+		case ETHTYPE_IP:
+		case ETHTYPE_ARP:
+			/* full packet send to tcpip_thread to process */
+			if (netif->input(p, netif) != ERR_OK) {
+				LWIP_DEBUGF(NETIF_DEBUG,
+							("lpc_usbnetif_input: IP input error\n"));
+				/* Free buffer */
+				pbuf_free(p);
+			}
+			break;
+
+		default:
+			/* Return buffer */
+			pbuf_free(p);
+			break;
+		}
+	}
+
+	lpc_tx_reclaim(lpc_netifdata);
+}
+
+/* Set the link state of a CDC-ECM interface */
+void lpc_usbnetif_set_link(struct netif *netif, int up)
+{
+	((struct lpc_usbnetdata *) netif->state)->ecm_up = up;
+}
+
+/* Data endpoint transfer completion handler */
+void lpc_usbnetif_xfer_done(int logicalEP, int xfer_in)
+{
+	struct lpc_usbnetdata *lpc_netifdata = &lpc_usbnetdata;
+	struct lpc_usbnet_rxbuf *b;
+
+	if ((lpc_netifdata->netif == NULL) || (!lpc_netifdata->link_up)) {
+		return;
+	}
+
+	if ((!xfer_in) && (logicalEP == lpc_netifdata->cfg.out_ep)) {
+		b = &lpc_netifdata->rxbufs[lpc_netifdata->rx_queue_idx];
+		if (b->state != USBNET_RXBUF_QUEUED) {
+			return;
+		}
+
+		b->len = usb_data_buffer_OUT_size[lpc_netifdata->cfg.corenum];
+		b->state = USBNET_RXBUF_DONE;
+
+		lpc_netifdata->rx_queue_idx++;
+		if (lpc_netifdata->rx_queue_idx >= LPC_USBNET_NUM_RXBUFS) {
+			lpc_netifdata->rx_queue_idx = 0;
+		}
+		lpc_rxqueue_buf(lpc_netifdata);
+	}
+	else if ((xfer_in) && (logicalEP == lpc_netifdata->cfg.in_ep) && (lpc_netifdata->tx_busy)) {
+		if (lpc_netifdata->tx_zlp) {
+			lpc_netifdata->tx_zlp = 0;
+			DcdDataTransfer(lpc_netifdata->cfg.corenum, 2 * lpc_netifdata->cfg.in_ep + 1,
+							lpc_netifdata->txdata[lpc_netifdata->tx_send_idx % LPC_USBNET_NUM_TXPBUFS], 0);
+			return;
+		}
+
+		lpc_netifdata->tx_send_idx++;
+		lpc_tx_start(lpc_netifdata);
+	}
+}
+
+/* USB reset and configuration change handler */
+void lpc_usbnetif_usb_reset(void)
+{
+	struct lpc_usbnetdata *lpc_netifdata = &lpc_usbnetdata;
+	u32_t primask;
+
+	if (lpc_netifdata->netif == NULL) {
+		return;
+	}
+
+	/* The reset has dropped the queued transfers, the link comes back up
+	   from lpc_usbnetif_input() once the host has set up the function */
+	primask = lpc_usbnet_lock();
+	if (lpc_netifdata->link_up) {
+		lpc_usbnet_stop(lpc_netifdata);
+	}
+	lpc_netifdata->ecm_up = 0;
+	lpc_usbnet_unlock(primask);
+}
+
+/* LWIP 18xx/43xx USB network interface initialization function */
+err_t lpc_usbnetif_init(struct netif *netif)
+{
+	const struct lpc_usbnetcfg *cfg;
+	u32_t idx;
+
+	LWIP_ASSERT("netif != NULL", (netif != NULL));
+	LWIP_ASSERT("netif->state != NULL", (netif->state != NULL));
+
+	cfg = netif->state;
+	memset(&lpc_usbnetdata, 0, sizeof(lpc_usbnetdata));
+	lpc_usbnetdata.netif = netif;
+	lpc_usbnetdata.cfg = *cfg;
+	lpc_usbnetdata.rx_stalled = 1;
+
+	for (idx = 0; idx < LPC_USBNET_NUM_RXBUFS; idx++) {
+		lpc_usbnetdata.rxbufs[idx].pc.custom_free_function = lpc_rxbuf_free;
+	}
+
+	/* set MAC hardware address */
+	memcpy(netif->hwaddr, cfg->hwaddr, ETHARP_HWADDR_LEN);
+	netif->hwaddr_len = ETHARP_HWADDR_LEN;
+
+	/* maximum transfer unit */
+	netif->mtu = 1500;
+
+	/* device capabilities, the link comes up once the host has configured the function */
+	netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_UP |
+				   NETIF_FLAG_ETHERNET;
+
+	netif->state = &lpc_usbnetdata;
+
+#if LWIP_NETIF_HOSTNAME
+	/* Initialize interface hostname */
+	netif->hostname = "lwiplpc";
+#endif /* LWIP_NETIF_HOSTNAME */
+
+	netif->name[0] = 'u';
+	netif->name[1] = 's';
+
+	netif->output = lpc_etharp_output;
+	netif->linkoutput = lpc_low_level_output;
+
+	return ERR_OK;
+}
+
+/**
+ * @}
+ */
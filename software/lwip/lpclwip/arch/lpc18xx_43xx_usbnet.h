@@ -0,0 +1,134 @@
+/*
+ * @brief LPC18xx/43xx LWIP USB RNDIS/CDC-ECM network driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __LPC18XX_43XX_USBNET_H_
+#define __LPC18XX_43XX_USBNET_H_
+
+#include "lwip/opt.h"
+#include "lwip/netif.h"
+#include "USB.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup NET_LWIP_LPC18XX43XX_USBNET_DRIVER 18xx/43xx USB RNDIS/CDC-ECM driver for LWIP
+ * @ingroup NET_LWIP
+ * This is an LWIP network interface carried over the bulk endpoints of a
+ * USB RNDIS or CDC-ECM function of the LPCUSBLib device stack. Received
+ * transfers are made by the USB controller straight into a pool of buffers
+ * that are passed to LWIP as custom pbufs and returned to the pool when
+ * LWIP frees them. Transmitted CDC-ECM packets are sent by the USB
+ * controller from the pbuf payload when the packet is a single pbuf not
+ * referenced elsewhere, other packets and all RNDIS packets from a
+ * linearized copy.
+ *
+ * The driver only handles the data endpoints. The RNDIS control channel is
+ * serviced by the LPCUSBLib RNDIS class driver, the CDC-ECM control requests
+ * and descriptors by the application. LWIP must be built with custom pbuf
+ * support (IP_FRAG_USES_STATIC_BUF = 0).
+ * @{
+ */
+
+/** Framing of the Ethernet frames on the USB data endpoints */
+typedef enum {
+	LPC_USBNET_RNDIS,	/*!< Frames are preceded by a RNDIS packet message header */
+	LPC_USBNET_ECM		/*!< Raw frames, CDC-ECM */
+} LPC_USBNET_FRAMING_T;
+
+/** USB network interface configuration, passed as the state of netif_add() */
+struct lpc_usbnetcfg {
+	LPC_USBNET_FRAMING_T framing;	/**< Framing used on the data endpoints */
+	uint8_t corenum;				/**< USB port the function is running on */
+	uint8_t in_ep;					/**< Bulk IN data endpoint number */
+	uint8_t out_ep;					/**< Bulk OUT data endpoint number */
+	uint16_t in_ep_size;			/**< Bulk IN data endpoint size */
+	USB_ClassInfo_RNDIS_Device_t *rndis;	/**< RNDIS interface whose state gives the link state, NULL for CDC-ECM */
+	u8_t hwaddr[6];					/**< MAC address of the LWIP side of the link */
+};
+
+/**
+ * @brief	Pass received packets to LWIP, reclaim sent packets and follow the link state
+ * @param	netif	: lwip network interface structure pointer
+ * @return	Nothing
+ * @note	Should be called periodically from the main loop (NO_SYS = 1) or
+ * from a task (NO_SYS = 0).
+ */
+void lpc_usbnetif_input(struct netif *netif);
+
+/**
+ * @brief	Set the link state of a CDC-ECM interface
+ * @param	netif	: lwip network interface structure pointer
+ * @param	up		: 1 when the host has enabled the data interface, 0 otherwise
+ * @return	Nothing
+ * @note	RNDIS interfaces follow the RNDIS class driver state instead.
+ */
+void lpc_usbnetif_set_link(struct netif *netif, int up);
+
+/**
+ * @brief	Data endpoint transfer completion handler
+ * @param	logicalEP	: Logical endpoint number of the completed transfer
+ * @param	xfer_in		: 0 for an OUT transfer, IN transfer otherwise
+ * @return	Nothing
+ * @note	Must be called from EVENT_USB_Device_TransferComplete().
+ */
+void lpc_usbnetif_xfer_done(int logicalEP, int xfer_in);
+
+/**
+ * @brief	USB reset and configuration change handler
+ * @return	Nothing
+ * @note	Must be called from EVENT_USB_Device_Reset() and
+ * EVENT_USB_Device_ConfigurationChanged(). The transfers queued before are
+ * dropped by the controller, so the data transfers are stopped until the
+ * host has set up the function again. A CDC-ECM link stays down until
+ * lpc_usbnetif_set_link() is called again.
+ */
+void lpc_usbnetif_usb_reset(void);
+
+/**
+ * @brief	LWIP 18xx/43xx USB network interface initialization function
+ * @param	netif	: lwip network interface structure pointer, whose state
+ *					  points to a struct lpc_usbnetcfg
+ * @return	ERR_OK if the interface is initialized, or ERR_* on other errors
+ * @note	This function should be passed as a parameter to netif_add().
+ */
+err_t lpc_usbnetif_init(struct netif *netif);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* __LPC18XX_43XX_USBNET_H_ */